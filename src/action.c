@@ -179,6 +179,7 @@ typedef enum
   F_SelectedTexts,
   F_SelectedVias,
   F_SelectedRats,
+  F_Stats,
   F_Stroke,
   F_Text,
   F_TextByName,
@@ -188,6 +189,7 @@ typedef enum
   F_ToggleAllDirections,
   F_ToggleAutoDRC,
   F_ToggleClearLine,
+  F_ToggleFullDetail,
   F_ToggleFullPoly,
   F_ToggleGrid,
   F_ToggleHideNames,
@@ -419,6 +421,7 @@ static FunctionType Functions[] = {
   {"SelectedRats", F_SelectedRats},
   {"SelectedTexts", F_SelectedTexts},
   {"SelectedVias", F_SelectedVias},
+  {"Stats", F_Stats},
   {"Stroke", F_Stroke},
   {"Text", F_Text},
   {"TextByName", F_TextByName},
@@ -427,6 +430,7 @@ static FunctionType Functions[] = {
   {"ToLayout", F_ToLayout},
   {"Toggle45Degree", F_ToggleAllDirections},
   {"ToggleClearLine", F_ToggleClearLine},
+  {"ToggleFullDetail", F_ToggleFullDetail},
   {"ToggleFullPoly", F_ToggleFullPoly},
   {"ToggleGrid", F_ToggleGrid},
   {"ToggleMask", F_ToggleMask},
@@ -1612,6 +1616,7 @@ NotifyMode (void)
 
 		save_n = NAME_INDEX (PCB);
 
+		UpdateElementNameIndex (PCB->Data, e, false);
 		for (i = 0; i < MAX_ELEMENTNAMES; i++)
 		  {
 		    if (i == save_n)
@@ -1626,6 +1631,7 @@ NotifyMode (void)
 		    if (i == save_n)
 		      DrawElementName (e);
 		  }
+		UpdateElementNameIndex (PCB->Data, e, true);
 	      }
 	  }
 	break;
@@ -2482,6 +2488,7 @@ static const char display_syntax[] =
   "Display(ToggleGrid|ToggleRubberBandMode|ToggleUniqueNames)\n"
   "Display(ToggleMask|ToggleName|ToggleClearLine|ToggleFullPoly|ToggleSnapPin)\n"
   "Display(ToggleThindraw|ToggleThindrawPoly|ToggleOrthoMove|ToggleLocalRef)\n"
+  "Display(ToggleFullDetail)\n"
   "Display(ToggleCheckPlanes|ToggleShowDRC|ToggleAutoDRC)\n"
   "Display(ToggleLiveRoute|LockNames|OnlyNames)\n"
   "Display(Pinout|PinOrPadName)");
@@ -2541,6 +2548,11 @@ for example.
 @item ToggleThindrawPoly
 If set, polygons on the screen are drawn as outlines.
 
+@item ToggleFullDetail
+If set, every object is drawn even when zoomed far out.  Otherwise
+objects and crowded areas only a pixel or two across are drawn as
+filled tiles, which is much faster on large boards.
+
 @item ToggleShowDRC
 If set, pending objects (i.e. lines you're in the process of drawing)
 will be drawn with an outline showing how far away from other copper
@@ -2753,6 +2765,11 @@ ActionDisplay (int argc, char **argv, Coord childX, Coord childY)
 	  Redraw ();
 	  break;
 
+	case F_ToggleFullDetail:
+	  Settings.FullDetail = !Settings.FullDetail;
+	  Redraw ();
+	  break;
+
 	case F_ToggleLockNames:
 	  TOGGLE_FLAG (LOCKNAMESFLAG, PCB);
 	  CLEAR_FLAG (ONLYNAMESFLAG, PCB);
@@ -3943,7 +3960,8 @@ ActionAutoPlaceSelected (int argc, char **argv, Coord x, Coord y)
 
 /* --------------------------------------------------------------------------- */
 
-static const char autoroute_syntax[] = N_("AutoRoute(AllRats|SelectedRats)");
+static const char autoroute_syntax[] =
+  N_("AutoRoute(AllRats|SelectedRats[, Stats[, filename]])");
 
 static const char autoroute_help[] = N_("Auto-route some or all rat lines.");
 
@@ -3957,6 +3975,16 @@ Attempt to autoroute all rats.
 @item SelectedRats
 Attempt to autoroute the selected rats.
 
+@item Stats
+Given as the second argument, write statistics about the run to
+@var{filename} as JSON, or to @file{autoroute-stats.json} if no file
+name is given.  A file name of @code{-} writes them to standard output.
+For every pass and for every net routed in it they give the wall time,
+the number of searches, the edges created and expanded, the expansion
+areas, the @code{mtspace} queries and vetting iterations, the conflicts
+and rip-ups, and the peak sizes of the search heap and of the router's
+working memory.
+
 @end table
 
 Before autorouting, it's important to set up a few things.  First,
@@ -3974,18 +4002,26 @@ static int
 ActionAutoRoute (int argc, char **argv, Coord x, Coord y)
 {
   char *function = ARG (0);
+  char *stats_file = NULL;
+
+  if (ARG (1))
+    {
+      if (GetFunctionID (ARG (1)) != F_Stats)
+	AFAIL (autoroute);
+      stats_file = ARG (2) ? ARG (2) : "autoroute-stats.json";
+    }
   hid_action("Busy");
   if (function)			/* one parameter */
     {
       switch (GetFunctionID (function))
 	{
 	case F_AllRats:
-	  if (AutoRoute (false))
+	  if (AutoRoute (false, stats_file))
 	    SetChangedFlag (true);
 	  break;
 	case F_SelectedRats:
 	case F_Selected:
-	  if (AutoRoute (true))
+	  if (AutoRoute (true, stats_file))
 	    SetChangedFlag (true);
 	  break;
 	}
@@ -6896,6 +6932,210 @@ ChangeFlag (char *what, char *flag_name, int value, char *cmd_name)
 
 /* --------------------------------------------------------------------------- */
 
+static const char benchmarkactions_syntax[] =
+  N_("BenchmarkActions(count, actions)");
+
+static const char benchmarkactions_help[] =
+  N_("Report how many actions per second the action parser can run.");
+
+/* %start-doc actions BenchmarkActions
+
+Runs the given action string @code{count} times, first by parsing it on
+every run as menus and scripts do, then as a script compiled once with
+@code{hid_compile_actions}.  The number of actions per second of both
+is reported.  A failing action ends that pass early, and only its
+completed runs are counted.  The actions really are executed, so pick
+ones whose effect on the board is harmless, for example:
+
+@example
+BenchmarkActions(100000, "Mode(None)")
+@end example
+
+%end-doc */
+
+static int
+ActionBenchmarkActions (int argc, char **argv, Coord x, Coord y)
+{
+  HID_ActionScript *script;
+  GTimer *timer;
+  long i, count, parsed_runs, compiled_runs;
+  int length;
+  double parsed, compiled;
+
+  if (argc != 2)
+    AFAIL (benchmarkactions);
+
+  count = strtol (argv[0], NULL, 0);
+  if (count <= 0)
+    AFAIL (benchmarkactions);
+
+  script = hid_compile_actions (argv[1]);
+  if (script == NULL)
+    return 1;
+  length = hid_compiled_actions_length (script);
+
+  timer = g_timer_new ();
+  for (i = 0; i < count; i++)
+    if (hid_parse_actions (argv[1]))
+      break;
+  parsed = g_timer_elapsed (timer, NULL);
+  parsed_runs = i;
+
+  g_timer_start (timer);
+  for (i = 0; i < count; i++)
+    if (hid_run_compiled_actions (script))
+      break;
+  compiled = g_timer_elapsed (timer, NULL);
+  compiled_runs = i;
+
+  g_timer_destroy (timer);
+  hid_free_compiled_actions (script);
+
+  /* a failing action stops a loop early, so only count whole runs */
+  Message (_("parsed:   %g actions per second, %ld of %ld runs\n"),
+	   parsed > 0 ? (double) parsed_runs * length / parsed : 0.0,
+	   parsed_runs, count);
+  Message (_("compiled: %g actions per second, %ld of %ld runs\n"),
+	   compiled > 0 ? (double) compiled_runs * length / compiled : 0.0,
+	   compiled_runs, count);
+  return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static const char benchmarkobjects_syntax[] =
+  N_("BenchmarkObjects([count])");
+
+static const char benchmarkobjects_help[] =
+  N_("Report how fast lines can be created and destroyed.");
+
+/* %start-doc actions BenchmarkObjects
+
+Creates @code{count} lines (one million by default) on a scratch layer
+that is not part of the board, then destroys them again, newest first.
+The time taken by both phases is reported.  The board is not touched.
+
+%end-doc */
+
+static int
+ActionBenchmarkObjects (int argc, char **argv, Coord x, Coord y)
+{
+  DataType *scratch;
+  LayerType *layer;
+  GPtrArray *lines;
+  GTimer *timer;
+  long i, count = 1000000;
+  double created, destroyed;
+
+  if (argc > 1)
+    AFAIL (benchmarkobjects);
+  if (argc == 1)
+    count = strtol (argv[0], NULL, 0);
+  if (count <= 0)
+    AFAIL (benchmarkobjects);
+
+  scratch = CreateNewBuffer ();
+  layer = &scratch->Layer[0];
+  lines = g_ptr_array_sized_new (count);
+
+  timer = g_timer_new ();
+  for (i = 0; i < count; i++)
+    {
+      Coord cx = (i % 1000) * MIL_TO_COORD (20);
+      Coord cy = (i / 1000) * MIL_TO_COORD (20);
+
+      g_ptr_array_add (lines,
+		       CreateNewLineOnLayer (layer, cx, cy,
+					     cx + MIL_TO_COORD (10), cy,
+					     MIL_TO_COORD (8), MIL_TO_COORD (10),
+					     NoFlags ()));
+    }
+  created = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = count - 1; i >= 0; i--)
+    {
+      LineType *line = (LineType *) g_ptr_array_index (lines, i);
+
+      DestroyObject (scratch, LINE_TYPE, layer, line, line);
+    }
+  destroyed = g_timer_elapsed (timer, NULL);
+
+  g_timer_destroy (timer);
+  g_ptr_array_free (lines, TRUE);
+  FreeDataMemory (scratch);
+  free (scratch);
+
+  Message (_("created %ld lines in %.3f s, destroyed them in %.3f s\n"),
+	   count, created, destroyed);
+  return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
+static const char benchmarkbom_syntax[] =
+  N_("BenchmarkBOM([count])");
+
+static const char benchmarkbom_help[] =
+  N_("Report how fast the BOM, XY and JSON files can be exported.");
+
+/* %start-doc actions BenchmarkBOM
+
+Runs the @code{bom} exporter @code{count} times (ten by default) on the
+current board, with its BOM, XY and JSON files all written to
+@file{/dev/null}, and reports the time taken per export.
+
+%end-doc */
+
+static int
+ActionBenchmarkBOM (int argc, char **argv, Coord x, Coord y)
+{
+  HID *bom = hid_find_exporter ("bom");
+  HID_Attribute *opts;
+  HID_Attr_Val *vals;
+  GTimer *timer;
+  long i, count = 10;
+  int n;
+  double elapsed;
+
+  if (argc > 1)
+    AFAIL (benchmarkbom);
+  if (argc == 1)
+    count = strtol (argv[0], NULL, 0);
+  if (count <= 0)
+    AFAIL (benchmarkbom);
+  if (bom == NULL)
+    {
+      Message (_("BenchmarkBOM(): the bom exporter is not available\n"));
+      return 1;
+    }
+
+  opts = bom->get_export_options (&n);
+  vals = g_new0 (HID_Attr_Val, n);
+  for (i = 0; i < n; i++)
+    {
+      vals[i] = opts[i].default_val;
+      if (strcmp (opts[i].name, "bomfile") == 0
+	  || strcmp (opts[i].name, "xyfile") == 0
+	  || strcmp (opts[i].name, "jsonfile") == 0)
+	vals[i].str_value = "/dev/null";
+    }
+
+  timer = g_timer_new ();
+  for (i = 0; i < count; i++)
+    bom->do_export (vals);
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_timer_destroy (timer);
+  g_free (vals);
+
+  Message (_("exported %u elements %ld times, %.3f ms per export\n"),
+	   (unsigned) PCB->Data->ElementN, count, elapsed * 1000.0 / count);
+  return 0;
+}
+
+/* --------------------------------------------------------------------------- */
+
 static const char executefile_syntax[] = N_("ExecuteFile(filename)");
 
 static const char executefile_help[] = N_("Run actions from the given file.");
@@ -8474,6 +8714,15 @@ HID_Action action_action_list[] = {
   {"AutoRoute", 0, ActionAutoRoute,
    autoroute_help, autoroute_syntax}
   ,
+  {"BenchmarkActions", 0, ActionBenchmarkActions,
+   benchmarkactions_help, benchmarkactions_syntax}
+  ,
+  {"BenchmarkBOM", 0, ActionBenchmarkBOM,
+   benchmarkbom_help, benchmarkbom_syntax}
+  ,
+  {"BenchmarkObjects", 0, ActionBenchmarkObjects,
+   benchmarkobjects_help, benchmarkobjects_syntax}
+  ,
   {"ChangeClearSize", 0, ActionChangeClearSize,
    changeclearsize_help, changeclearsize_syntax}
   ,
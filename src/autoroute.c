@@ -448,6 +448,32 @@ static int routing_layers = 0;
 static float total_wire_length = 0;
 static int total_via_count = 0;
 
+/*!
+ * \brief Running totals of the router's work.
+ *
+ * These are always kept since they cost a few increments; the
+ * per-net and per-pass figures written by AutoRoute(..., Stats) are
+ * differences between two snapshots.  The peaks are reset at the
+ * start of every net.
+ */
+typedef struct route_counters
+{
+  long searches;		/* calls to RouteOne */
+  long edges_created;
+  long edges_expanded;
+  long expansion_areas;
+  long conflicts;		/* conflicts on the paths found */
+  long mtspace_queries;		/* copied from mtspace_counters */
+  long vetting_iterations;	/* copied from mtspace_counters */
+  int heap_peak;		/* largest search work heap */
+  int edges_peak;		/* most edges alive at once */
+  long areas_peak;		/* most expansion areas made by one search */
+}
+route_counters_t;
+
+static route_counters_t counters;
+static int live_edges = 0;
+
 /* assertion helper for routeboxen */
 #ifndef NDEBUG
 static int
@@ -1033,8 +1059,9 @@ CreateRouteData ()
    *
    * this saves on searching the trees to find the nets
    */
-  /* use the DRCFLAG to mark objects as they are entered */
+  /* mark objects in a fresh search epoch as they are entered */
   Nets = CollectSubnets (false);
+  NewSearchEpoch ();
   {
     routebox_t *last_net = NULL;
     NETLIST_LOOP (&Nets);
@@ -1051,7 +1078,7 @@ CreateRouteData ()
 	CONNECTION_LOOP (net);
 	{
 	  routebox_t *rb = NULL;
-	  SET_FLAG (DRCFLAG, (PinType *) connection->ptr2);
+	  SET_MARK ((PinType *) connection->ptr2);
 	  if (connection->type == LINE_TYPE)
 	    {
 	      LineType *line = (LineType *) connection->ptr2;
@@ -1160,26 +1187,20 @@ CreateRouteData ()
   /* add pins and pads of elements */
   ALLPIN_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (DRCFLAG, pin))
-      CLEAR_FLAG (DRCFLAG, pin);
-    else
+    if (!TEST_MARK (pin))
       AddPin (layergroupboxes, pin, false, rd->styles[NUM_STYLES]);
   }
   ENDALL_LOOP;
   ALLPAD_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (DRCFLAG, pad))
-      CLEAR_FLAG (DRCFLAG, pad);
-    else
+    if (!TEST_MARK (pad))
       AddPad (layergroupboxes, element, pad, rd->styles[NUM_STYLES]);
   }
   ENDALL_LOOP;
   /* add all vias */
   VIA_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (DRCFLAG, via))
-      CLEAR_FLAG (DRCFLAG, via);
-    else
+    if (!TEST_MARK (via))
       AddPin (layergroupboxes, via, true, rd->styles[NUM_STYLES]);
   }
   END_LOOP;
@@ -1190,11 +1211,8 @@ CreateRouteData ()
       /* add all (non-rat) lines */
       LINE_LOOP (LAYER_PTR (i));
       {
-	if (TEST_FLAG (DRCFLAG, line))
-	  {
-	    CLEAR_FLAG (DRCFLAG, line);
-	    continue;
-	  }
+	if (TEST_MARK (line))
+	  continue;
 	/* dice up non-straight lines into many tiny obstacles */
 	if (line->Point1.X != line->Point2.X
 	    && line->Point1.Y != line->Point2.Y)
@@ -1232,9 +1250,7 @@ CreateRouteData ()
       /* add all polygons */
       POLYGON_LOOP (LAYER_PTR (i));
       {
-	if (TEST_FLAG (DRCFLAG, polygon))
-	  CLEAR_FLAG (DRCFLAG, polygon);
-	else
+	if (!TEST_MARK (polygon))
 	  AddPolygon (layergroupboxes, i, polygon, rd->styles[NUM_STYLES]);
       }
       END_LOOP;
@@ -1756,6 +1772,9 @@ CreateEdge (routebox_t * rb,
   e = (edge_t *)malloc (sizeof (*e));
   memset ((void *) e, 0, sizeof (*e));
   assert (e);
+  counters.edges_created++;
+  if (++live_edges > counters.edges_peak)
+    counters.edges_peak = live_edges;
   e->rb = rb;
   if (rb->flags.homeless)
     RB_up_count (rb);
@@ -1953,6 +1972,7 @@ KillEdge (void *edge)
   if (e->flags.via_search)
     mtsFreeWork (&e->work);
   free (e);
+  live_edges--;
 }
 
 static void
@@ -2092,6 +2112,7 @@ CreateExpansionArea (const BoxType * area, Cardinal group,
   routebox_t *rb = (routebox_t *) malloc (sizeof (*rb));
   memset ((void *) rb, 0, sizeof (*rb));
   assert (area && parent);
+  counters.expansion_areas++;
   init_const_box (rb, area->X1, area->Y1, area->X2, area->Y2, 0);
   rb->group = group;
   rb->type = EXPANSION_AREA;
@@ -2501,6 +2522,7 @@ CreateBridge (const BoxType * area, routebox_t * parent, direction_t dir)
   routebox_t *rb = (routebox_t *) malloc (sizeof (*rb));
   memset ((void *) rb, 0, sizeof (*rb));
   assert (area && parent);
+  counters.expansion_areas++;
   init_const_box (rb, area->X1, area->Y1, area->X2, area->Y2, 0);
   rb->group = parent->group;
   rb->type = EXPANSION_AREA;
@@ -3775,6 +3797,9 @@ CreateSearchEdge (struct routeone_state *s, vetting_t * work, edge_t * parent,
       ne = (edge_t *)malloc (sizeof (*ne));
       memset ((void *) ne, 0, sizeof (*ne));
       assert (ne);
+      counters.edges_created++;
+      if (++live_edges > counters.edges_peak)
+	counters.edges_peak = live_edges;
       ne->flags.via_search = 1;
       ne->flags.in_plane = in_plane;
       ne->rb = rb;
@@ -4083,8 +4108,11 @@ RouteOne (routedata_t * rd, routebox_t * from, routebox_t * to, int max_edges)
 
   struct routeone_state s;
   struct routeone_via_site_state vss;
+  long first_area;
 
   assert (rd && from);
+  counters.searches++;
+  first_area = counters.expansion_areas;
   result.route_had_conflicts = 0;
   /* no targets on to/from net need keepaway areas */
   LIST_LOOP (from, same_net, p);
@@ -4232,7 +4260,11 @@ RouteOne (routedata_t * rd, routebox_t * from, routebox_t * to, int max_edges)
   vss.hi_conflict_space_vec = vector_create ();
   while (!heap_is_empty (s.workheap))
     {
-      edge_t *e = (edge_t *)heap_remove_smallest (s.workheap);
+      edge_t *e;
+
+      if (heap_size (s.workheap) > counters.heap_peak)
+	counters.heap_peak = heap_size (s.workheap);
+      e = (edge_t *)heap_remove_smallest (s.workheap);
 #ifdef ROUTE_DEBUG
       if (aabort)
 	goto dontexpand;
@@ -4251,6 +4283,7 @@ RouteOne (routedata_t * rd, routebox_t * from, routebox_t * to, int max_edges)
       if (seen++ > max_edges)
 	goto dontexpand;
       assert (__edge_is_good (e));
+      counters.edges_expanded++;
       /* mark or unmark conflictors as needed */
       touch_conflicts (e->rb->conflicts_with, 1);
       if (e->flags.via_search)
@@ -4549,6 +4582,7 @@ RouteOne (routedata_t * rd, routebox_t * from, routebox_t * to, int max_edges)
 	      rb->flags.is_bad = 1;
 	      result.route_had_conflicts++;
 	    }
+	  counters.conflicts += result.route_had_conflicts;
 	}
 #ifdef ROUTE_VERBOSE
       if (result.route_had_conflicts)
@@ -4591,6 +4625,8 @@ RouteOne (routedata_t * rd, routebox_t * from, routebox_t * to, int max_edges)
       r_delete_entry (rd->layergrouptree[rb->group], &rb->box);
     }
   vector_destroy (&area_vec);
+  if (counters.expansion_areas - first_area > counters.areas_peak)
+    counters.areas_peak = counters.expansion_areas - first_area;
   /* clean up; remove all 'source', 'target', and 'nobloat' flags */
   LIST_LOOP (from, same_net, p);
   if (p->flags.source && p->conflicts_with)
@@ -4731,6 +4767,282 @@ calculate_progress (double this_heap_item, double this_heap_size,
   return process_fraction;
 }
 
+/* ---------------------------------------------------------------------------
+ * runtime statistics, written by AutoRoute(..., Stats)
+ */
+
+/*!
+ * \brief State of the statistics file being written, or NULL when the
+ * router runs without one.
+ */
+static struct route_stats
+{
+  FILE *fp;
+  GTimer *timer;
+  bool cancelled;
+  bool in_pass;
+  int passes_written;
+  int nets_written;
+  double setup_seconds;
+  double pass_start;
+  double net_start;
+  route_counters_t run_base, pass_base, net_base;
+  route_counters_t run_peaks, pass_peaks;
+  struct routeall_status net_ras;
+} *stats = NULL;
+
+static route_counters_t
+stats_snapshot (void)
+{
+  route_counters_t now = counters;
+
+  now.mtspace_queries = mtspace_counters.queries;
+  now.vetting_iterations = mtspace_counters.iterations;
+  return now;
+}
+
+static void
+stats_fold_peaks (route_counters_t *into, const route_counters_t *from)
+{
+  MAKEMAX (into->heap_peak, from->heap_peak);
+  MAKEMAX (into->edges_peak, from->edges_peak);
+  MAKEMAX (into->areas_peak, from->areas_peak);
+}
+
+/*!
+ * \brief Write \c str to the statistics file as a quoted JSON string.
+ */
+static void
+stats_string (const char *str)
+{
+  const unsigned char *c;
+
+  fputc ('"', stats->fp);
+  for (c = (const unsigned char *) str; *c; c++)
+    if (*c == '"' || *c == '\\')
+      fprintf (stats->fp, "\\%c", *c);
+    else if (*c < 0x20)
+      fprintf (stats->fp, "\\u%04x", *c);
+    else
+      fputc (*c, stats->fp);
+  fputc ('"', stats->fp);
+}
+
+/*!
+ * \brief Names a net after its first element pin or pad, e.g. "U1-3".
+ */
+static void
+stats_net_label (routebox_t * net)
+{
+  routebox_t *p;
+  char *label;
+
+  LIST_LOOP (net, same_net, p);
+  {
+    if (p->type == PIN || p->type == PAD)
+      {
+	ElementType *element;
+	char *number;
+
+	if (p->type == PIN)
+	  {
+	    element = (ElementType *) p->parent.pin->Element;
+	    number = p->parent.pin->Number;
+	  }
+	else
+	  {
+	    element = (ElementType *) p->parent.pad->Element;
+	    number = p->parent.pad->Number;
+	  }
+	label = g_strdup_printf ("%s-%s", EMPTY (NAMEONPCB_NAME (element)),
+				 EMPTY (number));
+	stats_string (label);
+	g_free (label);
+	return;
+      }
+  }
+  END_LOOP;
+  fputs ("null", stats->fp);
+}
+
+/*!
+ * \brief Write the work done between \c base and \c now, and the
+ * peaks reached meanwhile.
+ */
+static void
+stats_counters (const route_counters_t *now, const route_counters_t *base,
+		const route_counters_t *peaks, const char *indent)
+{
+  fprintf (stats->fp,
+	   "%s\"searches\": %ld, \"edges_created\": %ld, "
+	   "\"edges_expanded\": %ld, \"expansion_areas\": %ld,\n"
+	   "%s\"conflicts\": %ld, \"mtspace_queries\": %ld, "
+	   "\"vetting_iterations\": %ld,\n"
+	   "%s\"heap_peak\": %d, \"edges_peak\": %d, \"areas_peak\": %ld, "
+	   "\"memory_peak\": %lu",
+	   indent, now->searches - base->searches,
+	   now->edges_created - base->edges_created,
+	   now->edges_expanded - base->edges_expanded,
+	   now->expansion_areas - base->expansion_areas,
+	   indent, now->conflicts - base->conflicts,
+	   now->mtspace_queries - base->mtspace_queries,
+	   now->vetting_iterations - base->vetting_iterations,
+	   indent, peaks->heap_peak, peaks->edges_peak, peaks->areas_peak,
+	   (unsigned long) (peaks->edges_peak * sizeof (edge_t)
+			    + peaks->areas_peak * sizeof (routebox_t)));
+}
+
+/*!
+ * \brief Start writing statistics to \c filename, or to stdout if it
+ * is "-".
+ */
+static void
+stats_open (const char *filename, bool selected)
+{
+  FILE *fp;
+
+  if (strcmp (filename, "-") == 0)
+    fp = stdout;
+  else if ((fp = fopen (filename, "w")) == NULL)
+    {
+      Message (_("Can't open %s for the autorouter statistics\n"), filename);
+      return;
+    }
+
+  stats = g_new0 (struct route_stats, 1);
+  stats->fp = fp;
+  stats->timer = g_timer_new ();
+  stats->run_base = stats_snapshot ();
+
+  fprintf (fp, "{\n  \"board\": ");
+  if (PCB->Filename)
+    stats_string (PCB->Filename);
+  else
+    fputs ("null", fp);
+  fprintf (fp, ",\n  \"selected\": %s,\n  \"passes\": [",
+	   selected ? "true" : "false");
+}
+
+static void
+stats_pass_begin (int pass, int queued_nets)
+{
+  if (!stats)
+    return;
+
+  fprintf (stats->fp,
+	   "%s\n    {\"pass\": %d, \"kind\": \"%s\", \"queued_nets\": %d,\n"
+	   "     \"nets\": [",
+	   stats->passes_written ? "," : "", pass,
+	   pass == 0 ? "route" : pass <= passes ? "refine" : "smooth",
+	   queued_nets);
+  stats->in_pass = true;
+  stats->nets_written = 0;
+  stats->pass_start = g_timer_elapsed (stats->timer, NULL);
+  stats->pass_base = stats_snapshot ();
+  memset (&stats->pass_peaks, 0, sizeof (stats->pass_peaks));
+}
+
+static void
+stats_net_begin (struct routeall_status *ras)
+{
+  if (!stats)
+    return;
+
+  stats->net_start = g_timer_elapsed (stats->timer, NULL);
+  stats->net_base = stats_snapshot ();
+  stats->net_ras = *ras;
+  counters.heap_peak = 0;
+  counters.edges_peak = live_edges;
+  counters.areas_peak = 0;
+}
+
+static void
+stats_net_end (routebox_t * net, struct routeall_status *ras, cost_t cost,
+	       bool complete)
+{
+  route_counters_t now;
+
+  if (!stats)
+    return;
+
+  now = stats_snapshot ();
+  stats_fold_peaks (&stats->pass_peaks, &now);
+  fprintf (stats->fp, "%s\n      {\"net\": ",
+	   stats->nets_written++ ? "," : "");
+  stats_net_label (net);
+  fprintf (stats->fp, ", \"style\": ");
+  stats_string (EMPTY (net->style->Name));
+  fprintf (stats->fp,
+	   ", \"seconds\": %.6f,\n"
+	   "       \"subnets\": %d, \"routed\": %d, \"with_conflicts\": %d, "
+	   "\"failed\": %d, \"ripped\": %s, \"complete\": %s, \"cost\": %.0f,\n",
+	   g_timer_elapsed (stats->timer, NULL) - stats->net_start,
+	   ras->total_subnets - stats->net_ras.total_subnets,
+	   ras->routed_subnets - stats->net_ras.routed_subnets,
+	   ras->conflict_subnets - stats->net_ras.conflict_subnets,
+	   ras->failed - stats->net_ras.failed,
+	   ras->ripped != stats->net_ras.ripped ? "true" : "false",
+	   complete ? "true" : "false", (double) cost);
+  stats_counters (&now, &stats->net_base, &now, "       ");
+  fprintf (stats->fp, "}");
+}
+
+static void
+stats_pass_end (struct routeall_status *ras, cost_t cost)
+{
+  route_counters_t now;
+
+  if (!stats || !stats->in_pass)
+    return;
+
+  now = stats_snapshot ();
+  stats_fold_peaks (&stats->run_peaks, &stats->pass_peaks);
+  fprintf (stats->fp,
+	   "\n     ],\n"
+	   "     \"seconds\": %.6f, \"subnets\": %d, \"routed\": %d, "
+	   "\"with_conflicts\": %d,\n"
+	   "     \"failed\": %d, \"ripped\": %d, \"cost\": %.0f,\n",
+	   g_timer_elapsed (stats->timer, NULL) - stats->pass_start,
+	   ras->total_subnets, ras->routed_subnets, ras->conflict_subnets,
+	   ras->failed, ras->ripped, (double) cost);
+  stats_counters (&now, &stats->pass_base, &stats->pass_peaks, "     ");
+  fprintf (stats->fp, "}");
+  stats->passes_written++;
+  stats->in_pass = false;
+}
+
+/*!
+ * \brief Finish the statistics file with the totals of the whole run.
+ */
+static void
+stats_close (void)
+{
+  route_counters_t now;
+
+  if (!stats)
+    return;
+
+  now = stats_snapshot ();
+  fprintf (stats->fp,
+	   "\n  ],\n"
+	   "  \"cancelled\": %s, \"setup_seconds\": %.6f, \"seconds\": %.6f,\n"
+	   "  \"wire_length_mm\": %.3f, \"vias\": %d,\n"
+	   "  \"totals\": {\n",
+	   stats->cancelled ? "true" : "false", stats->setup_seconds,
+	   g_timer_elapsed (stats->timer, NULL),
+	   COORD_TO_MM (total_wire_length), total_via_count);
+  stats_counters (&now, &stats->run_base, &stats->run_peaks, "    ");
+  fprintf (stats->fp, "}\n}\n");
+
+  if (stats->fp != stdout)
+    fclose (stats->fp);
+  else
+    fflush (stats->fp);
+  g_timer_destroy (stats->timer);
+  g_free (stats);
+  stats = NULL;
+}
+
 struct routeall_status
 RouteAll (routedata_t * rd)
 {
@@ -4789,6 +5101,7 @@ RouteAll (routedata_t * rd)
       assert (heap_is_empty (next_pass));
 
       this_heap_size = heap_size (this_pass);
+      stats_pass_begin (i, this_heap_size);
       for (this_heap_item = 0; !heap_is_empty (this_pass); this_heap_item++)
 	{
 #ifdef ROUTE_DEBUG
@@ -4796,6 +5109,7 @@ RouteAll (routedata_t * rd)
 	    break;
 #endif
 	  net = (routebox_t *) heap_remove_smallest (this_pass);
+	  stats_net_begin (&ras);
 	  InitAutoRouteParameters (i, net->style, i < passes, i > passes,
 				   i == passes + smoothes);
 	  if (i > 0)
@@ -4961,6 +5275,8 @@ RouteAll (routedata_t * rd)
 						  _("Autorouting tracks"));
 		  if (request_cancel)
 		    {
+		      if (stats)
+			stats->cancelled = true;
 		      ras.total_nets_routed = 0;
 		      ras.conflict_subnets = 0;
 		      Message ("Autorouting cancelled\n");
@@ -4973,6 +5289,7 @@ RouteAll (routedata_t * rd)
 #endif
 	  if (!ros.net_completely_routed)
 	    net->flags.is_bad = 1;	/* don't skip this the next round */
+	  stats_net_end (net, &ras, total_net_cost, ros.net_completely_routed);
 
 	  /* Route easiest nets from this pass first on next pass.
 	   * This works best because it's likely that the hardest
@@ -5002,6 +5319,7 @@ RouteAll (routedata_t * rd)
 	 i, ras.routed_subnets, ras.total_subnets, this_cost,
 	 ras.conflict_subnets, ras.failed, ras.ripped);
 #endif
+      stats_pass_end (&ras, this_cost);
 #ifdef ROUTE_DEBUG
       if (aabort)
 	break;
@@ -5021,6 +5339,7 @@ RouteAll (routedata_t * rd)
 	   ras.routed_subnets, ras.total_subnets);
 
 out:
+  stats_pass_end (&ras, this_cost);
   heap_destroy (&this_pass);
   heap_destroy (&next_pass);
 #ifdef NET_HEAP
@@ -5226,7 +5545,7 @@ IronDownAllUnfixedPaths (routedata_t * rd)
 }
 
 bool
-AutoRoute (bool selected)
+AutoRoute (bool selected, const char *stats_file)
 {
   bool changed = false;
   routedata_t *rd;
@@ -5257,7 +5576,11 @@ AutoRoute (bool selected)
     }
   if (PCB->Data->RatN == 0)
     return (false);
+  if (stats_file)
+    stats_open (stats_file, selected);
   rd = CreateRouteData ();
+  if (stats)
+    stats->setup_seconds = g_timer_elapsed (stats->timer, NULL);
 
   if (1)
     {
@@ -5295,11 +5618,26 @@ AutoRoute (bool selected)
                */
               if (a != NULL && b != NULL)
                 {
+                  struct routeall_status ras;
+                  struct routeone_status ros;
+
                   assert (a->style == b->style);
+                  memset (&ras, 0, sizeof (ras));
+                  stats_pass_begin (0, 1);
+                  stats_net_begin (&ras);
                   /* route exactly one net, without allowing conflicts */
                   InitAutoRouteParameters (0, a->style, false, true, true);
                   /* hace planes work better as sources than targets */
-                  changed = RouteOne (rd, a, b, 150000).found_route || changed;
+                  ros = RouteOne (rd, a, b, 150000);
+                  ras.total_subnets = 1;
+                  if (ros.found_route)
+                    ras.routed_subnets = ras.total_nets_routed = 1;
+                  else
+                    ras.failed = 1;
+                  stats_net_end (a, &ras, ros.best_route_cost,
+                                 ros.found_route);
+                  stats_pass_end (&ras, ros.best_route_cost);
+                  changed = ros.found_route || changed;
                   goto donerouting;
                 }
 	    }
@@ -5415,6 +5753,7 @@ donerouting:
     changed = IronDownAllUnfixedPaths (rd);
   Message ("Total added wire length = %$mS, %d vias added\n",
 	   (Coord) total_wire_length, total_via_count);
+  stats_close ();
   DestroyRouteData (&rd);
   if (changed)
     {
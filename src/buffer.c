@@ -46,6 +46,7 @@
 #include "create.h"
 #include "crosshair.h"
 #include "data.h"
+#include "drill.h"
 #include "error.h"
 #include "flags.h"
 #include "mymem.h"
@@ -204,7 +205,10 @@ AddPolygonToBuffer (LayerType *Layer, PolygonType *Polygon)
     layer->polygon_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (layer->polygon_tree, (BoxType *)polygon, 0);
 
-  CLEAR_FLAG (NOCOPY_FLAGS | ExtraFlag, polygon);
+  /* Mask the flags directly: going through CLEAR_FLAG would make the
+   * board's selection index think the selection had changed.
+   */
+  polygon->Flags = MaskFlags (polygon->Flags, NOCOPY_FLAGS | ExtraFlag);
   return (polygon);
 }
 
@@ -227,12 +231,15 @@ MoveViaToBuffer (PinType *via)
   RestoreToPolygon (Source, VIA_TYPE, via, via);
 
   r_delete_entry (Source->via_tree, (BoxType *) via);
-  Source->Via = g_list_remove (Source->Via, via);
+  RemoveObjectFromList (&Source->Via, &Source->ViaTail, (AnyObjectType *) via);
   Source->ViaN --;
-  Dest->Via = g_list_append (Dest->Via, via);
+  AppendObjectToList (&Dest->Via, &Dest->ViaTail, (AnyObjectType *) via);
   Dest->ViaN ++;
+  InvalidateDrillInfo (Source);
+  InvalidateDrillInfo (Dest);
 
   CLEAR_FLAG (WARNFLAG | NOCOPY_FLAGS, via);
+  UpdateSelectionIndex (VIA_TYPE, via, via, Dest == PCB->Data);
 
   if (!Dest->via_tree)
     Dest->via_tree = r_create_tree (NULL, 0, 0);
@@ -249,12 +256,13 @@ MoveRatToBuffer (RatType *rat)
 {
   r_delete_entry (Source->rat_tree, (BoxType *)rat);
 
-  Source->Rat = g_list_remove (Source->Rat, rat);
+  RemoveObjectFromList (&Source->Rat, &Source->RatTail, (AnyObjectType *) rat);
   Source->RatN --;
-  Dest->Rat = g_list_append (Dest->Rat, rat);
+  AppendObjectToList (&Dest->Rat, &Dest->RatTail, (AnyObjectType *) rat);
   Dest->RatN ++;
 
   CLEAR_FLAG (NOCOPY_FLAGS, rat);
+  UpdateSelectionIndex (RATLINE_TYPE, rat, rat, Dest == PCB->Data);
 
   if (!Dest->rat_tree)
     Dest->rat_tree = r_create_tree (NULL, 0, 0);
@@ -273,12 +281,14 @@ MoveLineToBuffer (LayerType *layer, LineType *line)
   RestoreToPolygon (Source, LINE_TYPE, layer, line);
   r_delete_entry (layer->line_tree, (BoxType *)line);
 
-  layer->Line = g_list_remove (layer->Line, line);
+  RemoveObjectFromList (&layer->Line, &layer->LineTail,
+			(AnyObjectType *) line);
   layer->LineN --;
-  lay->Line = g_list_append (lay->Line, line);
+  AppendObjectToList (&lay->Line, &lay->LineTail, (AnyObjectType *) line);
   lay->LineN ++;
 
   CLEAR_FLAG (NOCOPY_FLAGS, line);
+  UpdateSelectionIndex (LINE_TYPE, lay, line, Dest == PCB->Data);
 
   if (!lay->line_tree)
     lay->line_tree = r_create_tree (NULL, 0, 0);
@@ -298,12 +308,13 @@ MoveArcToBuffer (LayerType *layer, ArcType *arc)
   RestoreToPolygon (Source, ARC_TYPE, layer, arc);
   r_delete_entry (layer->arc_tree, (BoxType *)arc);
 
-  layer->Arc = g_list_remove (layer->Arc, arc);
+  RemoveObjectFromList (&layer->Arc, &layer->ArcTail, (AnyObjectType *) arc);
   layer->ArcN --;
-  lay->Arc = g_list_append (lay->Arc, arc);
+  AppendObjectToList (&lay->Arc, &lay->ArcTail, (AnyObjectType *) arc);
   lay->ArcN ++;
 
   CLEAR_FLAG (NOCOPY_FLAGS, arc);
+  UpdateSelectionIndex (ARC_TYPE, lay, arc, Dest == PCB->Data);
 
   if (!lay->arc_tree)
     lay->arc_tree = r_create_tree (NULL, 0, 0);
@@ -323,10 +334,12 @@ MoveTextToBuffer (LayerType *layer, TextType *text)
   r_delete_entry (layer->text_tree, (BoxType *)text);
   RestoreToPolygon (Source, TEXT_TYPE, layer, text);
 
-  layer->Text = g_list_remove (layer->Text, text);
+  RemoveObjectFromList (&layer->Text, &layer->TextTail,
+			(AnyObjectType *) text);
   layer->TextN --;
-  lay->Text = g_list_append (lay->Text, text);
+  AppendObjectToList (&lay->Text, &lay->TextTail, (AnyObjectType *) text);
   lay->TextN ++;
+  UpdateSelectionIndex (TEXT_TYPE, lay, text, Dest == PCB->Data);
 
   if (!lay->text_tree)
     lay->text_tree = r_create_tree (NULL, 0, 0);
@@ -347,12 +360,15 @@ MovePolygonToBuffer (LayerType *layer, PolygonType *polygon)
 
   r_delete_entry (layer->polygon_tree, (BoxType *)polygon);
 
-  layer->Polygon = g_list_remove (layer->Polygon, polygon);
+  RemoveObjectFromList (&layer->Polygon, &layer->PolygonTail,
+			(AnyObjectType *) polygon);
   layer->PolygonN --;
-  lay->Polygon = g_list_append (lay->Polygon, polygon);
+  AppendObjectToList (&lay->Polygon, &lay->PolygonTail,
+		      (AnyObjectType *) polygon);
   lay->PolygonN ++;
 
   CLEAR_FLAG (NOCOPY_FLAGS, polygon);
+  UpdateSelectionIndex (POLYGON_TYPE, lay, polygon, Dest == PCB->Data);
 
   if (!lay->polygon_tree)
     lay->polygon_tree = r_create_tree (NULL, 0, 0);
@@ -373,10 +389,16 @@ MoveElementToBuffer (ElementType *element)
    */
   r_delete_element (Source, element);
 
-  Source->Element = g_list_remove (Source->Element, element);
+  UpdateElementNameIndex (Source, element, false);
+  RemoveObjectFromList (&Source->Element, &Source->ElementTail,
+			(AnyObjectType *) element);
   Source->ElementN --;
-  Dest->Element = g_list_append (Dest->Element, element);
+  AppendObjectToList (&Dest->Element, &Dest->ElementTail,
+		      (AnyObjectType *) element);
   Dest->ElementN ++;
+  UpdateElementNameIndex (Dest, element, true);
+  InvalidateDrillInfo (Source);
+  InvalidateDrillInfo (Dest);
 
   PIN_LOOP (element);
   {
@@ -391,6 +413,7 @@ MoveElementToBuffer (ElementType *element)
   }
   END_LOOP;
   SetElementBoundingBox (Dest, element, &PCB->Font);
+  UpdateSelectionIndex (ELEMENT_TYPE, element, element, Dest == PCB->Data);
   /*
    * Now clear the from the polygons in the destination
    */
@@ -846,6 +869,7 @@ LoadFootprint (int argc, char **argv, Coord x, Coord y)
   if (e->Name[2].TextString)
     free (e->Name[2].TextString);
   e->Name[2].TextString = value ? strdup (value) : 0;
+  InvalidateElementNameIndex (PASTEBUFFER->Data);
 
   return 0;
 }
@@ -1094,7 +1118,10 @@ ConvertBufferToElement (BufferType *Buffer)
   LINE_LOOP (&Buffer->Data->SILKLAYER);
   {
     if (line->Number && !NAMEONPCB_NAME (Element))
-      NAMEONPCB_NAME (Element) = strdup (line->Number);
+      {
+	NAMEONPCB_NAME (Element) = strdup (line->Number);
+	UpdateElementNameIndex (PCB->Data, Element, true);
+      }
     CreateNewLineInElement (Element, line->Point1.X,
 			    line->Point1.Y, line->Point2.X,
 			    line->Point2.Y, line->Thickness);
@@ -44,6 +44,7 @@
 #include "crosshair.h"
 #include "data.h"
 #include "draw.h"
+#include "drill.h"
 #include "error.h"
 #include "mymem.h"
 #include "misc.h"
@@ -444,6 +445,7 @@ ChangeVia2ndSize (PinType *Via)
       EraseVia (Via);
       RestoreToPolygon (PCB->Data, VIA_TYPE, Via, Via);
       Via->DrillingHole = new_value;
+      InvalidateDrillInfo (PCB->Data);
       if (TEST_FLAG (HOLEFLAG, Via))
 	{
 	  AddObjectToSizeUndoList (VIA_TYPE, Via, Via, Via);
@@ -646,6 +648,7 @@ ChangeElement2ndSize (ElementType *Element)
 	ErasePin (pin);
 	RestoreToPolygon (PCB->Data, PIN_TYPE, Element, pin);
 	pin->DrillingHole = new_value;
+	InvalidateDrillInfo (PCB->Data);
 	if (TEST_FLAG (HOLEFLAG, pin))
 	  {
 	    AddObjectToSizeUndoList (PIN_TYPE, Element, pin, pin);
@@ -683,6 +686,7 @@ ChangePin2ndSize (ElementType *Element, PinType *Pin)
       ErasePin (Pin);
       RestoreToPolygon (PCB->Data, PIN_TYPE, Element, Pin);
       Pin->DrillingHole = new_value;
+      InvalidateDrillInfo (PCB->Data);
       if (TEST_FLAG (HOLEFLAG, Pin))
 	{
 	  AddObjectToSizeUndoList (PIN_TYPE, Element, Pin, Pin);
@@ -1048,7 +1052,11 @@ ChangeElementText (PCBType *pcb, DataType *data, ElementType *Element, int which
   r_delete_entry (data->name_tree[which],
 		  & Element->Name[which].BoundingBox);
 
+  if (which == NAMEONPCB_INDEX)
+    UpdateElementNameIndex (data, Element, false);
   Element->Name[which].TextString = new_name;
+  if (which == NAMEONPCB_INDEX)
+    UpdateElementNameIndex (data, Element, true);
   SetTextBoundingBox (&PCB->Font, &Element->Name[which]);
 
   r_insert_entry (data->name_tree[which],
@@ -1606,6 +1614,7 @@ ChangeHole (PinType *Via)
   r_delete_entry (PCB->Data->via_tree, (BoxType *) Via);
   RestoreToPolygon (PCB->Data, VIA_TYPE, Via, Via);
   TOGGLE_FLAG (HOLEFLAG, Via);
+  InvalidateDrillInfo (PCB->Data);
 
   if (TEST_FLAG (HOLEFLAG, Via))
     {
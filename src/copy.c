@@ -180,6 +180,8 @@ CopyElementLowLevel (DataType *Data, ElementType *Src,
   Dest->MarkY = Src->MarkY + dy;
 
   SetElementBoundingBox (Data, Dest, &PCB->Font);
+  if (Data == PCB->Data)
+    UpdateSelectionIndex (ELEMENT_TYPE, Dest, Dest, true);
   return (Dest);
 }
 
@@ -271,6 +273,7 @@ CopyPolygon (LayerType *Layer, PolygonType *Polygon)
 
   polygon = CreateNewPolygon (Layer, NoFlags ());
   CopyPolygonLowLevel (polygon, Polygon);
+  UpdateSelectionIndex (POLYGON_TYPE, Layer, polygon, true);
   MovePolygonLowLevel (polygon, DeltaX, DeltaY);
   if (!Layer->polygon_tree)
     Layer->polygon_tree = r_create_tree (NULL, 0, 0);
@@ -332,6 +335,9 @@ CopyPastebufferToLayout (Coord X, Coord Y)
   /* set movement vector */
   DeltaX = X - PASTEBUFFER->X, DeltaY = Y - PASTEBUFFER->Y;
 
+  /* clear the polygons once everything is in place */
+  BeginPolygonBatch ();
+
   /* paste all layers */
   for (i = 0; i < max_copper_layer + SILK_LAYER; i++)
     {
@@ -396,6 +402,8 @@ CopyPastebufferToLayout (Coord X, Coord Y)
       END_LOOP;
     }
 
+  EndPolygonBatch ();
+
   if (changed)
     {
       Draw ();
@@ -44,6 +44,7 @@
 #include "create.h"
 #include "data.h"
 #include "draw.h"
+#include "drill.h"
 #include "error.h"
 #include "hid.h" /* REGISTER_ACTIONS */
 #include "mymem.h"
@@ -53,6 +54,7 @@
 #include "polygon.h"
 #include "rtree.h"
 #include "search.h"
+#include "select.h"
 #include "set.h"
 #include "undo.h"
 #include "vendor.h"
@@ -89,6 +91,29 @@ CreateBeLenient (bool v)
   be_lenient = v;
 }
 
+/*!
+ * \brief Tells if Data is the data of the current board.
+ */
+static bool
+IsBoardData (DataType *Data)
+{
+  return (PCB != NULL && Data == PCB->Data);
+}
+
+/*!
+ * \brief Tells if Layer is one of the layers of the current board.
+ *
+ * Objects created already selected (e.g. when a selected paste buffer
+ * is copied to the board) have to be added to the selection index, but
+ * only if they end up on the board.
+ */
+static bool
+IsBoardLayer (LayerType *Layer)
+{
+  return (PCB != NULL && Layer >= PCB->Data->Layer
+	  && Layer < PCB->Data->Layer + MAX_ALL_LAYER);
+}
+
 /*!
  * \brief Creates a new paste buffer.
  */
@@ -316,6 +341,9 @@ CreateNewVia (DataType *Data,
   if (!Data->via_tree)
     Data->via_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (Data->via_tree, (BoxType *) Via, 0);
+  InvalidateDrillInfo (Data);
+  if (TEST_FLAG (SELECTEDFLAG, Via))
+    UpdateSelectionIndex (VIA_TYPE, Via, Via, IsBoardData (Data));
   return (Via);
 }
 
@@ -539,6 +567,8 @@ CreateNewLineOnLayer (LayerType *Layer,
   if (!Layer->line_tree)
     Layer->line_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (Layer->line_tree, (BoxType *) Line, 0);
+  if (TEST_FLAG (SELECTEDFLAG, Line))
+    UpdateSelectionIndex (LINE_TYPE, Layer, Line, IsBoardLayer (Layer));
   return (Line);
 }
 
@@ -571,9 +601,31 @@ CreateNewRat (DataType *Data, Coord X1, Coord Y1,
   if (!Data->rat_tree)
     Data->rat_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (Data->rat_tree, &Line->BoundingBox, 0);
+  if (TEST_FLAG (SELECTEDFLAG, Line))
+    UpdateSelectionIndex (RATLINE_TYPE, Line, Line, IsBoardData (Data));
   return (Line);
 }
 
+struct stacked_arc_info
+{
+  Coord X, Y, Width;
+  Angle StartAngle, Delta;
+  bool found;
+};
+
+static int
+stacked_arc_callback (const BoxType * b, void *cl)
+{
+  ArcType *arc = (ArcType *) b;
+  struct stacked_arc_info *i = (struct stacked_arc_info *) cl;
+
+  if (arc->X == i->X && arc->Y == i->Y && arc->Width == i->Width &&
+      NormalizeAngle (arc->StartAngle) == NormalizeAngle (i->StartAngle) &&
+      arc->Delta == i->Delta)
+    i->found = true;
+  return 0;
+}
+
 /*!
  * \brief Creates a new arc on a layer.
  */
@@ -587,15 +639,28 @@ CreateNewArcOnLayer (LayerType *Layer,
 		     Coord Clearance, FlagType Flags)
 {
   ArcType *Arc;
+  struct stacked_arc_info info;
+  BoxType strip;
 
-  ARC_LOOP (Layer);
-  {
-    if (arc->X == X1 && arc->Y == Y1 && arc->Width == width &&
-	NormalizeAngle (arc->StartAngle) == NormalizeAngle (sa) &&
-	arc->Delta == dir)
-      return (NULL);		/* prevent stacked arcs */
-  }
-  END_LOOP;
+  /* prevent stacked arcs.  Every point of an arc of this width lies
+   * within width of X1, so its bounding box overlaps this strip.
+   */
+  if (Layer->arc_tree)
+    {
+      info.X = X1;
+      info.Y = Y1;
+      info.Width = width;
+      info.StartAngle = sa;
+      info.Delta = dir;
+      info.found = false;
+      strip.X1 = X1 - width - 1;
+      strip.X2 = X1 + width + 1;
+      strip.Y1 = -COORD_MAX;
+      strip.Y2 = COORD_MAX;
+      r_search (Layer->arc_tree, &strip, NULL, stacked_arc_callback, &info);
+      if (info.found)
+	return (NULL);
+    }
   Arc = GetArcMemory (Layer);
   if (!Arc)
     return (Arc);
@@ -614,6 +679,8 @@ CreateNewArcOnLayer (LayerType *Layer,
   if (!Layer->arc_tree)
     Layer->arc_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (Layer->arc_tree, (BoxType *) Arc, 0);
+  if (TEST_FLAG (SELECTEDFLAG, Arc))
+    UpdateSelectionIndex (ARC_TYPE, Layer, Arc, IsBoardLayer (Layer));
   return (Arc);
 }
 
@@ -675,6 +742,8 @@ CreateNewText (LayerType *Layer, FontType *PCBFont,
   if (!Layer->text_tree)
     Layer->text_tree = r_create_tree (NULL, 0, 0);
   r_insert_entry (Layer->text_tree, (BoxType *) text, 0);
+  if (TEST_FLAG (SELECTEDFLAG, text))
+    UpdateSelectionIndex (TEXT_TYPE, Layer, text, IsBoardLayer (Layer));
   return (text);
 }
 
@@ -692,6 +761,9 @@ CreateNewPolygon (LayerType *Layer, FlagType Flags)
   polygon->Clipped = NULL;
   polygon->NoHoles = NULL;
   polygon->NoHolesValid = 0;
+  polygon->ClipGeneration = 0;
+  if (TEST_FLAG (SELECTEDFLAG, polygon))
+    UpdateSelectionIndex (POLYGON_TYPE, Layer, polygon, IsBoardLayer (Layer));
   return (polygon);
 }
 
@@ -739,6 +811,7 @@ CreateNewElement (DataType *Data, FontType *PCBFont, FlagType Flags,
 #endif
 
   Element = GetElementMemory (Data);
+  InvalidateDrillInfo (Data);
 
   /* copy values and set additional information */
   TextScale = MAX (MIN_TEXTSCALE, TextScale);
@@ -753,6 +826,7 @@ CreateNewElement (DataType *Data, FontType *PCBFont, FlagType Flags,
   DESCRIPTION_TEXT (Element).Element = Element;
   NAMEONPCB_TEXT (Element).Element = Element;
   VALUE_TEXT (Element).Element = Element;
+  UpdateElementNameIndex (Data, Element, true);
   Element->Flags = Flags;
   Element->ID = ID++;
 
@@ -775,7 +849,7 @@ CreateNewArcInElement (ElementType *Element,
   ArcType *arc;
 
   arc = g_slice_new0 (ArcType);
-  Element->Arc = g_list_append (Element->Arc, arc);
+  AppendObjectToList (&Element->Arc, &Element->ArcTail, (AnyObjectType *) arc);
   Element->ArcN ++;
 
   /* set Delta (0,360], StartAngle in [0,360) */
@@ -816,7 +890,8 @@ CreateNewLineInElement (ElementType *Element,
     return NULL;
 
   line = g_slice_new0 (LineType);
-  Element->Line = g_list_append (Element->Line, line);
+  AppendObjectToList (&Element->Line, &Element->LineTail,
+		      (AnyObjectType *) line);
   Element->LineN ++;
 
   /* copy values */
@@ -850,6 +925,7 @@ CreateNewPin (ElementType *Element,
   pin->Mask = Mask;
   pin->Name = STRDUP (Name);
   pin->Number = STRDUP (Number);
+  ForgetElementTerminals (Element);
   pin->Flags = Flags;
   CLEAR_FLAG (WARNFLAG, pin);
   SET_FLAG (PINFLAG, pin);
@@ -930,6 +1006,7 @@ CreateNewPad (ElementType *Element,
   pad->Mask = Mask;
   pad->Name = STRDUP (Name);
   pad->Number = STRDUP (Number);
+  ForgetElementTerminals (Element);
   pad->Flags = Flags;
   CLEAR_FLAG (WARNFLAG, pad);
   pad->ID = ID++;
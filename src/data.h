@@ -72,5 +72,6 @@ extern bool Bumped;
 extern FlagType no_flags;
 
 extern int netlist_frozen;
+extern unsigned long netlist_serial;
 
 #endif
@@ -51,6 +51,8 @@
 #include "select.h"
 #include "print.h"
 
+#include "hid/common/draw_helpers.h"
+
 #ifdef HAVE_LIBDMALLOC
 #include <dmalloc.h>
 #endif
@@ -87,26 +89,381 @@ static void DrawPPV (int group, const BoxType *);
 static void AddPart (void *);
 static void DrawEMark (ElementType *, Coord, Coord, bool);
 static void DrawRats (const BoxType *);
+static bool via_visible_on_layer_group (PinType *);
+
+static char *
+object_color (AnyObjectType *obj, char *warn_color, char *selected_color,
+              char *connected_color, char *found_color, char *normal_color)
+{
+  if      (warn_color      != NULL && TEST_FLAG (WARNFLAG,      obj)) return warn_color;
+  else if (selected_color  != NULL && TEST_FLAG (SELECTEDFLAG,  obj)) return selected_color;
+  else if (connected_color != NULL && TEST_FLAG (CONNECTEDFLAG, obj)) return connected_color;
+  else if (found_color     != NULL && TEST_FLAG (FOUNDFLAG,     obj)) return found_color;
+  else                                                                return normal_color;
+}
 
 static void
 set_object_color (AnyObjectType *obj, char *warn_color, char *selected_color,
                   char *connected_color, char *found_color, char *normal_color)
 {
-  char *color;
-
-  if      (warn_color      != NULL && TEST_FLAG (WARNFLAG,      obj)) color = warn_color;
-  else if (selected_color  != NULL && TEST_FLAG (SELECTEDFLAG,  obj)) color = selected_color;
-  else if (connected_color != NULL && TEST_FLAG (CONNECTEDFLAG, obj)) color = connected_color;
-  else if (found_color     != NULL && TEST_FLAG (FOUNDFLAG,     obj)) color = found_color;
-  else                                                                color = normal_color;
+  gui->graphics->set_color (Output.fgGC,
+                            object_color (obj, warn_color, selected_color,
+                                          connected_color, found_color,
+                                          normal_color));
+}
 
-  gui->graphics->set_color (Output.fgGC, color);
+static char *
+layer_object_color (LayerType *layer, AnyObjectType *obj)
+{
+  return object_color (obj, NULL, layer->SelectedColor, PCB->ConnectedColor, PCB->FoundColor, layer->Color);
 }
 
 static void
 set_layer_object_color (LayerType *layer, AnyObjectType *obj)
 {
-  set_object_color (obj, NULL, layer->SelectedColor, PCB->ConnectedColor, PCB->FoundColor, layer->Color);
+  gui->graphics->set_color (Output.fgGC, layer_object_color (layer, obj));
+}
+
+/* ---------------------------------------------------------------------------
+ * Batched drawing.
+ *
+ * Runs of lines, arcs or hole circles which are drawn with the same GC
+ * state are collected here and handed to the HID in one draw_lines,
+ * draw_arcs or fill_circles call.  Whoever queues primitives must call
+ * flush_batch () before drawing anything else, so the HID sees the same
+ * sequence of primitives and GC states as if each had been drawn on its
+ * own.
+ */
+enum batch_kind
+{
+  BATCH_NONE,
+  BATCH_LINES,
+  BATCH_ARCS,
+  BATCH_CIRCLES
+};
+
+static struct
+{
+  enum batch_kind kind;
+  hidGC gc;
+  char *color;    /*!< Colour to set before drawing, or NULL. */
+  Coord width;
+  GArray *lines;
+  GArray *arcs;
+  GArray *circles;
+} batch;
+
+static void
+flush_batch (void)
+{
+  switch (batch.kind)
+    {
+    case BATCH_NONE:
+      return;
+
+    case BATCH_LINES:
+      gui->graphics->set_color (batch.gc, batch.color);
+      gui->graphics->set_line_cap (batch.gc, Trace_Cap);
+      gui->graphics->set_line_width (batch.gc, batch.width);
+      gui->graphics->draw_lines (batch.gc, batch.lines->len,
+                                 (HID_Line *) batch.lines->data);
+      g_array_set_size (batch.lines, 0);
+      break;
+
+    case BATCH_ARCS:
+      gui->graphics->set_color (batch.gc, batch.color);
+      gui->graphics->set_line_width (batch.gc, batch.width);
+      gui->graphics->set_line_cap (batch.gc, Trace_Cap);
+      gui->graphics->draw_arcs (batch.gc, batch.arcs->len,
+                                (HID_Arc *) batch.arcs->data);
+      g_array_set_size (batch.arcs, 0);
+      break;
+
+    case BATCH_CIRCLES:
+      gui->graphics->fill_circles (batch.gc, batch.circles->len,
+                                   (HID_Circle *) batch.circles->data);
+      g_array_set_size (batch.circles, 0);
+      break;
+    }
+  batch.kind = BATCH_NONE;
+}
+
+/*!
+ * \brief Start or continue a batch of the given kind and state.
+ */
+static void
+begin_batch (enum batch_kind kind, hidGC gc, char *color, Coord width)
+{
+  if (batch.kind == kind && batch.gc == gc
+      && batch.color == color && batch.width == width)
+    return;
+
+  flush_batch ();
+  if (batch.lines == NULL)
+    {
+      batch.lines = g_array_new (FALSE, FALSE, sizeof (HID_Line));
+      batch.arcs = g_array_new (FALSE, FALSE, sizeof (HID_Arc));
+      batch.circles = g_array_new (FALSE, FALSE, sizeof (HID_Circle));
+    }
+  batch.kind = kind;
+  batch.gc = gc;
+  batch.color = color;
+  batch.width = width;
+}
+
+/*!
+ * \brief Queue what draw_pcb_line would draw for \c line in \c color.
+ *
+ * Falls back to draw_pcb_line itself for HIDs which override it.
+ */
+static void
+batch_pcb_line (LineType *line, char *color)
+{
+  HID_Line l;
+
+  if (gui->graphics->draw_pcb_line != common_draw_pcb_line)
+    {
+      flush_batch ();
+      gui->graphics->set_color (Output.fgGC, color);
+      gui->graphics->draw_pcb_line (Output.fgGC, line);
+      return;
+    }
+
+  begin_batch (BATCH_LINES, Output.fgGC, color,
+               TEST_FLAG (THINDRAWFLAG, PCB) ? 0 : line->Thickness);
+  l.x1 = line->Point1.X;
+  l.y1 = line->Point1.Y;
+  l.x2 = line->Point2.X;
+  l.y2 = line->Point2.Y;
+  g_array_append_val (batch.lines, l);
+}
+
+/*!
+ * \brief Queue what draw_pcb_arc would draw for \c arc in \c color.
+ *
+ * Falls back to draw_pcb_arc itself for HIDs which override it.
+ */
+static void
+batch_pcb_arc (ArcType *arc, char *color)
+{
+  HID_Arc a;
+
+  if (gui->graphics->draw_pcb_arc != common_draw_pcb_arc)
+    {
+      flush_batch ();
+      gui->graphics->set_color (Output.fgGC, color);
+      gui->graphics->draw_pcb_arc (Output.fgGC, arc);
+      return;
+    }
+
+  /* common_draw_pcb_arc draws nothing for these */
+  if (!arc->Thickness)
+    return;
+
+  begin_batch (BATCH_ARCS, Output.fgGC, color,
+               TEST_FLAG (THINDRAWFLAG, PCB) ? 0 : arc->Thickness);
+  a.cx = arc->X;
+  a.cy = arc->Y;
+  a.width = arc->Width;
+  a.height = arc->Height;
+  a.start_angle = arc->StartAngle;
+  a.delta_angle = arc->Delta;
+  g_array_append_val (batch.arcs, a);
+}
+
+/*!
+ * \brief Queue a filled circle drawn with \c gc as it is.
+ */
+static void
+batch_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
+{
+  HID_Circle c;
+
+  begin_batch (BATCH_CIRCLES, gc, NULL, 0);
+  c.cx = cx;
+  c.cy = cy;
+  c.radius = radius;
+  g_array_append_val (batch.circles, c);
+}
+
+/* ---------------------------------------------------------------------------
+ * Search profiling.
+ */
+
+DrawSearchStatsType *draw_search_stats = NULL;
+
+const char *draw_search_names[N_DRAW_SEARCH_KINDS] =
+{
+  "pin", "via", "pad", "hole", "clearance", "element", "name", "emark",
+  "rat", "polygon", "line", "arc", "text"
+};
+
+/* ---------------------------------------------------------------------------
+ * Level of detail.
+ *
+ * Zoomed out, whole r-tree nodes shrink to a pixel or two on screen.
+ * Such a node is drawn as one tile in the layer or object colour instead
+ * of visiting every object below it, and objects that small on their own
+ * are drawn as their bounding box.  Text is greeked the same way once it
+ * is too small to read.  The r-tree keeps the node boxes up to date on
+ * every edit, so these summaries need no memory or upkeep of their own.
+ */
+
+#define LOD_TILE_PIXELS 2
+#define LOD_TEXT_PIXELS 4
+
+Coord draw_lod_pixel = -1;
+
+/* Pixel size used by the current expose, 0 when not culling. */
+static Coord lod_pixel = 0;
+
+static struct
+{
+  enum draw_search_kind kind;
+  int (*callback) (const BoxType *, void *);
+  void *closure;
+  Coord tile;
+} lod;
+
+/*!
+ * \brief Colour of a tile standing for \c obj, or for a whole node when
+ * \c obj is NULL.
+ *
+ * \return NULL if nothing should be drawn.
+ */
+static char *
+lod_color (AnyObjectType *obj)
+{
+  LayerType *layer = (LayerType *) lod.closure;
+
+  switch (lod.kind)
+    {
+    case DRAW_SEARCH_LINE:
+    case DRAW_SEARCH_ARC:
+      return obj ? layer_object_color (layer, obj) : layer->Color;
+    case DRAW_SEARCH_TEXT:
+      return obj && TEST_FLAG (SELECTEDFLAG, obj) ?
+        layer->SelectedColor : layer->Color;
+    case DRAW_SEARCH_PIN:
+      return obj ? object_color (obj, PCB->WarnColor, PCB->PinSelectedColor,
+                                 PCB->ConnectedColor, PCB->FoundColor,
+                                 PCB->PinColor) : PCB->PinColor;
+    case DRAW_SEARCH_VIA:
+      if (obj && !via_visible_on_layer_group ((PinType *) obj))
+        return NULL;
+      return obj ? object_color (obj, PCB->WarnColor, PCB->ViaSelectedColor,
+                                 PCB->ConnectedColor, PCB->FoundColor,
+                                 PCB->ViaColor) : PCB->ViaColor;
+    case DRAW_SEARCH_RAT:
+      return obj ? object_color (obj, NULL, PCB->RatSelectedColor,
+                                 PCB->ConnectedColor, PCB->FoundColor,
+                                 PCB->RatColor) : PCB->RatColor;
+    default:
+      /* holes that small are not visible */
+      return NULL;
+    }
+}
+
+static void
+lod_tile (const BoxType *box, char *color)
+{
+  if (color == NULL)
+    return;
+  flush_batch ();
+  gui->graphics->set_color (Output.fgGC, color);
+  gui->graphics->fill_rect (Output.fgGC, box->X1, box->Y1, box->X2, box->Y2);
+  if (draw_search_stats != NULL)
+    draw_search_stats->tiles[lod.kind]++;
+}
+
+static int
+lod_check_region (const BoxType *region, void *cl)
+{
+  if (region->X2 - region->X1 > lod.tile || region->Y2 - region->Y1 > lod.tile)
+    return 1;
+  /* A node of the via tree may hold vias which are not drawn on the
+   * current layer group, so only look at the vias one by one there. */
+  if (lod.kind == DRAW_SEARCH_VIA && current_layergroup != -1)
+    return 1;
+  lod_tile (region, lod_color (NULL));
+  return 0;
+}
+
+static int
+lod_found (const BoxType *b, void *cl)
+{
+  Coord w = b->X2 - b->X1;
+  Coord h = b->Y2 - b->Y1;
+
+  if (lod.kind == DRAW_SEARCH_TEXT ?
+      MIN (w, h) < LOD_TEXT_PIXELS * lod_pixel : MAX (w, h) <= lod.tile)
+    {
+      lod_tile (b, lod_color ((AnyObjectType *) b));
+      return 1;
+    }
+  return lod.callback (b, lod.closure);
+}
+
+/*!
+ * \brief r_search () with level of detail culling, if it applies.
+ */
+static int
+lod_search (enum draw_search_kind kind, rtree_t *tree, const BoxType *area,
+            int (*callback) (const BoxType *, void *), void *closure)
+{
+  if (lod_pixel <= 0)
+    return r_search (tree, area, NULL, callback, closure);
+
+  switch (kind)
+    {
+    case DRAW_SEARCH_LINE:
+    case DRAW_SEARCH_ARC:
+    case DRAW_SEARCH_TEXT:
+    case DRAW_SEARCH_PIN:
+    case DRAW_SEARCH_VIA:
+    case DRAW_SEARCH_HOLE:
+    case DRAW_SEARCH_RAT:
+      break;
+    default:
+      return r_search (tree, area, NULL, callback, closure);
+    }
+
+  lod.kind = kind;
+  lod.callback = callback;
+  lod.closure = closure;
+  lod.tile = LOD_TILE_PIXELS * lod_pixel;
+  return r_search (tree, area, lod_check_region, lod_found, NULL);
+}
+
+/*!
+ * \brief r_search () for the drawing code.
+ *
+ * When draw_search_stats is set, the search is counted and timed.  Any
+ * batch it queued is flushed inside the timed part, so that drawing work
+ * is charged to the search which produced it.
+ */
+static int
+draw_search (enum draw_search_kind kind, rtree_t *tree,
+             const BoxType *area,
+             int (*callback) (const BoxType *, void *), void *closure)
+{
+  static GTimer *timer = NULL;
+  double start;
+  int found;
+
+  if (draw_search_stats == NULL)
+    return lod_search (kind, tree, area, callback, closure);
+
+  if (timer == NULL)
+    timer = g_timer_new ();
+  flush_batch ();
+  start = g_timer_elapsed (timer, NULL);
+  found = lod_search (kind, tree, area, callback, closure);
+  flush_batch ();
+  draw_search_stats->searches[kind]++;
+  draw_search_stats->found[kind] += found;
+  draw_search_stats->seconds[kind] += g_timer_elapsed (timer, NULL) - start;
+  return found;
 }
 
 /*!
@@ -456,6 +813,14 @@ via_ok:
   if (!via_visible_on_layer_group (pv))
      return 1;
 
+  if (!TEST_FLAG (THINDRAWFLAG, PCB) && ViaIsOnAnyVisibleLayer (pv)
+      && !TEST_FLAG (HOLEFLAG, pv))
+    {
+      batch_circle (Output.bgGC, pv->X, pv->Y, pv->DrillingHole / 2);
+      return 1;
+    }
+  flush_batch ();
+
   if (TEST_FLAG (THINDRAWFLAG, PCB))
     {
       if (!TEST_FLAG (HOLEFLAG, pv))
@@ -504,8 +869,11 @@ DrawHoles (bool draw_plated, bool draw_unplated, const BoxType *drawn_area, Card
 
   current_layergroup = -1;
 
-  r_search (PCB->Data->pin_tree, drawn_area, NULL, hole_callback, &hi);
-  r_search (PCB->Data->via_tree, drawn_area, NULL, hole_callback, &hi);
+  draw_search (DRAW_SEARCH_HOLE, PCB->Data->pin_tree,
+               drawn_area, hole_callback, &hi);
+  draw_search (DRAW_SEARCH_HOLE, PCB->Data->via_tree,
+               drawn_area, hole_callback, &hi);
+  flush_batch ();
 }
 
 static int
@@ -514,8 +882,7 @@ line_callback (const BoxType * b, void *cl)
   LayerType *layer = (LayerType *) cl;
   LineType *line = (LineType *) b;
 
-  set_layer_object_color (layer, (AnyObjectType *) line);
-  gui->graphics->draw_pcb_line (Output.fgGC, line);
+  batch_pcb_line (line, layer_object_color (layer, (AnyObjectType *) line));
 
   return 1;
 }
@@ -553,8 +920,7 @@ arc_callback (const BoxType * b, void *cl)
   LayerType *layer = (LayerType *) cl;
   ArcType *arc =  (ArcType *) b;
 
-  set_layer_object_color (layer, (AnyObjectType *) arc);
-  gui->graphics->draw_pcb_arc (Output.fgGC, arc);
+  batch_pcb_arc (arc, layer_object_color (layer, (AnyObjectType *) arc));
 
   return 1;
 }
@@ -562,27 +928,31 @@ arc_callback (const BoxType * b, void *cl)
 static void
 draw_element_package (ElementType *element)
 {
+  char *color;
+
   /* set color and draw lines, arcs, text and pins */
   if (doing_pinout || doing_assy)
-    gui->graphics->set_color (Output.fgGC, PCB->ElementColor);
+    color = PCB->ElementColor;
   else if (TEST_FLAG (SELECTEDFLAG, element))
-    gui->graphics->set_color (Output.fgGC, PCB->ElementSelectedColor);
+    color = PCB->ElementSelectedColor;
   else if (FRONT (element))
-    gui->graphics->set_color (Output.fgGC, PCB->ElementColor);
+    color = PCB->ElementColor;
   else
-    gui->graphics->set_color (Output.fgGC, PCB->InvisibleObjectsColor);
+    color = PCB->InvisibleObjectsColor;
+  gui->graphics->set_color (Output.fgGC, color);
 
   /* draw lines, arcs, text and pins */
   ELEMENTLINE_LOOP (element);
   {
-    gui->graphics->draw_pcb_line (Output.fgGC, line);
+    batch_pcb_line (line, color);
   }
   END_LOOP;
   ARC_LOOP (element);
   {
-    gui->graphics->draw_pcb_arc (Output.fgGC, arc);
+    batch_pcb_arc (arc, color);
   }
   END_LOOP;
+  flush_batch ();
 }
 
 static int
@@ -659,11 +1029,14 @@ DrawEverything (const BoxType *drawn_area)
       side = SWAP_IDENT ? TOP_SIDE : BOTTOM_SIDE;
       if (PCB->ElementOn)
 	{
-	  r_search (PCB->Data->element_tree, drawn_area, NULL, element_callback, &side);
-	  r_search (PCB->Data->name_tree[NAME_INDEX (PCB)], drawn_area, NULL, name_callback, &side);
+	  draw_search (DRAW_SEARCH_ELEMENT, PCB->Data->element_tree,
+		       drawn_area, element_callback, &side);
+	  draw_search (DRAW_SEARCH_NAME, PCB->Data->name_tree[NAME_INDEX (PCB)],
+		       drawn_area, name_callback, &side);
 	  DrawLayer (&(PCB->Data->Layer[max_copper_layer + side]), drawn_area);
 	}
-      r_search (PCB->Data->pad_tree, drawn_area, NULL, pad_callback, &side);
+      draw_search (DRAW_SEARCH_PAD, PCB->Data->pad_tree,
+                   drawn_area, pad_callback, &side);
       gui->end_layer ();
     }
 
@@ -752,8 +1125,8 @@ DrawEverything (const BoxType *drawn_area)
     {
       /* Draw element Marks */
       if (PCB->PinOn)
-	r_search (PCB->Data->element_tree, drawn_area, NULL, EMark_callback,
-		  NULL);
+	draw_search (DRAW_SEARCH_EMARK, PCB->Data->element_tree,
+		     drawn_area, EMark_callback, NULL);
       /* Draw rat lines on top */
       if (gui->set_layer ("rats", SL (RATS, 0), 0))
         {
@@ -852,19 +1225,22 @@ DrawPPV (int group, const BoxType *drawn_area)
   if (PCB->PinOn || !gui->gui)
     {
       /* draw element pins */
-      r_search (PCB->Data->pin_tree, drawn_area, NULL, pin_callback, NULL);
+      draw_search (DRAW_SEARCH_PIN, PCB->Data->pin_tree,
+                   drawn_area, pin_callback, NULL);
 
       /* draw element pads */
       if (group == top_group)
         {
           side = TOP_SIDE;
-          r_search (PCB->Data->pad_tree, drawn_area, NULL, pad_callback, &side);
+          draw_search (DRAW_SEARCH_PAD, PCB->Data->pad_tree,
+                       drawn_area, pad_callback, &side);
         }
 
       if (group == bottom_group)
         {
           side = BOTTOM_SIDE;
-          r_search (PCB->Data->pad_tree, drawn_area, NULL, pad_callback, &side);
+          draw_search (DRAW_SEARCH_PAD, PCB->Data->pad_tree,
+                       drawn_area, pad_callback, &side);
         }
     }
 
@@ -874,11 +1250,18 @@ DrawPPV (int group, const BoxType *drawn_area)
 
       current_layergroup = (gui->gui)?(-1):group; /* Limit vias only for layer group */
 
-      r_search (PCB->Data->via_tree, drawn_area, NULL, via_callback, NULL);
-      r_search (PCB->Data->via_tree, drawn_area, NULL, hole_callback, NULL);
+      draw_search (DRAW_SEARCH_VIA, PCB->Data->via_tree,
+                   drawn_area, via_callback, NULL);
+      draw_search (DRAW_SEARCH_HOLE, PCB->Data->via_tree,
+                   drawn_area, hole_callback, NULL);
+      flush_batch ();
     }
   if (PCB->PinOn || doing_assy)
-    r_search (PCB->Data->pin_tree, drawn_area, NULL, hole_callback, NULL);
+    {
+      draw_search (DRAW_SEARCH_HOLE, PCB->Data->pin_tree,
+                   drawn_area, hole_callback, NULL);
+      flush_batch ();
+    }
 }
 
 static int
@@ -954,23 +1337,30 @@ DrawSilk (int side, const BoxType * drawn_area)
 #endif
       DrawLayer (LAYER_PTR (max_copper_layer + side), drawn_area);
       /* draw package */
-      r_search (PCB->Data->element_tree, drawn_area, NULL, element_callback, &side);
-      r_search (PCB->Data->name_tree[NAME_INDEX (PCB)], drawn_area, NULL, name_callback, &side);
+      draw_search (DRAW_SEARCH_ELEMENT, PCB->Data->element_tree,
+                   drawn_area, element_callback, &side);
+      draw_search (DRAW_SEARCH_NAME, PCB->Data->name_tree[NAME_INDEX (PCB)],
+                   drawn_area, name_callback, &side);
 #if 0
     }
 
   gui->graphics->use_mask (HID_MASK_CLEAR);
-  r_search (PCB->Data->pin_tree, drawn_area, NULL, clearPin_callback, NULL);
-  r_search (PCB->Data->via_tree, drawn_area, NULL, clearPin_callback, NULL);
-  r_search (PCB->Data->pad_tree, drawn_area, NULL, clearPad_callback, &side);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->pin_tree,
+               drawn_area, clearPin_callback, NULL);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->via_tree,
+               drawn_area, clearPin_callback, NULL);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->pad_tree,
+               drawn_area, clearPad_callback, &side);
 
   if (gui->poly_after)
     {
       gui->graphics->use_mask (HID_MASK_AFTER);
       DrawLayer (LAYER_PTR (max_copper_layer + layer), drawn_area);
       /* draw package */
-      r_search (PCB->Data->element_tree, drawn_area, NULL, element_callback, &side);
-      r_search (PCB->Data->name_tree[NAME_INDEX (PCB)], drawn_area, NULL, name_callback, &side);
+      draw_search (DRAW_SEARCH_ELEMENT, PCB->Data->element_tree,
+                   drawn_area, element_callback, &side);
+      draw_search (DRAW_SEARCH_NAME, PCB->Data->name_tree[NAME_INDEX (PCB)],
+                   drawn_area, name_callback, &side);
     }
   gui->graphics->use_mask (HID_MASK_OFF);
 #endif
@@ -1010,9 +1400,12 @@ DrawMask (int side, const BoxType *screen)
       gui->graphics->use_mask (HID_MASK_CLEAR);
     }
 
-  r_search (PCB->Data->pin_tree, screen, NULL, clearPin_callback, NULL);
-  r_search (PCB->Data->via_tree, screen, NULL, clearPin_callback, &side);
-  r_search (PCB->Data->pad_tree, screen, NULL, clearPad_callback, &side);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->pin_tree,
+               screen, clearPin_callback, NULL);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->via_tree,
+               screen, clearPin_callback, &side);
+  draw_search (DRAW_SEARCH_CLEARANCE, PCB->Data->pad_tree,
+               screen, clearPad_callback, &side);
 
   if (thin)
     gui->graphics->set_color (Output.pmGC, "erase");
@@ -1073,7 +1466,8 @@ DrawRats (const BoxType *drawn_area)
 
   if (can_mask)
     gui->graphics->use_mask (HID_MASK_CLEAR);
-  r_search (PCB->Data->rat_tree, drawn_area, NULL, rat_callback, NULL);
+  draw_search (DRAW_SEARCH_RAT, PCB->Data->rat_tree,
+               drawn_area, rat_callback, NULL);
   if (can_mask)
     gui->graphics->use_mask (HID_MASK_OFF);
 }
@@ -1104,18 +1498,23 @@ DrawLayer (LayerType *Layer, const BoxType *screen)
   struct poly_info info = {screen, Layer, 0};
 
   /* draw the poly outlines */
-  r_search (Layer->polygon_tree, screen, NULL, poly_callback, &info);
+  draw_search (DRAW_SEARCH_POLYGON, Layer->polygon_tree,
+               screen, poly_callback, &info);
 
   if (!TEST_FLAG (CHECKPLANESFLAG, PCB))
   {
     /* draw all visible lines this layer */
-    r_search (Layer->line_tree, screen, NULL, line_callback, Layer);
+    draw_search (DRAW_SEARCH_LINE, Layer->line_tree,
+                 screen, line_callback, Layer);
+    flush_batch ();
 
     /* draw the layer arcs on screen */
-    r_search (Layer->arc_tree, screen, NULL, arc_callback, Layer);
+    draw_search (DRAW_SEARCH_ARC, Layer->arc_tree, screen, arc_callback, Layer);
+    flush_batch ();
 
     /* draw the layer text on screen */
-    r_search (Layer->text_tree, screen, NULL, text_callback, Layer);
+    draw_search (DRAW_SEARCH_TEXT, Layer->text_tree,
+                 screen, text_callback, Layer);
 
     /* We should check for gui->gui here, but it's kinda cool seeing the
       auto-outline magically disappear when you first add something to
@@ -1134,7 +1533,8 @@ DrawLayer (LayerType *Layer, const BoxType *screen)
   info.fill = 1;
 
   /* fill the polys */
-  r_search (Layer->polygon_tree, screen, NULL, poly_callback, &info);
+  draw_search (DRAW_SEARCH_POLYGON, Layer->polygon_tree,
+               screen, poly_callback, &info);
 
 }
 
@@ -1692,6 +2092,10 @@ hid_expose_callback (HID * hid, BoxType * region, void *item)
   HID *old_gui = gui;
 
   gui = hid;
+  if (draw_lod_pixel >= 0)
+    lod_pixel = draw_lod_pixel;
+  else
+    lod_pixel = hid->gui && !Settings.FullDetail ? pixel_slop : 0;
   Output.fgGC = gui->graphics->make_gc ();
   Output.bgGC = gui->graphics->make_gc ();
   Output.pmGC = gui->graphics->make_gc ();
@@ -77,4 +77,50 @@ void DrawMask (int side, const BoxType *drawn_area);
 void DrawHoles (bool draw_plated, bool draw_unplated, const BoxType *drawn_area, Cardinal g_from, Cardinal g_to);
 void PrintAssembly (int side, const BoxType *drawn_area);
 
+/*!
+ * \brief The r-tree searches made while drawing, for profiling.
+ */
+enum draw_search_kind
+{
+  DRAW_SEARCH_PIN,
+  DRAW_SEARCH_VIA,
+  DRAW_SEARCH_PAD,
+  DRAW_SEARCH_HOLE,
+  DRAW_SEARCH_CLEARANCE,
+  DRAW_SEARCH_ELEMENT,
+  DRAW_SEARCH_NAME,
+  DRAW_SEARCH_EMARK,
+  DRAW_SEARCH_RAT,
+  DRAW_SEARCH_POLYGON,
+  DRAW_SEARCH_LINE,
+  DRAW_SEARCH_ARC,
+  DRAW_SEARCH_TEXT,
+  N_DRAW_SEARCH_KINDS
+};
+
+/*!
+ * \brief Time spent in each kind of r-tree search, callbacks included.
+ *
+ * Only collected while draw_search_stats points at one of these.
+ */
+typedef struct
+{
+  long searches[N_DRAW_SEARCH_KINDS];
+  long found[N_DRAW_SEARCH_KINDS];
+  long tiles[N_DRAW_SEARCH_KINDS];	/*!< Level of detail tiles drawn. */
+  double seconds[N_DRAW_SEARCH_KINDS];
+} DrawSearchStatsType;
+
+extern DrawSearchStatsType *draw_search_stats;
+extern const char *draw_search_names[N_DRAW_SEARCH_KINDS];
+
+/*!
+ * \brief PCB size of a pixel for level of detail drawing.
+ *
+ * Objects and r-tree nodes a couple of these across are drawn as filled
+ * tiles.  0 turns this off; the default of -1 uses pixel_slop for the
+ * GUI and turns it off for everything else.
+ */
+extern Coord draw_lod_pixel;
+
 #endif
@@ -607,16 +607,13 @@ drc_callback (DataType *data, LayerType *layer, PolygonType *polygon,
        */
 
 
-      ClearFlagOnAllObjects (DRCFLAG, false);
-      start_do_it_and_dump (thing1.type, ptr1, ptr2, ptr2, DRCFLAG, 
+      NewSearchEpoch ();
+      start_do_it_and_dump (thing1.type, ptr1, ptr2, ptr2, SEARCHMARK,
                             false, 0, false);
 
-      /* Now everything that touches the line should have the DRCFLAG set. */
-      if (!TEST_FLAG (DRCFLAG, polygon))
+      /* Now everything that touches the line is marked in this epoch. */
+      if (!TEST_MARK (polygon))
         new_polygon_not_connected_violation (layer, polygon);
-
-      /* Pretend we were never here. */
-      ClearFlagOnAllObjects (DRCFLAG, false);
     }
 
     break;
@@ -38,73 +38,99 @@
 
 #include "data.h"
 #include "error.h"
+#include "drill.h"
 #include "mymem.h"
 
 #ifdef HAVE_LIBDMALLOC
 #include <dmalloc.h>
 #endif
 
-/*
- * some local prototypes
+/*!
+ * \brief A hole collected by the pass over the board.
  */
-static void FillDrill (DrillType *, ElementType *, PinType *);
-static void InitializeDrill (DrillType *, PinType *, ElementType *);
+typedef struct
+{
+  PinType *pin;
+  ElementType *element; /*!< NULL for vias. */
+  Cardinal bucket; /*!< Index of the drill size in the unsorted table. */
+} DrillHoleType;
+
+/*!
+ * \brief Open addressed hash from drill size to bucket index.
+ */
+typedef struct
+{
+  Cardinal Size; /*!< Number of slots, a power of two. */
+  Cardinal Used; /*!< Number of occupied slots. */
+  Coord *Key; /*!< Drill size of each slot. */
+  int *Value; /*!< Bucket index, -1 for an empty slot. */
+} DrillHashType;
 
+static Cardinal
+DrillHashSlot (DrillHashType *hash, Coord size)
+{
+  unsigned long h = (unsigned long) size * 2654435761UL;
+  Cardinal slot = (h ^ (h >> 16)) & (hash->Size - 1);
+
+  while (hash->Value[slot] != -1 && hash->Key[slot] != size)
+    slot = (slot + 1) & (hash->Size - 1);
+  return slot;
+}
 
 static void
-FillDrill (DrillType *Drill, ElementType *Element, PinType *Pin)
+DrillHashInit (DrillHashType *hash, Cardinal size)
 {
-  Cardinal n;
-  ElementType **ptr;
-  PinType **pin;
+  Cardinal i;
 
-  pin = GetDrillPinMemory (Drill);
-  *pin = Pin;
-  if (Element)
-    {
-      Drill->PinCount++;
-      for (n = Drill->ElementN - 1; n != -1; n--)
-	if (Drill->Element[n] == Element)
-	  break;
-      if (n == -1)
-	{
-	  ptr = GetDrillElementMemory (Drill);
-	  *ptr = Element;
-	}
-    }
-  else
-    Drill->ViaCount++;
-  if (TEST_FLAG (HOLEFLAG, Pin))
-    Drill->UnplatedCount++;
+  hash->Size = size;
+  hash->Used = 0;
+  hash->Key = (Coord *)malloc (size * sizeof (Coord));
+  hash->Value = (int *)malloc (size * sizeof (int));
+  for (i = 0; i < size; i++)
+    hash->Value[i] = -1;
 }
 
 static void
-InitializeDrill (DrillType *drill, PinType *pin, ElementType *element)
+DrillHashGrow (DrillHashType *hash)
 {
-  void *ptr;
-
-  drill->DrillSize = pin->DrillingHole;
-  drill->ElementN = 0;
-  drill->ViaCount = 0;
-  drill->PinCount = 0;
-  drill->UnplatedCount = 0;
-  drill->ElementMax = 0;
-  drill->Element = NULL;
-  drill->PinN = 0;
-  drill->Pin = NULL;
-  drill->PinMax = 0;
-  ptr = (void *) GetDrillPinMemory (drill);
-  *((PinType **) ptr) = pin;
-  if (element)
-    {
-      ptr = (void *) GetDrillElementMemory (drill);
-      *((ElementType **) ptr) = element;
-      drill->PinCount = 1;
-    }
-  else
-    drill->ViaCount = 1;
-  if (TEST_FLAG (HOLEFLAG, pin))
-    drill->UnplatedCount = 1;
+  DrillHashType bigger;
+  Cardinal i;
+
+  DrillHashInit (&bigger, hash->Size * 2);
+  for (i = 0; i < hash->Size; i++)
+    if (hash->Value[i] != -1)
+      {
+        Cardinal slot = DrillHashSlot (&bigger, hash->Key[i]);
+
+        bigger.Key[slot] = hash->Key[i];
+        bigger.Value[slot] = hash->Value[i];
+        bigger.Used++;
+      }
+  free (hash->Key);
+  free (hash->Value);
+  *hash = bigger;
+}
+
+/*!
+ * \brief Returns the bucket of a drill size, or -1 if there is none yet.
+ */
+static int
+DrillHashFind (DrillHashType *hash, Coord size)
+{
+  return hash->Value[DrillHashSlot (hash, size)];
+}
+
+static void
+DrillHashInsert (DrillHashType *hash, Coord size, int bucket)
+{
+  Cardinal slot;
+
+  if (2 * (hash->Used + 1) > hash->Size)
+    DrillHashGrow (hash);
+  slot = DrillHashSlot (hash, size);
+  hash->Key[slot] = size;
+  hash->Value[slot] = bucket;
+  hash->Used++;
 }
 
 static int
@@ -112,107 +138,193 @@ DrillQSort (const void *va, const void *vb)
 {
   DrillType *a = (DrillType *) va;
   DrillType *b = (DrillType *) vb;
-  return a->DrillSize - b->DrillSize;
+
+  if (a->DrillSize < b->DrillSize)
+    return -1;
+  return a->DrillSize > b->DrillSize;
+}
+
+/*!
+ * \brief State of the pass collecting the holes of a board.
+ */
+typedef struct
+{
+  DrillInfoType *AllDrills;
+  DrillHashType hash;
+  DrillHoleType *holes; /*!< Every hole, in board order. */
+  Cardinal holeN;
+  ElementType **last; /*!< Last element added to each bucket. */
+} DrillPassType;
+
+static void
+AddHole (DrillPassType *pass, PinType *pin, ElementType *element)
+{
+  DrillInfoType *AllDrills = pass->AllDrills;
+  DrillType *drill;
+  int bucket;
+
+  bucket = DrillHashFind (&pass->hash, pin->DrillingHole);
+  if (bucket == -1)
+    {
+      drill = GetDrillInfoDrillMemory (AllDrills);
+      drill->DrillSize = pin->DrillingHole;
+      bucket = AllDrills->DrillN - 1;
+      DrillHashInsert (&pass->hash, pin->DrillingHole, bucket);
+      pass->last = (ElementType **)realloc (pass->last, AllDrills->DrillMax
+                                            * sizeof (ElementType *));
+      pass->last[bucket] = NULL;
+    }
+  drill = &AllDrills->Drill[bucket];
+
+  if (element)
+    {
+      drill->PinCount++;
+      if (pass->last[bucket] != element)
+        {
+          drill->ElementN++;
+          pass->last[bucket] = element;
+        }
+    }
+  else
+    drill->ViaCount++;
+  if (TEST_FLAG (HOLEFLAG, pin))
+    drill->UnplatedCount++;
+  drill->PinN++;
+
+  pass->holes[pass->holeN].pin = pin;
+  pass->holes[pass->holeN].element = element;
+  pass->holes[pass->holeN].bucket = bucket;
+  pass->holeN++;
 }
 
+/*!
+ * \brief Collects all pins and vias into buckets by drill size.
+ *
+ * The board is walked once; each hole finds its bucket through a hash
+ * on the drill size.  The buckets are then sorted by size and the pin
+ * and element pointers are placed into two arrays shared by all
+ * buckets, each bucket owning a contiguous slice in size order.
+ *
+ * The pins of an element are visited one after the other, so an
+ * element is already listed in a bucket if and only if it is the last
+ * one added to it.
+ *
+ * The returned table is owned by the caller and must be released with
+ * FreeDrillInfo().
+ */
 DrillInfoType *
 GetDrillInfo (DataType *top)
 {
   DrillInfoType *AllDrills;
-  DrillType *Drill = NULL;
-  DrillType savedrill, swapdrill;
-  bool DrillFound = false;
-  bool NewDrill;
+  DrillPassType pass;
+  Cardinal *rank;
+  Cardinal maxholes = top->ViaN, i, pins, elements;
+
+  ELEMENT_LOOP (top);
+  {
+    maxholes += element->PinN;
+  }
+  END_LOOP;
 
   AllDrills = (DrillInfoType *)calloc (1, sizeof (DrillInfoType));
+  pass.AllDrills = AllDrills;
+  pass.holes = (DrillHoleType *)malloc (MAX (maxholes, 1)
+                                        * sizeof (DrillHoleType));
+  pass.holeN = 0;
+  pass.last = NULL;
+  DrillHashInit (&pass.hash, 32);
+
   ALLPIN_LOOP (top);
   {
-    if (!DrillFound)
-      {
-	DrillFound = true;
-	Drill = GetDrillInfoDrillMemory (AllDrills);
-	InitializeDrill (Drill, pin, element);
-      }
-    else
-      {
-	if (Drill->DrillSize == pin->DrillingHole)
-	  FillDrill (Drill, element, pin);
-	else
-	  {
-	    NewDrill = false;
-	    DRILL_LOOP (AllDrills);
-	    {
-	      if (drill->DrillSize == pin->DrillingHole)
-		{
-		  Drill = drill;
-		  FillDrill (Drill, element, pin);
-		  break;
-		}
-	      else if (drill->DrillSize > pin->DrillingHole)
-		{
-		  if (!NewDrill)
-		    {
-		      NewDrill = true;
-		      InitializeDrill (&swapdrill, pin, element);
-		      Drill = GetDrillInfoDrillMemory (AllDrills);
-		      Drill->DrillSize = pin->DrillingHole + 1;
-		      Drill = drill;
-		    }
-		  savedrill = *drill;
-		  *drill = swapdrill;
-		  swapdrill = savedrill;
-		}
-	    }
-	    END_LOOP;
-	    if (AllDrills->Drill[AllDrills->DrillN - 1].DrillSize <
-		pin->DrillingHole)
-	      {
-		Drill = GetDrillInfoDrillMemory (AllDrills);
-		InitializeDrill (Drill, pin, element);
-	      }
-	  }
-      }
+    AddHole (&pass, pin, element);
   }
   ENDALL_LOOP;
   VIA_LOOP (top);
   {
-    if (!DrillFound)
-      {
-	DrillFound = true;
-	Drill = GetDrillInfoDrillMemory (AllDrills);
-	Drill->DrillSize = via->DrillingHole;
-	FillDrill (Drill, NULL, via);
-      }
-    else
-      {
-	if (Drill->DrillSize != via->DrillingHole)
-	  {
-	    DRILL_LOOP (AllDrills);
-	    {
-	      if (drill->DrillSize == via->DrillingHole)
-		{
-		  Drill = drill;
-		  FillDrill (Drill, NULL, via);
-		  break;
-		}
-	    }
-	    END_LOOP;
-	    if (Drill->DrillSize != via->DrillingHole)
-	      {
-		Drill = GetDrillInfoDrillMemory (AllDrills);
-		Drill->DrillSize = via->DrillingHole;
-		FillDrill (Drill, NULL, via);
-	      }
-	  }
-	else
-	  FillDrill (Drill, NULL, via);
-      }
+    AddHole (&pass, via, NULL);
   }
   END_LOOP;
+
   qsort (AllDrills->Drill, AllDrills->DrillN, sizeof (DrillType), DrillQSort);
+
+  /* Map each bucket to its position in the sorted table and hand out
+   * the slices of the shared arrays.  */
+  rank = (Cardinal *)malloc (MAX (AllDrills->DrillN, 1) * sizeof (Cardinal));
+  pins = elements = 0;
+  for (i = 0; i < AllDrills->DrillN; i++)
+    {
+      DrillType *drill = &AllDrills->Drill[i];
+
+      rank[DrillHashFind (&pass.hash, drill->DrillSize)] = i;
+      drill->PinMax = drill->PinN;
+      drill->ElementMax = drill->ElementN;
+      pins += drill->PinN;
+      elements += drill->ElementN;
+    }
+
+  AllDrills->PinStore = (PinType **)malloc (MAX (pins, 1) * sizeof (PinType *));
+  AllDrills->ElementStore =
+    (ElementType **)malloc (MAX (elements, 1) * sizeof (ElementType *));
+  pins = elements = 0;
+  DRILL_LOOP (AllDrills);
+  {
+    drill->Pin = AllDrills->PinStore + pins;
+    drill->Element = AllDrills->ElementStore + elements;
+    pins += drill->PinMax;
+    elements += drill->ElementMax;
+    drill->PinN = 0;
+    drill->ElementN = 0;
+  }
+  END_LOOP;
+
+  for (i = 0; i < pass.holeN; i++)
+    {
+      DrillHoleType *hole = &pass.holes[i];
+      DrillType *drill = &AllDrills->Drill[rank[hole->bucket]];
+
+      drill->Pin[drill->PinN++] = hole->pin;
+      if (hole->element
+          && (drill->ElementN == 0
+              || drill->Element[drill->ElementN - 1] != hole->element))
+        drill->Element[drill->ElementN++] = hole->element;
+    }
+
+  free (rank);
+  free (pass.last);
+  free (pass.holes);
+  free (pass.hash.Key);
+  free (pass.hash.Value);
   return (AllDrills);
 }
 
+/*!
+ * \brief Returns the drill table of \p top, building it only when the
+ * pins or vias changed since the last call.
+ *
+ * The table is owned by \p top and must not be freed by the caller.
+ * Anything that adds, removes or re-drills a pin or via, or changes
+ * whether it is plated, must call InvalidateDrillInfo().
+ */
+DrillInfoType *
+GetCachedDrillInfo (DataType *top)
+{
+  if (top->drill_info == NULL)
+    top->drill_info = GetDrillInfo (top);
+  return top->drill_info;
+}
+
+/*!
+ * \brief Drops the cached drill table of \p top.
+ */
+void
+InvalidateDrillInfo (DataType *top)
+{
+  if (top == NULL || top->drill_info == NULL)
+    return;
+  FreeDrillInfo (top->drill_info);
+  top->drill_info = NULL;
+}
+
 #define ROUND(x,n) ((int)(((x)+(n)/2)/(n))*(n))
 
 /*
@@ -253,36 +365,22 @@ RoundDrillInfo (DrillInfoType *d, int roundto)
 	{
 	  int ei, ej;
 
-	  d->Drill[i].ElementMax
-	    = d->Drill[i].ElementN + d->Drill[i+1].ElementN;
-	  if (d->Drill[i].ElementMax)
+	  /* Neighbouring buckets own neighbouring slices of the shared
+	   * arrays, so the pins of the second simply extend the first and
+	   * its new elements can be moved down in place.  */
+	  for (ei = 0; ei < d->Drill[i + 1].ElementN; ei++)
 	    {
-	      d->Drill[i].Element = (ElementType **)realloc (d->Drill[i].Element,
-					     d->Drill[i].ElementMax *
-					     sizeof (ElementType *));
-
-	      for (ei = 0; ei < d->Drill[i+1].ElementN; ei++)
-		{
-		  for (ej = 0; ej < d->Drill[i].ElementN; ej++)
-		    if (d->Drill[i].Element[ej] == d->Drill[i + 1].Element[ei])
-		      break;
-		  if (ej == d->Drill[i].ElementN)
-		    d->Drill[i].Element[d->Drill[i].ElementN++]
-		      = d->Drill[i + 1].Element[ei];
-		}
+	      for (ej = 0; ej < d->Drill[i].ElementN; ej++)
+		if (d->Drill[i].Element[ej] == d->Drill[i + 1].Element[ei])
+		  break;
+	      if (ej == d->Drill[i].ElementN)
+		d->Drill[i].Element[d->Drill[i].ElementN++]
+		  = d->Drill[i + 1].Element[ei];
 	    }
-	  free (d->Drill[i + 1].Element);
-	  d->Drill[i + 1].Element = NULL;
-
-	  d->Drill[i].PinMax = d->Drill[i].PinN + d->Drill[i + 1].PinN;
-	  d->Drill[i].Pin = (PinType **)realloc (d->Drill[i].Pin,
-				     d->Drill[i].PinMax *
-				     sizeof (PinType *));
-	  memcpy (d->Drill[i].Pin + d->Drill[i].PinN, d->Drill[i + 1].Pin,
-		  d->Drill[i + 1].PinN * sizeof (PinType *));
+	  d->Drill[i].ElementMax += d->Drill[i + 1].ElementMax;
+
 	  d->Drill[i].PinN += d->Drill[i + 1].PinN;
-	  free (d->Drill[i + 1].Pin);
-	  d->Drill[i + 1].Pin = NULL;
+	  d->Drill[i].PinMax += d->Drill[i + 1].PinMax;
 
 	  d->Drill[i].PinCount += d->Drill[i + 1].PinCount;
 	  d->Drill[i].ViaCount += d->Drill[i + 1].ViaCount;
@@ -307,12 +405,8 @@ RoundDrillInfo (DrillInfoType *d, int roundto)
 void
 FreeDrillInfo (DrillInfoType *Drills)
 {
-  DRILL_LOOP (Drills);
-  {
-    free (drill->Element);
-    free (drill->Pin);
-  }
-  END_LOOP;
+  free (Drills->PinStore);
+  free (Drills->ElementStore);
   free (Drills->Drill);
   free (Drills);
 }
@@ -33,5 +33,7 @@
  */
 
 DrillInfoType * GetDrillInfo (DataType *);
+DrillInfoType * GetCachedDrillInfo (DataType *);
+void InvalidateDrillInfo (DataType *);
 void FreeDrillInfo (DrillInfoType *);
 void RoundDrillInfo (DrillInfoType *, int);
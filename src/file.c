@@ -133,6 +133,11 @@ static int LoadNewlibFootprintsFromDir(char *path, char *toppath, bool recursive
 
 #define F2S(OBJ, TYPE) flags_to_string ((OBJ)->Flags, TYPE)
 
+/*!
+ * \brief Size of the stdio buffer used when saving layouts and buffers.
+ */
+#define SAVE_BUFFER_SIZE (256 * 1024)
+
 /* --------------------------------------------------------------------------- */
 
 /* The idea here is to avoid gratuitously breaking backwards
@@ -255,6 +260,7 @@ sort_library (LibraryType *lib)
 {
   int i;
   qsort (lib->Menu, lib->MenuN, sizeof (lib->Menu[0]), netlist_sort);
+  netlist_serial++;
   for (i = 0; i < lib->MenuN; i++)
     qsort (lib->Menu[i].Entry,
 	   lib->Menu[i].EntryN, sizeof (lib->Menu[i].Entry[0]), netnode_sort);
@@ -931,6 +937,7 @@ WritePCBFile (char *Filename)
       OpenErrorMessage (Filename);
       return (STATUS_ERROR);
     }
+  setvbuf (fp, NULL, _IOFBF, SAVE_BUFFER_SIZE);
   result = WritePCB (fp);
 
   if (ferror (fp))
@@ -989,6 +996,7 @@ WritePipe (char *Filename, bool thePcb)
 	  return (STATUS_ERROR);
 	}
     }
+  setvbuf (fp, NULL, _IOFBF, SAVE_BUFFER_SIZE);
   if (thePcb)
     {
       if (PCB->is_footprint)
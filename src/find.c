@@ -193,8 +193,13 @@ add_object_to_list (ListType *list, int type, void *ptr1, void *ptr2, void *ptr3
   /* Set the appropriate flag to indicate the object appears in one of the
    * lists. This is how we later compare runs.
    */
-  AddObjectToFlagUndoList (type, ptr1, ptr2, ptr3);
-  SET_FLAG (flag, object);
+  if (flag == SEARCHMARK)
+    SET_MARK (object);
+  else
+    {
+      AddObjectToFlagUndoList (type, ptr1, ptr2, ptr3);
+      SET_FLAG (flag, object);
+    }
 
   /* Add the object to the list. */  
   LIST_ENTRY (list, list->Number) = object;
@@ -1366,7 +1371,7 @@ LOCtoPVline_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (i->pv, GetLayerGroupNumberByNumber (i->layer)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, line) && PinLineIntersect (i->pv, line) &&
+  if (!TEST_FOUND (i->flag, line) && PinLineIntersect (i->pv, line) &&
       !TEST_FLAG (HOLEFLAG, i->pv))
     {
       if (ADD_LINE_TO_LIST (i->layer, line, i->flag))
@@ -1384,7 +1389,7 @@ LOCtoPVarc_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (i->pv, GetLayerGroupNumberByNumber (i->layer)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, arc) && IS_PV_ON_ARC (i->pv, arc) &&
+  if (!TEST_FOUND (i->flag, arc) && IS_PV_ON_ARC (i->pv, arc) &&
       !TEST_FLAG (HOLEFLAG, i->pv))
     {
       if (ADD_ARC_TO_LIST (i->layer, arc, i->flag))
@@ -1402,7 +1407,7 @@ LOCtoPVpad_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (i->pv, GetLayerGroupNumberBySide (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, pad) && IS_PV_ON_PAD (i->pv, pad) &&
+  if (!TEST_FOUND (i->flag, pad) && IS_PV_ON_PAD (i->pv, pad) &&
       !TEST_FLAG (HOLEFLAG, i->pv) &&
       ADD_PAD_TO_LIST (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE :
                        TOP_SIDE, pad, i->flag))
@@ -1416,7 +1421,7 @@ LOCtoPVrat_callback (const BoxType * b, void *cl)
   RatType *rat = (RatType *) b;
   struct pv_info *i = (struct pv_info *) cl;
 
-  if (!TEST_FLAG (i->flag, rat) && IS_PV_ON_RAT (i->pv, rat) &&
+  if (!TEST_FOUND (i->flag, rat) && IS_PV_ON_RAT (i->pv, rat) &&
       ADD_RAT_TO_LIST (rat, i->flag))
     longjmp (i->env, 1);
   return 0;
@@ -1437,7 +1442,7 @@ LOCtoPVpoly_callback (const BoxType * b, void *cl)
    * because it might not be inside the polygon, or it could
    * be on an edge such that it doesn't actually touch.
    */
-  if (!TEST_FLAG (i->flag, polygon) && !TEST_FLAG (HOLEFLAG, i->pv) 
+  if (!TEST_FOUND (i->flag, polygon) && !TEST_FLAG (HOLEFLAG, i->pv) 
        && (TEST_THERM (i->layer, i->pv) 
            || !TEST_FLAG (CLEARPOLYFLAG, polygon)
            || !i->pv->Clearance)
@@ -1694,7 +1699,7 @@ pv_pv_callback (const BoxType * b, void *cl)
     }
 
   /* If either of the vias is a thru via, there is potential overlap. */
-  if (!TEST_FLAG (i->flag, pin) && PV_TOUCH_PV (i->pv, pin))
+  if (!TEST_FOUND (i->flag, pin) && PV_TOUCH_PV (i->pv, pin))
     {
 	  /* If it's only a hole (no copper) then just issue a warning to the
 	   * log, and highlight the pin. It doesn't affect the netlist.
@@ -1778,7 +1783,7 @@ pv_line_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (pv, GetLayerGroupNumberByNumber (i->layer)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, pv) && PinLineIntersect (pv, i->line))
+  if (!TEST_FOUND (i->flag, pv) && PinLineIntersect (pv, i->line))
     {
       if (TEST_FLAG (HOLEFLAG, pv))
         {
@@ -1801,7 +1806,7 @@ pv_pad_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (pv, GetLayerGroupNumberBySide (i->layer)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, pv) && IS_PV_ON_PAD (pv, i->pad))
+  if (!TEST_FOUND (i->flag, pv) && IS_PV_ON_PAD (pv, i->pad))
     {
       if (TEST_FLAG (HOLEFLAG, pv))
         {
@@ -1824,7 +1829,7 @@ pv_arc_callback (const BoxType * b, void *cl)
   if (!ViaIsOnLayerGroup (pv, GetLayerGroupNumberByNumber (i->layer)))
     return 0;
 
-  if (!TEST_FLAG (i->flag, pv) && IS_PV_ON_ARC (pv, i->arc))
+  if (!TEST_FOUND (i->flag, pv) && IS_PV_ON_ARC (pv, i->arc))
     {
       if (TEST_FLAG (HOLEFLAG, pv))
         {
@@ -1848,7 +1853,7 @@ pv_poly_callback (const BoxType * b, void *cl)
     return 0;
 
   /* note that holes in polygons are ok, so they don't generate warnings. */
-  if (!TEST_FLAG (i->flag, pv) && !TEST_FLAG (HOLEFLAG, pv) &&
+  if (!TEST_FOUND (i->flag, pv) && !TEST_FLAG (HOLEFLAG, pv) &&
                                   (TEST_THERM (i->layer, pv) ||
                                    !TEST_FLAG (CLEARPOLYFLAG, i->polygon) ||
                                    !pv->Clearance))
@@ -1888,7 +1893,7 @@ pv_rat_callback (const BoxType * b, void *cl)
   struct lo_info *i = (struct lo_info *) cl;
 
   /* rats can't cause DRC so there is no early exit */
-  if (!TEST_FLAG (i->flag, pv) && IS_PV_ON_RAT (pv, i->rat))
+  if (!TEST_FOUND (i->flag, pv) && IS_PV_ON_RAT (pv, i->rat))
     ADD_PV_TO_LIST (pv, i->flag);
   return 0;
 }
@@ -2071,7 +2076,7 @@ LOCtoArcLine_callback (const BoxType * b, void *cl)
   LineType *line = (LineType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, line) && LineArcIntersect (line, i->arc))
+  if (!TEST_FOUND (i->flag, line) && LineArcIntersect (line, i->arc))
     {
       if (ADD_LINE_TO_LIST (i->layer, line, i->flag))
         longjmp (i->env, 1);
@@ -2087,7 +2092,7 @@ LOCtoArcArc_callback (const BoxType * b, void *cl)
 
   if (!arc->Thickness)
     return 0;
-  if (!TEST_FLAG (i->flag, arc) && ArcArcIntersect (i->arc, arc))
+  if (!TEST_FOUND (i->flag, arc) && ArcArcIntersect (i->arc, arc))
     {
       if (ADD_ARC_TO_LIST (i->layer, arc, i->flag))
         longjmp (i->env, 1);
@@ -2101,7 +2106,7 @@ LOCtoArcPad_callback (const BoxType * b, void *cl)
   PadType *pad = (PadType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, pad) && i->layer ==
+  if (!TEST_FOUND (i->flag, pad) && i->layer ==
       (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE)
       && ArcPadIntersect (i->arc, pad) && ADD_PAD_TO_LIST (i->layer, pad, i->flag))
     longjmp (i->env, 1);
@@ -2161,7 +2166,7 @@ LookupLOConnectionsToArc (ArcType *Arc, Cardinal LayerGroup, int flag, bool AndR
           for (i = layer->Polygon; i != NULL; i = g_list_next (i))
             {
               PolygonType *polygon = i->data;
-              if (!TEST_FLAG (flag, polygon) && IsArcInPolygon (Arc, polygon)
+              if (!TEST_FOUND (flag, polygon) && IsArcInPolygon (Arc, polygon)
                   && ADD_POLYGON_TO_LIST (layer_no, polygon, flag))
                 return true;
             }
@@ -2185,7 +2190,7 @@ LOCtoLineLine_callback (const BoxType * b, void *cl)
   LineType *line = (LineType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, line) && LineLineIntersect (i->line, line))
+  if (!TEST_FOUND (i->flag, line) && LineLineIntersect (i->line, line))
     {
       if (ADD_LINE_TO_LIST (i->layer, line, i->flag))
         longjmp (i->env, 1);
@@ -2201,7 +2206,7 @@ LOCtoLineArc_callback (const BoxType * b, void *cl)
 
   if (!arc->Thickness)
     return 0;
-  if (!TEST_FLAG (i->flag, arc) && LineArcIntersect (i->line, arc))
+  if (!TEST_FOUND (i->flag, arc) && LineArcIntersect (i->line, arc))
     {
       if (ADD_ARC_TO_LIST (i->layer, arc, i->flag))
         longjmp (i->env, 1);
@@ -2215,7 +2220,7 @@ LOCtoLineRat_callback (const BoxType * b, void *cl)
   RatType *rat = (RatType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, rat))
+  if (!TEST_FOUND (i->flag, rat))
     {
       if ((rat->group1 == i->layer)
           && IsRatPointOnLineEnd (&rat->Point1, i->line))
@@ -2239,7 +2244,7 @@ LOCtoLinePad_callback (const BoxType * b, void *cl)
   PadType *pad = (PadType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, pad) && i->layer ==
+  if (!TEST_FOUND (i->flag, pad) && i->layer ==
       (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE)
       && LinePadIntersect (i->line, pad) && ADD_PAD_TO_LIST (i->layer, pad, i->flag))
     longjmp (i->env, 1);
@@ -2314,7 +2319,7 @@ LookupLOConnectionsToLine (LineType *Line, Cardinal LayerGroup,
               for (i = layer->Polygon; i != NULL; i = g_list_next (i))
                 {
                   PolygonType *polygon = i->data;
-                  if (!TEST_FLAG (flag, polygon) && IsLineInPolygon (Line, polygon)
+                  if (!TEST_FOUND (flag, polygon) && IsLineInPolygon (Line, polygon)
                       && ADD_POLYGON_TO_LIST (layer_no, polygon, flag))
                     return true;
                 }
@@ -2348,7 +2353,7 @@ LOCtoRat_callback (const BoxType * b, void *cl)
   LineType *line = (LineType *) b;
   struct rat_info *i = (struct rat_info *) cl;
 
-  if (!TEST_FLAG (i->flag, line) &&
+  if (!TEST_FOUND (i->flag, line) &&
       ((line->Point1.X == i->Point->X &&
         line->Point1.Y == i->Point->Y) ||
        (line->Point2.X == i->Point->X && line->Point2.Y == i->Point->Y)))
@@ -2364,7 +2369,7 @@ PolygonToRat_callback (const BoxType * b, void *cl)
   PolygonType *polygon = (PolygonType *) b;
   struct rat_info *i = (struct rat_info *) cl;
 
-  if (!TEST_FLAG (i->flag, polygon) && polygon->Clipped &&
+  if (!TEST_FOUND (i->flag, polygon) && polygon->Clipped &&
       (i->Point->X == polygon->Clipped->contours->head.point[0]) &&
       (i->Point->Y == polygon->Clipped->contours->head.point[1]))
     {
@@ -2380,7 +2385,7 @@ LOCtoPad_callback (const BoxType * b, void *cl)
   PadType *pad = (PadType *) b;
   struct rat_info *i = (struct rat_info *) cl;
 
-  if (!TEST_FLAG (i->flag, pad) && i->layer ==
+  if (!TEST_FOUND (i->flag, pad) && i->layer ==
 	(TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE) &&
       ((pad->Point1.X == i->Point->X && pad->Point1.Y == i->Point->Y) ||
        (pad->Point2.X == i->Point->X && pad->Point2.Y == i->Point->Y) ||
@@ -2453,7 +2458,7 @@ LOCtoPadLine_callback (const BoxType * b, void *cl)
   LineType *line = (LineType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, line) && LinePadIntersect (line, i->pad))
+  if (!TEST_FOUND (i->flag, line) && LinePadIntersect (line, i->pad))
     {
       if (ADD_LINE_TO_LIST (i->layer, line, i->flag))
         longjmp (i->env, 1);
@@ -2469,7 +2474,7 @@ LOCtoPadArc_callback (const BoxType * b, void *cl)
 
   if (!arc->Thickness)
     return 0;
-  if (!TEST_FLAG (i->flag, arc) && ArcPadIntersect (arc, i->pad))
+  if (!TEST_FOUND (i->flag, arc) && ArcPadIntersect (arc, i->pad))
     {
       if (ADD_ARC_TO_LIST (i->layer, arc, i->flag))
         longjmp (i->env, 1);
@@ -2484,7 +2489,7 @@ LOCtoPadPoly_callback (const BoxType * b, void *cl)
   struct lo_info *i = (struct lo_info *) cl;
 
 
-  if (!TEST_FLAG (i->flag, polygon) &&
+  if (!TEST_FOUND (i->flag, polygon) &&
       (!TEST_FLAG (CLEARPOLYFLAG, polygon) || !i->pad->Clearance))
     {
       if (IsPadInPolygon (i->pad, polygon) &&
@@ -2500,7 +2505,7 @@ LOCtoPadRat_callback (const BoxType * b, void *cl)
   RatType *rat = (RatType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, rat))
+  if (!TEST_FOUND (i->flag, rat))
     {
       if (rat->group1 == i->layer &&
 	  ((rat->Point1.X == i->pad->Point1.X && rat->Point1.Y == i->pad->Point1.Y) ||
@@ -2530,7 +2535,7 @@ LOCtoPadPad_callback (const BoxType * b, void *cl)
   PadType *pad = (PadType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, pad) && i->layer ==
+  if (!TEST_FOUND (i->flag, pad) && i->layer ==
       (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE)
       && PadPadIntersect (pad, i->pad) && ADD_PAD_TO_LIST (i->layer, pad, i->flag))
     longjmp (i->env, 1);
@@ -2623,7 +2628,7 @@ LOCtoPolyLine_callback (const BoxType * b, void *cl)
   LineType *line = (LineType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, line) && IsLineInPolygon (line, i->polygon))
+  if (!TEST_FOUND (i->flag, line) && IsLineInPolygon (line, i->polygon))
     {
       if (ADD_LINE_TO_LIST (i->layer, line, i->flag))
         longjmp (i->env, 1);
@@ -2639,7 +2644,7 @@ LOCtoPolyArc_callback (const BoxType * b, void *cl)
 
   if (!arc->Thickness)
     return 0;
-  if (!TEST_FLAG (i->flag, arc) && IsArcInPolygon (arc, i->polygon))
+  if (!TEST_FOUND (i->flag, arc) && IsArcInPolygon (arc, i->polygon))
     {
       if (ADD_ARC_TO_LIST (i->layer, arc, i->flag))
         longjmp (i->env, 1);
@@ -2653,7 +2658,7 @@ LOCtoPolyPad_callback (const BoxType * b, void *cl)
   PadType *pad = (PadType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, pad) && i->layer ==
+  if (!TEST_FOUND (i->flag, pad) && i->layer ==
       (TEST_FLAG (ONSOLDERFLAG, pad) ? BOTTOM_SIDE : TOP_SIDE)
       && IsPadInPolygon (pad, i->polygon))
     {
@@ -2669,7 +2674,7 @@ LOCtoPolyRat_callback (const BoxType * b, void *cl)
   RatType *rat = (RatType *) b;
   struct lo_info *i = (struct lo_info *) cl;
 
-  if (!TEST_FLAG (i->flag, rat))
+  if (!TEST_FOUND (i->flag, rat))
     {
       if ((rat->Point1.X == (i->polygon->Clipped->contours->head.point[0]) &&
            rat->Point1.Y == (i->polygon->Clipped->contours->head.point[1]) &&
@@ -2734,7 +2739,7 @@ LookupLOConnectionsToPolygon (PolygonType *Polygon, Cardinal LayerGroup, int fla
           for (i = layer->Polygon; i != NULL; i = g_list_next (i))
             {
               PolygonType *polygon = i->data;
-              if (!TEST_FLAG (flag, polygon)
+              if (!TEST_FOUND (flag, polygon)
                   && IsPolygonInPolygon (polygon, Polygon)
                   && ADD_POLYGON_TO_LIST (layer_no, polygon, flag))
                 return true;
@@ -2991,7 +2996,7 @@ PrintElementConnections (ElementType *Element, FILE * FP, int flag, bool AndDraw
   PIN_LOOP (Element);
   {
     /* pin might have been checked before, add to list if not */
-    if (TEST_FLAG (flag, pin))
+    if (TEST_FOUND (flag, pin))
       {
         PrintConnectionListEntry ((char *)EMPTY (pin->Name), NULL, true, FP);
         fputs ("\t\t__CHECKED_BEFORE__\n\t}\n", FP);
@@ -3015,7 +3020,7 @@ PrintElementConnections (ElementType *Element, FILE * FP, int flag, bool AndDraw
   {
     Cardinal layer;
     /* pad might have been checked before, add to list if not */
-    if (TEST_FLAG (flag, pad))
+    if (TEST_FOUND (flag, pad))
       {
         PrintConnectionListEntry ((char *)EMPTY (pad->Name), NULL, true, FP);
         fputs ("\t\t__CHECKED_BEFORE__\n\t}\n", FP);
@@ -3198,6 +3203,70 @@ LookupConnectionByPin (int type, void *ptr1)
   UnlockUndo();
 }
 
+/*!
+ * \brief Find the connected component of a single object and report
+ * every member of it.
+ *
+ * This is intended for sweeps which label all copper on the board, one
+ * component at a time.  The caller does InitConnectionLookup() once,
+ * calls this for every object which does not yet carry \p flag, and
+ * frees the lookup memory and clears \p flag once at the end.  Since
+ * components are disjoint, objects marked by an earlier call are never
+ * reached again, so no flag reset is needed between components.
+ *
+ * With SEARCHMARK as \p flag, the caller starts with NewSearchEpoch()
+ * and tests TEST_MARK() instead, and nothing needs clearing at all.
+ *
+ * \p func is called with (type, ptr1, ptr2) of each object in the
+ * component, the starting object included.
+ */
+void
+LookupConnectedComponent (int type, void *ptr1, void *ptr2, void *ptr3,
+                          int flag, bool AndRats,
+                          FoundObjectFunc func, void *userdata)
+{
+  Cardinal layer, i;
+
+  LockUndo ();
+  ListStart (type, ptr1, ptr2, ptr3, flag);
+  DoIt (flag, 0, AndRats, false, false);
+  UnlockUndo ();
+
+  if (func == NULL)
+    return;
+
+  for (i = 0; i < PVList.Number; i++)
+    {
+      PinType *pv = PVLIST_ENTRY (i);
+
+      if (pv->Element)
+        func (PIN_TYPE, pv->Element, pv, userdata);
+      else
+        func (VIA_TYPE, pv, pv, userdata);
+    }
+  for (layer = 0; layer < 2; layer++)
+    for (i = 0; i < PadList[layer].Number; i++)
+      {
+        PadType *pad = PADLIST_ENTRY (layer, i);
+
+        func (PAD_TYPE, pad->Element, pad, userdata);
+      }
+  for (layer = 0; layer < max_copper_layer; layer++)
+    {
+      for (i = 0; i < LineList[layer].Number; i++)
+        func (LINE_TYPE, LAYER_PTR (layer), LINELIST_ENTRY (layer, i),
+              userdata);
+      for (i = 0; i < ArcList[layer].Number; i++)
+        func (ARC_TYPE, LAYER_PTR (layer), ARCLIST_ENTRY (layer, i),
+              userdata);
+      for (i = 0; i < PolygonList[layer].Number; i++)
+        func (POLYGON_TYPE, LAYER_PTR (layer), POLYGONLIST_ENTRY (layer, i),
+              userdata);
+    }
+  for (i = 0; i < RatList.Number; i++)
+    func (RATLINE_TYPE, RATLIST_ENTRY (i), RATLIST_ENTRY (i), userdata);
+}
+
 /*!
  * \brief Find connections for rats nesting.
  *
@@ -3233,7 +3302,7 @@ PrintAndSelectUnusedPinsAndPadsOfElement (ElementType *Element, FILE * FP, int f
     if (!TEST_FLAG (HOLEFLAG, pin))
       {
         /* pin might have bee checked before, add to list if not */
-        if (!TEST_FLAG (flag, pin) && FP)
+        if (!TEST_FOUND (flag, pin) && FP)
           {
             int i;
             if (ADD_PV_TO_LIST (pin, flag))
@@ -3276,7 +3345,7 @@ PrintAndSelectUnusedPinsAndPadsOfElement (ElementType *Element, FILE * FP, int f
   {
     /* lookup pad in list */
     /* pad might has bee checked before, add to list if not */
-    if (!TEST_FLAG (flag, pad) && FP)
+    if (!TEST_FOUND (flag, pad) && FP)
       {
         int i;
         if (ADD_PAD_TO_LIST (TEST_FLAG (ONSOLDERFLAG, pad)
@@ -3384,24 +3453,23 @@ void
 LookupConnectionsToAllElements (FILE * FP)
 {
   LockUndo();
-  /* reset all currently marked connections */
-  ClearFlagOnAllObjects (FOUNDFLAG, false);
+  /* the connections are only marked, so the board is left untouched */
+  NewSearchEpoch ();
   
   InitConnectionLookup ();
 
   ELEMENT_LOOP (PCB->Data);
   {
     /* break if abort dialog returned true */
-    if (PrintElementConnections (element, FP, FOUNDFLAG, false))
+    if (PrintElementConnections (element, FP, SEARCHMARK, false))
       break;
     SEPARATE (FP);
     if (Settings.ResetAfterElement && n != 1)
-      ClearFlagOnAllObjects (FOUNDFLAG, false);
+      NewSearchEpoch ();
   }
   END_LOOP;
   if (Settings.RingBellWhenFinished)
     gui->beep ();
-  ClearFlagOnAllObjects (FOUNDFLAG, false);
   UnlockUndo();
   FreeConnectionLookupMemory ();
   Redraw ();
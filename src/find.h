@@ -58,6 +58,14 @@ void FreeConnectionLookupMemory (void);
 void RatFindHook (int, void *, void *, void *, bool, int flag, bool);
 void LookupConnectionByPin (int , void *);
 
+/*!
+ * \brief Called once for every object of a connected component.
+ */
+typedef void (*FoundObjectFunc) (int type, void *ptr1, void *ptr2,
+                                 void *userdata);
+void LookupConnectedComponent (int, void *, void *, void *, int, bool,
+                               FoundObjectFunc, void *);
+
 /* remove these prototypes later */
 bool ListStart(int, void*, void*, void*, int);
 bool DoIt(int, Coord, bool, bool, bool);
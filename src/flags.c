@@ -55,6 +55,9 @@
 
 int pcb_flag_eq (FlagType *f1, FlagType *f2);
 
+unsigned long selection_serial = 0;
+unsigned int search_epoch = 1;
+
 /*!
  * \brief .
  *
@@ -392,6 +395,71 @@ ClearFlagOnAllObjects (int flag, bool undoable)
   return change;
 }
 
+/*!
+ * \brief Reset the search marks of all objects in a data set.
+ */
+static void
+ClearMarksOnData (DataType *data)
+{
+  VIA_LOOP (data);
+  {
+    via->Flags.mark = 0;
+  }
+  END_LOOP;
+  ALLPIN_LOOP (data);
+  {
+    pin->Flags.mark = 0;
+  }
+  ENDALL_LOOP;
+  ALLPAD_LOOP (data);
+  {
+    pad->Flags.mark = 0;
+  }
+  ENDALL_LOOP;
+  ALLLINE_LOOP (data);
+  {
+    line->Flags.mark = 0;
+  }
+  ENDALL_LOOP;
+  ALLARC_LOOP (data);
+  {
+    arc->Flags.mark = 0;
+  }
+  ENDALL_LOOP;
+  ALLPOLYGON_LOOP (data);
+  {
+    polygon->Flags.mark = 0;
+  }
+  ENDALL_LOOP;
+  RAT_LOOP (data);
+  {
+    line->Flags.mark = 0;
+  }
+  END_LOOP;
+}
+
+/*!
+ * \brief Forget all search marks by starting a new search epoch.
+ *
+ * Only when the epoch counter wraps around are the objects themselves
+ * visited, so that no old stamp can match the new epoch.
+ */
+void
+NewSearchEpoch (void)
+{
+  int i;
+
+  if (++search_epoch != 0)
+    return;
+
+  if (PCB != NULL && PCB->Data != NULL)
+    ClearMarksOnData (PCB->Data);
+  for (i = 0; i < MAX_BUFFER; i++)
+    if (Buffers[i].Data != NULL)
+      ClearMarksOnData (Buffers[i].Data);
+  search_epoch = 1;
+}
+
 static const char dump_flags_syntax[] = ("DumpFlags([Output file])");
 static const char dump_flags_help[] = ("Write out a list of objects and their flags.");
 
@@ -511,6 +579,7 @@ HID_Flag flags_flag_list[] = {
   {"drawgrid",             FlagSETTINGS,     OFFSET_POINTER (SettingType, DrawGrid)},
   {"ratwarn",              FlagSETTINGS,     OFFSET_POINTER (SettingType, RatWarn)},
   {"stipplepolygons",      FlagSETTINGS,     OFFSET_POINTER (SettingType, StipplePolygons)},
+  {"fulldetail",           FlagSETTINGS,     OFFSET_POINTER (SettingType, FullDetail)},
   {"alldirectionlines",    FlagSETTINGS,     OFFSET_POINTER (SettingType, AllDirectionLines)},
   {"rubberbandmode",       FlagSETTINGS,     OFFSET_POINTER (SettingType, RubberBandMode)},
   {"swapstartdirection",   FlagSETTINGS,     OFFSET_POINTER (SettingType, SwapStartDirection)},
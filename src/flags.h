@@ -47,23 +47,58 @@ typedef struct
 {
   unsigned long f;		/* generic flags */
   unsigned char t[(MAX_LAYER + 1) / 2];  /* thermals */
+  unsigned int mark;		/* search epoch stamp, see TEST_MARK */
 } FlagType;
 
 int pcb_flag_eq (FlagType *f1, FlagType *f2);
 
 
+/*!
+ * \brief Bumped whenever SELECTEDFLAG is written through the macros
+ * below.
+ *
+ * The selection index in select.c compares it against the value it
+ * was last synchronised with to find out whether somebody changed the
+ * selection behind its back.
+ */
+extern unsigned long selection_serial;
+
+#define	SELECTION_TOUCH(F)	((F) & SELECTEDFLAG ? (void) selection_serial++ : (void) 0)
+
 /* ---------------------------------------------------------------------------
  * some routines for flag setting, clearing, changing and testing
  */
-#define	SET_FLAG(F,P)		((P)->Flags.f |= (F))
-#define	CLEAR_FLAG(F,P)		((P)->Flags.f &= (~(F)))
+#define	SET_FLAG(F,P)		(SELECTION_TOUCH (F), (P)->Flags.f |= (F))
+#define	CLEAR_FLAG(F,P)		(SELECTION_TOUCH (F), (P)->Flags.f &= (~(F)))
 #define	TEST_FLAG(F,P)		((P)->Flags.f & (F) ? 1 : 0)
-#define	TOGGLE_FLAG(F,P)	((P)->Flags.f ^= (F))
-#define	ASSIGN_FLAG(F,V,P)	((P)->Flags.f = ((P)->Flags.f & (~(F))) | ((V) ? (F) : 0))
+#define	TOGGLE_FLAG(F,P)	(SELECTION_TOUCH (F), (P)->Flags.f ^= (F))
+#define	ASSIGN_FLAG(F,V,P)	(SELECTION_TOUCH (F), (P)->Flags.f = ((P)->Flags.f & (~(F))) | ((V) ? (F) : 0))
 #define TEST_FLAGS(F,P)         (((P)->Flags.f & (F)) == (F) ? 1 : 0)
 
 #define FLAGS_EQUAL(F1,F2)	pcb_flag_eq(&(F1), &(F2))
 
+/*!
+ * \brief The current search epoch.
+ *
+ * Searches which only need to remember the objects they have already
+ * reached, and which leave nothing for the user to see, stamp them with
+ * the current epoch instead of setting a flag.  NewSearchEpoch() then
+ * forgets every mark at once, where ClearFlagOnAllObjects() would have
+ * to visit the whole board.  Marks are not saved and not undoable.
+ */
+extern unsigned int search_epoch;
+
+#define	SET_MARK(P)		((P)->Flags.mark = search_epoch)
+#define	TEST_MARK(P)		((P)->Flags.mark == search_epoch)
+
+/*!
+ * \brief Pseudo-flag which makes the connection lookup in find.c mark
+ * the objects it finds instead of flagging them.
+ */
+#define	SEARCHMARK		0
+
+#define	TEST_FOUND(F,P)		((F) == SEARCHMARK ? TEST_MARK (P) : TEST_FLAG (F, P))
+
 #define THERMFLAG(L)		(0xf << (4 *((L) % 2)))
 
 #define TEST_THERM(L,P)		((P)->Flags.t[(L)/2] & THERMFLAG(L) ? 1 : 0)
@@ -85,5 +120,6 @@ FlagType MaskFlags (FlagType, unsigned int);
 bool ClearFlagOnLinesAndPolygons (int flag, bool undoable);
 bool ClearFlagOnPinsViasAndPads (int flag, bool undoable);
 bool ClearFlagOnAllObjects (int flag, bool undoable);
+void NewSearchEpoch (void);
 
 #endif  // ifndef PCB_FLAGS_H
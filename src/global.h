@@ -169,6 +169,7 @@ typedef unsigned char BYTE;
 	BoxType		BoundingBox;	\
 	long int	ID;		\
 	FlagType	Flags;		\
+	GList		*Link;		\
 	//	struct LibraryEntryType *net
 
 /* Lines, pads, and rats all use this so they can be cross-cast.  */
@@ -292,6 +293,7 @@ struct polygon_st
   POLYAREA *Clipped; /*!< The clipped region of this polygon. */
   PLINE *NoHoles; /*!< The polygon broken into hole-less regions */
   int NoHolesValid; /*!< Is the NoHoles polygon up to date? */
+  unsigned int ClipGeneration; /*!< Changes whenever Clipped is replaced. */
   PointType *Points; /*!< Data. */
   Cardinal *HoleIndex; /*!< Index of hole data within the Points array. */
   Cardinal HoleIndexN; /*!< Number of holes in polygon. */
@@ -336,6 +338,8 @@ typedef struct
   GList *Text;
   GList *Polygon;
   GList *Arc;
+  GList *LineTail, *TextTail, *PolygonTail, *ArcTail;
+    /*!< Last nodes of the lists above, see AppendObjectToList(). */
   rtree_t *line_tree, *text_tree, *polygon_tree, *arc_tree;
   bool On; /*!< Visible flag. */
   char *Color, /*!< Color. */
@@ -417,6 +421,8 @@ typedef struct
   GList *Pad;
   GList *Line;
   GList *Arc;
+  GList *PinTail, *PadTail, *LineTail, *ArcTail;
+    /*!< Last nodes of the lists above, see AppendObjectToList(). */
   BoxType VBox;
   AttributeListType Attributes;
 } ElementType;
@@ -462,11 +468,15 @@ typedef struct
   GList *Via;
   GList *Element;
   GList *Rat;
+  GList *ViaTail, *ElementTail, *RatTail;
+    /*!< Last nodes of the lists above, see AppendObjectToList(). */
   rtree_t *via_tree, *element_tree, *pin_tree, *pad_tree, *name_tree[3],	/* for element names */
    *rat_tree;
   struct PCBType *pcb;
   LayerType Layer[MAX_ALL_LAYER];
   int polyClip;
+  struct DrillInfoType *drill_info; /*!< Cached drill table, see drill.c. */
+  struct ElementIndexType *element_index; /*!< Elements by name, see search.c. */
 } DataType;
 
 /*!
@@ -489,11 +499,13 @@ typedef struct
 /*!
  * \brief Holds a range of Drill Infos.
  */
-typedef struct
+typedef struct DrillInfoType
 {
   Cardinal DrillN; /*!< Number of drill sizes. */
   Cardinal DrillMax; /*!< Max. number from malloc(). */
   DrillType *Drill; /*!< Plated holes. */
+  PinType **PinStore; /*!< Storage for the Pin arrays of all drills. */
+  ElementType **ElementStore; /*!< Storage for the Element arrays. */
 } DrillInfoType;
 
 typedef struct
@@ -781,6 +793,8 @@ typedef struct
     Mode, /*!< Currently active mode. */
     BufferNumber; /*!< Number of the current buffer. */
   int BackupInterval; /*!< Time between two backups in seconds. */
+  int UndoMemory; /*!< Kilobytes of undo history kept in memory, 0 for
+                       no limit. */
   char *DefaultLayerName[MAX_LAYER],
    *FontCommand, /*!< Command for font file loading. */
    *FileCommand, /*!< Command for file loading. */
@@ -827,6 +841,7 @@ typedef struct
     DrawGrid, /*!< Draw grid points. */
     RatWarn, /*!< Rats nest has set warnings. */
     StipplePolygons, /*!< Draw polygons with stipple. */
+    FullDetail, /*!< Draw every object, even when zoomed far out. */
     AllDirectionLines, /*!< Enable lines to all directions. */
     RubberBandMode, /*!< Move, rotate use rubberband connections. */
     SwapStartDirection,/*!< Change starting direction after each click. */
@@ -194,6 +194,35 @@ extern "C"
    */
   int hid_parse_actions (const char *str_);
 
+  typedef struct hid_action_script HID_ActionScript;
+
+  /*!
+   * \brief Parse the given string once into a script that can be run
+   * many times.
+   *
+   * Accepts the same syntax as hid_parse_actions.  Action names are
+   * resolved here, so running the script needs neither parsing nor
+   * name lookups.
+   *
+   * \return Returns NULL on a syntax error or an unknown action.
+   */
+  HID_ActionScript *hid_compile_actions (const char *str_);
+
+  /*!
+   * \brief Run every action of a compiled script in turn.
+   *
+   * \return Returns nonzero, and stops, as soon as an action handler
+   * returns nonzero.
+   */
+  int hid_run_compiled_actions (HID_ActionScript *script_);
+
+  /*!
+   * \brief Number of action calls in a compiled script.
+   */
+  int hid_compiled_actions_length (HID_ActionScript *script_);
+
+  void hid_free_compiled_actions (HID_ActionScript *script_);
+
   typedef struct
   {
     char *name; /*!< Name of the flag */
@@ -42,6 +42,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/stat.h>
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #include "global.h"
 #include "crosshair.h"
@@ -150,6 +159,352 @@ HID_Action batch_action_list[] = {
 REGISTER_ACTIONS (batch_action_list)
 
 
+/* ----------------------------------------------------------------------------- */
+
+static char *server_socket = NULL;
+
+HID_Attribute batch_attribute_list[] = {
+/* %start-doc options "23 Batch Options"
+@ftable @code
+@item --batch-socket <string>
+Instead of reading actions from standard input, listen for them on the
+Unix domain socket at this path.  Any number of clients may connect at
+once.  Each line a client sends is run as an action and answered with
+one @samp{message @var{text}} line per line of output the action logged,
+then @samp{status @var{result} @var{microseconds}}.  Clients share the
+loaded board, and their actions run one at a time.  A client which does
+not read its replies only holds up its own further lines, never the
+other clients.
+@end ftable
+%end-doc
+*/
+  {"batch-socket", "Serve actions on this Unix domain socket",
+   HID_String, 0, 0, {0, 0, 0}, 0, &server_socket},
+#define HA_batch_socket 0
+};
+
+REGISTER_ATTRIBUTES (batch_attribute_list)
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+
+/*!
+ * \brief One connected client of the batch server.
+ */
+typedef struct
+{
+  int fd;
+  GString *input; /*!< Received text not yet ending in a newline. */
+  GString *output; /*!< Replies the client has not taken yet. */
+  bool eof; /*!< The client has sent all it is going to send. */
+} BatchClient;
+
+/* Stop running a client's lines while this much of its output waits. */
+#define SERVER_OUTPUT_LIMIT 65536
+
+static GString *server_messages = NULL; /*!< Log of the running action. */
+static char *server_path = NULL;
+
+static void
+server_logv (const char *fmt, va_list ap)
+{
+  g_string_append_vprintf (server_messages, fmt, ap);
+}
+
+static void
+server_log (const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start (ap, fmt);
+  server_logv (fmt, ap);
+  va_end (ap);
+}
+
+/* Nobody is at the terminal to answer questions; go ahead with the
+ * defaults. */
+
+static int
+server_confirm_dialog (char *msg, ...)
+{
+  return 1;
+}
+
+static int
+server_close_confirm_dialog ()
+{
+  return 1;
+}
+
+static char *
+server_prompt_for (const char *msg, const char *default_string)
+{
+  return strdup (default_string ? default_string : "");
+}
+
+static char *
+server_fileselect (const char *title, const char *descr,
+		   char *default_file, char *default_ext,
+		   const char *history_tag, int flags)
+{
+  return default_file ? strdup (default_file) : NULL;
+}
+
+static void
+server_remove_socket (void)
+{
+  if (server_path)
+    unlink (server_path);
+}
+
+/*!
+ * \brief Sends as much of a client's pending output as its socket takes
+ * without blocking.
+ *
+ * \return false once the client has gone away.
+ */
+static bool
+server_flush (BatchClient *client)
+{
+  gsize sent = 0;
+
+  while (sent < client->output->len)
+    {
+      ssize_t n = write (client->fd, client->output->str + sent,
+			 client->output->len - sent);
+
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	break;
+      if (n <= 0)
+	return false;
+      sent += n;
+    }
+  g_string_erase (client->output, 0, sent);
+  return true;
+}
+
+/*!
+ * \brief Runs one action line for a client and queues the reply.
+ */
+static void
+server_run_line (BatchClient *client, const char *line)
+{
+  GString *reply = client->output;
+  GTimer *timer = g_timer_new ();
+  char *start, *end;
+  int rv;
+
+  g_string_truncate (server_messages, 0);
+  rv = hid_parse_command (line);
+  g_timer_stop (timer);
+
+  for (start = server_messages->str; *start; start = end)
+    {
+      end = strchr (start, '\n');
+      if (end == NULL)
+	end = start + strlen (start);
+      g_string_append (reply, "message ");
+      g_string_append_len (reply, start, end - start);
+      g_string_append_c (reply, '\n');
+      if (*end)
+	end++;
+    }
+  g_string_append_printf (reply, "status %d %ld\n", rv,
+			  (long) (g_timer_elapsed (timer, NULL) * 1e6));
+
+  g_timer_destroy (timer);
+}
+
+/*!
+ * \brief Runs the complete lines a client sent, until too much of its
+ * output is waiting to be read.
+ */
+static void
+server_run_lines (BatchClient *client)
+{
+  char *newline;
+
+  while (client->output->len < SERVER_OUTPUT_LIMIT
+	 && (newline = strchr (client->input->str, '\n')) != NULL)
+    {
+      *newline = '\0';
+      if (newline > client->input->str && newline[-1] == '\r')
+	newline[-1] = '\0';
+      server_run_line (client, client->input->str);
+      g_string_erase (client->input, 0, newline + 1 - client->input->str);
+    }
+}
+
+/*!
+ * \brief Reads what a client sent and runs the complete lines.
+ *
+ * \return false if reading failed.
+ */
+static bool
+server_read (BatchClient *client)
+{
+  char buf[4096];
+  ssize_t n;
+
+  n = read (client->fd, buf, sizeof (buf));
+  if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+    return true;
+  if (n < 0)
+    return false;
+  if (n == 0)
+    client->eof = true;
+  else
+    g_string_append_len (client->input, buf, n);
+
+  server_run_lines (client);
+  return true;
+}
+
+static void
+server_close (GPtrArray *clients, guint i)
+{
+  BatchClient *client = (BatchClient *) g_ptr_array_index (clients, i);
+
+  close (client->fd);
+  g_string_free (client->input, TRUE);
+  g_string_free (client->output, TRUE);
+  g_free (client);
+  g_ptr_array_remove_index_fast (clients, i);
+}
+
+/*!
+ * \brief Serves actions on a Unix domain socket until Quit() is run.
+ *
+ * The board, fonts and libraries are loaded once and shared by every
+ * client; each action runs to completion before the next one starts.
+ * Client sockets never block: replies wait in the client's output
+ * buffer until its socket takes them.
+ */
+static void
+batch_serve (const char *path)
+{
+  struct sockaddr_un addr;
+  struct stat st;
+  GPtrArray *clients;
+  int listener;
+  guint i;
+
+  if (strlen (path) >= sizeof (addr.sun_path))
+    {
+      fprintf (stderr, "Socket path too long: %s\n", path);
+      return;
+    }
+  /* only replace a stale socket, never some other file */
+  if (stat (path, &st) == 0 && S_ISSOCK (st.st_mode))
+    unlink (path);
+
+  listener = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0)
+    {
+      perror ("socket");
+      return;
+    }
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, path);
+  if (bind (listener, (struct sockaddr *) &addr, sizeof (addr)) < 0
+      || listen (listener, 16) < 0)
+    {
+      perror (path);
+      close (listener);
+      return;
+    }
+  server_path = strdup (path);
+  atexit (server_remove_socket);
+  signal (SIGPIPE, SIG_IGN);
+
+  server_messages = g_string_new (NULL);
+  gui->log = server_log;
+  gui->logv = server_logv;
+  gui->confirm_dialog = server_confirm_dialog;
+  gui->close_confirm_dialog = server_close_confirm_dialog;
+  gui->prompt_for = server_prompt_for;
+  gui->fileselect = server_fileselect;
+
+  clients = g_ptr_array_new ();
+  while (1)
+    {
+      fd_set readable, writable;
+      int max_fd = listener;
+
+      FD_ZERO (&readable);
+      FD_ZERO (&writable);
+      FD_SET (listener, &readable);
+      for (i = 0; i < clients->len; i++)
+	{
+	  BatchClient *client = (BatchClient *) g_ptr_array_index (clients, i);
+
+	  if (!client->eof && client->output->len < SERVER_OUTPUT_LIMIT)
+	    FD_SET (client->fd, &readable);
+	  if (client->output->len > 0)
+	    FD_SET (client->fd, &writable);
+	  max_fd = MAX (max_fd, client->fd);
+	}
+
+      if (select (max_fd + 1, &readable, &writable, NULL, NULL) < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  perror ("select");
+	  break;
+	}
+
+      for (i = clients->len; i-- > 0;)
+	{
+	  BatchClient *client = (BatchClient *) g_ptr_array_index (clients, i);
+	  bool ok = true;
+
+	  if (FD_ISSET (client->fd, &writable))
+	    {
+	      ok = server_flush (client);
+	      /* run the lines held back while the output was full */
+	      if (ok)
+		server_run_lines (client);
+	    }
+	  if (ok && FD_ISSET (client->fd, &readable))
+	    ok = server_read (client);
+	  if (ok && client->output->len > 0)
+	    ok = server_flush (client);
+
+	  /* with no output left, no complete line is left either */
+	  if (!ok || (client->eof && client->output->len == 0))
+	    server_close (clients, i);
+	}
+
+      if (FD_ISSET (listener, &readable))
+	{
+	  int fd = accept (listener, NULL, NULL);
+
+	  if (fd >= FD_SETSIZE)
+	    close (fd);
+	  else if (fd >= 0)
+	    {
+	      BatchClient *client = g_new (BatchClient, 1);
+
+	      fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+	      client->fd = fd;
+	      client->input = g_string_new (NULL);
+	      client->output = g_string_new (NULL);
+	      client->eof = false;
+	      g_ptr_array_add (clients, client);
+	    }
+	}
+    }
+
+  while (clients->len > 0)
+    server_close (clients, clients->len - 1);
+  g_ptr_array_free (clients, TRUE);
+  close (listener);
+}
+
+#endif
+
 /* ----------------------------------------------------------------------------- */
 
 static void
@@ -158,6 +513,16 @@ batch_do_export (HID_Attr_Val * options)
   int interactive;
   char line[1000];
 
+  if (server_socket && *server_socket)
+    {
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+      batch_serve (server_socket);
+#else
+      fprintf (stderr, "This pcb was built without Unix domain socket support.\n");
+#endif
+      return;
+    }
+
   if (isatty (0))
     interactive = 1;
   else
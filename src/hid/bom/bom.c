@@ -126,6 +126,19 @@ Parameter @code{<unit>} can be @samp{km}, @samp{m}, @samp{cm}, @samp{mm},
   {"xy-in-mm", ATTR_UNDOCUMENTED,
    HID_Boolean, 0, 0, {0, 0, 0}, 0, 0},
 #define HA_xymm 4
+
+/* %start-doc options "80 BOM Creation"
+@ftable @code
+@item --jsonfile <string>
+Name of an optional JSON output file holding both the placements and the
+bill of materials.  Not written unless a name is given.
+Parameter @code{<string>} can include a path.
+@end ftable
+%end-doc
+*/
+  {"jsonfile", "Name of the combined JSON output file",
+   HID_String, 0, 0, {0, 0, 0}, 0, 0},
+#define HA_jsonfile 5
 };
 
 #define NUM_OPTIONS (sizeof(bom_options)/sizeof(bom_options[0]))
@@ -134,6 +147,7 @@ static HID_Attr_Val bom_values[NUM_OPTIONS];
 
 static const char *bom_filename;
 static const char *xy_filename;
+static const char *json_filename;
 static const Unit *xy_unit;
 
 static char **attr_list = NULL;
@@ -152,10 +166,17 @@ typedef struct _BomList
   char *value;
   int num;
   StringList *refdes;
+  StringList *refdes_tail;
   char **attrs;
   struct _BomList *next;
 } BomList;
 
+/*!
+ * \brief Entries of the BOM being built, keyed by bom_key ().
+ */
+static GHashTable *bom_index = NULL;
+static BomList *bom_tail = NULL;
+
 static HID_Attribute *
 bom_get_export_options (int *n)
 {
@@ -216,6 +237,41 @@ CleanBOMString (char *in)
 }
 
 
+/*!
+ * \brief Write \c str to \c fp as a quoted JSON string.
+ */
+static void
+json_string (FILE *fp, const char *str)
+{
+  const unsigned char *c;
+
+  fputc ('"', fp);
+  for (c = (const unsigned char *) str; *c; c++)
+    {
+      switch (*c)
+	{
+	case '"':
+	  fputs ("\\\"", fp);
+	  break;
+	case '\\':
+	  fputs ("\\\\", fp);
+	  break;
+	case '\n':
+	  fputs ("\\n", fp);
+	  break;
+	case '\t':
+	  fputs ("\\t", fp);
+	  break;
+	default:
+	  if (*c < 0x20)
+	    fprintf (fp, "\\u%04x", *c);
+	  else
+	    fputc (*c, fp);
+	}
+    }
+  fputc ('"', fp);
+}
+
 static double
 xyToAngle (double x, double y, bool morethan2pins)
 {
@@ -261,9 +317,9 @@ xyToAngle (double x, double y, bool morethan2pins)
 }
 
 static StringList *
-string_insert (char *str, StringList * list)
+string_insert (char *str, StringList * list, StringList ** tail)
 {
-  StringList *newlist, *cur;
+  StringList *newlist;
 
   if ((newlist = (StringList *) malloc (sizeof (StringList))) == NULL)
     {
@@ -275,53 +331,56 @@ string_insert (char *str, StringList * list)
   newlist->str = strdup (str);
 
   if (list == NULL)
-    return (newlist);
+    list = newlist;
+  else
+    (*tail)->next = newlist;
+  *tail = newlist;
 
-  cur = list;
-  while (cur->next != NULL)
-    cur = cur->next;
+  return (list);
+}
 
-  cur->next = newlist;
+/*!
+ * \brief Build the key under which an element is grouped in the BOM.
+ *
+ * Every field is prefixed with its length so that no two different
+ * combinations of description, value and attributes give the same key.
+ */
+static char *
+bom_key (char *descr, char *value, ElementType *e)
+{
+  GString *key = g_string_new ("");
+  char *val;
+  int i;
 
-  return (list);
+  g_string_append_printf (key, "%lu:%s%lu:%s",
+                          (unsigned long) strlen (descr), descr,
+                          (unsigned long) strlen (value), value);
+  for (i=0; i<attr_count; i++)
+    {
+      val = AttributeGet (e, attr_list[i]);
+      val = val ? val : "";
+      g_string_append_printf (key, "%lu:%s", (unsigned long) strlen (val), val);
+    }
+  return g_string_free (key, FALSE);
 }
 
 static BomList *
 bom_insert (char *refdes, char *descr, char *value, ElementType *e, BomList * bom)
 {
-  BomList *newlist = NULL, *cur = NULL, *prev = NULL;
+  BomList *newlist = NULL, *cur = NULL;
   int i;
   char *val;
+  char *key;
 
-
-  if (bom != NULL)
+  /* see if we already have used one of these components */
+  key = bom_key (descr, value, e);
+  cur = (BomList *) g_hash_table_lookup (bom_index, key);
+  if (cur != NULL)
     {
-      /* search and see if we already have used one of these
-	 components */
-      cur = bom;
-      while (cur != NULL)
-	{
-	  int attr_mismatch = 0;
-
-	  for (i=0; i<attr_count; i++)
-	    {
-	      val = AttributeGet (e, attr_list[i]);
-	      val = val ? val : "";
-	      if (strcmp (val, cur->attrs[i]) != 0)
-		attr_mismatch = 1;
-	    }
-
-	  if ((NSTRCMP (descr, cur->descr) == 0) &&
-	      (NSTRCMP (value, cur->value) == 0) &&
-	      ! attr_mismatch)
-	    {
-	      cur->num++;
-	      cur->refdes = string_insert (refdes, cur->refdes);
-	      return (bom);
-	    }
-	  prev = cur;
-	  cur = cur->next;
-	}
+      g_free (key);
+      cur->num++;
+      cur->refdes = string_insert (refdes, cur->refdes, &cur->refdes_tail);
+      return (bom);
     }
 
   if ((newlist = (BomList *) malloc (sizeof (BomList))) == NULL)
@@ -330,14 +389,16 @@ bom_insert (char *refdes, char *descr, char *value, ElementType *e, BomList * bo
       exit (1);
     }
 
-  if (prev)
-    prev->next = newlist;
+  if (bom_tail)
+    bom_tail->next = newlist;
+  bom_tail = newlist;
+  g_hash_table_insert (bom_index, key, newlist);
 
   newlist->next = NULL;
   newlist->descr = strdup (descr);
   newlist->value = strdup (value);
   newlist->num = 1;
-  newlist->refdes = string_insert (refdes, NULL);
+  newlist->refdes = string_insert (refdes, NULL, &newlist->refdes_tail);
 
   if ((newlist->attrs = (char **) malloc (attr_count * sizeof (char *))) == NULL)
     {
@@ -360,26 +421,34 @@ bom_insert (char *refdes, char *descr, char *value, ElementType *e, BomList * bo
 
 /*!
  * \brief If \c fp is not NULL then print out the bill of materials
- * contained in \c bom.
+ * contained in \c bom, likewise for the "bom" array of \c json.
  * Either way, free all memory which has been allocated for bom.
  */
 static void
-print_and_free (FILE *fp, BomList *bom)
+print_and_free (FILE *fp, FILE *json, BomList *bom)
 {
   BomList *lastb;
   StringList *lasts;
   char *descr, *value;
+  int i;
 
   while (bom != NULL)
     {
+      /* both outputs use the cleaned strings, like the placements */
+      descr = CleanBOMString (bom->descr);
+      value = CleanBOMString (bom->value);
       if (fp)
+	fprintf (fp, "%d,\"%s\",\"%s\",", bom->num, descr, value);
+      if (json)
 	{
-	  descr = CleanBOMString (bom->descr);
-	  value = CleanBOMString (bom->value);
-	  fprintf (fp, "%d,\"%s\",\"%s\",", bom->num, descr, value);
-	  free (descr);
-	  free (value);
+	  fprintf (json, "    {\"quantity\": %d, \"description\": ", bom->num);
+	  json_string (json, descr);
+	  fprintf (json, ", \"value\": ");
+	  json_string (json, value);
+	  fprintf (json, ",\n     \"refdes\": [");
 	}
+      free (descr);
+      free (value);
       
       while (bom->refdes != NULL)
 	{
@@ -387,6 +456,15 @@ print_and_free (FILE *fp, BomList *bom)
 	    {
 	      fprintf (fp, "%s ", bom->refdes->str);
 	    }
+	  if (json)
+	    {
+	      char *refdes = CleanBOMString (bom->refdes->str);
+
+	      json_string (json, refdes);
+	      free (refdes);
+	      if (bom->refdes->next)
+		fprintf (json, ", ");
+	    }
 	  free (bom->refdes->str);
 	  lasts = bom->refdes;
 	  bom->refdes = bom->refdes->next;
@@ -394,16 +472,35 @@ print_and_free (FILE *fp, BomList *bom)
 	}
       if (fp)
 	{
-	  int i;
 	  for (i=0; i<attr_count; i++)
 	    fprintf (fp, ",\"%s\"", bom->attrs[i]);
 	  fprintf (fp, "\n");
 	}
+      if (json)
+	{
+	  fprintf (json, "],\n     \"attributes\": {");
+	  for (i=0; i<attr_count; i++)
+	    {
+	      if (i > 0)
+		fprintf (json, ", ");
+	      json_string (json, attr_list[i]);
+	      fprintf (json, ": ");
+	      json_string (json, bom->attrs[i]);
+	    }
+	  fprintf (json, "}}%s\n", bom->next ? "," : "");
+	}
       free (bom->attrs);
       lastb = bom;
       bom = bom->next;
       free (lastb);
     }
+
+  if (bom_index != NULL)
+    {
+      g_hash_table_destroy (bom_index);
+      bom_index = NULL;
+    }
+  bom_tail = NULL;
 }
 
 static void
@@ -484,14 +581,19 @@ PrintBOM (void)
   int found_any;
   time_t currenttime;
   FILE *fp;
+  FILE *json = NULL;
+  int placements = 0;
   BomList *bom = NULL;
   char *name, *descr, *value,*fixed_rotation;
   int rpindex;
   int i;
   char fmt[256];
+  char json_fmt[256];
 
   sprintf(fmt, "%%s,\"%%s\",\"%%s\",%%.2`m%c,%%.2`m%c,%%g,%%s\n", 
           xy_unit->printf_code, xy_unit->printf_code);
+  sprintf(json_fmt, ", \"x\": %%.2`m%c, \"y\": %%.2`m%c, \"rotation\": %%g, \"side\": \"%%s\"}",
+          xy_unit->printf_code, xy_unit->printf_code);
 
   fp = fopen (xy_filename, "wb");
   if (!fp)
@@ -500,7 +602,20 @@ PrintBOM (void)
       return 1;
     }
 
+  if (json_filename)
+    {
+      json = fopen (json_filename, "wb");
+      if (!json)
+	{
+	  gui->log ((_("Cannot open file %s for writing\n")), json_filename);
+	  fclose (fp);
+	  return 1;
+	}
+    }
+
   fetch_attr_list ();
+  bom_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  bom_tail = NULL;
 
   /* Create a portable timestamp. */
   currenttime = time (NULL);
@@ -519,6 +634,15 @@ PrintBOM (void)
   fprintf (fp, (_("# X,Y in %s.  rotation in degrees.\n")), xy_unit->suffix);
   fprintf (fp, "# --------------------------------------------\n");
 
+  if (json)
+    {
+      fprintf (json, "{\n  \"title\": ");
+      json_string (json, UNKNOWN (PCB->Name));
+      fprintf (json, ",\n  \"unit\": ");
+      json_string (json, xy_unit->suffix);
+      fprintf (json, ",\n  \"placements\": [\n");
+    }
+
   /*
    * For each element we calculate the centroid of the footprint.
    * In addition, we need to extract some notion of rotation.
@@ -683,6 +807,17 @@ PrintBOM (void)
 	//pcb_fprintf (fp, "%m+%s,\"%s\",\"%s\",%.2`mS,%.2`mS,%g,%s\n",
 	pcb_fprintf (fp, fmt, name, descr, value, x, y, theta, 
                           FRONT (element) == 1 ? "top" : "bottom");
+	if (json)
+	  {
+	    fprintf (json, "%s    {\"refdes\": ", placements++ ? ",\n" : "");
+	    json_string (json, name);
+	    fprintf (json, ", \"description\": ");
+	    json_string (json, descr);
+	    fprintf (json, ", \"value\": ");
+	    json_string (json, value);
+	    pcb_fprintf (json, json_fmt, x, y, theta,
+			 FRONT (element) == 1 ? "top" : "bottom");
+	  }
 	free (name);
 	free (descr);
 	free (value);
@@ -692,13 +827,18 @@ PrintBOM (void)
 
   fclose (fp);
 
+  if (json)
+    fprintf (json, "%s  ],\n  \"bom\": [\n", placements ? "\n" : "");
+
   /* Now print out a Bill of Materials file */
 
   fp = fopen (bom_filename, "wb");
   if (!fp)
     {
       gui->log ((_("Cannot open file %s for writing\n")), bom_filename);
-      print_and_free (NULL, bom);
+      print_and_free (NULL, NULL, bom);
+      if (json)
+	fclose (json);
       return 1;
     }
 
@@ -712,10 +852,16 @@ PrintBOM (void)
   fprintf (fp, "\n");
   fprintf (fp, "# --------------------------------------------\n");
 
-  print_and_free (fp, bom);
+  print_and_free (fp, json, bom);
 
   fclose (fp);
 
+  if (json)
+    {
+      fprintf (json, "  ]\n}\n");
+      fclose (json);
+    }
+
   return (0);
 }
 
@@ -740,6 +886,8 @@ bom_do_export (HID_Attr_Val * options)
   if (!xy_filename)
     xy_filename = "pcb-out.xy";
 
+  json_filename = options[HA_jsonfile].str_value;
+
   if (options[HA_xymm].int_value)
     xy_unit = get_unit_struct ("mm");
   else
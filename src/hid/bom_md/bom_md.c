@@ -116,10 +116,17 @@ typedef struct _bom_md_list
   char *value;
   int num;
   string_list *refdes;
+  string_list *refdes_tail;
   char **attrs;
   struct _bom_md_list *next;
 } bom_md_list;
 
+/*!
+ * \brief Entries of the BOM being built, keyed by bom_md_key ().
+ */
+static GHashTable *bom_md_index = NULL;
+static bom_md_list *bom_md_tail = NULL;
+
 /*!
  * \brief Get export options.
  */
@@ -175,9 +182,9 @@ bom_md_clean_string (char *in)
 }
 
 static string_list *
-bom_md_string_insert (char *str, string_list *list)
+bom_md_string_insert (char *str, string_list *list, string_list **tail)
 {
-  string_list *newlist, *cur;
+  string_list *newlist;
 
   if ((newlist = (string_list *) malloc (sizeof (string_list))) == NULL)
     {
@@ -189,16 +196,40 @@ bom_md_string_insert (char *str, string_list *list)
   newlist->str = strdup (str);
 
   if (list == NULL)
-    return (newlist);
+    list = newlist;
+  else
+    (*tail)->next = newlist;
+
+  *tail = newlist;
+
+  return (list);
+}
 
-  cur = list;
+/*!
+ * \brief Build the key under which an element is grouped in the BOM.
+ *
+ * Every field is prefixed with its length so that no two different
+ * combinations of description, value and attributes give the same key.
+ */
+static char *
+bom_md_key (char *descr, char *value, ElementType *e)
+{
+  GString *key = g_string_new ("");
+  char *val;
+  int i;
 
-  while (cur->next != NULL)
-    cur = cur->next;
+  g_string_append_printf (key, "%lu:%s%lu:%s",
+    (unsigned long) strlen (descr), descr,
+    (unsigned long) strlen (value), value);
 
-  cur->next = newlist;
+  for (i=0; i<attr_count; i++)
+  {
+    val = AttributeGet (e, attr_list[i]);
+    val = val ? val : "";
+    g_string_append_printf (key, "%lu:%s", (unsigned long) strlen (val), val);
+  }
 
-  return (list);
+  return g_string_free (key, FALSE);
 }
 
 /*!
@@ -207,42 +238,22 @@ bom_md_string_insert (char *str, string_list *list)
 static bom_md_list *
 bom_md_insert (char *refdes, char *descr, char *value, ElementType *e, bom_md_list * bom_md)
 {
-  bom_md_list *newlist = NULL, *cur = NULL, *prev = NULL;
+  bom_md_list *newlist = NULL, *cur = NULL;
   int i;
   char *val;
+  char *key;
 
+  /* search and see if we already have used one of these components. */
+  key = bom_md_key (descr, value, e);
+  cur = (bom_md_list *) g_hash_table_lookup (bom_md_index, key);
 
-  if (bom_md != NULL)
-    {
-      /* search and see if we already have used one of these components. */
-      cur = bom_md;
-
-      while (cur != NULL)
-      {
-        int attr_mismatch = 0;
-
-        for (i=0; i<attr_count; i++)
-        {
-          val = AttributeGet (e, attr_list[i]);
-          val = val ? val : "";
-
-          if (strcmp (val, cur->attrs[i]) != 0)
-            attr_mismatch = 1;
-        }
-
-        if ((NSTRCMP (descr, cur->descr) == 0)
-          && (NSTRCMP (value, cur->value) == 0)
-          && !attr_mismatch)
-        {
-          cur->num++;
-          cur->refdes = bom_md_string_insert (refdes, cur->refdes);
-          return (bom_md);
-        }
-
-        prev = cur;
-        cur = cur->next;
-      }
-    }
+  if (cur != NULL)
+  {
+    g_free (key);
+    cur->num++;
+    cur->refdes = bom_md_string_insert (refdes, cur->refdes, &cur->refdes_tail);
+    return (bom_md);
+  }
 
   if ((newlist = (bom_md_list *) malloc (sizeof (bom_md_list))) == NULL)
   {
@@ -250,14 +261,17 @@ bom_md_insert (char *refdes, char *descr, char *value, ElementType *e, bom_md_li
     exit (1);
   }
 
-  if (prev)
-    prev->next = newlist;
+  if (bom_md_tail)
+    bom_md_tail->next = newlist;
+
+  bom_md_tail = newlist;
+  g_hash_table_insert (bom_md_index, key, newlist);
 
   newlist->next = NULL;
   newlist->descr = strdup (descr);
   newlist->value = strdup (value);
   newlist->num = 1;
-  newlist->refdes = bom_md_string_insert (refdes, NULL);
+  newlist->refdes = bom_md_string_insert (refdes, NULL, &newlist->refdes_tail);
 
   if ((newlist->attrs = (char **) malloc (attr_count * sizeof (char *))) == NULL)
   {
@@ -328,6 +342,14 @@ bom_md_print_and_free (FILE *fp, bom_md_list *bom_md)
     bom_md = bom_md->next;
     free (lastb);
   }
+
+  if (bom_md_index != NULL)
+  {
+    g_hash_table_destroy (bom_md_index);
+    bom_md_index = NULL;
+  }
+
+  bom_md_tail = NULL;
 }
 
 /*!
@@ -398,12 +420,13 @@ bom_md_print (void)
   time_t currenttime;
   FILE *fp;
   bom_md_list *bom_md = NULL;
-  char *name, *descr, *value;
 //  int rpindex;
   int i;
 //  char fmt[256];
 
   bom_md_fetch_attr_list ();
+  bom_md_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  bom_md_tail = NULL;
 
   /* Create a portable timestamp. */
   currenttime = time (NULL);
@@ -448,9 +471,6 @@ bom_md_print (void)
       (char *)UNKNOWN (VALUE_NAME (element)),
       element,
       bom_md);
-    name = bom_md_clean_string ((char *)UNKNOWN (NAMEONPCB_NAME (element)));
-    descr = bom_md_clean_string ((char *)UNKNOWN (DESCRIPTION_NAME (element)));
-    value = bom_md_clean_string ((char *)UNKNOWN (VALUE_NAME (element)));
   }
   END_LOOP;
 
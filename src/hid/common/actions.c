@@ -22,6 +22,13 @@ static HID_Action **all_actions = 0;
 static int all_actions_sorted = 0;
 static int n_actions = 0;
 
+/* Lookup tables built from all_actions on first use, one keyed by the
+ * exact name and one by the lower-cased name.  Dropped whenever an
+ * action is registered.
+ */
+static GHashTable *action_names = NULL;
+static GHashTable *action_names_folded = NULL;
+
 HID_Action *current_action = NULL;
 
 static const char *
@@ -52,6 +59,13 @@ hid_register_actions (HID_Action * a, int n)
     }
   n_actions += count;
   all_actions_sorted = 0;
+
+  if (action_names)
+    {
+      g_hash_table_destroy (action_names);
+      g_hash_table_destroy (action_names_folded);
+      action_names = action_names_folded = NULL;
+    }
 }
 
 void
@@ -75,34 +89,56 @@ sort_actions ()
   all_actions_sorted = 1;
 }
 
-static int
-action_search_compar (const void *va, const void *vb)
+static void
+hash_actions ()
 {
-  char *name = (char*)va;
-  HID_Action *action = *(HID_Action**)vb;
-  return strcmp (name, action->name);
+  int i;
+
+  if (!all_actions_sorted)
+    sort_actions ();
+
+  action_names = g_hash_table_new (g_str_hash, g_str_equal);
+  action_names_folded = g_hash_table_new_full (g_str_hash, g_str_equal,
+					       g_free, NULL);
+
+  /* walk in sorted order and keep the first hit, which is what the
+   * binary and linear searches used to return
+   */
+  for (i = 0; i < n_actions; i++)
+    {
+      char *folded = g_ascii_strdown (all_actions[i]->name, -1);
+
+      if (!g_hash_table_lookup (action_names, all_actions[i]->name))
+	g_hash_table_insert (action_names, (char *) all_actions[i]->name,
+			     all_actions[i]);
+      if (!g_hash_table_lookup (action_names_folded, folded))
+	g_hash_table_insert (action_names_folded, folded, all_actions[i]);
+      else
+	g_free (folded);
+    }
 }
 
 HID_Action *
 hid_find_action (const char *name)
 {
-  HID_Action **action;
-  int i;
-  
+  HID_Action *action;
+  char *folded;
+
   if (name == NULL)
     return 0;
 
-  if (!all_actions_sorted)
-    sort_actions ();
+  if (!action_names)
+    hash_actions ();
 
-  action = (HID_Action **)bsearch (name, all_actions, n_actions, sizeof (HID_Action*),
-                    action_search_compar);
+  action = (HID_Action *) g_hash_table_lookup (action_names, name);
   if (action)
-    return *action;
+    return action;
 
-  for (i = 0; i < n_actions; i++)
-    if (strcasecmp (all_actions[i]->name, name) == 0)
-      return all_actions[i];
+  folded = g_ascii_strdown (name, -1);
+  action = (HID_Action *) g_hash_table_lookup (action_names_folded, folded);
+  g_free (folded);
+  if (action)
+    return action;
 
   printf ("unknown action `%s'\n", name);
   return 0;
@@ -206,26 +242,15 @@ hid_actionl (const char *name, ...)
   return hid_actionv (name, argc, argv);
 }
 
-int
-hid_actionv (const char *name, int argc, char **argv)
+/*!
+ * \brief Run an action that has already been looked up.
+ */
+static int
+hid_invoke_action (HID_Action *a, const char *name, int argc, char **argv)
 {
   Coord x = 0, y = 0;
   int i, ret;
-  HID_Action *a, *old_action;
-
-  if (!name)
-    return 1;
-
-  a = hid_find_action (name);
-  if (!a)
-    {
-      int i;
-      Message (_("no action %s("), name);
-      for (i = 0; i < argc; i++)
-        Message ("%s%s", i ? ", " : "", argv[i]);
-      Message (")\n");
-      return 1;
-    }
+  HID_Action *old_action;
 
   if (a->need_coord_msg)
     gui->get_coords (_(a->need_coord_msg), &x, &y);
@@ -246,8 +271,45 @@ hid_actionv (const char *name, int argc, char **argv)
   return ret;
 }
 
+int
+hid_actionv (const char *name, int argc, char **argv)
+{
+  HID_Action *a;
+
+  if (!name)
+    return 1;
+
+  a = hid_find_action (name);
+  if (!a)
+    {
+      int i;
+      Message (_("no action %s("), name);
+      for (i = 0; i < argc; i++)
+        Message ("%s%s", i ? ", " : "", argv[i]);
+      Message (")\n");
+      return 1;
+    }
+
+  return hid_invoke_action (a, name, argc, argv);
+}
+
+typedef int (*ActionEmitFunc) (const char *, int, char **, void *);
+
+static int
+run_parsed_action (const char *name, int argc, char **argv, void *closure)
+{
+  return hid_actionv (name, argc, argv);
+}
+
+/*!
+ * \brief Split an action string into action calls.
+ *
+ * Every call found is handed to \c emit; parsing stops as soon as
+ * \c emit returns nonzero.
+ */
 static int
-hid_parse_actionstring (const char *rstr, char require_parens)
+hid_parse_actionstring (const char *rstr, char require_parens,
+			ActionEmitFunc emit, void *closure)
 {
   char **list = NULL;
   int max = 0;
@@ -297,7 +359,7 @@ another:
    */
   if (!*sp)
     {
-      retcode = hid_actionv (aname, 0, 0);
+      retcode = emit (aname, 0, 0, closure);
       goto cleanup;
     }
 
@@ -324,7 +386,7 @@ another:
        */
       if (!maybe_empty && ((parens && *sp == ')') || (!parens && !*sp)))
 	{
-          retcode = hid_actionv (aname, num, list);
+          retcode = emit (aname, num, list, closure);
           if (retcode)
             goto cleanup;
 
@@ -407,12 +469,108 @@ another:
 
 int hid_parse_command (const char *str_)
 {
-  return hid_parse_actionstring (str_, FALSE);
+  return hid_parse_actionstring (str_, FALSE, run_parsed_action, NULL);
 }
 
 int hid_parse_actions (const char *str_)
 {
-  return hid_parse_actionstring (str_, TRUE);
+  return hid_parse_actionstring (str_, TRUE, run_parsed_action, NULL);
+}
+
+/*!
+ * \brief One call of a compiled action script.
+ */
+typedef struct
+{
+  HID_Action *action;
+  int argc;
+  char **argv; /*!< NULL terminated copy of the arguments. */
+} CompiledActionType;
+
+struct hid_action_script
+{
+  int n, max;
+  CompiledActionType *calls;
+};
+
+static int
+compile_parsed_action (const char *name, int argc, char **argv, void *closure)
+{
+  HID_ActionScript *script = (HID_ActionScript *) closure;
+  CompiledActionType *call;
+  HID_Action *a;
+  int i;
+
+  a = hid_find_action (name);
+  if (!a)
+    {
+      Message (_("no action %s\n"), name);
+      return 1;
+    }
+
+  if (script->n >= script->max)
+    {
+      script->max = script->max ? 2 * script->max : 8;
+      script->calls = (CompiledActionType *)
+	realloc (script->calls, script->max * sizeof (CompiledActionType));
+    }
+  call = &script->calls[script->n++];
+  call->action = a;
+  call->argc = argc;
+  call->argv = g_new (char *, argc + 1);
+  for (i = 0; i < argc; i++)
+    call->argv[i] = g_strdup (argv[i]);
+  call->argv[argc] = NULL;
+  return 0;
+}
+
+HID_ActionScript *
+hid_compile_actions (const char *str_)
+{
+  HID_ActionScript *script = g_new0 (HID_ActionScript, 1);
+
+  if (hid_parse_actionstring (str_, TRUE, compile_parsed_action, script))
+    {
+      hid_free_compiled_actions (script);
+      return NULL;
+    }
+  return script;
+}
+
+int
+hid_run_compiled_actions (HID_ActionScript *script)
+{
+  int i, ret;
+
+  for (i = 0; i < script->n; i++)
+    {
+      CompiledActionType *call = &script->calls[i];
+
+      ret = hid_invoke_action (call->action, call->action->name,
+			       call->argc, call->argv);
+      if (ret)
+	return ret;
+    }
+  return 0;
+}
+
+int
+hid_compiled_actions_length (HID_ActionScript *script)
+{
+  return script->n;
+}
+
+void
+hid_free_compiled_actions (HID_ActionScript *script)
+{
+  int i;
+
+  if (script == NULL)
+    return;
+  for (i = 0; i < script->n; i++)
+    g_strfreev (script->calls[i].argv);
+  free (script->calls);
+  g_free (script);
 }
 
 /* trick for the doc extractor */
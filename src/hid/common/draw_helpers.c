@@ -2,7 +2,7 @@
 #include "hid.h"
 #include "hid_draw.h"
 #include "data.h" /* For global "PCB" variable */
-#include "rotate.h" /* For RotateLineLowLevel() */
+#include "misc.h" /* For GetTextStrokes() */
 #include "polygon.h"
 #include "draw_helpers.h"
 
@@ -36,87 +36,80 @@ common_draw_pcb_arc (hidGC gc, ArcType *arc)
   gui->graphics->draw_arc (gc, arc->X, arc->Y, arc->Width, arc->Height, arc->StartAngle, arc->Delta);
 }
 
+#define TEXT_LINE_BATCH 64
+
+static void
+draw_text_lines (hidGC gc, Coord width, int n_lines, const HID_Line *lines)
+{
+  gui->graphics->set_line_cap (gc, Trace_Cap);
+  if (TEST_FLAG (THINDRAWFLAG, PCB))
+    gui->graphics->set_line_width (gc, 0);
+  else
+    gui->graphics->set_line_width (gc, width);
+  gui->graphics->draw_lines (gc, n_lines, lines);
+}
+
 /* ---------------------------------------------------------------------------
  * drawing routine for text objects
+ *
+ * The strokes come pre-expanded from GetTextStrokes().  When the HID
+ * draws PCB lines the default way, runs of strokes of one width go out
+ * through a single draw_lines() call.
  */
 static void
 common_draw_pcb_text (hidGC gc, TextType *Text, Coord min_line_width)
 {
-  Coord x = 0;
-  unsigned char *string = (unsigned char *) Text->TextString;
-  Cardinal n;
-  FontType *font = &PCB->Font;
-
-  while (string && *string)
+  const TextStrokeType *stroke;
+  Cardinal i, n;
+  HID_Line lines[TEXT_LINE_BATCH];
+  int n_lines = 0;
+  Coord width = 0;
+  bool batch = gui->graphics->draw_pcb_line == common_draw_pcb_line;
+
+  stroke = GetTextStrokes (&PCB->Font, Text, &n);
+  for (i = 0; i < n; i++, stroke++)
     {
-      /* draw lines if symbol is valid and data is present */
-      if (*string <= MAX_FONTPOSITION && font->Symbol[*string].Valid)
-        {
-          LineType *line = font->Symbol[*string].Line;
-          LineType newline;
+      Coord thickness = MAX (stroke->Thickness, min_line_width);
 
-          for (n = font->Symbol[*string].LineN; n; n--, line++)
-            {
-              /* create one line, scale, move, rotate and swap it */
-              newline = *line;
-              newline.Point1.X = SCALE_TEXT (newline.Point1.X + x, Text->Scale);
-              newline.Point1.Y = SCALE_TEXT (newline.Point1.Y, Text->Scale);
-              newline.Point2.X = SCALE_TEXT (newline.Point2.X + x, Text->Scale);
-              newline.Point2.Y = SCALE_TEXT (newline.Point2.Y, Text->Scale);
-              newline.Thickness = SCALE_TEXT (newline.Thickness, Text->Scale / 2);
-              if (newline.Thickness < min_line_width)
-                newline.Thickness = min_line_width;
-
-              RotateLineLowLevel (&newline, 0, 0, Text->Direction);
-
-              /* the labels of SMD objects on the bottom
-               * side haven't been swapped yet, only their offset
-               */
-              if (TEST_FLAG (ONSOLDERFLAG, Text))
-                {
-                  newline.Point1.X = SWAP_SIGN_X (newline.Point1.X);
-                  newline.Point1.Y = SWAP_SIGN_Y (newline.Point1.Y);
-                  newline.Point2.X = SWAP_SIGN_X (newline.Point2.X);
-                  newline.Point2.Y = SWAP_SIGN_Y (newline.Point2.Y);
-                }
-              /* add offset and draw line */
-              newline.Point1.X += Text->X;
-              newline.Point1.Y += Text->Y;
-              newline.Point2.X += Text->X;
-              newline.Point2.Y += Text->Y;
-              gui->graphics->draw_pcb_line (gc, &newline);
-            }
-
-          /* move on to next cursor position */
-          x += (font->Symbol[*string].Width + font->Symbol[*string].Delta);
+      if (n_lines > 0 &&
+          (stroke->Box || thickness != width || n_lines == TEXT_LINE_BATCH))
+        {
+          draw_text_lines (gc, width, n_lines, lines);
+          n_lines = 0;
         }
-      else
+
+      if (stroke->Box)
         {
           /* the default symbol is a filled box */
-          BoxType defaultsymbol = PCB->Font.DefaultSymbol;
-          Coord size = (defaultsymbol.X2 - defaultsymbol.X1) * 6 / 5;
-
-          defaultsymbol.X1 = SCALE_TEXT (defaultsymbol.X1 + x, Text->Scale);
-          defaultsymbol.Y1 = SCALE_TEXT (defaultsymbol.Y1, Text->Scale);
-          defaultsymbol.X2 = SCALE_TEXT (defaultsymbol.X2 + x, Text->Scale);
-          defaultsymbol.Y2 = SCALE_TEXT (defaultsymbol.Y2, Text->Scale);
-
-          RotateBoxLowLevel (&defaultsymbol, 0, 0, Text->Direction);
-
-          /* add offset and draw box */
-          defaultsymbol.X1 += Text->X;
-          defaultsymbol.Y1 += Text->Y;
-          defaultsymbol.X2 += Text->X;
-          defaultsymbol.Y2 += Text->Y;
           gui->graphics->fill_rect (gc,
-                                    defaultsymbol.X1, defaultsymbol.Y1,
-                                    defaultsymbol.X2, defaultsymbol.Y2);
+                                    stroke->X1 + Text->X, stroke->Y1 + Text->Y,
+                                    stroke->X2 + Text->X, stroke->Y2 + Text->Y);
+        }
+      else if (batch)
+        {
+          width = thickness;
+          lines[n_lines].x1 = stroke->X1 + Text->X;
+          lines[n_lines].y1 = stroke->Y1 + Text->Y;
+          lines[n_lines].x2 = stroke->X2 + Text->X;
+          lines[n_lines].y2 = stroke->Y2 + Text->Y;
+          n_lines++;
+        }
+      else
+        {
+          LineType newline;
 
-          /* move on to next cursor position */
-          x += size;
+          memset (&newline, 0, sizeof (newline));
+          newline.Point1.X = stroke->X1 + Text->X;
+          newline.Point1.Y = stroke->Y1 + Text->Y;
+          newline.Point2.X = stroke->X2 + Text->X;
+          newline.Point2.Y = stroke->Y2 + Text->Y;
+          newline.Thickness = thickness;
+          gui->graphics->draw_pcb_line (gc, &newline);
         }
-      string++;
     }
+
+  if (n_lines > 0)
+    draw_text_lines (gc, width, n_lines, lines);
 }
 
 static void
@@ -687,6 +680,37 @@ common_thindraw_pcb_pv (hidGC fg_gc, hidGC bg_gc, PinType *pv, bool drawHole, bo
     }
 }
 
+void
+common_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  int i;
+
+  for (i = 0; i < n_lines; i++)
+    gui->graphics->draw_line (gc, lines[i].x1, lines[i].y1,
+                                  lines[i].x2, lines[i].y2);
+}
+
+void
+common_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  int i;
+
+  for (i = 0; i < n_arcs; i++)
+    gui->graphics->draw_arc (gc, arcs[i].cx, arcs[i].cy,
+                             arcs[i].width, arcs[i].height,
+                             arcs[i].start_angle, arcs[i].delta_angle);
+}
+
+void
+common_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  int i;
+
+  for (i = 0; i < n_circles; i++)
+    gui->graphics->fill_circle (gc, circles[i].cx, circles[i].cy,
+                                circles[i].radius);
+}
+
 void
 common_draw_helpers_init (HID_DRAW *graphics)
 {
@@ -701,4 +725,8 @@ common_draw_helpers_init (HID_DRAW *graphics)
   graphics->thindraw_pcb_pad     = common_thindraw_pcb_pad;
   graphics->fill_pcb_pv          = common_fill_pcb_pv;
   graphics->thindraw_pcb_pv      = common_thindraw_pcb_pv;
+
+  graphics->draw_lines           = common_draw_lines;
+  graphics->draw_arcs            = common_draw_arcs;
+  graphics->fill_circles         = common_fill_circles;
 }
@@ -7,4 +7,7 @@ void common_fill_pcb_pad (hidGC gc, PadType *pad, bool clear, bool mask);
 void common_thindraw_pcb_pad (hidGC gc, PadType *pad, bool clear, bool mask);
 void common_fill_pcb_pv (hidGC fg_gc, hidGC bg_gc, PinType *pv, bool drawHole, bool mask);
 void common_thindraw_pcb_pv (hidGC fg_gc, hidGC bg_gc, PinType *pv, bool drawHole, bool mask);
+void common_draw_lines (hidGC gc, int n_lines, const HID_Line *lines);
+void common_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs);
+void common_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles);
 void common_draw_helpers_init (HID_DRAW *graphics);
@@ -71,7 +71,9 @@
 #include "clip.h"
 
 #include "hid.h"
+#include "hid_draw.h"
 #include "hidgl.h"
+#include "hidgl_tess.h"
 #include "rtree.h"
 
 #ifdef HAVE_LIBDMALLOC
@@ -438,168 +440,96 @@ hidgl_fill_circle (Coord vx, Coord vy, Coord vr, double scale)
   }
 }
 
-#define MAX_COMBINED_MALLOCS 2500
-static void *combined_to_free [MAX_COMBINED_MALLOCS];
-static int combined_num_to_free = 0;
-
-static GLenum tessVertexType;
-static int stashed_vertices;
-static int triangle_comp_idx;
-
-#ifndef CALLBACK
-#define CALLBACK
-#endif
-
-static void CALLBACK
-myError (GLenum errno)
+/*!
+ * \brief Draw a batch of lines of the same cap style and width.
+ */
+void
+hidgl_draw_lines (int cap, Coord width, int n_lines, const HID_Line *lines, double scale)
 {
-  printf ("gluTess error: %s\n", gluErrorString (errno));
+  int i;
+
+  for (i = 0; i < n_lines; i++)
+    hidgl_draw_line (cap, width, lines[i].x1, lines[i].y1,
+                                 lines[i].x2, lines[i].y2, scale);
 }
 
-static void CALLBACK
-myCombine ( GLdouble coords[3], void *vertex_data[4], GLfloat weight[4], void **dataOut )
+/*!
+ * \brief Draw a batch of arcs of the same width.
+ */
+void
+hidgl_draw_arcs (Coord width, int n_arcs, const HID_Arc *arcs, double scale)
 {
-#define MAX_COMBINED_VERTICES 2500
-  static GLdouble combined_vertices [3 * MAX_COMBINED_VERTICES];
-  static int num_combined_vertices = 0;
-
-  GLdouble *new_vertex;
-
-  if (num_combined_vertices < MAX_COMBINED_VERTICES)
-    {
-      new_vertex = &combined_vertices [3 * num_combined_vertices];
-      num_combined_vertices ++;
-    }
-  else
-    {
-      new_vertex = malloc (3 * sizeof (GLdouble));
-
-      if (combined_num_to_free < MAX_COMBINED_MALLOCS)
-        combined_to_free [combined_num_to_free ++] = new_vertex;
-      else
-        printf ("myCombine leaking %lu bytes of memory\n",
-                    (unsigned long)3 * sizeof (GLdouble));
-    }
-
-  new_vertex[0] = coords[0];
-  new_vertex[1] = coords[1];
-  new_vertex[2] = coords[2];
+  int i;
 
-  *dataOut = new_vertex;
+  for (i = 0; i < n_arcs; i++)
+    hidgl_draw_arc (width, arcs[i].cx, arcs[i].cy,
+                    arcs[i].width, arcs[i].height,
+                    arcs[i].start_angle, arcs[i].delta_angle, scale);
 }
 
-static void CALLBACK
-myBegin (GLenum type)
+/*!
+ * \brief Fill a batch of circles.
+ */
+void
+hidgl_fill_circles (int n_circles, const HID_Circle *circles, double scale)
 {
-  tessVertexType = type;
-  stashed_vertices = 0;
-  triangle_comp_idx = 0;
+  int i;
+
+  for (i = 0; i < n_circles; i++)
+    hidgl_fill_circle (circles[i].cx, circles[i].cy, circles[i].radius, scale);
 }
 
 static double global_scale;
 
-static void CALLBACK
-myVertex (GLdouble *vertex_data)
+/*!
+ * \brief Add count triangles, six GLfloats each, to the triangle buffer.
+ */
+static void
+add_triangles (GLfloat *t, int count)
 {
-  static GLfloat triangle_vertices [2 * 3];
+  int left, n, i;
 
-  if (tessVertexType == GL_TRIANGLE_STRIP ||
-      tessVertexType == GL_TRIANGLE_FAN)
-    {
-      if (stashed_vertices < 2)
-        {
-          triangle_vertices [triangle_comp_idx ++] = vertex_data [0];
-          triangle_vertices [triangle_comp_idx ++] = vertex_data [1];
-          stashed_vertices ++;
-        }
-      else
-        {
-          hidgl_ensure_triangle_space (&buffer, 1);
-          hidgl_add_triangle (&buffer,
-                              triangle_vertices [0], triangle_vertices [1],
-                              triangle_vertices [2], triangle_vertices [3],
-                              vertex_data [0], vertex_data [1]);
-
-          if (tessVertexType == GL_TRIANGLE_STRIP)
-            {
-              /* STRIP saves the last two vertices for re-use in the next triangle */
-              triangle_vertices [0] = triangle_vertices [2];
-              triangle_vertices [1] = triangle_vertices [3];
-            }
-          /* Both FAN and STRIP save the last vertex for re-use in the next triangle */
-          triangle_vertices [2] = vertex_data [0];
-          triangle_vertices [3] = vertex_data [1];
-        }
-    }
-  else if (tessVertexType == GL_TRIANGLES)
+  for (left = count; left > 0; left -= n)
     {
-      triangle_vertices [triangle_comp_idx ++] = vertex_data [0];
-      triangle_vertices [triangle_comp_idx ++] = vertex_data [1];
-      stashed_vertices ++;
-      if (stashed_vertices == 3)
-        {
-          hidgl_ensure_triangle_space (&buffer, 1);
-          hidgl_add_triangle (&buffer,
-                              triangle_vertices [0], triangle_vertices [1],
-                              triangle_vertices [2], triangle_vertices [3],
-                              triangle_vertices [4], triangle_vertices [5]);
-          triangle_comp_idx = 0;
-          stashed_vertices = 0;
-        }
+      n = MIN (left, TRIANGLE_ARRAY_SIZE);
+      hidgl_ensure_triangle_space (&buffer, n);
+      for (i = 0; i < n; i++, t += 6)
+        hidgl_add_triangle (&buffer, t[0], t[1], t[2], t[3], t[4], t[5]);
     }
-  else
-    printf ("Vertex received with unknown type\n");
-}
-
-static void
-myFreeCombined ()
-{
-  while (combined_num_to_free)
-    free (combined_to_free [-- combined_num_to_free]);
 }
 
 void
 hidgl_fill_polygon (int n_coords, Coord *x, Coord *y)
 {
+  static GArray *triangles = NULL;
   int i;
-  GLUtesselator *tobj;
   GLdouble *vertices;
 
   assert (n_coords > 0);
 
-  vertices = malloc (sizeof(GLdouble) * n_coords * 3);
-
-  tobj = gluNewTess ();
-  gluTessCallback(tobj, GLU_TESS_BEGIN,   (_GLUfuncptr)myBegin);
-  gluTessCallback(tobj, GLU_TESS_VERTEX,  (_GLUfuncptr)myVertex);
-  gluTessCallback(tobj, GLU_TESS_COMBINE, (_GLUfuncptr)myCombine);
-  gluTessCallback(tobj, GLU_TESS_ERROR,   (_GLUfuncptr)myError);
+  if (triangles == NULL)
+    triangles = g_array_new (FALSE, FALSE, sizeof (GLfloat));
 
-  gluTessBeginPolygon (tobj, NULL);
-  gluTessBeginContour (tobj);
+  vertices = malloc (sizeof(GLdouble) * n_coords * 3);
 
   for (i = 0; i < n_coords; i++)
     {
       vertices [0 + i * 3] = x[i];
       vertices [1 + i * 3] = y[i];
       vertices [2 + i * 3] = 0.;
-      gluTessVertex (tobj, &vertices [i * 3], &vertices [i * 3]);
     }
 
-  gluTessEndContour (tobj);
-  gluTessEndPolygon (tobj);
-  gluDeleteTess (tobj);
+  hidgl_tesselate (triangles, n_coords, vertices);
+  add_triangles ((GLfloat *)triangles->data, triangles->len / 6);
+  g_array_set_size (triangles, 0);
 
-  myFreeCombined ();
   free (vertices);
 }
 
-void
-tesselate_contour (GLUtesselator *tobj, PLINE *contour, GLdouble *vertices,
-                   double scale)
+static void
+fill_contour (PolygonTriangles *pt, int index, PLINE *contour, double scale)
 {
-  VNODE *vn = &contour->head;
-  int offset = 0;
+  ContourTriangles *ct;
 
   /* If the contour is round, and hidgl_fill_circle would use
    * less slices than we have vertices to draw it, then call
@@ -613,53 +543,27 @@ tesselate_contour (GLUtesselator *tobj, PLINE *contour, GLdouble *vertices,
     }
   }
 
-  gluTessBeginPolygon (tobj, NULL);
-  gluTessBeginContour (tobj);
-  do {
-    vertices [0 + offset] = vn->point[0];
-    vertices [1 + offset] = vn->point[1];
-    vertices [2 + offset] = 0.;
-    gluTessVertex (tobj, &vertices [offset], &vertices [offset]);
-    offset += 3;
-  } while ((vn = vn->next) != &contour->head);
-  gluTessEndContour (tobj);
-  gluTessEndPolygon (tobj);
-}
-
-struct do_hole_info {
-  GLUtesselator *tobj;
-  GLdouble *vertices;
-  double scale;
-};
-
-static int
-do_hole (const BoxType *b, void *cl)
-{
-  struct do_hole_info *info = cl;
-  PLINE *curc = (PLINE *) b;
-
-  /* Ignore the outer contour - we draw it first explicitly*/
-  if (curc->Flags.orient == PLF_DIR) {
-    return 0;
-  }
-
-  tesselate_contour (info->tobj, curc, info->vertices, info->scale);
-  return 1;
+  ct = hidgl_contour_triangles (pt, index, contour);
+  add_triangles (&g_array_index (pt->triangles, GLfloat, 6 * ct->first),
+                 ct->count);
 }
 
 static GLint stencil_bits;
 static int dirty_bits = 0;
 static int assigned_bits = 0;
 
+/*!
+ * \brief Fill one piece of a polygon, whose contours start at index
+ * within the polygon's triangle cache.
+ */
 static void
-fill_polyarea (POLYAREA *pa, const BoxType *clip_box, double scale)
+fill_polyarea (POLYAREA *pa, PolygonTriangles *pt, int index,
+               const BoxType *clip_box, double scale)
 {
-  int vertex_count = 0;
   PLINE *contour;
-  struct do_hole_info info;
   int stencil_bit;
+  int i;
 
-  info.scale = scale;
   global_scale = scale;
 
   stencil_bit = hidgl_assign_clear_stencil_bit ();
@@ -672,18 +576,6 @@ fill_polyarea (POLYAREA *pa, const BoxType *clip_box, double scale)
   /* Flush out any existing geoemtry to be rendered */
   hidgl_flush_triangles (&buffer);
 
-  /* Walk the polygon structure, counting vertices */
-  /* This gives an upper bound on the amount of storage required */
-  for (contour = pa->contours; contour != NULL; contour = contour->next)
-    vertex_count = MAX (vertex_count, contour->Count);
-
-  info.vertices = malloc (sizeof(GLdouble) * vertex_count * 3);
-  info.tobj = gluNewTess ();
-  gluTessCallback(info.tobj, GLU_TESS_BEGIN,   (_GLUfuncptr)myBegin);
-  gluTessCallback(info.tobj, GLU_TESS_VERTEX,  (_GLUfuncptr)myVertex);
-  gluTessCallback(info.tobj, GLU_TESS_COMBINE, (_GLUfuncptr)myCombine);
-  gluTessCallback(info.tobj, GLU_TESS_ERROR,   (_GLUfuncptr)myError);
-
   glPushAttrib (GL_STENCIL_BUFFER_BIT);                 /* Save the write mask etc.. for final restore */
   glEnable (GL_STENCIL_TEST);
   glPushAttrib (GL_STENCIL_BUFFER_BIT |                 /* Resave the stencil write-mask etc.., and */
@@ -696,7 +588,17 @@ fill_polyarea (POLYAREA *pa, const BoxType *clip_box, double scale)
 
   /* Drawing operations now set our reference bit in the stencil buffer */
 
-  r_search (pa->contour_tree, clip_box, NULL, do_hole, &info);
+  /* The holes follow the outer contour; skip any which are off-screen */
+  for (contour = pa->contours->next, i = index + 1;
+       contour != NULL;
+       contour = contour->next, i++)
+    {
+      if (clip_box != NULL &&
+          (contour->xmax < clip_box->X1 || contour->xmin > clip_box->X2 ||
+           contour->ymax < clip_box->Y1 || contour->ymin > clip_box->Y2))
+        continue;
+      fill_contour (pt, i, contour, scale);
+    }
   hidgl_flush_triangles (&buffer);
 
   glPopAttrib ();                               /* Restore the colour and stencil buffer write-mask etc.. */
@@ -712,7 +614,7 @@ fill_polyarea (POLYAREA *pa, const BoxType *clip_box, double scale)
   /* Drawing operations as masked to areas where the stencil buffer is '0' */
 
   /* Draw the polygon outer */
-  tesselate_contour (info.tobj, pa->contours, info.vertices, scale);
+  fill_contour (pt, index, pa->contours, scale);
 
   hidgl_flush_triangles (&buffer);
 
@@ -720,27 +622,37 @@ fill_polyarea (POLYAREA *pa, const BoxType *clip_box, double scale)
   hidgl_return_stencil_bit (stencil_bit);
 
   glPopAttrib ();                               /* Restore the stencil buffer write-mask etc.. */
-
-  gluDeleteTess (info.tobj);
-  myFreeCombined ();
-  free (info.vertices);
 }
 
 void
 hidgl_fill_pcb_polygon (PolygonType *poly, const BoxType *clip_box, double scale)
 {
+  PolygonTriangles *pt;
+
   if (poly->Clipped == NULL)
     return;
 
-  fill_polyarea (poly->Clipped, clip_box, scale);
+  /* A polygon with no generation gets a one-off triangulation */
+  pt = hidgl_lookup_polygon_triangles (poly);
+  if (pt == NULL)
+    pt = hidgl_new_polygon_triangles (poly);
+
+  fill_polyarea (poly->Clipped, pt, 0, clip_box, scale);
 
   if (TEST_FLAG (FULLPOLYFLAG, poly))
     {
       POLYAREA *pa;
+      int index = hidgl_count_contours (poly->Clipped);
 
       for (pa = poly->Clipped->f; pa != poly->Clipped; pa = pa->f)
-        fill_polyarea (pa, clip_box, scale);
+        {
+          fill_polyarea (pa, pt, index, clip_box, scale);
+          index += hidgl_count_contours (pa);
+        }
     }
+
+  if (poly->ClipGeneration == 0)
+    hidgl_free_polygon_triangles (pt);
 }
 
 void
@@ -775,6 +687,7 @@ hidgl_start_render (void)
 {
   hidgl_init ();
   hidgl_init_triangle_array (&buffer);
+  hidgl_tess_begin_frame ();
 }
 
 void
@@ -847,3 +760,87 @@ hidgl_reset_stencil_usage (void)
   assigned_bits = 0;
   dirty_bits = 0;
 }
+
+/* --------------------------------------------------------------------------- */
+
+static const char benchmarktesselation_syntax[] =
+  N_("BenchmarkTesselation([count])");
+
+static const char benchmarktesselation_help[] =
+  N_("Compare polygon tesselation time against triangle cache hits.");
+
+/* %start-doc actions BenchmarkTesselation
+
+Tesselates every polygon on the board @code{count} times (ten by
+default), first from scratch and then through the polygon triangle
+cache used by the OpenGL renderer, and reports the time taken per pass
+for each.  Nothing is drawn, so no graphics hardware is involved.
+
+%end-doc */
+
+static int
+ActionBenchmarkTesselation (int argc, char **argv, Coord x, Coord y)
+{
+  GTimer *timer;
+  long i, count = 10;
+  int polygons = 0, triangles = 0;
+  double uncached, cached;
+
+  if (argc > 1)
+    AFAIL (benchmarktesselation);
+  if (argc == 1)
+    count = strtol (argv[0], NULL, 0);
+  if (count <= 0)
+    AFAIL (benchmarktesselation);
+
+  timer = g_timer_new ();
+  for (i = 0; i < count; i++)
+    {
+      polygons = triangles = 0;
+      ALLPOLYGON_LOOP (PCB->Data);
+      {
+        if (polygon->Clipped != NULL)
+          {
+            PolygonTriangles *pt = hidgl_new_polygon_triangles (polygon);
+
+            triangles += hidgl_tesselate_polygon (polygon, pt);
+            hidgl_free_polygon_triangles (pt);
+            polygons++;
+          }
+      }
+      ENDALL_LOOP;
+    }
+  uncached = g_timer_elapsed (timer, NULL);
+
+  /* Fill the cache first, so that the timed passes only hit it */
+  for (i = 0; i <= count; i++)
+    {
+      if (i == 1)
+        g_timer_start (timer);
+      ALLPOLYGON_LOOP (PCB->Data);
+      {
+        PolygonTriangles *pt;
+
+        if (polygon->Clipped != NULL &&
+            (pt = hidgl_lookup_polygon_triangles (polygon)) != NULL)
+          hidgl_tesselate_polygon (polygon, pt);
+      }
+      ENDALL_LOOP;
+    }
+  cached = g_timer_elapsed (timer, NULL);
+
+  g_timer_destroy (timer);
+
+  Message (_("tesselated %d polygons into %d triangles %ld times, "
+             "%.3f ms per pass, %.3f ms per pass from the cache\n"),
+           polygons, triangles, count,
+           uncached * 1000.0 / count, cached * 1000.0 / count);
+  return 0;
+}
+
+HID_Action hidgl_action_list[] = {
+  {"BenchmarkTesselation", 0, ActionBenchmarkTesselation,
+   benchmarktesselation_help, benchmarktesselation_syntax}
+};
+
+REGISTER_ACTIONS (hidgl_action_list)
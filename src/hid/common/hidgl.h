@@ -75,6 +75,9 @@ void hidgl_draw_line (int cap, Coord width, Coord x1, Coord y1, Coord x2, Coord
 void hidgl_draw_arc (Coord width, Coord vx, Coord vy, Coord vrx, Coord vry, Angle start_angle, Angle delta_angle, double scale);
 void hidgl_draw_rect (Coord x1, Coord y1, Coord x2, Coord y2);
 void hidgl_fill_circle (Coord vx, Coord vy, Coord vr, double scale);
+void hidgl_draw_lines (int cap, Coord width, int n_lines, const HID_Line *lines, double scale);
+void hidgl_draw_arcs (Coord width, int n_arcs, const HID_Arc *arcs, double scale);
+void hidgl_fill_circles (int n_circles, const HID_Circle *circles, double scale);
 void hidgl_fill_polygon (int n_coords, Coord *x, Coord *y);
 void hidgl_fill_pcb_polygon (PolygonType *poly, const BoxType *clip_box, double scale);
 void hidgl_fill_rect (Coord x1, Coord y1, Coord x2, Coord y2);
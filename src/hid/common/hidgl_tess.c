@@ -0,0 +1,637 @@
+/*
+ *                            COPYRIGHT
+ *
+ *  PCB, interactive printed circuit board design
+ *  Copyright (C) 2009-2011 PCB Contributors (See ChangeLog for details).
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Polygon tesselation for the OpenGL renderer, and the polygon triangle
+ * cache.  Nothing here draws, so it can be checked without a GL context.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#include <math.h>
+
+/* The Linux OpenGL ABI 1.0 spec requires that we define
+ * GL_GLEXT_PROTOTYPES before including gl.h or glx.h for extensions
+ * in order to get prototypes:
+ *   http://www.opengl.org/registry/ABI/
+ */
+#define GL_GLEXT_PROTOTYPES 1
+
+/* This follows autoconf's recommendation for the AX_CHECK_GL macro
+   https://www.gnu.org/software/autoconf-archive/ax_check_gl.html */
+#if defined HAVE_WINDOWS_H && defined _WIN32
+#  include <windows.h>
+#endif
+#if defined HAVE_GL_GL_H
+#  include <GL/gl.h>
+#elif defined HAVE_OPENGL_GL_H
+#  include <OpenGL/gl.h>
+#else
+#  error autoconf couldnt find gl.h
+#endif
+
+/* This follows autoconf's recommendation for the AX_CHECK_GLU macro
+   https://www.gnu.org/software/autoconf-archive/ax_check_glu.html */
+#if defined HAVE_GL_GLU_H
+#  include <GL/glu.h>
+#elif defined HAVE_OPENGL_GLU_H
+#  include <OpenGL/glu.h>
+#else
+#  error autoconf couldnt find glu.h
+#endif
+
+#include "global.h"
+
+#include "hid.h"
+#include "hid_draw.h"
+#include "hidgl.h"
+#include "hidgl_tess.h"
+
+#ifdef HAVE_LIBDMALLOC
+#include <dmalloc.h>
+#endif
+
+#define MAX_COMBINED_MALLOCS 2500
+static void *combined_to_free [MAX_COMBINED_MALLOCS];
+static int combined_num_to_free = 0;
+
+static GLenum tessVertexType;
+static int stashed_vertices;
+static int triangle_comp_idx;
+
+/* Tesselated triangles are appended here, six GLfloats per triangle */
+static GArray *tess_triangles = NULL;
+
+#ifndef CALLBACK
+#define CALLBACK
+#endif
+
+static void CALLBACK
+myError (GLenum errno)
+{
+  printf ("gluTess error: %s\n", gluErrorString (errno));
+}
+
+static void CALLBACK
+myCombine ( GLdouble coords[3], void *vertex_data[4], GLfloat weight[4], void **dataOut )
+{
+#define MAX_COMBINED_VERTICES 2500
+  static GLdouble combined_vertices [3 * MAX_COMBINED_VERTICES];
+  static int num_combined_vertices = 0;
+
+  GLdouble *new_vertex;
+
+  if (num_combined_vertices < MAX_COMBINED_VERTICES)
+    {
+      new_vertex = &combined_vertices [3 * num_combined_vertices];
+      num_combined_vertices ++;
+    }
+  else
+    {
+      new_vertex = malloc (3 * sizeof (GLdouble));
+
+      if (combined_num_to_free < MAX_COMBINED_MALLOCS)
+        combined_to_free [combined_num_to_free ++] = new_vertex;
+      else
+        printf ("myCombine leaking %lu bytes of memory\n",
+                    (unsigned long)3 * sizeof (GLdouble));
+    }
+
+  new_vertex[0] = coords[0];
+  new_vertex[1] = coords[1];
+  new_vertex[2] = coords[2];
+
+  *dataOut = new_vertex;
+}
+
+static void CALLBACK
+myBegin (GLenum type)
+{
+  tessVertexType = type;
+  stashed_vertices = 0;
+  triangle_comp_idx = 0;
+}
+
+static void
+emit_triangle (GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2,
+               GLfloat x3, GLfloat y3)
+{
+  GLfloat t[6] = {x1, y1, x2, y2, x3, y3};
+
+  g_array_append_vals (tess_triangles, t, 6);
+}
+
+static void CALLBACK
+myVertex (GLdouble *vertex_data)
+{
+  static GLfloat triangle_vertices [2 * 3];
+
+  if (tessVertexType == GL_TRIANGLE_STRIP ||
+      tessVertexType == GL_TRIANGLE_FAN)
+    {
+      if (stashed_vertices < 2)
+        {
+          triangle_vertices [triangle_comp_idx ++] = vertex_data [0];
+          triangle_vertices [triangle_comp_idx ++] = vertex_data [1];
+          stashed_vertices ++;
+        }
+      else
+        {
+          emit_triangle (triangle_vertices [0], triangle_vertices [1],
+                         triangle_vertices [2], triangle_vertices [3],
+                         vertex_data [0], vertex_data [1]);
+
+          if (tessVertexType == GL_TRIANGLE_STRIP)
+            {
+              /* STRIP saves the last two vertices for re-use in the next triangle */
+              triangle_vertices [0] = triangle_vertices [2];
+              triangle_vertices [1] = triangle_vertices [3];
+            }
+          /* Both FAN and STRIP save the last vertex for re-use in the next triangle */
+          triangle_vertices [2] = vertex_data [0];
+          triangle_vertices [3] = vertex_data [1];
+        }
+    }
+  else if (tessVertexType == GL_TRIANGLES)
+    {
+      triangle_vertices [triangle_comp_idx ++] = vertex_data [0];
+      triangle_vertices [triangle_comp_idx ++] = vertex_data [1];
+      stashed_vertices ++;
+      if (stashed_vertices == 3)
+        {
+          emit_triangle (triangle_vertices [0], triangle_vertices [1],
+                         triangle_vertices [2], triangle_vertices [3],
+                         triangle_vertices [4], triangle_vertices [5]);
+          triangle_comp_idx = 0;
+          stashed_vertices = 0;
+        }
+    }
+  else
+    printf ("Vertex received with unknown type\n");
+}
+
+static void
+myFreeCombined ()
+{
+  while (combined_num_to_free)
+    free (combined_to_free [-- combined_num_to_free]);
+}
+
+static GLUtesselator *tobj = NULL;
+
+/*!
+ * \brief Tesselate one contour, given as n_vertices (x, y, z) triples,
+ * appending six GLfloats per triangle to triangles.
+ */
+void
+hidgl_tesselate (GArray *triangles, int n_vertices, double *vertices)
+{
+  int i;
+
+  if (tobj == NULL)
+    {
+      tobj = gluNewTess ();
+      gluTessCallback(tobj, GLU_TESS_BEGIN,   (_GLUfuncptr)myBegin);
+      gluTessCallback(tobj, GLU_TESS_VERTEX,  (_GLUfuncptr)myVertex);
+      gluTessCallback(tobj, GLU_TESS_COMBINE, (_GLUfuncptr)myCombine);
+      gluTessCallback(tobj, GLU_TESS_ERROR,   (_GLUfuncptr)myError);
+    }
+
+  tess_triangles = triangles;
+
+  gluTessBeginPolygon (tobj, NULL);
+  gluTessBeginContour (tobj);
+  for (i = 0; i < n_vertices; i++)
+    gluTessVertex (tobj, &vertices [i * 3], &vertices [i * 3]);
+  gluTessEndContour (tobj);
+  gluTessEndPolygon (tobj);
+
+  tess_triangles = NULL;
+  myFreeCombined ();
+}
+
+/* Polygon triangle cache
+ *
+ * Tesselating a large polygon pour is expensive, yet its clipped shape
+ * rarely changes from one frame to the next.  The triangles for each
+ * contour of a polygon's Clipped area are therefore kept, keyed by the
+ * PolygonType and checked against its ClipGeneration, which polygon.c
+ * changes whenever Clipped is replaced.  Contours are tesselated the
+ * first time they are drawn, and only the CPU side is cached; the
+ * triangles are copied into the triangle buffer each frame.
+ *
+ * Once the cache is full, the entry drawn least recently is dropped to
+ * make room.  If even that one was drawn in the current frame, the board
+ * has more polygons than fit, and the limit is doubled instead, so that
+ * a large board does not keep tesselating everything over again.
+ */
+
+#define TRIANGLE_CACHE_MIN 4096
+
+static GHashTable *triangle_cache = NULL;
+static GQueue cache_lru = G_QUEUE_INIT;   /*!< Entries, most recently used first. */
+static unsigned int cache_limit = TRIANGLE_CACHE_MIN;
+static unsigned int cache_frame = 0;
+static GLdouble *cache_vertices = NULL;
+static int cache_vertices_max = 0;
+
+int
+hidgl_count_contours (POLYAREA *pa)
+{
+  PLINE *contour;
+  int n = 0;
+
+  for (contour = pa->contours; contour != NULL; contour = contour->next)
+    n++;
+  return n;
+}
+
+void
+hidgl_free_polygon_triangles (PolygonTriangles *pt)
+{
+  g_array_free (pt->triangles, TRUE);
+  g_free (pt->contours);
+  g_slice_free (PolygonTriangles, pt);
+}
+
+static void
+free_cache_entry (gpointer data)
+{
+  PolygonTriangles *pt = data;
+
+  g_queue_unlink (&cache_lru, &pt->lru);
+  hidgl_free_polygon_triangles (pt);
+}
+
+/*!
+ * \brief Make room for one more entry in the triangle cache.
+ */
+static void
+make_cache_room (void)
+{
+  PolygonTriangles *oldest;
+
+  if (g_hash_table_size (triangle_cache) < cache_limit)
+    return;
+
+  oldest = g_queue_peek_tail (&cache_lru);
+  if (oldest->frame == cache_frame)
+    cache_limit *= 2;
+  else
+    g_hash_table_remove (triangle_cache, oldest->poly);
+}
+
+/*!
+ * \brief Allocate room for the triangles of a polygon's Clipped area,
+ * none of whose contours are tesselated yet.
+ */
+PolygonTriangles *
+hidgl_new_polygon_triangles (PolygonType *poly)
+{
+  PolygonTriangles *pt = g_slice_new0 (PolygonTriangles);
+  POLYAREA *pa = poly->Clipped;
+  int i;
+
+  pt->clipped = poly->Clipped;
+  pt->generation = poly->ClipGeneration;
+  pt->n_contours = 0;
+  do
+    pt->n_contours += hidgl_count_contours (pa);
+  while ((pa = pa->f) != poly->Clipped);
+
+  pt->contours = g_new (ContourTriangles, pt->n_contours);
+  for (i = 0; i < pt->n_contours; i++)
+    pt->contours[i].first = -1;
+  pt->triangles = g_array_new (FALSE, FALSE, sizeof (GLfloat));
+  return pt;
+}
+
+/*!
+ * \brief Find the cached triangles for a polygon's current Clipped area.
+ *
+ * Returns NULL for a polygon which has never been clipped by polygon.c,
+ * as there is then no generation to check the cache against.  An entry
+ * is only reused while both the generation and the Clipped pointer
+ * match, so a Clipped area replaced without a new generation is not
+ * drawn from stale triangles.
+ */
+PolygonTriangles *
+hidgl_lookup_polygon_triangles (PolygonType *poly)
+{
+  PolygonTriangles *pt;
+
+  if (poly->ClipGeneration == 0)
+    return NULL;
+
+  if (triangle_cache == NULL)
+    triangle_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, free_cache_entry);
+
+  pt = g_hash_table_lookup (triangle_cache, poly);
+  if (pt != NULL && pt->generation == poly->ClipGeneration &&
+      pt->clipped == poly->Clipped)
+    {
+      g_queue_unlink (&cache_lru, &pt->lru);
+      g_queue_push_head_link (&cache_lru, &pt->lru);
+      pt->frame = cache_frame;
+      return pt;
+    }
+
+  if (pt != NULL)
+    g_hash_table_remove (triangle_cache, poly);
+  else
+    make_cache_room ();
+
+  pt = hidgl_new_polygon_triangles (poly);
+  pt->poly = poly;
+  pt->frame = cache_frame;
+  pt->lru.data = pt;
+  g_queue_push_head_link (&cache_lru, &pt->lru);
+  g_hash_table_insert (triangle_cache, poly, pt);
+  return pt;
+}
+
+/*!
+ * \brief Drop the cached triangles of a polygon which is being freed.
+ */
+void
+hidgl_forget_polygon (PolygonType *poly)
+{
+  if (triangle_cache != NULL)
+    g_hash_table_remove (triangle_cache, poly);
+}
+
+/*!
+ * \brief Start a new frame; entries drawn before it may be evicted.
+ */
+void
+hidgl_tess_begin_frame (void)
+{
+  cache_frame++;
+}
+
+/*!
+ * \brief Return the triangles of one contour, tesselating it if this
+ * has not been done yet.
+ */
+ContourTriangles *
+hidgl_contour_triangles (PolygonTriangles *pt, int index, PLINE *contour)
+{
+  ContourTriangles *ct = &pt->contours[index];
+  VNODE *vn = &contour->head;
+  int offset = 0;
+
+  if (ct->first >= 0)
+    return ct;
+
+  if (contour->Count > cache_vertices_max)
+    {
+      cache_vertices_max = contour->Count;
+      cache_vertices = g_renew (GLdouble, cache_vertices,
+                                3 * cache_vertices_max);
+    }
+
+  do {
+    cache_vertices [0 + offset] = vn->point[0];
+    cache_vertices [1 + offset] = vn->point[1];
+    cache_vertices [2 + offset] = 0.;
+    offset += 3;
+  } while ((vn = vn->next) != &contour->head);
+
+  ct->first = pt->triangles->len / 6;
+  hidgl_tesselate (pt->triangles, contour->Count, cache_vertices);
+  ct->count = pt->triangles->len / 6 - ct->first;
+  return ct;
+}
+
+/*!
+ * \brief Tesselate every contour of a polygon which is not yet in pt,
+ * returning the number of triangles pt then holds.
+ */
+int
+hidgl_tesselate_polygon (PolygonType *poly, PolygonTriangles *pt)
+{
+  POLYAREA *pa = poly->Clipped;
+  PLINE *contour;
+  int index = 0;
+
+  do
+    for (contour = pa->contours; contour != NULL; contour = contour->next)
+      hidgl_contour_triangles (pt, index++, contour);
+  while ((pa = pa->f) != poly->Clipped);
+
+  return pt->triangles->len / 6;
+}
+
+#ifdef PCB_UNIT_TEST
+
+static POLYAREA *
+square (Coord x1, Coord y1, Coord x2, Coord y2)
+{
+  PLINE *contour = NULL;
+  POLYAREA *pa;
+  Vector v;
+
+  v[0] = x1; v[1] = y1;
+  contour = poly_NewContour (v);
+  v[0] = x2; v[1] = y1;
+  poly_InclVertex (contour->head.prev, poly_CreateNode (v));
+  v[0] = x2; v[1] = y2;
+  poly_InclVertex (contour->head.prev, poly_CreateNode (v));
+  v[0] = x1; v[1] = y2;
+  poly_InclVertex (contour->head.prev, poly_CreateNode (v));
+  poly_PreContour (contour, TRUE);
+  pa = poly_Create ();
+  poly_InclContour (pa, contour);
+  return pa;
+}
+
+/*!
+ * \brief Replace the polygon's Clipped area with its boolean combination
+ * with b, the way Subtract() and Unsubtract() in polygon.c do.
+ *
+ * The old area is only freed once the new one exists, so the two never
+ * share an address.
+ */
+static void
+clip (PolygonType *poly, POLYAREA *b, int action, bool new_generation)
+{
+  POLYAREA *res = NULL;
+
+  g_assert_cmpint (poly_Boolean (poly->Clipped, b, &res, action),
+                   ==, err_ok);
+  poly_Free (&poly->Clipped);
+  poly_Free (&b);
+  poly->Clipped = res;
+  if (new_generation)
+    poly->ClipGeneration++;
+}
+
+/*!
+ * \brief Total area of the triangles of one contour.
+ */
+static double
+triangles_area (PolygonTriangles *pt, ContourTriangles *ct)
+{
+  GLfloat *t = &g_array_index (pt->triangles, GLfloat, 6 * ct->first);
+  double area = 0;
+  int i;
+
+  for (i = 0; i < ct->count; i++, t += 6)
+    area += fabs ((t[2] - t[0]) * (t[5] - t[1]) -
+                  (t[4] - t[0]) * (t[3] - t[1])) / 2;
+  return area;
+}
+
+/*!
+ * \brief Check the cached triangles of a polygon against a fresh
+ * tesselation, and the contour areas against the expected ones.
+ */
+static void
+check_cache (PolygonType *poly, int n_contours, const double *areas)
+{
+  PolygonTriangles *cached, *fresh;
+  int i;
+
+  cached = hidgl_lookup_polygon_triangles (poly);
+  g_assert (cached != NULL);
+  g_assert (cached->clipped == poly->Clipped);
+  g_assert_cmpuint (cached->generation, ==, poly->ClipGeneration);
+  g_assert_cmpint (cached->n_contours, ==, n_contours);
+  hidgl_tesselate_polygon (poly, cached);
+
+  fresh = hidgl_new_polygon_triangles (poly);
+  hidgl_tesselate_polygon (poly, fresh);
+
+  g_assert_cmpint (fresh->n_contours, ==, cached->n_contours);
+  g_assert_cmpuint (fresh->triangles->len, ==, cached->triangles->len);
+  g_assert (memcmp (fresh->triangles->data, cached->triangles->data,
+                    fresh->triangles->len * sizeof (GLfloat)) == 0);
+  for (i = 0; i < n_contours; i++)
+    {
+      g_assert_cmpint (fresh->contours[i].first, ==,
+                       cached->contours[i].first);
+      g_assert_cmpint (fresh->contours[i].count, ==,
+                       cached->contours[i].count);
+      g_assert_cmpfloat (fabs (triangles_area (cached, &cached->contours[i])
+                               - areas[i]), <, 1);
+    }
+
+  hidgl_free_polygon_triangles (fresh);
+
+  /* Unchanged, the same entry comes back without tesselating again */
+  g_assert (hidgl_lookup_polygon_triangles (poly) == cached);
+  g_assert_cmpuint (hidgl_tesselate_polygon (poly, cached) * 6,
+                    ==, cached->triangles->len);
+}
+
+static void
+hidgl_tess_cache_test (void)
+{
+  static const double plain[] = {1000000};
+  static const double holed[] = {1000000, 40000};
+  PolygonType poly;
+
+  memset (&poly, 0, sizeof (poly));
+  poly.Clipped = square (0, 0, 1000, 1000);
+
+  /* Never clipped by polygon.c, so not cached */
+  g_assert (hidgl_lookup_polygon_triangles (&poly) == NULL);
+
+  poly.ClipGeneration = 1;
+  check_cache (&poly, 1, plain);
+
+  /* Clear a hole out of it, as a via or line being added would */
+  clip (&poly, square (400, 400, 600, 600), PBO_SUB, TRUE);
+  check_cache (&poly, 2, holed);
+
+  /* Restore the hole, as removing that object would */
+  clip (&poly, square (400, 400, 600, 600), PBO_UNITE, TRUE);
+  check_cache (&poly, 1, plain);
+
+  /* A Clipped area replaced without a new generation is not reused */
+  clip (&poly, square (400, 400, 600, 600), PBO_SUB, FALSE);
+  check_cache (&poly, 2, holed);
+
+  /* Freeing the polygon drops its entry */
+  hidgl_forget_polygon (&poly);
+  g_assert_cmpuint (g_hash_table_size (triangle_cache), ==, 0);
+  g_assert_cmpuint (g_queue_get_length (&cache_lru), ==, 0);
+
+  poly_Free (&poly.Clipped);
+}
+
+static void
+hidgl_tess_evict_test (void)
+{
+  int n = TRIANGLE_CACHE_MIN + 1;
+  PolygonType *polys = g_new0 (PolygonType, n + 1);
+  POLYAREA *pa = square (0, 0, 1000, 1000);
+  int i;
+
+  for (i = 0; i <= n; i++)
+    {
+      polys[i].Clipped = pa;
+      polys[i].ClipGeneration = 1;
+    }
+
+  /* More polygons than the limit in one frame grow the cache */
+  hidgl_tess_begin_frame ();
+  for (i = 0; i < n; i++)
+    hidgl_lookup_polygon_triangles (&polys[i]);
+  g_assert_cmpuint (g_hash_table_size (triangle_cache), ==, n);
+  for (i = 0; i < n; i++)
+    g_assert (g_hash_table_lookup (triangle_cache, &polys[i]) != NULL);
+
+  /* In a later frame, only the least recently drawn entry makes room */
+  hidgl_tess_begin_frame ();
+  hidgl_lookup_polygon_triangles (&polys[0]);
+  cache_limit = n;
+  hidgl_lookup_polygon_triangles (&polys[n]);
+  g_assert_cmpuint (g_hash_table_size (triangle_cache), ==, n);
+  g_assert (g_hash_table_lookup (triangle_cache, &polys[0]) != NULL);
+  g_assert (g_hash_table_lookup (triangle_cache, &polys[1]) == NULL);
+  g_assert (g_hash_table_lookup (triangle_cache, &polys[n]) != NULL);
+
+  for (i = 0; i <= n; i++)
+    hidgl_forget_polygon (&polys[i]);
+  g_assert_cmpuint (g_hash_table_size (triangle_cache), ==, 0);
+  cache_limit = TRIANGLE_CACHE_MIN;
+
+  poly_Free (&pa);
+  g_free (polys);
+}
+
+void
+hidgl_tess_register_tests (void)
+{
+  g_test_add_func ("/hidgl-tess/cache", hidgl_tess_cache_test);
+  g_test_add_func ("/hidgl-tess/evict", hidgl_tess_evict_test);
+}
+
+#endif /* PCB_UNIT_TEST */
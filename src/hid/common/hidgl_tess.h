@@ -0,0 +1,60 @@
+/*
+ *                            COPYRIGHT
+ *
+ *  PCB, interactive printed circuit board design
+ *  Copyright (C) 2009-2011 PCB Contributors (See ChangeLog for details).
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PCB_HID_COMMON_HIDGL_TESS_H
+#define PCB_HID_COMMON_HIDGL_TESS_H
+
+typedef struct
+{
+  int first;                    /*!< First triangle, -1 if not tesselated yet. */
+  int count;                    /*!< Number of triangles. */
+} ContourTriangles;
+
+typedef struct
+{
+  POLYAREA *clipped;            /*!< The Clipped area which was triangulated. */
+  unsigned int generation;      /*!< ClipGeneration of the triangulated area. */
+  int n_contours;
+  ContourTriangles *contours;   /*!< Every contour of every piece, in order. */
+  GArray *triangles;            /*!< Six GLfloats per triangle. */
+  PolygonType *poly;            /*!< Key of a cached entry. */
+  unsigned int frame;           /*!< Frame a cached entry was last drawn in. */
+  GList lru;                    /*!< Link of a cached entry in the LRU queue. */
+} PolygonTriangles;
+
+void hidgl_tesselate (GArray *triangles, int n_vertices, double *vertices);
+
+int hidgl_count_contours (POLYAREA *pa);
+PolygonTriangles *hidgl_new_polygon_triangles (PolygonType *poly);
+void hidgl_free_polygon_triangles (PolygonTriangles *pt);
+PolygonTriangles *hidgl_lookup_polygon_triangles (PolygonType *poly);
+void hidgl_forget_polygon (PolygonType *poly);
+void hidgl_tess_begin_frame (void);
+ContourTriangles *hidgl_contour_triangles (PolygonTriangles *pt, int index,
+                                           PLINE *contour);
+int hidgl_tesselate_polygon (PolygonType *poly, PolygonTriangles *pt);
+
+#ifdef PCB_UNIT_TEST
+void hidgl_tess_register_tests (void);
+#endif
+
+#endif /* PCB_HID_COMMON_HIDGL_TESS_H  */
@@ -62,6 +62,8 @@ static void gerber_fill_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
 static void gerber_calibrate (double xval, double yval);
 static void gerber_set_crosshair (int x, int y, int action);
 static void gerber_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y);
+static void gerber_line_to_file (Coord x1, Coord y1, Coord x2, Coord y2);
+static void gerber_arc_to_file (hidGC gc, Coord cx, Coord cy, Coord width, Coord height, Angle start_angle, Angle delta_angle);
 
 /*----------------------------------------------------------------------------*/
 /* Utility routines                                                           */
@@ -1137,8 +1139,6 @@ gerber_draw_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 static void
 gerber_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 {
-  bool m = false;
-
   if (x1 != x2 && y1 != y2 && gc->cap == Square_Cap)
     {
       Coord x[5], y[5];
@@ -1165,6 +1165,17 @@ gerber_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
   if (!f)
     return;
 
+  gerber_line_to_file (x1, y1, x2, y2);
+}
+
+/*!
+ * \brief Write a line with the aperture already selected by use_gc ().
+ */
+static void
+gerber_line_to_file (Coord x1, Coord y1, Coord x2, Coord y2)
+{
+  bool m = false;
+
   if (x1 != lastX)
     {
       m = true;
@@ -1202,9 +1213,6 @@ static void
 gerber_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 		 Angle start_angle, Angle delta_angle)
 {
-  bool m = false;
-  double arcStartX, arcStopX, arcStartY, arcStopY;
-
   /* we never draw zero-width lines */
   if (gc->width == 0)
     return;
@@ -1213,6 +1221,19 @@ gerber_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
   if (!f)
     return;
 
+  gerber_arc_to_file (gc, cx, cy, width, height, start_angle, delta_angle);
+}
+
+/*!
+ * \brief Write an arc with the aperture already selected by use_gc ().
+ */
+static void
+gerber_arc_to_file (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
+		    Angle start_angle, Angle delta_angle)
+{
+  bool m = false;
+  double arcStartX, arcStopX, arcStartY, arcStopY;
+
   arcStartX = cx - width * cos (TO_RADIANS (start_angle));
   arcStartY = cy + height * sin (TO_RADIANS (start_angle));
 
@@ -1280,6 +1301,62 @@ gerber_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
   lastY = arcStopY;
 }
 
+/*!
+ * \brief Draw a batch of lines, selecting the aperture only once.
+ *
+ * Square capped lines may be drawn as polygons, which select another
+ * aperture, so those still go through gerber_draw_line ().
+ */
+static void
+gerber_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  int i;
+
+  if (gc->cap == Square_Cap)
+    {
+      for (i = 0; i < n_lines; i++)
+	gerber_draw_line (gc, lines[i].x1, lines[i].y1,
+			  lines[i].x2, lines[i].y2);
+      return;
+    }
+
+  use_gc (gc, 0);
+  if (!f)
+    return;
+
+  for (i = 0; i < n_lines; i++)
+    gerber_line_to_file (lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+}
+
+/*!
+ * \brief Draw a batch of arcs, selecting the aperture only once.
+ */
+static void
+gerber_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  int i;
+
+  /* gerber_draw_arc () skips zero-width arcs, and may draw elliptic
+     ones as square capped lines, which are polygons */
+  if (gc->width == 0 || gc->cap == Square_Cap)
+    {
+      for (i = 0; i < n_arcs; i++)
+	gerber_draw_arc (gc, arcs[i].cx, arcs[i].cy,
+			 arcs[i].width, arcs[i].height,
+			 arcs[i].start_angle, arcs[i].delta_angle);
+      return;
+    }
+
+  use_gc (gc, 0);
+  if (!f)
+    return;
+
+  for (i = 0; i < n_arcs; i++)
+    gerber_arc_to_file (gc, arcs[i].cx, arcs[i].cy,
+			arcs[i].width, arcs[i].height,
+			arcs[i].start_angle, arcs[i].delta_angle);
+}
+
 static void
 gerber_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
 {
@@ -1320,6 +1397,21 @@ gerber_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
   fprintf (f, "D03*\r\n");
 }
 
+/*!
+ * \brief Draw a batch of circles.
+ *
+ * The aperture depends on the radius, so there is no state to share;
+ * this only saves going through the HID for every circle.
+ */
+static void
+gerber_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  int i;
+
+  for (i = 0; i < n_circles; i++)
+    gerber_fill_circle (gc, circles[i].cx, circles[i].cy, circles[i].radius);
+}
+
 static void
 gerber_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
 {
@@ -1441,6 +1533,9 @@ hid_gerber_init ()
   gerber_graphics.fill_circle    = gerber_fill_circle;
   gerber_graphics.fill_polygon   = gerber_fill_polygon;
   gerber_graphics.fill_rect      = gerber_fill_rect;
+  gerber_graphics.draw_lines     = gerber_draw_lines;
+  gerber_graphics.draw_arcs      = gerber_draw_arcs;
+  gerber_graphics.fill_circles   = gerber_fill_circles;
 
   hid_register_hid (&gerber_hid);
 }
@@ -257,7 +257,7 @@ REGISTER_ATTRIBUTES(gsvit_attribute_list)
 void gsvit_create_netlist (void);
 void gsvit_destroy_netlist (void);
 static void gsvit_xml_out (char* gsvit_basename);
-static void gsvit_build_net_from_selected (struct gsvit_netlist* currNet);
+static void gsvit_build_net_from_marked (struct gsvit_netlist* currNet);
 static void gsvit_fill_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
 static void gsvit_write_xnets (void);
 
@@ -349,11 +349,11 @@ hslToRgb (int h, uint8_t s, uint8_t l)
 
 
 void
-gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
+gsvit_build_net_from_marked (struct gsvit_netlist* currNet)
 {
   COPPERLINE_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, line))
+    if (TEST_MARK (line))
     {
       currNet->layer[l].Line = g_list_prepend(currNet->layer[l].Line, line);
     }
@@ -362,7 +362,7 @@ gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
 
   COPPERARC_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, arc))
+    if (TEST_MARK (arc))
     {
       currNet->layer[l].Arc = g_list_prepend (currNet->layer[l].Arc, arc);
     }
@@ -371,7 +371,7 @@ gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
 
   COPPERPOLYGON_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, polygon))
+    if (TEST_MARK (polygon))
     {
       currNet->layer[l].Polygon = g_list_prepend (currNet->layer[l].Polygon, polygon);
     }
@@ -380,7 +380,7 @@ gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
 
   ALLPAD_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, pad))
+    if (TEST_MARK (pad))
     {
       currNet->Pad = g_list_prepend (currNet->Pad, pad);
     }
@@ -389,7 +389,7 @@ gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
 
   ALLPIN_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, pin))
+    if (TEST_MARK (pin))
     {
       currNet->Pin = g_list_prepend (currNet->Pin, pin);
     }
@@ -398,7 +398,7 @@ gsvit_build_net_from_selected (struct gsvit_netlist* currNet)
 
   VIA_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (SELECTEDFLAG, via))
+    if (TEST_MARK (via))
     {
       currNet->Via = g_list_prepend(currNet->Via, via);
     }
@@ -426,21 +426,20 @@ gsvit_create_netlist (void)
     /*! \todo Add fancy color attachment here. */
 
     InitConnectionLookup ();
-    ClearFlagOnAllObjects (FOUNDFLAG | SELECTEDFLAG, false);
+    NewSearchEpoch ();
     for (j = PCB->NetlistLib.Menu[i].EntryN, entry = PCB->NetlistLib.Menu[i].Entry; j; j--, entry++)
     { /* For each component (pin/pad) in the net. */
       if (SeekPad(entry, &conn, false))
       {
-        RatFindHook(conn.type, conn.ptr1, conn.ptr2, conn.ptr2, false, SELECTEDFLAG, false);
+        RatFindHook(conn.type, conn.ptr1, conn.ptr2, conn.ptr2, false, SEARCHMARK, false);
       }
     }
-    /* The conn should now contain a list of all elements that are part
-     * of the net.
-     * Now build a database of all things selected as part of this net.
+    /* Everything that is part of the net is now marked in this search
+     * epoch.
+     * Now build a database of all things marked as part of this net.
      */
-    gsvit_build_net_from_selected (currNet);
+    gsvit_build_net_from_marked (currNet);
 
-    ClearFlagOnAllObjects (FOUNDFLAG | SELECTEDFLAG, false);
     FreeConnectionLookupMemory ();
   }
 
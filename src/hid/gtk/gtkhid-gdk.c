@@ -678,6 +678,34 @@ ghid_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
 		Vx (cx) - vr, Vy (cy) - vr, vr * 2, vr * 2, 0, 360 * 64);
 }
 
+void
+ghid_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  int i;
+
+  for (i = 0; i < n_lines; i++)
+    ghid_draw_line (gc, lines[i].x1, lines[i].y1, lines[i].x2, lines[i].y2);
+}
+
+void
+ghid_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  int i;
+
+  for (i = 0; i < n_arcs; i++)
+    ghid_draw_arc (gc, arcs[i].cx, arcs[i].cy, arcs[i].width, arcs[i].height,
+                   arcs[i].start_angle, arcs[i].delta_angle);
+}
+
+void
+ghid_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  int i;
+
+  for (i = 0; i < n_circles; i++)
+    ghid_fill_circle (gc, circles[i].cx, circles[i].cy, circles[i].radius);
+}
+
 void
 ghid_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
 {
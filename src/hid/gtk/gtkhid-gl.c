@@ -575,6 +575,30 @@ ghid_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
 }
 
 
+void
+ghid_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  USE_GC (gc);
+
+  hidgl_draw_lines (gc->cap, gc->width, n_lines, lines, gport->view.coord_per_px);
+}
+
+void
+ghid_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  USE_GC (gc);
+
+  hidgl_draw_arcs (gc->width, n_arcs, arcs, gport->view.coord_per_px);
+}
+
+void
+ghid_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  USE_GC (gc);
+
+  hidgl_fill_circles (n_circles, circles, gport->view.coord_per_px);
+}
+
 void
 ghid_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
 {
@@ -2391,6 +2391,9 @@ hid_gtk_init ()
   ghid_graphics.fill_circle         = ghid_fill_circle;
   ghid_graphics.fill_polygon        = ghid_fill_polygon;
   ghid_graphics.fill_rect           = ghid_fill_rect;
+  ghid_graphics.draw_lines          = ghid_draw_lines;
+  ghid_graphics.draw_arcs           = ghid_draw_arcs;
+  ghid_graphics.fill_circles        = ghid_fill_circles;
   
   ghid_graphics.draw_grid           = ghid_draw_grid;
 
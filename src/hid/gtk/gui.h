@@ -494,6 +494,9 @@ void ghid_draw_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
 void ghid_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius);
 void ghid_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y);
 void ghid_fill_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
+void ghid_draw_lines (hidGC gc, int n_lines, const HID_Line *lines);
+void ghid_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs);
+void ghid_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles);
 void ghid_invalidate_lr (Coord left, Coord right, Coord top, Coord bottom);
 void ghid_invalidate_all ();
 void ghid_notify_crosshair_change (bool changes_complete);
@@ -97,17 +97,46 @@ typedef struct
   IPCD356_Alias *Alias;
 } IPCD356_AliasList;
 
-void IPCD356_WriteNet (FILE *, char *);
+/*!
+ * \brief A pin, pad or via belonging to a net.
+ */
+typedef struct
+{
+  int type; /*!< PIN_TYPE, PAD_TYPE or VIA_TYPE. */
+  ElementType *element; /*!< Owning element, NULL for vias. */
+  void *ptr; /*!< The pin, pad or via itself. */
+} IPCD356_Node;
+
+/*!
+ * \brief A net found by the connectivity sweep.
+ */
+typedef struct
+{
+  char Name[256]; /*!< Net name, or its alias if it is too long. */
+  GArray *Nodes; /*!< IPCD356_Node entries in board order. */
+} IPCD356_Net;
+
+/*!
+ * \brief Size of the stdio buffer used for the output file.
+ */
+#define IPCD356_BUFFER_SIZE (64 * 1024)
+
+void IPCD356_WriteNet (FILE *, IPCD356_Net *);
 void IPCD356_WriteHeader (FILE *);
 void IPCD356_End (FILE *);
 int IPCD356_Netlist (void);
 int IPCD356_WriteAliases (FILE *, IPCD356_AliasList *);
-void ResetVisitPinsViasAndPads (void);
 void CheckNetLength (char *, IPCD356_AliasList *);
 IPCD356_AliasList *CreateAliasList (void);
 IPCD356_AliasList *AddAliasToList (IPCD356_AliasList *);
 int IPCD356_SanityCheck (void);
 
+/*!
+ * \brief Divisor from PCB units to output units, 2540 for 0.0001" or
+ * 1000 for 0.001 mm.
+ */
+static int IPCD356_divisor;
+
 static HID_Attribute *
 IPCD356_get_export_options (int *n)
 {
@@ -168,15 +197,88 @@ IPCD356_WriteHeader (FILE * fd)
 }
 
 
+/*!
+ * \brief Converts a value in PCB units to the output units.
+ */
+static int
+IPCD356_ToUnits (int value)
+{
+  return value / IPCD356_divisor;
+}
+
+/*!
+ * \brief Formats the record of a pad into \p buf.
+ */
+static void
+IPCD356_FormatPad (char *buf, size_t size, const char *net,
+                   ElementType *element, PadType *pad)
+{
+  bool onsolder = TEST_FLAG (ONSOLDERFLAG, pad);
+  const char *mask;
+
+  if (pad->Mask > 0)
+    mask = onsolder ? "S2" : "S1"; /* Soldermask on bottom/top side. */
+  else
+    mask = "S3"; /* No soldermask. */
+
+  /* Net name, refdes, pin number, midpoint indicator (blank), drilled
+   * hole Id (blank for pads), access side, pad center, pad dimensions,
+   * rotation, a blank column 72 and the soldermask. */
+  snprintf (buf, size,
+            "327%-17.14s%-6.6s-%-4.4s       %s"
+            "X%+6.6dY%+6.6dX%4.4dY%4.4dR000 %s      \n",
+            net, element->Name[1].TextString, pad->Number,
+            onsolder ? "A02" : "A01", /*! \todo Put actual layer # for bottom side. */
+            IPCD356_ToUnits ((pad->Point1.X + pad->Point2.X) / 2),
+            IPCD356_ToUnits (PCB->MaxHeight
+                             - ((pad->Point1.Y + pad->Point2.Y) / 2)),
+            IPCD356_ToUnits (pad->Thickness + (pad->Point2.X - pad->Point1.X)),
+            IPCD356_ToUnits (pad->Thickness + (pad->Point2.Y - pad->Point1.Y)),
+            mask);
+}
+
+/*!
+ * \brief Formats the record of a pin or via into \p buf.
+ *
+ * \p element is NULL for vias.
+ */
+static void
+IPCD356_FormatPinOrVia (char *buf, size_t size, const char *net,
+                        ElementType *element, PinType *pin)
+{
+  bool unplated = TEST_FLAG (HOLEFLAG, pin);
+  char refdes[16];
+  int dimx;
+
+  if (element)
+    snprintf (refdes, sizeof (refdes), "%-6.6s-%-4.4s",
+              element->Name[1].TextString, pin->Number);
+  else
+    strcpy (refdes, "VIA   -    ");
+
+  dimx = IPCD356_ToUnits (pin->Thickness);
+
+  /* Net name, refdes and pin number, midpoint indicator (blank), drilled
+   * hole Id, access from both sides, pad center, pad dimensions (Y is 0
+   * for round pins), rotation, a blank column 72 and the soldermask. */
+  snprintf (buf, size,
+            "%s%-17.14s%s D%-4.4d%cA00"
+            "X%+6.6dY%+6.6dX%4.4dY%4.4dR000 %s      \n",
+            unplated ? "367" : "317", net, refdes,
+            IPCD356_ToUnits (pin->DrillingHole), unplated ? 'U' : 'P',
+            IPCD356_ToUnits (pin->X),
+            IPCD356_ToUnits (PCB->MaxHeight - pin->Y),
+            dimx,
+            (element && TEST_FLAG (SQUAREFLAG, pin)) ? dimx : 0,
+            pin->Mask > 0 ? "S0" : "S3");
+}
+
 /*!
  * \brief Writes a net to the file provided.
  *
- * The net name is passed through the "net" and should be 14 characters
- * max.\n
- * The function scans through pads, pins and vias  and looks for the
- * \c FOUNDFLAG.\n
- * Once the object has been added to the net list the \c VISITFLAG is
- * set on that object.
+ * The net name should be 14 characters max.\n
+ * The records are written in board order: the pads and pins of each
+ * element, followed by the vias.
  *
  * \todo 1) The bottom layer is always written as layer #2 (A02).\n
  *          It could output the actual layer number (example: A06 on a
@@ -187,268 +289,115 @@ IPCD356_WriteHeader (FILE * fd)
  *          (column 32) field written to indicate a Mid Net Point.
  */
 void
-IPCD356_WriteNet (FILE * fd, char *net)
+IPCD356_WriteNet (FILE * fd, IPCD356_Net *net)
 {
-  int padx, pady, tmp;
+  char record[256];
+  guint i;
 
-  ELEMENT_LOOP (PCB->Data);
-  PAD_LOOP (element);
-  if (TEST_FLAG (FOUNDFLAG, pad))
+  for (i = 0; i < net->Nodes->len; i++)
     {
-      fprintf (fd, "327%-17.14s", net); /* Net Name. */
-      fprintf (fd, "%-6.6s", element->Name[1].TextString); /* Refdes. */
-      fprintf (fd, "-%-4.4s", pad->Number); /* pin number. */
-      fprintf (fd, " "); /*! \todo Midpoint indicator (M). */
-      fprintf (fd, "      "); /* Drilled hole Id (blank for pads). */
-      if (TEST_FLAG (ONSOLDERFLAG, pad) == true)
-        {
-          fprintf (fd, "A02"); /*! \todo Put actual layer # for bottom side. */
-        }
-      else
-        {
-          fprintf (fd, "A01"); /* Top side. */
-        }
-      padx = (pad->Point1.X + pad->Point2.X) / 2; /* X location in PCB units. */
-      pady = (PCB->MaxHeight - ((pad->Point1.Y + pad->Point2.Y) / 2)); /* Y location in PCB units. */
-
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-          pady = pady / 2540; /* Y location in 0.0001". */
-        }
-      else
-        {
-          padx = padx / 1000; /* X location in 0.001 mm. */
-          pady = pady / 1000; /* Y location in 0.001 mm. */
-        }
-      fprintf (fd, "X%+6.6d", padx); /* X Pad center. */
-      fprintf (fd, "Y%+6.6d", pady); /* Y pad center. */
-
-      padx = (pad->Thickness + (pad->Point2.X - pad->Point1.X)); /* Pad dimension X in PCB units. */
-      pady = (pad->Thickness + (pad->Point2.Y - pad->Point1.Y)); /* Pad dimension Y in PCB units. */
+      IPCD356_Node *node = &g_array_index (net->Nodes, IPCD356_Node, i);
 
-      if (strcmp(Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-          pady = pady / 2540; /* Y location in 0.0001". */
-        }
+      if (node->type == PAD_TYPE)
+        IPCD356_FormatPad (record, sizeof (record), net->Name,
+                           node->element, (PadType *) node->ptr);
       else
-        {
-          padx = padx / 1000;	// X location in 0.001mm
-          pady = pady / 1000;	// Y location in 0.001mm
-        }
-
-      fprintf (fd, "X%4.4d", padx);
-      fprintf (fd, "Y%4.4d", pady);
-      fprintf (fd, "R000"); /* Rotation (0 degrees). */
-      fprintf (fd, " "); /* Column 72 should be left blank. */
-      if (pad->Mask > 0)    
-        {
-          if (TEST_FLAG (ONSOLDERFLAG, pad) == true)
-            {
-              fprintf(fd, "S2"); /* Soldermask on bottom side. */
-            }
-          else
-            {
-              fprintf(fd, "S1"); /* SolderMask on top side. */
-            }
-        }
-      else
-        {
-          fprintf(fd, "S3"); /* No soldermask. */
-        }
-      fprintf (fd, "      "); /* Padding. */
-      fprintf (fd, "\n");
-      SET_FLAG (VISITFLAG, pad);
+        IPCD356_FormatPinOrVia (record, sizeof (record), net->Name,
+                                node->element, (PinType *) node->ptr);
+      fputs (record, fd);
     }
+}
 
-  END_LOOP; /* Pad. */
-  PIN_LOOP (element);
-  if (TEST_FLAG (FOUNDFLAG, pin))
-    {
-      if (TEST_FLAG (HOLEFLAG, pin)) /* Non plated? */
-        {
-          fprintf (fd, "367%-17.14s", net); /* Net Name. */
-        }
-      else
-        {
-          fprintf (fd, "317%-17.14s", net); /* Net Name. */
-        }
-      fprintf (fd, "%-6.6s", element->Name[1].TextString); /* Refdes. */
-      fprintf (fd, "-%-4.4s", pin->Number); /* Pin number. */
-      fprintf (fd, " "); /*! \todo Midpoint indicator (M). */
-      tmp = pin->DrillingHole;
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          tmp = tmp / 2540; /* 0.0001". */
-        }
-      else
-        {
-          tmp = tmp / 1000; /* 0.001 mm. */
-        }
-
-      if (TEST_FLAG (HOLEFLAG, pin))
-        {
-          fprintf (fd, "D%-4.4dU", tmp); /* Unplated Drilled hole Id. */
-        }
-      else
-        {
-          fprintf (fd, "D%-4.4dP", tmp); /* Plated drill hole. */
-        }
-      fprintf (fd, "A00"); /* Accessible from both sides. */
-      padx = pin->X; /* X location in PCB units. */
-      pady = (PCB->MaxHeight - pin->Y); /* Y location in PCB units.*/
-
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-          pady = pady / 2540; /* Y location in 0.0001". */
-        }
-      else
-        {
-          padx = padx / 1000; /* X location in 0.001 mm. */
-          pady = pady / 1000; /* Y location in 0.001 mm. */
-        }
-
-      fprintf (fd, "X%+6.6d", padx); /* X Pad center. */
-      fprintf (fd, "Y%+6.6d", pady); /* Y pad center. */
-
-      padx = pin->Thickness;
-
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-        }
-      else
-        {
-          padx = padx / 1000; /* X location in 0.001 mm. */
-        }
+/*!
+ * \brief State shared by the connectivity sweep callbacks.
+ */
+typedef struct
+{
+  GHashTable *labels; /*!< Pin, pad or via -> net index + 1. */
+  int net; /*!< Index of the net currently being labelled. */
+} IPCD356_Sweep;
 
-      fprintf (fd, "X%4.4d", padx); /* Pad dimension X. */
-      if (TEST_FLAG (SQUAREFLAG, pin))
-        {
-          fprintf (fd, "Y%4.4d", padx); /* Pad dimension Y. */
-        }
-      else
-        {
-          fprintf (fd, "Y0000"); /*  Y is 0 for round pins. */
-        }
-      fprintf (fd, "R000"); /* Rotation (0 degrees). */
-      fprintf (fd, " "); /* Column 72 should be left blank.*/
-      if (pin->Mask > 0)    
-        {
-          fprintf(fd, "S0"); /* No Soldermask. */
-        }
-      else
-        {
-          fprintf(fd, "S3"); /* Soldermask on both sides. */
-        }
-      fprintf (fd, "      "); /* Padding. */
+static void
+IPCD356_LabelObject (int type, void *ptr1, void *ptr2, void *userdata)
+{
+  IPCD356_Sweep *sweep = (IPCD356_Sweep *) userdata;
 
-      fprintf (fd, "\n");
+  if (type & (PIN_TYPE | PAD_TYPE | VIA_TYPE))
+    g_hash_table_insert (sweep->labels, ptr2,
+                         GINT_TO_POINTER (sweep->net + 1));
+}
 
-      SET_FLAG (VISITFLAG, pin);
+/*!
+ * \brief Starts a new net at an unlabelled pin, pad or via and labels
+ * everything connected to it.
+ *
+ * \p name is the net name, or NULL for an unconnected net.
+ */
+static void
+IPCD356_StartNet (GPtrArray *nets, IPCD356_Sweep *sweep,
+                  IPCD356_AliasList *aliaslist, LibraryMenuType *menu,
+                  int type, void *ptr1, void *ptr2)
+{
+  IPCD356_Net *net = g_new0 (IPCD356_Net, 1);
 
+  if (menu)
+    {
+      strcpy (net->Name, &menu->Name[2]);
+      CheckNetLength (net->Name, aliaslist);
     }
-
-  END_LOOP; /* Pin. */
-  END_LOOP; /* Element */
-
-  VIA_LOOP (PCB->Data);
-  if (TEST_FLAG (FOUNDFLAG, via))
+  else
     {
-      if (TEST_FLAG (HOLEFLAG, via)) /* Non plated ? */
-        {
-          fprintf (fd, "367%-17.14s", net); /* Net Name. */
-        }
-      else
-        {
-          fprintf (fd, "317%-17.14s", net); /* Net Name. */
-        }
-      fprintf (fd, "VIA   "); /* Refdes. */
-      fprintf (fd, "-    "); /* Pin number. */
-      fprintf (fd, " "); /*! \todo Midpoint indicator (M). */
-      tmp = via->DrillingHole;	
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          tmp = tmp / 2540; /* 0.0001". */
-        }
-      else
-        {
-          tmp = tmp / 1000; /* 0.001 mm. */
-        }
-
-      if (TEST_FLAG (HOLEFLAG, via))
-        {
-          fprintf (fd, "D%-4.4dU", tmp); /* Unplated Drilled hole Id. */
-        }
-      else
-        {
-          fprintf (fd, "D%-4.4dP", tmp); /* Plated drill hole. */
-        }
-      fprintf (fd, "A00"); /* Accessible from both sides. */
-      padx = via->X; /* X location in PCB units. */
-      pady = (PCB->MaxHeight - via->Y); /* Y location in PCB units. */
-
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-          pady = pady / 2540; /* Y location in 0.0001". */
-        }
-      else
-        {
-          padx = padx / 1000; /* X location in 0.001 mm. */
-          pady = pady / 1000; /* Y location in 0.001 mm. */
-        }
-
-      fprintf (fd, "X%+6.6d", padx); /* X Pad center. */
-      fprintf (fd, "Y%+6.6d", pady); /* Y pad center. */
-
-      padx = via->Thickness;
-      
-      if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
-        {
-          padx = padx / 2540; /* X location in 0.0001". */
-        }
-      else
-        {
-          padx = padx / 1000; /* X location in 0.001 mm. */
-        }
-
-      fprintf (fd, "X%4.4d", padx); /* Pad dimension X. */
-      fprintf (fd, "Y0000"); /* Y is 0 for round pins (vias always round?). */
-      fprintf (fd, "R000"); /* Rotation (0 degrees). */
-      fprintf (fd, " "); /* Column 72 should be left blank. */
-      if (via->Mask > 0)    
-        {
-          fprintf(fd, "S0"); /* No Soldermask. */
-        }
-      else
-        {
-          fprintf(fd, "S3"); /* Soldermask on both sides. */
-        }
-      fprintf (fd, "      "); /* Padding. */
-      fprintf (fd, "\n");
-      SET_FLAG (VISITFLAG, via);
+      strcpy (net->Name, "N/C");
     }
+  net->Nodes = g_array_new (FALSE, FALSE, sizeof (IPCD356_Node));
+  g_ptr_array_add (nets, net);
 
-  END_LOOP; /* Via. */
+  sweep->net = nets->len - 1;
+  LookupConnectedComponent (type, ptr1, ptr2, ptr2, SEARCHMARK, true,
+                            IPCD356_LabelObject, sweep);
 }
 
+/*!
+ * \brief Appends a labelled pin, pad or via to its net.
+ */
+static void
+IPCD356_AddNode (GPtrArray *nets, IPCD356_Sweep *sweep,
+                 int type, ElementType *element, void *ptr)
+{
+  int label = GPOINTER_TO_INT (g_hash_table_lookup (sweep->labels, ptr));
+  IPCD356_Node node;
+
+  if (label == 0)
+    return;
+  node.type = type;
+  node.element = element;
+  node.ptr = ptr;
+  g_array_append_val (((IPCD356_Net *) g_ptr_array_index (nets, label - 1))->Nodes,
+                      node);
+}
 
 /*!
  * \brief The main IPC-D-356 function.
  *
  * Gets the filename for the netlist from the dialog.
+ *
+ * All copper is labelled with net numbers in a single connectivity
+ * sweep: each pin, pad or via not yet found starts a new net, and the
+ * lookup marks it in the current search epoch so it is never visited
+ * again.
+ * The pins, pads and vias are then bucketed per net with one more pass
+ * over the board and the nets are written out in the order they were
+ * found.
  */
 int
 IPCD356_Netlist (void)
 {
   FILE *fp;
   char nodename[256];
-  char net[256];
-  LibraryMenuType *netname;
   IPCD356_AliasList * aliaslist;
+  IPCD356_Sweep sweep;
+  GPtrArray *nets;
+  guint i;
 
   if (IPCD356_SanityCheck()) /* Check for invalid names + numbers. */
     {
@@ -456,7 +405,6 @@ IPCD356_Netlist (void)
       return(1);
     }
 
-  sprintf (net, "%s.ipc", PCB->Name);
   if (IPCD356_filename == NULL)
     return 1;
 
@@ -466,8 +414,14 @@ IPCD356_Netlist (void)
       Message ("error opening %s\n", IPCD356_filename);
       return 1;
     }
+  setvbuf (fp, NULL, _IOFBF, IPCD356_BUFFER_SIZE);
 /*   free (IPCD356_filename); */
 
+  /* Use whatever unit is currently in use (mil or mm). */
+  if (strcmp (Settings.grid_unit->suffix, "mil") == 0)
+    IPCD356_divisor = 2540;
+  else
+    IPCD356_divisor = 1000;
 
   IPCD356_WriteHeader (fp);
 
@@ -484,66 +438,69 @@ IPCD356_Netlist (void)
       return 1;
     }
 
+  nets = g_ptr_array_new ();
+  sweep.labels = g_hash_table_new (g_direct_hash, g_direct_equal);
+  sweep.net = 0;
+
+  NewSearchEpoch ();
+  InitConnectionLookup ();
 
   ELEMENT_LOOP (PCB->Data);
   PIN_LOOP (element);
-  if (!TEST_FLAG (VISITFLAG, pin))
+  if (!TEST_MARK (pin))
     {
-      ClearFlagOnAllObjects(FOUNDFLAG, true);
-      LookupConnectionByPin (PIN_TYPE, pin);
       sprintf (nodename, "%s-%s", element->Name[1].TextString, pin->Number);
-      netname = netnode_to_netname (nodename);
-/*      Message("Netname: %s\n", netname->Name +2); */
-      if (netname)
-        {
-          strcpy (net, &netname->Name[2]);
-          CheckNetLength (net, aliaslist);
-        }
-      else
-        {
-          strcpy (net, "N/C");
-        }
-      IPCD356_WriteNet (fp, net);
+      IPCD356_StartNet (nets, &sweep, aliaslist,
+                        netnode_to_netname (nodename),
+                        PIN_TYPE, element, pin);
     }
   END_LOOP; /* Pin. */
   PAD_LOOP (element);
-  if (!TEST_FLAG (VISITFLAG, pad))
+  if (!TEST_MARK (pad))
     {
-      ClearFlagOnAllObjects(FOUNDFLAG, true);
-      LookupConnectionByPin (PAD_TYPE, pad);
       sprintf (nodename, "%s-%s", element->Name[1].TextString, pad->Number);
-      netname = netnode_to_netname (nodename);
-/*      Message("Netname: %s\n", netname->Name +2); */
-      if (netname)
-        {
-          strcpy (net, &netname->Name[2]);
-          CheckNetLength (net, aliaslist);
-        }
-      else
-        {
-          strcpy (net, "N/C");
-        }
-      IPCD356_WriteNet (fp, net);
+      IPCD356_StartNet (nets, &sweep, aliaslist,
+                        netnode_to_netname (nodename),
+                        PAD_TYPE, element, pad);
     }
   END_LOOP; /* Pad. */
-
   END_LOOP; /* Element. */
 
   VIA_LOOP (PCB->Data);
-  if (!TEST_FLAG (VISITFLAG, via))
-    {
-      ClearFlagOnAllObjects(FOUNDFLAG, true);
-      LookupConnectionByPin (PIN_TYPE, via);
-      strcpy (net, "N/C");
-      IPCD356_WriteNet (fp, net);
-    }
+  if (!TEST_MARK (via))
+    IPCD356_StartNet (nets, &sweep, aliaslist, NULL, VIA_TYPE, via, via);
+  END_LOOP; /* Via. */
+
+  FreeConnectionLookupMemory ();
+
+  ELEMENT_LOOP (PCB->Data);
+  PAD_LOOP (element);
+  IPCD356_AddNode (nets, &sweep, PAD_TYPE, element, pad);
+  END_LOOP; /* Pad. */
+  PIN_LOOP (element);
+  IPCD356_AddNode (nets, &sweep, PIN_TYPE, element, pin);
+  END_LOOP; /* Pin. */
+  END_LOOP; /* Element. */
+  VIA_LOOP (PCB->Data);
+  IPCD356_AddNode (nets, &sweep, VIA_TYPE, NULL, via);
   END_LOOP; /* Via. */
 
+  for (i = 0; i < nets->len; i++)
+    IPCD356_WriteNet (fp, g_ptr_array_index (nets, i));
+
   IPCD356_End (fp);
   fclose (fp);
+
+  for (i = 0; i < nets->len; i++)
+    {
+      IPCD356_Net *net = g_ptr_array_index (nets, i);
+
+      g_array_free (net->Nodes, TRUE);
+      g_free (net);
+    }
+  g_ptr_array_free (nets, TRUE);
+  g_hash_table_destroy (sweep.labels);
   free (aliaslist);
-  ResetVisitPinsViasAndPads ();
-  ClearFlagOnAllObjects(FOUNDFLAG, true);
   return 0;
 }
 
@@ -553,22 +510,6 @@ IPCD356_End (FILE * fd)
   fprintf (fd, "999\n");
 }
 
-void
-ResetVisitPinsViasAndPads ()
-{
-  VIA_LOOP (PCB->Data);
-    CLEAR_FLAG (VISITFLAG, via);
-  END_LOOP; /* Via. */
-  ELEMENT_LOOP (PCB->Data);
-    PIN_LOOP (element);
-      CLEAR_FLAG (VISITFLAG, pin);
-    END_LOOP; /* Pin. */
-    PAD_LOOP (element);
-      CLEAR_FLAG (VISITFLAG, pad);
-    END_LOOP; /* Pad. */
-  END_LOOP; /* Element. */
-}
-
 int
 IPCD356_WriteAliases (FILE * fd, IPCD356_AliasList * aliaslist)
 {
@@ -944,9 +944,25 @@ nelma_draw_line(hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 		    pcb_to_nelma(x2), pcb_to_nelma(y2), gdBrushed);
 }
 
+static void	nelma_arc_to_image(Coord cx, Coord cy, Coord width, Coord height,
+				   Angle start_angle, Angle delta_angle);
+
 static void
 nelma_draw_arc(hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 	       Angle start_angle, Angle delta_angle)
+{
+	use_gc(gc);
+	gdImageSetThickness(nelma_im, 0);
+	linewidth = 0;
+	nelma_arc_to_image(cx, cy, width, height, start_angle, delta_angle);
+}
+
+/*!
+ * \brief Draw an arc with the brush already set up by use_gc().
+ */
+static void
+nelma_arc_to_image(Coord cx, Coord cy, Coord width, Coord height,
+		   Angle start_angle, Angle delta_angle)
 {
 	Angle sa, ea;
 
@@ -978,9 +994,6 @@ nelma_draw_arc(hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 	       im, SCALE_X(cx), SCALE_Y(cy),
 	       SCALE(width), SCALE(height), sa, ea, gc->color->c);
 #endif
-	use_gc(gc);
-	gdImageSetThickness(nelma_im, 0);
-	linewidth = 0;
 	gdImageArc(nelma_im, pcb_to_nelma(cx), pcb_to_nelma(cy),
 		   pcb_to_nelma(2 * width), pcb_to_nelma(2 * height), sa, ea, gdBrushed);
 }
@@ -997,6 +1010,65 @@ nelma_fill_circle(hidGC gc, Coord cx, Coord cy, Coord radius)
 
 }
 
+/*!
+ * \brief Draw a batch of lines, setting up the brush only once.
+ */
+static void
+nelma_draw_lines(hidGC gc, int n_lines, const HID_Line *lines)
+{
+	int             i;
+
+	use_gc(gc);
+	gdImageSetThickness(nelma_im, 0);
+	linewidth = 0;
+	for (i = 0; i < n_lines; i++) {
+		const HID_Line *l = &lines[i];
+
+		/* nelma_draw_line() turns these into squares */
+		if (l->x1 == l->x2 && l->y1 == l->y2)
+			nelma_draw_line(gc, l->x1, l->y1, l->x2, l->y2);
+		else
+			gdImageLine(nelma_im, pcb_to_nelma(l->x1), pcb_to_nelma(l->y1),
+				    pcb_to_nelma(l->x2), pcb_to_nelma(l->y2), gdBrushed);
+	}
+}
+
+/*!
+ * \brief Draw a batch of arcs, setting up the brush only once.
+ */
+static void
+nelma_draw_arcs(hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+	int             i;
+
+	use_gc(gc);
+	gdImageSetThickness(nelma_im, 0);
+	linewidth = 0;
+	for (i = 0; i < n_arcs; i++)
+		nelma_arc_to_image(arcs[i].cx, arcs[i].cy, arcs[i].width,
+				   arcs[i].height, arcs[i].start_angle,
+				   arcs[i].delta_angle);
+}
+
+/*!
+ * \brief Draw a batch of circles, setting up the brush only once.
+ */
+static void
+nelma_fill_circles(hidGC gc, int n_circles, const HID_Circle *circles)
+{
+	int             i;
+
+	use_gc(gc);
+	gdImageSetThickness(nelma_im, 0);
+	linewidth = 0;
+	for (i = 0; i < n_circles; i++)
+		gdImageFilledEllipse(nelma_im, pcb_to_nelma(circles[i].cx),
+				     pcb_to_nelma(circles[i].cy),
+				     pcb_to_nelma(2 * circles[i].radius),
+				     pcb_to_nelma(2 * circles[i].radius),
+				     gc->color->c);
+}
+
 static void
 nelma_fill_polygon(hidGC gc, int n_coords, Coord *x, Coord *y)
 {
@@ -1072,6 +1144,9 @@ hid_nelma_init()
   nelma_graphics.fill_circle    = nelma_fill_circle;
   nelma_graphics.fill_polygon   = nelma_fill_polygon;
   nelma_graphics.fill_rect      = nelma_fill_rect;
+  nelma_graphics.draw_lines     = nelma_draw_lines;
+  nelma_graphics.draw_arcs      = nelma_draw_arcs;
+  nelma_graphics.fill_circles   = nelma_fill_circles;
 
   hid_register_hid (&nelma_hid);
 
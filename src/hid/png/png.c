@@ -72,9 +72,10 @@ static double scale = 1;
 static Coord x_shift = 0;
 static Coord y_shift = 0;
 static int show_bottom_side;
+static int band_y = 0;		/* image row at the top of the photo band */
 #define SCALE(w)   ((int)round((w)/scale))
 #define SCALE_X(x) ((int)round(((x) - x_shift)/scale))
-#define SCALE_Y(y) ((int)round(((show_bottom_side ? (PCB->MaxHeight-(y)) : (y)) - y_shift)/scale))
+#define SCALE_Y(y) ((int)round(((show_bottom_side ? (PCB->MaxHeight-(y)) : (y)) - y_shift)/scale) - band_y)
 #define SWAP_IF_SOLDER(a,b) do { Coord c; if (show_bottom_side) { c=a; a=b; b=c; }} while (0)
 
 /* Used to detect non-trivial outlines */
@@ -83,6 +84,10 @@ static int show_bottom_side;
 #define NOT_EDGE(x,y) (NOT_EDGE_X(x) || NOT_EDGE_Y(y))
 
 static void png_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius);
+static void photo_render (HID_Attr_Val *options);
+static void png_line_to_image (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
+static void png_arc_to_image (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
+			      Angle start_angle, Angle delta_angle);
 
 /* The result of a failed gdImageColorAllocate() call */
 #define BADC -1
@@ -136,6 +141,17 @@ static gdImagePtr photo_outline;
 static int photo_groups[MAX_ALL_LAYER], photo_ngroups;
 static int photo_has_inners;
 
+/* Photo mode renders the board in bands of this many image rows, plus an
+   apron above and below for the shadow kernels in ts_bs (), so that the
+   layer masks only ever hold one band.  The outline is the exception:
+   it is flood filled from the image border and is drawn in full, in a
+   pass of its own.  */
+#define PHOTO_BAND_ROWS 256
+#define PHOTO_APRON 2
+
+static enum { PHOTO_PASS_OUTLINE, PHOTO_PASS_BANDS } photo_pass;
+static int photo_w, photo_h;
+
 static int doing_outline, have_outline;
 
 #define FMT_gif "GIF"
@@ -658,7 +674,10 @@ png_hid_export_to_file (FILE * the_file, HID_Attr_Val * options)
 	}
     }
 
-  hid_expose_callback (&png_hid, bounds, 0);
+  if (photo_mode)
+    photo_render (options);
+  else
+    hid_expose_callback (&png_hid, bounds, 0);
 
   memcpy (LayerStack, saved_layer_stack, sizeof (LayerStack));
   PCB->Flags = save_flags;
@@ -831,6 +850,295 @@ ts_bs_sm (gdImagePtr im)
       }
 }
 
+/*!
+ * \brief Create a photo mode layer mask: white (0) with black (1) ink.
+ */
+static gdImagePtr
+photo_image_create (int w, int h)
+{
+  gdImagePtr mask = gdImageCreate (w, h);
+
+  if (mask == NULL)
+    {
+      Message ("%s():  gdImageCreate(%d, %d) returned NULL.  Aborting export.\n",
+	       __FUNCTION__, w, h);
+      return NULL;
+    }
+  if (gdImageColorAllocate (mask, 255, 255, 255) == BADC
+      || gdImageColorAllocate (mask, 0, 0, 0) == BADC)
+    {
+      Message ("%s():  gdImageColorAllocate() returned NULL.  Aborting export.\n",
+	       __FUNCTION__);
+      gdImageDestroy (mask);
+      return NULL;
+    }
+  return mask;
+}
+
+static void
+photo_images_destroy (void)
+{
+  int i;
+
+  for (i = 0; i < MAX_ALL_LAYER; i++)
+    if (photo_copper[i])
+      {
+	gdImageDestroy (photo_copper[i]);
+	photo_copper[i] = NULL;
+      }
+  if (photo_silk)
+    gdImageDestroy (photo_silk);
+  if (photo_mask)
+    gdImageDestroy (photo_mask);
+  if (photo_drill)
+    gdImageDestroy (photo_drill);
+  if (photo_outline)
+    gdImageDestroy (photo_outline);
+  photo_silk = photo_mask = photo_drill = photo_outline = NULL;
+}
+
+/*!
+ * \brief Blank the band masks before drawing the next band.
+ */
+static void
+photo_images_clear (void)
+{
+  int i;
+
+  for (i = 0; i < MAX_ALL_LAYER; i++)
+    if (photo_copper[i])
+      gdImageFilledRectangle (photo_copper[i], 0, 0, photo_w, photo_h, 0);
+  if (photo_silk)
+    gdImageFilledRectangle (photo_silk, 0, 0, photo_w, photo_h, 0);
+  if (photo_mask)
+    gdImageFilledRectangle (photo_mask, 0, 0, photo_w, photo_h, 0);
+  if (photo_drill)
+    gdImageFilledRectangle (photo_drill, 0, 0, photo_w, photo_h, 1);
+}
+
+/*!
+ * \brief Shade image rows y0 to y1 of the photo from the band masks.
+ */
+static void
+photo_composite (HID_Attr_Val *options, int y0, int y1)
+{
+  int x, y;
+  color_struct white, black, fr4;
+
+  rgb (&white, 255, 255, 255);
+  rgb (&black, 0, 0, 0);
+  rgb (&fr4, 70, 70, 70);
+
+  for (x = 0; x < gdImageSX (master_im); x++)
+    {
+      for (y = y0; y < y1; y++)
+	{
+	  color_struct p, cop;
+	  color_struct mask_colour, silk_colour;
+	  int cc, mask, silk;
+	  int transparent;
+	 
+	  if (photo_outline && have_outline) {
+	    transparent=gdImageGetPixel(photo_outline, x, y);	      
+	  } else {
+	    transparent=0;
+	  }
+
+	  mask = photo_mask ? gdImageGetPixel (photo_mask, x, y - band_y) : 0;
+	  silk = photo_silk ? gdImageGetPixel (photo_silk, x, y - band_y) : 0;
+
+	  if (photo_copper[photo_groups[1]]
+	      && gdImageGetPixel (photo_copper[photo_groups[1]], x, y - band_y))
+	    rgb (&cop, 40, 40, 40);
+	  else
+	    rgb (&cop, 100, 100, 110);
+
+	  if (photo_ngroups == 2)
+	    blend (&cop, 0.3, &cop, &fr4);
+	  
+          if (photo_copper[photo_groups[0]])
+            cc = gdImageGetPixel (photo_copper[photo_groups[0]], x, y - band_y);
+          else
+            cc = 0;
+
+	  if (cc)
+	    {
+	      int r;
+	      
+	      if (mask)
+		rgb (&cop, 220, 145, 230);
+	      else
+		{
+		  if (options[HA_photo_plating].int_value == PLATING_GOLD)
+		    {
+		      // ENIG
+		      rgb (&cop, 185, 146, 52);
+
+		      // increase top shadow to increase shininess
+		      if (cc == TOP_SHADOW)
+			blend (&cop, 0.7, &cop, &white);
+		    }
+		  else if (options[HA_photo_plating].int_value == PLATING_TIN)
+		    {
+		      // tinned
+		      rgb (&cop, 140, 150, 160);
+
+		      // add some variation to make it look more matte
+		      r = (rand() % 5 - 2) * 2;
+		      cop.r += r;
+		      cop.g += r;
+		      cop.b += r;
+		    }
+		  else if (options[HA_photo_plating].int_value == PLATING_SILVER)
+		    {
+		      // silver
+		      rgb (&cop, 192, 192, 185);
+
+		      // increase top shadow to increase shininess
+		      if (cc == TOP_SHADOW)
+			blend (&cop, 0.7, &cop, &white);
+		    }
+		  else if (options[HA_photo_plating].int_value == PLATING_COPPER)
+		    {
+		      // copper
+		      rgb (&cop, 184, 115, 51);
+
+		      // increase top shadow to increase shininess
+		      if (cc == TOP_SHADOW)
+			blend (&cop, 0.7, &cop, &white);
+		    }
+		}
+	      
+	      if (cc == TOP_SHADOW)
+		blend (&cop, 0.7, &cop, &white);
+	      if (cc == BOTTOM_SHADOW)
+		blend (&cop, 0.7, &cop, &black);
+	    }
+
+	  if (photo_drill && !gdImageGetPixel (photo_drill, x, y - band_y)) 
+	    {		
+	      rgb (&p, 0, 0, 0);
+	      transparent=1;
+	    }
+	  else if (silk)
+	    {
+	      silk_colour = silk_colours[options[HA_photo_silk_colour].int_value];
+	      blend (&p, 1.0, &silk_colour, &silk_colour);
+	      if (silk == TOP_SHADOW)
+		add (&p, 1.0, &p, 1.0, &silk_top_shadow);
+	      else if (silk == BOTTOM_SHADOW)
+		subtract (&p, 1.0, &p, 1.0, &silk_bottom_shadow);
+	    }
+	  else if (mask)
+	    {
+	      p = cop;
+	      mask_colour = mask_colours[options[HA_photo_mask_colour].int_value];
+	      multiply (&p, &p, &mask_colour);
+	      add (&p, 1, &p, 0.2, &mask_colour);
+	      if (mask == TOP_SHADOW)
+		blend (&p, 0.7, &p, &white);
+	      if (mask == BOTTOM_SHADOW)
+		blend (&p, 0.7, &p, &black);
+	    }
+	  else
+	    p = cop;
+	  
+	  if (options[HA_use_alpha].int_value) {
+
+	    cc = (transparent)?\
+	      gdImageColorResolveAlpha(master_im, 0, 0, 0, 127):\
+	      gdImageColorResolveAlpha(master_im, p.r, p.g, p.b, 0);
+
+	  } else {
+	    cc = (transparent)?\
+	      gdImageColorResolve(master_im, 0, 0, 0):\
+	      gdImageColorResolve(master_im, p.r, p.g, p.b);
+	  }		  
+
+	  if (photo_flip == PHOTO_FLIP_X)
+	    gdImageSetPixel (master_im, gdImageSX (master_im) - x - 1, y, cc);
+	  else if (photo_flip == PHOTO_FLIP_Y)
+	    gdImageSetPixel (master_im, x, gdImageSY (master_im) - y - 1, cc);
+	  else
+	    gdImageSetPixel (master_im, x, y, cc);
+	}
+    }
+}
+
+/*!
+ * \brief Board y coordinate of the top of an image row, mirrored the
+ * same way as in SCALE_Y when the bottom side is shown.
+ */
+static Coord
+photo_row_y (int row)
+{
+  Coord y = y_shift + (Coord) (row * scale);
+
+  return show_bottom_side ? PCB->MaxHeight - y : y;
+}
+
+/*!
+ * \brief Draw the photo mode image band by band.
+ */
+static void
+photo_render (HID_Attr_Val *options)
+{
+  int x, y, y0, sx = gdImageSX (master_im), sy = gdImageSY (master_im);
+  Coord top, bottom;
+  BoxType region;
+
+  photo_pass = PHOTO_PASS_OUTLINE;
+  photo_w = sx;
+  photo_h = sy;
+  band_y = 0;
+  have_outline = 0;
+  hid_expose_callback (&png_hid, bounds, 0);
+
+  if (photo_outline && have_outline) {
+    int black=gdImageColorResolve(photo_outline, 0x00, 0x00, 0x00);
+
+    // go all the way around the image, trying to fill the outline
+    for (x=0; x<sx; x++) {
+      gdImageFillToBorder(photo_outline, x, 0, black, black);
+      gdImageFillToBorder(photo_outline, x, sy-1, black, black);
+    }
+    for (y=1; y<sy-1; y++) {
+      gdImageFillToBorder(photo_outline, 0, y, black, black);
+      gdImageFillToBorder(photo_outline, sx-1, y, black, black);
+    }
+  }
+
+  photo_pass = PHOTO_PASS_BANDS;
+  photo_h = MIN (sy, PHOTO_BAND_ROWS) + 2 * PHOTO_APRON;
+  for (y0 = 0; y0 < sy; y0 += PHOTO_BAND_ROWS)
+    {
+      band_y = y0 - PHOTO_APRON;
+      photo_images_clear ();
+
+      /* only what touches the band and its apron needs drawing */
+      top = photo_row_y (band_y - 1);
+      bottom = photo_row_y (band_y + photo_h + 1);
+      region = *bounds;
+      region.Y1 = MAX (bounds->Y1, MIN (top, bottom));
+      region.Y2 = MIN (bounds->Y2, MAX (top, bottom));
+      if (region.Y1 < region.Y2)
+	hid_expose_callback (&png_hid, &region, 0);
+
+      if (photo_copper[photo_groups[0]])
+	ts_bs (photo_copper[photo_groups[0]]);
+      if (photo_silk)
+	ts_bs (photo_silk);
+      if (photo_mask)
+	ts_bs_sm (photo_mask);
+
+      photo_composite (options, y0, MIN (sy, y0 + PHOTO_BAND_ROWS));
+    }
+
+  band_y = 0;
+  photo_images_destroy ();
+  im = master_im;
+}
+
 static void
 png_do_export (HID_Attr_Val * options)
 {
@@ -1042,176 +1350,6 @@ png_do_export (HID_Attr_Val * options)
   if (!options[HA_as_shown].int_value)
     hid_restore_layer_ons (save_ons);
 
-  if (photo_mode)
-    {
-      int x, y;
-      color_struct white, black, fr4;
-
-      rgb (&white, 255, 255, 255);
-      rgb (&black, 0, 0, 0);
-      rgb (&fr4, 70, 70, 70);
-
-      im = master_im;
-
-      if (photo_copper[photo_groups[0]])
-        ts_bs (photo_copper[photo_groups[0]]);
-      if (photo_silk)
-        ts_bs (photo_silk);
-      if (photo_mask)
-        ts_bs_sm (photo_mask);
-
-      if (photo_outline && have_outline) {
-	int black=gdImageColorResolve(photo_outline, 0x00, 0x00, 0x00);
-
-	// go all the way around the image, trying to fill the outline
-	for (x=0; x<gdImageSX(im); x++) {
-	  gdImageFillToBorder(photo_outline, x, 0, black, black);
-	  gdImageFillToBorder(photo_outline, x, gdImageSY(im)-1, black, black);
-	}
-	for (y=1; y<gdImageSY(im)-1; y++) {
-	  gdImageFillToBorder(photo_outline, 0, y, black, black);
-	  gdImageFillToBorder(photo_outline, gdImageSX(im)-1, y, black, black);
-
-	}
-      }
-
-
-      for (x=0; x<gdImageSX (im); x++) 
-	{
-	  for (y=0; y<gdImageSY (im); y++)
-	    {
-	      color_struct p, cop;
-	      color_struct mask_colour, silk_colour;
-	      int cc, mask, silk;
-	      int transparent;
-	     
-	      if (photo_outline && have_outline) {
-		transparent=gdImageGetPixel(photo_outline, x, y);	      
-	      } else {
-		transparent=0;
-	      }
-
-	      mask = photo_mask ? gdImageGetPixel (photo_mask, x, y) : 0;
-	      silk = photo_silk ? gdImageGetPixel (photo_silk, x, y) : 0;
-
-	      if (photo_copper[photo_groups[1]]
-		  && gdImageGetPixel (photo_copper[photo_groups[1]], x, y))
-		rgb (&cop, 40, 40, 40);
-	      else
-		rgb (&cop, 100, 100, 110);
-
-	      if (photo_ngroups == 2)
-		blend (&cop, 0.3, &cop, &fr4);
-	      
-              if (photo_copper[photo_groups[0]])
-                cc = gdImageGetPixel (photo_copper[photo_groups[0]], x, y);
-              else
-                cc = 0;
-
-	      if (cc)
-		{
-		  int r;
-		  
-		  if (mask)
-		    rgb (&cop, 220, 145, 230);
-		  else
-		    {
-		      if (options[HA_photo_plating].int_value == PLATING_GOLD)
-			{
-			  // ENIG
-			  rgb (&cop, 185, 146, 52);
-
-			  // increase top shadow to increase shininess
-			  if (cc == TOP_SHADOW)
-			    blend (&cop, 0.7, &cop, &white);
-			}
-		      else if (options[HA_photo_plating].int_value == PLATING_TIN)
-			{
-			  // tinned
-			  rgb (&cop, 140, 150, 160);
-
-			  // add some variation to make it look more matte
-			  r = (rand() % 5 - 2) * 2;
-			  cop.r += r;
-			  cop.g += r;
-			  cop.b += r;
-			}
-		      else if (options[HA_photo_plating].int_value == PLATING_SILVER)
-			{
-			  // silver
-			  rgb (&cop, 192, 192, 185);
-
-			  // increase top shadow to increase shininess
-			  if (cc == TOP_SHADOW)
-			    blend (&cop, 0.7, &cop, &white);
-			}
-		      else if (options[HA_photo_plating].int_value == PLATING_COPPER)
-			{
-			  // copper
-			  rgb (&cop, 184, 115, 51);
-
-			  // increase top shadow to increase shininess
-			  if (cc == TOP_SHADOW)
-			    blend (&cop, 0.7, &cop, &white);
-			}
-		    }
-		  
-		  if (cc == TOP_SHADOW)
-		    blend (&cop, 0.7, &cop, &white);
-		  if (cc == BOTTOM_SHADOW)
-		    blend (&cop, 0.7, &cop, &black);
-		}
-
-	      if (photo_drill && !gdImageGetPixel (photo_drill, x, y)) 
-		{		
-		  rgb (&p, 0, 0, 0);
-		  transparent=1;
-		}
-	      else if (silk)
-		{
-		  silk_colour = silk_colours[options[HA_photo_silk_colour].int_value];
-		  blend (&p, 1.0, &silk_colour, &silk_colour);
-		  if (silk == TOP_SHADOW)
-		    add (&p, 1.0, &p, 1.0, &silk_top_shadow);
-		  else if (silk == BOTTOM_SHADOW)
-		    subtract (&p, 1.0, &p, 1.0, &silk_bottom_shadow);
-		}
-	      else if (mask)
-		{
-		  p = cop;
-		  mask_colour = mask_colours[options[HA_photo_mask_colour].int_value];
-		  multiply (&p, &p, &mask_colour);
-		  add (&p, 1, &p, 0.2, &mask_colour);
-		  if (mask == TOP_SHADOW)
-		    blend (&p, 0.7, &p, &white);
-		  if (mask == BOTTOM_SHADOW)
-		    blend (&p, 0.7, &p, &black);
-		}
-	      else
-		p = cop;
-	      
-	      if (options[HA_use_alpha].int_value) {
-
-		cc = (transparent)?\
-		  gdImageColorResolveAlpha(im, 0, 0, 0, 127):\
-		  gdImageColorResolveAlpha(im, p.r, p.g, p.b, 0);
-
-	      } else {
-		cc = (transparent)?\
-		  gdImageColorResolve(im, 0, 0, 0):\
-		  gdImageColorResolve(im, p.r, p.g, p.b);
-	      }		  
-
-	      if (photo_flip == PHOTO_FLIP_X)
-		gdImageSetPixel (im, gdImageSX (im) - x - 1, y, cc);
-	      else if (photo_flip == PHOTO_FLIP_Y)
-		gdImageSetPixel (im, x, gdImageSY (im) - y - 1, cc);
-	      else
-		gdImageSetPixel (im, x, y, cc);
-	    }
-	}
-    }
-
   /* actually write out the image */
   fmt = filetypes[options[HA_filetype].int_value];
 
@@ -1336,6 +1474,8 @@ png_set_layer (const char *name, int group, int empty)
 
 	  if (strcmp (name, "outline") == 0)
 	    {
+	      if (photo_pass != PHOTO_PASS_OUTLINE)
+		return 0;
 	      doing_outline = 1;
 	      have_outline = 0;
 	      photo_im = &photo_outline;
@@ -1346,40 +1486,17 @@ png_set_layer (const char *name, int group, int empty)
 	  break;
 	}
 
+      if (photo_pass == PHOTO_PASS_OUTLINE && photo_im != &photo_outline)
+	return 0;
+
       if (! *photo_im)
 	{
-	  static color_struct *black = NULL, *white = NULL;
-	  *photo_im = gdImageCreate (gdImageSX (im), gdImageSY (im));
-          if (photo_im == NULL) 
-	    {
-	      Message ("%s():  gdImageCreate(%d, %d) returned NULL.  Aborting export.\n", __FUNCTION__, 
-		       gdImageSX (im), gdImageSY (im));
-	      return 0;
-	    }
-
-
-	  white = (color_struct *) malloc (sizeof (color_struct));
-	  white->r = white->g = white->b = 255;
-	  white->a = 0;
-	  white->c = gdImageColorAllocate (*photo_im, white->r, white->g, white->b);
-	  if (white->c == BADC) 
-	    {
-	      Message ("%s():  gdImageColorAllocate() returned NULL.  Aborting export.\n", __FUNCTION__);
-	      return 0;
-	    }
-
-	  black = (color_struct *) malloc (sizeof (color_struct));
-	  black->r = black->g = black->b = black->a = 0;
-	  black->c = gdImageColorAllocate (*photo_im, black->r, black->g, black->b);
-	  if (black->c == BADC) 
-	    {
-	      Message ("%s(): gdImageColorAllocate() returned NULL.  Aborting export.\n", __FUNCTION__);
-	      return 0;
-	    }
-
+	  *photo_im = photo_image_create (photo_w, photo_h);
+	  if (*photo_im == NULL)
+	    return 0;
 	  if (idx == SL (PDRILL, 0)
 	      || idx == SL (UDRILL, 0))
-	    gdImageFilledRectangle (*photo_im, 0, 0, gdImageSX (im), gdImageSY (im), black->c);
+	    gdImageFilledRectangle (*photo_im, 0, 0, photo_w, photo_h, 1);
 	}
       im = *photo_im;
       return 1;
@@ -1702,7 +1819,17 @@ png_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
       return;
     }
   use_gc (gc);
+  gdImageSetThickness (im, 0);
+  linewidth = 0;
+  png_line_to_image (gc, x1, y1, x2, y2);
+}
 
+/*!
+ * \brief Draw a line with the brush already set up by use_gc ().
+ */
+static void
+png_line_to_image (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
+{
   if (NOT_EDGE (x1, y1) || NOT_EDGE (x2, y2))
     have_outline |= doing_outline;
   if (doing_outline)
@@ -1722,8 +1849,6 @@ png_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 	}
     }
 
-  gdImageSetThickness (im, 0);
-  linewidth = 0;
   if(gc->cap != Square_Cap || x1 == x2 || y1 == y2 )
     {
       gdImageLine (im, SCALE_X (x1), SCALE_Y (y1),
@@ -1758,8 +1883,6 @@ static void
 png_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 	      Angle start_angle, Angle delta_angle)
 {
-  Angle sa, ea;
-
   /*
    * zero angle arcs need special handling as gd will output either
    * nothing at all or a full circle when passed delta angle of 0 or 360.
@@ -1773,6 +1896,21 @@ png_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
     return;
   }
 
+  use_gc (gc);
+  gdImageSetThickness (im, 0);
+  linewidth = 0;
+  png_arc_to_image (gc, cx, cy, width, height, start_angle, delta_angle);
+}
+
+/*!
+ * \brief Draw an arc with the brush already set up by use_gc ().
+ */
+static void
+png_arc_to_image (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
+		  Angle start_angle, Angle delta_angle)
+{
+  Angle sa, ea;
+
   /* 
    * in gdImageArc, 0 degrees is to the right and +90 degrees is down
    * in pcb, 0 degrees is to the left and +90 degrees is down
@@ -1811,9 +1949,6 @@ png_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 	  im, SCALE_X (cx), SCALE_Y (cy),
 	  SCALE (width), SCALE (height), sa, ea, gc->color->c);
 #endif
-  use_gc (gc);
-  gdImageSetThickness (im, 0);
-  linewidth = 0;
   gdImageArc (im, SCALE_X (cx), SCALE_Y (cy),
 	      SCALE (2 * width), SCALE (2 * height), sa, ea, gdBrushed);
 }
@@ -1843,6 +1978,85 @@ png_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
 
 }
 
+/*!
+ * \brief Draw a batch of lines, setting up the brush only once.
+ */
+static void
+png_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  int i;
+
+  use_gc (gc);
+  gdImageSetThickness (im, 0);
+  linewidth = 0;
+  for (i = 0; i < n_lines; i++)
+    {
+      const HID_Line *l = &lines[i];
+
+      /* png_draw_line () turns these into dots, leaving the brush as
+         it was */
+      if (l->x1 == l->x2 && l->y1 == l->y2)
+	png_draw_line (gc, l->x1, l->y1, l->x2, l->y2);
+      else
+	png_line_to_image (gc, l->x1, l->y1, l->x2, l->y2);
+    }
+}
+
+/*!
+ * \brief Draw a batch of arcs, setting up the brush only once.
+ */
+static void
+png_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  int i;
+
+  use_gc (gc);
+  gdImageSetThickness (im, 0);
+  linewidth = 0;
+  for (i = 0; i < n_arcs; i++)
+    {
+      const HID_Arc *a = &arcs[i];
+
+      if (a->delta_angle == 0)
+	png_draw_arc (gc, a->cx, a->cy, a->width, a->height,
+		      a->start_angle, a->delta_angle);
+      else
+	png_arc_to_image (gc, a->cx, a->cy, a->width, a->height,
+			  a->start_angle, a->delta_angle);
+    }
+}
+
+/*!
+ * \brief Draw a batch of circles, setting up the brush only once.
+ */
+static void
+png_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  Coord my_bloat;
+  int i;
+
+  use_gc (gc);
+
+  if (fill_holes && gc->is_erase && is_copper)
+    return;
+
+  if (gc->is_erase)
+    my_bloat = -2 * bloat;
+  else
+    my_bloat = 2 * bloat;
+
+  if (n_circles > 0)
+    have_outline |= doing_outline;
+
+  gdImageSetThickness (im, 0);
+  linewidth = 0;
+  for (i = 0; i < n_circles; i++)
+    gdImageFilledEllipse (im, SCALE_X (circles[i].cx), SCALE_Y (circles[i].cy),
+			  SCALE (2 * circles[i].radius + my_bloat),
+			  SCALE (2 * circles[i].radius + my_bloat),
+			  gc->color->c);
+}
+
 static void
 png_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
 {
@@ -1920,6 +2134,9 @@ hid_png_init ()
   png_graphics.fill_circle    = png_fill_circle;
   png_graphics.fill_polygon   = png_fill_polygon;
   png_graphics.fill_rect      = png_fill_rect;
+  png_graphics.draw_lines     = png_draw_lines;
+  png_graphics.draw_arcs      = png_draw_arcs;
+  png_graphics.fill_circles   = png_fill_circles;
 
 #ifdef HAVE_SOME_FORMAT
   hid_register_hid (&png_hid);
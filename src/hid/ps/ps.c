@@ -1154,6 +1154,8 @@ ps_draw_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 
 static void ps_fill_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2);
 static void ps_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius);
+static void ps_arc_to_file (Coord cx, Coord cy, Coord width, Coord height,
+			    Angle start_angle, Angle delta_angle);
 
 static void
 ps_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
@@ -1191,6 +1193,17 @@ ps_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
 static void
 ps_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
 	     Angle start_angle, Angle delta_angle)
+{
+  use_gc (gc);
+  ps_arc_to_file (cx, cy, width, height, start_angle, delta_angle);
+}
+
+/*!
+ * \brief Write an arc using the line width already set by use_gc ().
+ */
+static void
+ps_arc_to_file (Coord cx, Coord cy, Coord width, Coord height,
+		Angle start_angle, Angle delta_angle)
 {
   Angle sa, ea;
   double linewidth;
@@ -1206,8 +1219,6 @@ ps_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width, Coord height,
       ea = start_angle;
     }
 
-  use_gc (gc);
-
   /* Other than pcb's screen renderer, PostScript (at least GhostScript)
      internally limits linewidth to (diameter / 2), so no drawing of a dot with
      a circle of zero diameter. Compensate for this by making diameter larger
@@ -1248,6 +1259,66 @@ ps_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
     }
 }
 
+/*!
+ * \brief Draw a batch of lines, applying the GC only once.
+ */
+static void
+ps_draw_lines (hidGC gc, int n_lines, const HID_Line *lines)
+{
+  int i;
+
+  use_gc (gc);
+  for (i = 0; i < n_lines; i++)
+    {
+      const HID_Line *l = &lines[i];
+
+      /* ps_draw_line () turns these into dots */
+      if (l->x1 == l->x2 && l->y1 == l->y2)
+	ps_draw_line (gc, l->x1, l->y1, l->x2, l->y2);
+      else
+	pcb_fprintf (global.f, "%mi %mi %mi %mi t\n",
+		     l->x1, l->y1, l->x2, l->y2);
+    }
+}
+
+/*!
+ * \brief Draw a batch of arcs, applying the GC only once.
+ */
+static void
+ps_draw_arcs (hidGC gc, int n_arcs, const HID_Arc *arcs)
+{
+  int i;
+
+  use_gc (gc);
+  for (i = 0; i < n_arcs; i++)
+    ps_arc_to_file (arcs[i].cx, arcs[i].cy, arcs[i].width, arcs[i].height,
+		    arcs[i].start_angle, arcs[i].delta_angle);
+}
+
+/*!
+ * \brief Draw a batch of circles, applying the GC only once.
+ */
+static void
+ps_fill_circles (hidGC gc, int n_circles, const HID_Circle *circles)
+{
+  Coord radius;
+  int i;
+
+  use_gc (gc);
+  if (gc->erase && global.is_copper && !global.drillcopper)
+    return;
+
+  for (i = 0; i < n_circles; i++)
+    {
+      radius = circles[i].radius;
+      if (gc->erase && global.is_copper && global.drill_helper
+	  && radius >= PCB->minDrill / 4)
+	radius = PCB->minDrill / 4;
+      pcb_fprintf (global.f, "%mi %mi %mi c\n", circles[i].cx, circles[i].cy,
+                   radius + (gc->erase ? -1 : 1) * global.bloat);
+    }
+}
+
 static void
 ps_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
 {
@@ -1552,6 +1623,9 @@ void ps_ps_graphics_init (HID_DRAW *graphics)
   graphics->fill_circle        = ps_fill_circle;
   graphics->fill_polygon       = ps_fill_polygon;
   graphics->fill_rect          = ps_fill_rect;
+  graphics->draw_lines         = ps_draw_lines;
+  graphics->draw_arcs          = ps_draw_arcs;
+  graphics->fill_circles       = ps_fill_circles;
 
   graphics->draw_pcb_polygon   = ps_draw_pcb_polygon;
 }
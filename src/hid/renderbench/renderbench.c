@@ -0,0 +1,787 @@
+/*!
+ * \file src/hid/renderbench/renderbench.c
+ *
+ * \brief Headless drawing benchmark.
+ *
+ * Replays the screen drawing code over a grid of viewports at several
+ * zoom levels, the way a user panning across the board would, and
+ * reports where the time goes: per layer group, per kind of r-tree
+ * search in draw.c and per kind of primitive handed to the HID.
+ *
+ * In "count" mode primitives are only counted, which measures draw.c
+ * and the common helpers.  In "raster" mode they are also scan
+ * converted into an 8 bit frame buffer, giving a rough figure for a
+ * software renderer.
+ *
+ * <hr>
+ *
+ * <h1><b>Copyright.</b></h1>\n
+ *
+ * PCB, interactive printed circuit board design
+ *
+ * Copyright (C) 2026 PCB Contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Contact addresses for paper mail and Email:
+ * Thomas Nau, Schlehenweg 15, 88471 Baustetten, Germany
+ * Thomas.Nau@rz.uni-ulm.de
+ *
+ * <hr>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "global.h"
+#include "data.h"
+#include "draw.h"
+#include "error.h"
+#include "misc.h"
+
+#include "hid.h"
+#include "hid_draw.h"
+#include "hid/common/hidnogui.h"
+#include "hid/common/draw_helpers.h"
+#include "../hidint.h"
+
+#ifdef HAVE_LIBDMALLOC
+#include <dmalloc.h>
+#endif
+
+static const char *modes[] = {
+  "count",
+  "raster",
+  0
+};
+
+#define MODE_COUNT 0
+#define MODE_RASTER 1
+
+static HID_Attribute renderbench_options[] = {
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --benchfile <string>
+Name of the report file, or @code{-} for standard output.
+@end ftable
+%end-doc
+*/
+  {"benchfile", "Report file, - for standard output",
+   HID_String, 0, 0, {0, 0, 0}, 0, 0},
+#define HA_benchfile 0
+
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --mode <count|raster>
+@code{count} only counts what the drawing code hands to the HID;
+@code{raster} also scan converts it into an off-screen frame buffer.
+@end ftable
+%end-doc
+*/
+  {"mode", "Count primitives, or rasterize them too",
+   HID_Enum, 0, 0, {0, 0, 0}, modes, 0},
+#define HA_mode 1
+
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --zooms <string>
+Comma separated zoom levels.  At zoom @code{n} the board is split into
+@code{n} by @code{n} viewports, each of which is drawn in turn.  The
+default is @code{1,4,16}.
+@end ftable
+%end-doc
+*/
+  {"zooms", "Comma separated zoom levels",
+   HID_String, 0, 0, {0, "1,4,16", 0}, 0, 0},
+#define HA_zooms 2
+
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --repeat <num>
+Number of times the whole set of viewports is drawn.
+@end ftable
+%end-doc
+*/
+  {"repeat", "Number of passes over all viewports",
+   HID_Integer, 1, 1000, {1, 0, 0}, 0, 0},
+#define HA_repeat 3
+
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --raster-size <num>
+Width and height in pixels of the frame buffer used in raster mode.
+@end ftable
+%end-doc
+*/
+  {"raster-size", "Frame buffer size in pixels (raster mode)",
+   HID_Integer, 16, 8192, {1024, 0, 0}, 0, 0},
+#define HA_raster_size 4
+
+/* %start-doc options "97 Render Benchmark Options"
+@ftable @code
+@item --lod
+Draw with level of detail culling, as the GUI does, at the pixel size
+of the frame buffer.
+@end ftable
+%end-doc
+*/
+  {"lod", "Use level of detail culling",
+   HID_Boolean, 0, 0, {0, 0, 0}, 0, 0},
+#define HA_lod 5
+};
+
+#define NUM_OPTIONS (sizeof(renderbench_options)/sizeof(renderbench_options[0]))
+
+static HID_Attr_Val renderbench_values[NUM_OPTIONS];
+
+static HID renderbench_hid;
+static HID_DRAW renderbench_graphics;
+
+typedef struct hid_gc_struct
+{
+  unsigned char value;
+  EndCapStyle cap;
+  Coord width;
+} hid_gc_struct;
+
+enum prim_kind
+{
+  PRIM_LINE,
+  PRIM_ARC,
+  PRIM_RECT,
+  PRIM_CIRCLE,
+  PRIM_POLYGON,
+  PRIM_FILL_RECT,
+  N_PRIM_KINDS
+};
+
+static const char *prim_names[N_PRIM_KINDS] = {
+  "line", "arc", "rect", "circle", "polygon", "fill_rect"
+};
+
+/*!
+ * \brief Time spent while one layer group was selected.
+ */
+typedef struct
+{
+  char *name;
+  long selected;
+  double seconds;
+} GroupStats;
+
+static GTimer *timer;
+static int bench_mode;
+static bool use_lod;
+
+static long prim_count[N_PRIM_KINDS];
+static double prim_seconds[N_PRIM_KINDS];
+
+static GHashTable *group_index;
+static GPtrArray *groups;
+static GroupStats *cur_group;
+static double cur_group_start;
+
+/* Frame buffer and the viewport mapped onto it. */
+static unsigned char *raster;
+static int raster_w, raster_h;
+static double view_x, view_y, view_scale;
+
+/*!
+ * \brief Charge the time since the last layer change to the current group.
+ */
+static void
+close_group (void)
+{
+  double now = g_timer_elapsed (timer, NULL);
+
+  if (cur_group != NULL)
+    cur_group->seconds += now - cur_group_start;
+  cur_group = NULL;
+  cur_group_start = now;
+}
+
+static int
+renderbench_set_layer (const char *name, int group, int empty)
+{
+  int idx = group;
+  char *key;
+  GroupStats *gs;
+
+  if (idx >= 0 && idx < max_group)
+    {
+      idx = PCB->LayerGroups.Entries[group][0];
+      key = g_strdup_printf ("group %d (%s)", group,
+                             PCB->Data->Layer[idx].Name);
+    }
+  else
+    key = g_strdup (name ? name : "(unnamed)");
+
+  close_group ();
+  gs = (GroupStats *) g_hash_table_lookup (group_index, key);
+  if (gs == NULL)
+    {
+      gs = g_new0 (GroupStats, 1);
+      gs->name = key;
+      g_hash_table_insert (group_index, gs->name, gs);
+      g_ptr_array_add (groups, gs);
+    }
+  else
+    g_free (key);
+  gs->selected++;
+  cur_group = gs;
+
+  /* draw what the GUI would show */
+  if (idx >= 0 && idx < max_copper_layer + SILK_LAYER)
+    return PCB->Data->Layer[idx].On;
+  if (idx < 0)
+    {
+      switch (SL_TYPE (idx))
+	{
+	case SL_INVISIBLE:
+	  return PCB->InvisibleObjectsOn;
+	case SL_MASK:
+	  return SL_MYSIDE (idx) && TEST_FLAG (SHOWMASKFLAG, PCB);
+	case SL_SILK:
+	  return SL_MYSIDE (idx) && PCB->ElementOn;
+	case SL_ASSY:
+	  return 0;
+	case SL_PDRILL:
+	case SL_UDRILL:
+	  return 1;
+	case SL_RATS:
+	  return PCB->RatOn;
+	}
+    }
+  return 0;
+}
+
+static hidGC
+renderbench_make_gc (void)
+{
+  return (hidGC) g_new0 (hid_gc_struct, 1);
+}
+
+static void
+renderbench_destroy_gc (hidGC gc)
+{
+  g_free (gc);
+}
+
+static void
+renderbench_use_mask (enum mask_mode mode)
+{
+}
+
+static void
+renderbench_set_color (hidGC gc, const char *name)
+{
+  if (name == NULL || strcmp (name, "erase") == 0)
+    gc->value = 0;
+  else
+    gc->value = (g_str_hash (name) & 0xff) | 1;
+}
+
+static void
+renderbench_set_line_cap (hidGC gc, EndCapStyle style)
+{
+  gc->cap = style;
+}
+
+static void
+renderbench_set_line_width (hidGC gc, Coord width)
+{
+  gc->width = width;
+}
+
+static void
+renderbench_set_draw_xor (hidGC gc, int xor_)
+{
+}
+
+/* ---------------------------------------------------------------------------
+ * Scan conversion, in frame buffer pixels.
+ */
+
+#define PX(x) (((x) - view_x) * view_scale)
+#define PY(y) (((y) - view_y) * view_scale)
+
+static void
+fill_span (int y, double x1, double x2, unsigned char value)
+{
+  int a, b;
+
+  if (y < 0 || y >= raster_h)
+    return;
+  a = MAX (0, (int) ceil (x1 - 0.5));
+  b = MIN (raster_w - 1, (int) floor (x2 - 0.5));
+  if (a <= b)
+    memset (raster + (size_t) y * raster_w + a, value, b - a + 1);
+}
+
+static void
+raster_rect (double x1, double y1, double x2, double y2, unsigned char value)
+{
+  int y, ya, yb;
+
+  if (x1 > x2)
+    {
+      double t = x1; x1 = x2; x2 = t;
+    }
+  if (y1 > y2)
+    {
+      double t = y1; y1 = y2; y2 = t;
+    }
+  ya = MAX (0, (int) ceil (y1 - 0.5));
+  yb = MIN (raster_h - 1, (int) floor (y2 - 0.5));
+  for (y = ya; y <= yb; y++)
+    fill_span (y, x1, x2, value);
+}
+
+static void
+raster_circle (double cx, double cy, double r, unsigned char value)
+{
+  int y, ya, yb;
+
+  ya = MAX (0, (int) ceil (cy - r - 0.5));
+  yb = MIN (raster_h - 1, (int) floor (cy + r - 0.5));
+  for (y = ya; y <= yb; y++)
+    {
+      double dy = y + 0.5 - cy;
+      double dx = sqrt (MAX (0, r * r - dy * dy));
+
+      fill_span (y, cx - dx, cx + dx, value);
+    }
+}
+
+static int
+cmp_double (const void *va, const void *vb)
+{
+  double a = *(const double *) va, b = *(const double *) vb;
+
+  return a < b ? -1 : a > b;
+}
+
+/*!
+ * \brief Even-odd scan conversion of a polygon.
+ */
+static void
+raster_polygon (int n, const double *x, const double *y, unsigned char value)
+{
+  static double *cross = NULL;
+  static int cross_max = 0;
+  double ymin = y[0], ymax = y[0];
+  int i, j, k, row, ya, yb;
+
+  if (n < 3)
+    return;
+  if (n > cross_max)
+    {
+      cross_max = n;
+      cross = (double *) realloc (cross, cross_max * sizeof (double));
+    }
+  for (i = 1; i < n; i++)
+    {
+      ymin = MIN (ymin, y[i]);
+      ymax = MAX (ymax, y[i]);
+    }
+  ya = MAX (0, (int) ceil (ymin - 0.5));
+  yb = MIN (raster_h - 1, (int) floor (ymax - 0.5));
+  for (row = ya; row <= yb; row++)
+    {
+      double sy = row + 0.5;
+
+      for (i = 0, j = n - 1, k = 0; i < n; j = i++)
+        if ((y[i] <= sy) != (y[j] <= sy))
+          cross[k++] = x[i] + (sy - y[i]) * (x[j] - x[i]) / (y[j] - y[i]);
+      qsort (cross, k, sizeof (double), cmp_double);
+      for (i = 0; i + 1 < k; i += 2)
+        fill_span (row, cross[i], cross[i + 1], value);
+    }
+}
+
+static void
+raster_line (hidGC gc, double x1, double y1, double x2, double y2)
+{
+  double w = gc->width * view_scale / 2;
+  double dx = x2 - x1, dy = y2 - y1;
+  double len = hypot (dx, dy);
+  double px[4], py[4], nx, ny;
+
+  if (w < 0.5)
+    {
+      /* hairline: one pixel per step along the major axis */
+      int i, steps = (int) ceil (MAX (fabs (dx), fabs (dy)));
+
+      for (i = 0; i <= steps; i++)
+        {
+          double t = steps ? (double) i / steps : 0;
+          int x = (int) floor (x1 + t * dx), y = (int) floor (y1 + t * dy);
+
+          if (x >= 0 && x < raster_w && y >= 0 && y < raster_h)
+            raster[(size_t) y * raster_w + x] = gc->value;
+        }
+      return;
+    }
+
+  if (gc->cap != Square_Cap)
+    {
+      raster_circle (x1, y1, w, gc->value);
+      raster_circle (x2, y2, w, gc->value);
+    }
+  if (len == 0)
+    {
+      if (gc->cap == Square_Cap)
+        raster_rect (x1 - w, y1 - w, x1 + w, y1 + w, gc->value);
+      return;
+    }
+
+  nx = -dy / len * w;
+  ny = dx / len * w;
+  if (gc->cap == Square_Cap)
+    {
+      x1 -= dx / len * w;
+      y1 -= dy / len * w;
+      x2 += dx / len * w;
+      y2 += dy / len * w;
+    }
+  px[0] = x1 + nx; py[0] = y1 + ny;
+  px[1] = x2 + nx; py[1] = y2 + ny;
+  px[2] = x2 - nx; py[2] = y2 - ny;
+  px[3] = x1 - nx; py[3] = y1 - ny;
+  raster_polygon (4, px, py, gc->value);
+}
+
+/* ---------------------------------------------------------------------------
+ * Drawing primitives.
+ */
+
+#define PRIM_BEGIN(kind)						\
+  double prim_start = 0;						\
+  prim_count[kind]++;							\
+  if (bench_mode == MODE_COUNT)						\
+    return;								\
+  prim_start = g_timer_elapsed (timer, NULL)
+
+#define PRIM_END(kind)							\
+  prim_seconds[kind] += g_timer_elapsed (timer, NULL) - prim_start
+
+static void
+renderbench_draw_line (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
+{
+  PRIM_BEGIN (PRIM_LINE);
+  raster_line (gc, PX (x1), PY (y1), PX (x2), PY (y2));
+  PRIM_END (PRIM_LINE);
+}
+
+static void
+renderbench_draw_arc (hidGC gc, Coord cx, Coord cy, Coord width,
+                      Coord height, Angle start_angle, Angle delta_angle)
+{
+  double r, step, a, x0, y0, x1, y1;
+  int i, n;
+
+  PRIM_BEGIN (PRIM_ARC);
+  r = MAX (width, height) * view_scale;
+  n = MAX (2, (int) ceil (fabs (delta_angle) / 360 * MIN (256, 2 * M_PI * r / 4)));
+  step = delta_angle / n;
+  a = start_angle * M_PI / 180;
+  x0 = PX (cx - width * cos (a));
+  y0 = PY (cy + height * sin (a));
+  for (i = 1; i <= n; i++)
+    {
+      a = (start_angle + step * i) * M_PI / 180;
+      x1 = PX (cx - width * cos (a));
+      y1 = PY (cy + height * sin (a));
+      raster_line (gc, x0, y0, x1, y1);
+      x0 = x1;
+      y0 = y1;
+    }
+  PRIM_END (PRIM_ARC);
+}
+
+static void
+renderbench_draw_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
+{
+  PRIM_BEGIN (PRIM_RECT);
+  raster_line (gc, PX (x1), PY (y1), PX (x2), PY (y1));
+  raster_line (gc, PX (x2), PY (y1), PX (x2), PY (y2));
+  raster_line (gc, PX (x2), PY (y2), PX (x1), PY (y2));
+  raster_line (gc, PX (x1), PY (y2), PX (x1), PY (y1));
+  PRIM_END (PRIM_RECT);
+}
+
+static void
+renderbench_fill_circle (hidGC gc, Coord cx, Coord cy, Coord radius)
+{
+  PRIM_BEGIN (PRIM_CIRCLE);
+  raster_circle (PX (cx), PY (cy), radius * view_scale, gc->value);
+  PRIM_END (PRIM_CIRCLE);
+}
+
+static void
+renderbench_fill_polygon (hidGC gc, int n_coords, Coord *x, Coord *y)
+{
+  static double *px = NULL, *py = NULL;
+  static int max = 0;
+  int i;
+
+  PRIM_BEGIN (PRIM_POLYGON);
+  if (n_coords > max)
+    {
+      max = n_coords;
+      px = (double *) realloc (px, max * sizeof (double));
+      py = (double *) realloc (py, max * sizeof (double));
+    }
+  for (i = 0; i < n_coords; i++)
+    {
+      px[i] = PX (x[i]);
+      py[i] = PY (y[i]);
+    }
+  raster_polygon (n_coords, px, py, gc->value);
+  PRIM_END (PRIM_POLYGON);
+}
+
+static void
+renderbench_fill_rect (hidGC gc, Coord x1, Coord y1, Coord x2, Coord y2)
+{
+  PRIM_BEGIN (PRIM_FILL_RECT);
+  raster_rect (PX (x1), PY (y1), PX (x2), PY (y2), gc->value);
+  PRIM_END (PRIM_FILL_RECT);
+}
+
+/* ---------------------------------------------------------------------------
+ * Export.
+ */
+
+static HID_Attribute *
+renderbench_get_export_options (int *n)
+{
+  static char *last_made_filename = 0;
+
+  if (PCB)
+    derive_default_filename (PCB->Filename,
+                             &renderbench_options[HA_benchfile],
+                             ".bench", &last_made_filename);
+  if (n)
+    *n = NUM_OPTIONS;
+  return renderbench_options;
+}
+
+static void
+free_group_stats (gpointer data)
+{
+  GroupStats *gs = (GroupStats *) data;
+
+  g_free (gs->name);
+  g_free (gs);
+}
+
+/*!
+ * \brief Draw every viewport of one zoom level once.
+ *
+ * \return the number of viewports drawn.
+ */
+static int
+draw_zoom (int zoom)
+{
+  Coord w = MAX (1, PCB->MaxWidth / zoom);
+  Coord h = MAX (1, PCB->MaxHeight / zoom);
+  BoxType region;
+  int i, j;
+
+  view_scale = (double) raster_w / MAX (w, h);
+  draw_lod_pixel = use_lod ? MAX (1, (Coord) (1 / view_scale)) : 0;
+  for (j = 0; j < zoom; j++)
+    for (i = 0; i < zoom; i++)
+      {
+        region.X1 = i * w;
+        region.Y1 = j * h;
+        region.X2 = region.X1 + w;
+        region.Y2 = region.Y1 + h;
+        view_x = region.X1;
+        view_y = region.Y1;
+        if (raster != NULL)
+          memset (raster, 0, (size_t) raster_w * raster_h);
+
+        close_group ();
+        hid_expose_callback (&renderbench_hid, &region, NULL);
+        close_group ();
+      }
+  return zoom * zoom;
+}
+
+static void
+renderbench_do_export (HID_Attr_Val * options)
+{
+  DrawSearchStatsType search_stats;
+  const char *filename;
+  char **zooms;
+  int i, repeat, pass, n_zooms;
+  int *views;
+  double *seconds;
+  FILE *fp;
+
+  if (!options)
+    {
+      renderbench_get_export_options (0);
+      for (i = 0; i < NUM_OPTIONS; i++)
+	renderbench_values[i] = renderbench_options[i].default_val;
+      options = renderbench_values;
+    }
+
+  filename = options[HA_benchfile].str_value;
+  if (!filename)
+    filename = "pcb-out.bench";
+  bench_mode = options[HA_mode].int_value;
+  repeat = MAX (1, options[HA_repeat].int_value);
+  raster_w = raster_h = options[HA_raster_size].int_value;
+  use_lod = options[HA_lod].int_value;
+  zooms = g_strsplit (options[HA_zooms].str_value
+                      ? options[HA_zooms].str_value : "1", ",", 0);
+  n_zooms = g_strv_length (zooms);
+
+  if (strcmp (filename, "-") == 0)
+    fp = stdout;
+  else if ((fp = fopen (filename, "w")) == NULL)
+    {
+      Message (_("Cannot open file %s for writing\n"), filename);
+      g_strfreev (zooms);
+      return;
+    }
+
+  memset (&search_stats, 0, sizeof (search_stats));
+  memset (prim_count, 0, sizeof (prim_count));
+  memset (prim_seconds, 0, sizeof (prim_seconds));
+  group_index = g_hash_table_new (g_str_hash, g_str_equal);
+  groups = g_ptr_array_new_with_free_func (free_group_stats);
+  views = g_new0 (int, n_zooms);
+  seconds = g_new0 (double, n_zooms);
+  if (bench_mode == MODE_RASTER)
+    raster = (unsigned char *) malloc ((size_t) raster_w * raster_h);
+  timer = g_timer_new ();
+
+  draw_search_stats = &search_stats;
+  for (pass = 0; pass < repeat; pass++)
+    for (i = 0; i < n_zooms; i++)
+      {
+        int zoom = MAX (1, atoi (zooms[i]));
+        double start = g_timer_elapsed (timer, NULL);
+
+        views[i] += draw_zoom (zoom);
+        seconds[i] += g_timer_elapsed (timer, NULL) - start;
+      }
+  draw_search_stats = NULL;
+  draw_lod_pixel = -1;
+
+  fprintf (fp, "# %s, %s mode%s, %d pass%s\n",
+           PCB->Filename ? PCB->Filename : "(unnamed)", modes[bench_mode],
+           use_lod ? " with level of detail" : "",
+           repeat, repeat == 1 ? "" : "es");
+
+  fprintf (fp, "\n%-24s %10s %12s %12s\n",
+           "zoom", "viewports", "total ms", "ms/view");
+  for (i = 0; i < n_zooms; i++)
+    fprintf (fp, "%-24d %10d %12.3f %12.4f\n", MAX (1, atoi (zooms[i])),
+             views[i], seconds[i] * 1e3,
+             views[i] ? seconds[i] * 1e3 / views[i] : 0.0);
+
+  fprintf (fp, "\n%-24s %10s %12s\n", "layer group", "selected", "ms");
+  for (i = 0; i < groups->len; i++)
+    {
+      GroupStats *gs = (GroupStats *) g_ptr_array_index (groups, i);
+
+      fprintf (fp, "%-24s %10ld %12.3f\n",
+               gs->name, gs->selected, gs->seconds * 1e3);
+    }
+
+  fprintf (fp, "\n%-24s %10s %12s %12s %12s\n",
+           "search", "searches", "found", "tiles", "ms");
+  for (i = 0; i < N_DRAW_SEARCH_KINDS; i++)
+    fprintf (fp, "%-24s %10ld %12ld %12ld %12.3f\n", draw_search_names[i],
+             search_stats.searches[i], search_stats.found[i],
+             search_stats.tiles[i], search_stats.seconds[i] * 1e3);
+
+  fprintf (fp, "\n%-24s %10s %12s\n", "primitive", "count", "ms");
+  for (i = 0; i < N_PRIM_KINDS; i++)
+    fprintf (fp, "%-24s %10ld %12.3f\n",
+             prim_names[i], prim_count[i], prim_seconds[i] * 1e3);
+
+  if (fp != stdout)
+    fclose (fp);
+
+  g_timer_destroy (timer);
+  free (raster);
+  raster = NULL;
+  g_free (views);
+  g_free (seconds);
+  g_strfreev (zooms);
+  g_hash_table_destroy (group_index);
+  g_ptr_array_free (groups, TRUE);
+  cur_group = NULL;
+}
+
+static void
+renderbench_parse_arguments (int *argc, char ***argv)
+{
+  hid_register_attributes (renderbench_options,
+                           sizeof (renderbench_options) /
+                           sizeof (renderbench_options[0]));
+  hid_parse_command_line (argc, argv);
+}
+
+void
+hid_renderbench_init ()
+{
+  memset (&renderbench_hid, 0, sizeof (HID));
+  memset (&renderbench_graphics, 0, sizeof (HID_DRAW));
+
+  common_nogui_init (&renderbench_hid);
+  common_draw_helpers_init (&renderbench_graphics);
+
+  renderbench_hid.struct_size = sizeof (HID);
+  renderbench_hid.name        = "renderbench";
+  renderbench_hid.description = "Benchmark the screen drawing code";
+  renderbench_hid.exporter    = 1;
+  renderbench_hid.poly_after  = 1;	/* as the GTK GUI does */
+
+  renderbench_hid.get_export_options = renderbench_get_export_options;
+  renderbench_hid.do_export          = renderbench_do_export;
+  renderbench_hid.parse_arguments    = renderbench_parse_arguments;
+  renderbench_hid.set_layer          = renderbench_set_layer;
+
+  renderbench_hid.graphics           = &renderbench_graphics;
+
+  renderbench_graphics.make_gc        = renderbench_make_gc;
+  renderbench_graphics.destroy_gc     = renderbench_destroy_gc;
+  renderbench_graphics.use_mask       = renderbench_use_mask;
+  renderbench_graphics.set_color      = renderbench_set_color;
+  renderbench_graphics.set_line_cap   = renderbench_set_line_cap;
+  renderbench_graphics.set_line_width = renderbench_set_line_width;
+  renderbench_graphics.set_draw_xor   = renderbench_set_draw_xor;
+  renderbench_graphics.draw_line      = renderbench_draw_line;
+  renderbench_graphics.draw_arc       = renderbench_draw_arc;
+  renderbench_graphics.draw_rect      = renderbench_draw_rect;
+  renderbench_graphics.fill_circle    = renderbench_fill_circle;
+  renderbench_graphics.fill_polygon   = renderbench_fill_polygon;
+  renderbench_graphics.fill_rect      = renderbench_fill_rect;
+
+  hid_register_hid (&renderbench_hid);
+}
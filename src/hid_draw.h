@@ -40,6 +40,31 @@ enum mask_mode
 };
 
 
+/*!
+ * \brief A line of a batch passed to hid_draw_st::draw_lines.
+ */
+typedef struct
+{
+  Coord x1, y1, x2, y2;
+} HID_Line;
+
+/*!
+ * \brief An arc of a batch passed to hid_draw_st::draw_arcs.
+ */
+typedef struct
+{
+  Coord cx, cy, width, height;
+  Angle start_angle, delta_angle;
+} HID_Arc;
+
+/*!
+ * \brief A circle of a batch passed to hid_draw_st::fill_circles.
+ */
+typedef struct
+{
+  Coord cx, cy, radius;
+} HID_Circle;
+
 /*!
  * \brief Low level drawing API Drawing Functions.
  *
@@ -106,4 +131,13 @@ struct hid_draw_st
   void (*fill_pcb_pv) (hidGC fg_gc, hidGC bg_gc, PinType *pv, bool drawHole, bool mask);
   void (*thindraw_pcb_pv) (hidGC fg_gc, hidGC bg_gc, PinType *pv, bool drawHole, bool mask);
 
+  /* Batched versions of draw_line, draw_arc and fill_circle.  All the
+     primitives of one call are drawn with the same state of gc, so a
+     HID only has to apply it once per batch.  common_draw_helpers_init
+     installs versions which call the single primitive functions in a
+     loop; HIDs with a faster path override them.  */
+  void (*draw_lines)   (hidGC gc, int n_lines, const HID_Line *lines);
+  void (*draw_arcs)    (hidGC gc, int n_arcs, const HID_Arc *arcs);
+  void (*fill_circles) (hidGC gc, int n_circles, const HID_Circle *circles);
+
 };
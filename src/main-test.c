@@ -38,12 +38,24 @@
 #include "pcb-printf.h"
 #include "object_list.h"
 
+#ifdef ENABLE_GL
+#if defined HAVE_GL_GL_H
+#  include <GL/gl.h>
+#elif defined HAVE_OPENGL_GL_H
+#  include <OpenGL/gl.h>
+#endif
+#include "hid/common/hidgl_tess.h"
+#endif
+
 int
 main (int argc, char *argv[])
 {
   initialize_units ();
   pcb_printf_register_tests ();
   object_list_register_tests ();
+#ifdef ENABLE_GL
+  hidgl_tess_register_tests ();
+#endif
 
   g_test_init (&argc, &argv, NULL);
   g_test_run ();
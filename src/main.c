@@ -1106,6 +1106,18 @@ The default value is @code{60}.
   ISET (BackupInterval, 60, "backup-interval",
   "Time between automatic backups in seconds. Set to 0 to disable"),
 
+/* %start-doc options "1 General Options"
+@ftable @code
+@item --undo-memory <kilobytes>
+Amount of undo history kept in memory.  Older history is written to a
+temporary file and read back when an undo reaches it.  Set to @code{0}
+to keep all of it in memory, which is the default.
+@end ftable
+%end-doc
+*/
+  ISET (UndoMemory, 0, "undo-memory",
+  "Kilobytes of undo history kept in memory. Set to 0 for no limit"),
+
 /* %start-doc options "4 Layer Names"
 @ftable @code
 @item --layer-name-1 <string>
@@ -1564,6 +1576,17 @@ Pinout shows number.
 */
   BSET (ShowNumber, 0, "show-number", "Pinout shows number"),
 
+/* %start-doc options "2 General GUI Options"
+@ftable @code
+@item --full-detail
+Draw every object, even when zoomed far out.  By default, objects and
+crowded areas smaller than a couple of pixels are drawn as filled tiles.
+@end ftable
+%end-doc
+*/
+  BSET (FullDetail, 0, "full-detail",
+       "Draw every object, even when zoomed far out"),
+
 /* %start-doc options "1 General Options"
 @ftable @code
 @item --reset-after-element
@@ -102,6 +102,11 @@ static struct
   int cnt;
 } SavedStack;
 
+/*!
+ * \brief Expanded text strokes, see GetTextStrokes().
+ */
+static GHashTable *text_stroke_cache = NULL;
+
 /*!
  * \brief Distance() should be used so that there is only one place to
  * deal with overflow/precision errors.
@@ -791,81 +796,259 @@ CountHolesEx (int *plated, int *unplated, const BoxType *within_area, Cardinal g
 }
 
 /*!
- * \brief Gets minimum and maximum coordinates.
- *
- * \return NULL if layout is empty.
+ * \brief Scans every object for the minimum and maximum coordinates.
  */
-BoxType *
-GetDataBoundingBox (DataType *Data)
+static void
+ScanDataBoundingBox (DataType *Data, BoxType *box)
 {
-  static BoxType box;
-  /* FIX ME: use r_search to do this much faster */
-
-  /* preset identifiers with highest and lowest possible values */
-  box.X1 = box.Y1 = MAX_COORD;
-  box.X2 = box.Y2 = -MAX_COORD;
-
   /* now scan for the lowest/highest X and Y coordinate */
   VIA_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, via->X - via->Thickness / 2);
-    box.Y1 = MIN (box.Y1, via->Y - via->Thickness / 2);
-    box.X2 = MAX (box.X2, via->X + via->Thickness / 2);
-    box.Y2 = MAX (box.Y2, via->Y + via->Thickness / 2);
+    box->X1 = MIN (box->X1, via->X - via->Thickness / 2);
+    box->Y1 = MIN (box->Y1, via->Y - via->Thickness / 2);
+    box->X2 = MAX (box->X2, via->X + via->Thickness / 2);
+    box->Y2 = MAX (box->Y2, via->Y + via->Thickness / 2);
   }
   END_LOOP;
   ELEMENT_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, element->BoundingBox.X1);
-    box.Y1 = MIN (box.Y1, element->BoundingBox.Y1);
-    box.X2 = MAX (box.X2, element->BoundingBox.X2);
-    box.Y2 = MAX (box.Y2, element->BoundingBox.Y2);
+    box->X1 = MIN (box->X1, element->BoundingBox.X1);
+    box->Y1 = MIN (box->Y1, element->BoundingBox.Y1);
+    box->X2 = MAX (box->X2, element->BoundingBox.X2);
+    box->Y2 = MAX (box->Y2, element->BoundingBox.Y2);
     {
       TextType *text = &NAMEONPCB_TEXT (element);
-      box.X1 = MIN (box.X1, text->BoundingBox.X1);
-      box.Y1 = MIN (box.Y1, text->BoundingBox.Y1);
-      box.X2 = MAX (box.X2, text->BoundingBox.X2);
-      box.Y2 = MAX (box.Y2, text->BoundingBox.Y2);
+      box->X1 = MIN (box->X1, text->BoundingBox.X1);
+      box->Y1 = MIN (box->Y1, text->BoundingBox.Y1);
+      box->X2 = MAX (box->X2, text->BoundingBox.X2);
+      box->Y2 = MAX (box->Y2, text->BoundingBox.Y2);
     };
   }
   END_LOOP;
   ALLLINE_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, line->Point1.X - line->Thickness / 2);
-    box.Y1 = MIN (box.Y1, line->Point1.Y - line->Thickness / 2);
-    box.X1 = MIN (box.X1, line->Point2.X - line->Thickness / 2);
-    box.Y1 = MIN (box.Y1, line->Point2.Y - line->Thickness / 2);
-    box.X2 = MAX (box.X2, line->Point1.X + line->Thickness / 2);
-    box.Y2 = MAX (box.Y2, line->Point1.Y + line->Thickness / 2);
-    box.X2 = MAX (box.X2, line->Point2.X + line->Thickness / 2);
-    box.Y2 = MAX (box.Y2, line->Point2.Y + line->Thickness / 2);
+    box->X1 = MIN (box->X1, line->Point1.X - line->Thickness / 2);
+    box->Y1 = MIN (box->Y1, line->Point1.Y - line->Thickness / 2);
+    box->X1 = MIN (box->X1, line->Point2.X - line->Thickness / 2);
+    box->Y1 = MIN (box->Y1, line->Point2.Y - line->Thickness / 2);
+    box->X2 = MAX (box->X2, line->Point1.X + line->Thickness / 2);
+    box->Y2 = MAX (box->Y2, line->Point1.Y + line->Thickness / 2);
+    box->X2 = MAX (box->X2, line->Point2.X + line->Thickness / 2);
+    box->Y2 = MAX (box->Y2, line->Point2.Y + line->Thickness / 2);
   }
   ENDALL_LOOP;
   ALLARC_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, arc->BoundingBox.X1);
-    box.Y1 = MIN (box.Y1, arc->BoundingBox.Y1);
-    box.X2 = MAX (box.X2, arc->BoundingBox.X2);
-    box.Y2 = MAX (box.Y2, arc->BoundingBox.Y2);
+    box->X1 = MIN (box->X1, arc->BoundingBox.X1);
+    box->Y1 = MIN (box->Y1, arc->BoundingBox.Y1);
+    box->X2 = MAX (box->X2, arc->BoundingBox.X2);
+    box->Y2 = MAX (box->Y2, arc->BoundingBox.Y2);
   }
   ENDALL_LOOP;
   ALLTEXT_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, text->BoundingBox.X1);
-    box.Y1 = MIN (box.Y1, text->BoundingBox.Y1);
-    box.X2 = MAX (box.X2, text->BoundingBox.X2);
-    box.Y2 = MAX (box.Y2, text->BoundingBox.Y2);
+    box->X1 = MIN (box->X1, text->BoundingBox.X1);
+    box->Y1 = MIN (box->Y1, text->BoundingBox.Y1);
+    box->X2 = MAX (box->X2, text->BoundingBox.X2);
+    box->Y2 = MAX (box->Y2, text->BoundingBox.Y2);
   }
   ENDALL_LOOP;
   ALLPOLYGON_LOOP (Data);
   {
-    box.X1 = MIN (box.X1, polygon->BoundingBox.X1);
-    box.Y1 = MIN (box.Y1, polygon->BoundingBox.Y1);
-    box.X2 = MAX (box.X2, polygon->BoundingBox.X2);
-    box.Y2 = MAX (box.Y2, polygon->BoundingBox.Y2);
+    box->X1 = MIN (box->X1, polygon->BoundingBox.X1);
+    box->Y1 = MIN (box->Y1, polygon->BoundingBox.Y1);
+    box->X2 = MAX (box->X2, polygon->BoundingBox.X2);
+    box->Y2 = MAX (box->Y2, polygon->BoundingBox.Y2);
   }
   ENDALL_LOOP;
-  return (IsDataEmpty (Data) ? NULL : &box);
+}
+
+/*!
+ * \brief Extent of a via's copper, leaving out clearance and mask.
+ */
+static void
+ViaExtent (const BoxType *b, BoxType *extent)
+{
+  const PinType *via = (const PinType *) b;
+
+  extent->X1 = via->X - via->Thickness / 2;
+  extent->Y1 = via->Y - via->Thickness / 2;
+  extent->X2 = via->X + via->Thickness / 2;
+  extent->Y2 = via->Y + via->Thickness / 2;
+}
+
+/*!
+ * \brief Extent of a line's copper, leaving out the clearance.
+ */
+static void
+LineExtent (const BoxType *b, BoxType *extent)
+{
+  const LineType *line = (const LineType *) b;
+
+  extent->X1 = MIN (line->Point1.X, line->Point2.X) - line->Thickness / 2;
+  extent->Y1 = MIN (line->Point1.Y, line->Point2.Y) - line->Thickness / 2;
+  extent->X2 = MAX (line->Point1.X, line->Point2.X) + line->Thickness / 2;
+  extent->Y2 = MAX (line->Point1.Y, line->Point2.Y) + line->Thickness / 2;
+}
+
+struct extent_info
+{
+  void (*extent) (const BoxType *, BoxType *);
+  BoxType box;
+};
+
+static int
+extent_callback (const BoxType * b, void *cl)
+{
+  struct extent_info *info = (struct extent_info *) cl;
+  BoxType extent;
+
+  info->extent (b, &extent);
+  MAKEMIN (info->box.X1, extent.X1);
+  MAKEMIN (info->box.Y1, extent.Y1);
+  MAKEMAX (info->box.X2, extent.X2);
+  MAKEMAX (info->box.Y2, extent.Y2);
+  return 1;
+}
+
+/*!
+ * \brief Grows box by the extents of the objects in a tree, for objects
+ * whose extent lies inside their bounding box.
+ *
+ * For each side, the objects whose bounding boxes touch that side of
+ * the tree give a first guess; only objects whose bounding boxes reach
+ * past the guess can beat it, so a second, narrow search finishes the
+ * job.  Neither search visits the bulk of the tree.
+ */
+static void
+TreeExtents (rtree_t *tree, void (*extent) (const BoxType *, BoxType *),
+	     BoxType *box)
+{
+  struct extent_info info;
+  BoxType bounds, strip;
+
+  if (!r_bounds (tree, &bounds))
+    return;
+  info.extent = extent;
+  info.box.X1 = info.box.Y1 = MAX_COORD;
+  info.box.X2 = info.box.Y2 = -MAX_COORD;
+
+  strip = bounds;
+  strip.X2 = bounds.X1 + 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+  strip.X2 = info.box.X1 + 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+
+  strip = bounds;
+  strip.X1 = bounds.X2 - 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+  strip.X1 = info.box.X2 - 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+
+  strip = bounds;
+  strip.Y2 = bounds.Y1 + 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+  strip.Y2 = info.box.Y1 + 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+
+  strip = bounds;
+  strip.Y1 = bounds.Y2 - 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+  strip.Y1 = info.box.Y2 - 1;
+  r_search (tree, &strip, NULL, extent_callback, &info);
+
+  MAKEMIN (box->X1, info.box.X1);
+  MAKEMIN (box->Y1, info.box.Y1);
+  MAKEMAX (box->X2, info.box.X2);
+  MAKEMAX (box->Y2, info.box.Y2);
+}
+
+/*!
+ * \brief Grows box by the bounding boxes of everything in a tree.
+ */
+static void
+TreeBounds (rtree_t *tree, BoxType *box)
+{
+  BoxType bounds;
+
+  if (!r_bounds (tree, &bounds))
+    return;
+  MAKEMIN (box->X1, bounds.X1);
+  MAKEMIN (box->Y1, bounds.Y1);
+  MAKEMAX (box->X2, bounds.X2);
+  MAKEMAX (box->Y2, bounds.Y2);
+}
+
+/*!
+ * \brief Whether every object of Data is in its r-tree.
+ */
+static bool
+DataTreesComplete (DataType *Data)
+{
+  Cardinal i;
+
+#define TREE_HOLDS(tree, n) ((n) == 0 || ((tree) != NULL && (tree)->size == (n)))
+  if (!TREE_HOLDS (Data->via_tree, Data->ViaN)
+      || !TREE_HOLDS (Data->element_tree, Data->ElementN)
+      || !TREE_HOLDS (Data->name_tree[NAMEONPCB_INDEX], Data->ElementN))
+    return false;
+  for (i = 0; i < max_copper_layer + SILK_LAYER; i++)
+    {
+      LayerType *layer = &Data->Layer[i];
+
+      if (!TREE_HOLDS (layer->line_tree, layer->LineN)
+	  || !TREE_HOLDS (layer->arc_tree, layer->ArcN)
+	  || !TREE_HOLDS (layer->text_tree, layer->TextN)
+	  || !TREE_HOLDS (layer->polygon_tree, layer->PolygonN))
+	return false;
+    }
+#undef TREE_HOLDS
+  return true;
+}
+
+/*!
+ * \brief Gets minimum and maximum coordinates.
+ *
+ * The r-trees keep their bounds up to date as objects are inserted and
+ * removed, so this costs a few tree lookups per layer rather than a
+ * visit to every object.  Vias and lines are measured without their
+ * clearance, which their bounding boxes include, so for those only the
+ * objects at the edges of the tree are looked at.
+ *
+ * \return NULL if layout is empty.
+ */
+BoxType *
+GetDataBoundingBox (DataType *Data)
+{
+  static BoxType box;
+  Cardinal i;
+
+  /* preset identifiers with highest and lowest possible values */
+  box.X1 = box.Y1 = MAX_COORD;
+  box.X2 = box.Y2 = -MAX_COORD;
+
+  if (IsDataEmpty (Data))
+    return (NULL);
+
+  if (!DataTreesComplete (Data))
+    {
+      ScanDataBoundingBox (Data, &box);
+      return (&box);
+    }
+
+  TreeExtents (Data->via_tree, ViaExtent, &box);
+  TreeBounds (Data->element_tree, &box);
+  TreeBounds (Data->name_tree[NAMEONPCB_INDEX], &box);
+  for (i = 0; i < max_copper_layer + SILK_LAYER; i++)
+    {
+      LayerType *layer = &Data->Layer[i];
+
+      TreeExtents (layer->line_tree, LineExtent, &box);
+      TreeBounds (layer->arc_tree, &box);
+      TreeBounds (layer->text_tree, &box);
+      TreeBounds (layer->polygon_tree, &box);
+    }
+  return (&box);
 }
 
 /*!
@@ -963,6 +1146,198 @@ SetFontInfo (FontType *Ptr)
   Ptr->DefaultSymbol.X1 = Ptr->DefaultSymbol.Y1 = 0;
   Ptr->DefaultSymbol.X2 = Ptr->DefaultSymbol.X1 + Ptr->MaxWidth;
   Ptr->DefaultSymbol.Y2 = Ptr->DefaultSymbol.Y1 + Ptr->MaxHeight;
+
+  /* glyph geometry changed, so expanded strokes are stale */
+  if (text_stroke_cache != NULL)
+    g_hash_table_remove_all (text_stroke_cache);
+}
+
+/*
+ * Text stroke cache.
+ *
+ * Expanding a text object into strokes walks every glyph and scales,
+ * rotates and mirrors each of its lines.  Labels repeat a lot (the same
+ * value on many parts, the same refdes prefix at the same size), so the
+ * expansion is kept per string, scale, direction and side, relative to
+ * the text origin.  Users only add the text position.
+ */
+
+#define TEXT_STROKE_CACHE_MAX 4096
+
+typedef struct
+{
+  FontType *font;
+  char *string;
+  int scale;
+  BYTE direction;
+  bool onsolder;
+} TextStrokeKey;
+
+typedef struct
+{
+  TextStrokeKey key;
+  Cardinal n;
+  TextStrokeType *strokes;
+} TextStrokeEntry;
+
+static guint
+text_stroke_key_hash (gconstpointer data)
+{
+  const TextStrokeKey *key = (const TextStrokeKey *) data;
+  guint hash = g_str_hash (key->string);
+
+  hash = hash * 31 + (guint) key->scale;
+  hash = hash * 31 + key->direction;
+  return hash * 2 + key->onsolder;
+}
+
+static gboolean
+text_stroke_key_equal (gconstpointer a, gconstpointer b)
+{
+  const TextStrokeKey *ka = (const TextStrokeKey *) a;
+  const TextStrokeKey *kb = (const TextStrokeKey *) b;
+
+  return ka->font == kb->font && ka->scale == kb->scale &&
+    ka->direction == kb->direction && ka->onsolder == kb->onsolder &&
+    strcmp (ka->string, kb->string) == 0;
+}
+
+static void
+free_text_stroke_entry (gpointer data)
+{
+  TextStrokeEntry *entry = (TextStrokeEntry *) data;
+
+  g_free (entry->key.string);
+  g_free (entry->strokes);
+  g_slice_free (TextStrokeEntry, entry);
+}
+
+/*!
+ * \brief Expand a text object into strokes relative to its origin.
+ */
+static TextStrokeType *
+expand_text_strokes (FontType *font, TextType *Text, Cardinal *n)
+{
+  GArray *strokes = g_array_new (FALSE, FALSE, sizeof (TextStrokeType));
+  unsigned char *string = (unsigned char *) Text->TextString;
+  Coord x = 0;
+  Cardinal i;
+
+  for (; *string; string++)
+    {
+      TextStrokeType stroke;
+
+      if (*string <= MAX_FONTPOSITION && font->Symbol[*string].Valid)
+        {
+          LineType *line = font->Symbol[*string].Line;
+          LineType newline;
+
+          for (i = font->Symbol[*string].LineN; i; i--, line++)
+            {
+              /* scale, move, rotate and swap it */
+              newline = *line;
+              newline.Point1.X = SCALE_TEXT (newline.Point1.X + x, Text->Scale);
+              newline.Point1.Y = SCALE_TEXT (newline.Point1.Y, Text->Scale);
+              newline.Point2.X = SCALE_TEXT (newline.Point2.X + x, Text->Scale);
+              newline.Point2.Y = SCALE_TEXT (newline.Point2.Y, Text->Scale);
+              RotateLineLowLevel (&newline, 0, 0, Text->Direction);
+
+              /* the labels of SMD objects on the bottom
+               * side haven't been swapped yet, only their offset
+               */
+              if (TEST_FLAG (ONSOLDERFLAG, Text))
+                {
+                  newline.Point1.X = SWAP_SIGN_X (newline.Point1.X);
+                  newline.Point1.Y = SWAP_SIGN_Y (newline.Point1.Y);
+                  newline.Point2.X = SWAP_SIGN_X (newline.Point2.X);
+                  newline.Point2.Y = SWAP_SIGN_Y (newline.Point2.Y);
+                }
+              stroke.X1 = newline.Point1.X;
+              stroke.Y1 = newline.Point1.Y;
+              stroke.X2 = newline.Point2.X;
+              stroke.Y2 = newline.Point2.Y;
+              stroke.Thickness = SCALE_TEXT (line->Thickness, Text->Scale / 2);
+              stroke.Box = false;
+              g_array_append_val (strokes, stroke);
+            }
+
+          /* move on to next cursor position */
+          x += (font->Symbol[*string].Width + font->Symbol[*string].Delta);
+        }
+      else
+        {
+          /* the default symbol is a filled box */
+          BoxType defaultsymbol = font->DefaultSymbol;
+          Coord size = (defaultsymbol.X2 - defaultsymbol.X1) * 6 / 5;
+
+          defaultsymbol.X1 = SCALE_TEXT (defaultsymbol.X1 + x, Text->Scale);
+          defaultsymbol.Y1 = SCALE_TEXT (defaultsymbol.Y1, Text->Scale);
+          defaultsymbol.X2 = SCALE_TEXT (defaultsymbol.X2 + x, Text->Scale);
+          defaultsymbol.Y2 = SCALE_TEXT (defaultsymbol.Y2, Text->Scale);
+          RotateBoxLowLevel (&defaultsymbol, 0, 0, Text->Direction);
+
+          stroke.X1 = defaultsymbol.X1;
+          stroke.Y1 = defaultsymbol.Y1;
+          stroke.X2 = defaultsymbol.X2;
+          stroke.Y2 = defaultsymbol.Y2;
+          stroke.Thickness = 0;
+          stroke.Box = true;
+          g_array_append_val (strokes, stroke);
+
+          /* move on to next cursor position */
+          x += size;
+        }
+    }
+
+  *n = strokes->len;
+  return (TextStrokeType *) g_array_free (strokes, FALSE);
+}
+
+/*!
+ * \brief Get the strokes that make up a text object.
+ *
+ * Line strokes and default-symbol boxes come in drawing order, relative
+ * to the text origin; add Text->X and Text->Y to place them.  Thickness
+ * is the scaled font thickness, before any minimum line width is applied.
+ *
+ * The array belongs to the cache and stays valid until the next call or
+ * the next change of font.
+ */
+const TextStrokeType *
+GetTextStrokes (FontType *font, TextType *Text, Cardinal *n)
+{
+  TextStrokeKey key;
+  TextStrokeEntry *entry;
+
+  *n = 0;
+  if (Text->TextString == NULL || *Text->TextString == '\0')
+    return NULL;
+
+  key.font = font;
+  key.string = Text->TextString;
+  key.scale = Text->Scale;
+  key.direction = Text->Direction;
+  key.onsolder = TEST_FLAG (ONSOLDERFLAG, Text) ? true : false;
+
+  if (text_stroke_cache == NULL)
+    text_stroke_cache = g_hash_table_new_full (text_stroke_key_hash,
+                                               text_stroke_key_equal,
+                                               NULL, free_text_stroke_entry);
+  entry = (TextStrokeEntry *) g_hash_table_lookup (text_stroke_cache, &key);
+  if (entry == NULL)
+    {
+      if (g_hash_table_size (text_stroke_cache) >= TEXT_STROKE_CACHE_MAX)
+        g_hash_table_remove_all (text_stroke_cache);
+
+      entry = g_slice_new (TextStrokeEntry);
+      entry->key = key;
+      entry->key.string = g_strdup (key.string);
+      entry->strokes = expand_text_strokes (font, Text, &entry->n);
+      g_hash_table_replace (text_stroke_cache, &entry->key, entry);
+    }
+
+  *n = entry->n;
+  return entry->strokes;
 }
 
 static Coord
@@ -1952,28 +2327,13 @@ BumpName (char *Name)
 char *
 UniqueElementName (DataType *Data, char *Name)
 {
-  bool unique = true;
   /* null strings are ok */
   if (!Name || !*Name)
     return (Name);
 
-  for (;;)
-    {
-      ELEMENT_LOOP (Data);
-      {
-        if (NAMEONPCB_NAME (element) &&
-            NSTRCMP (NAMEONPCB_NAME (element), Name) == 0)
-          {
-            Name = BumpName (Name);
-            unique = false;
-            break;
-          }
-      }
-      END_LOOP;
-      if (unique)
-        return (Name);
-      unique = true;
-    }
+  while (SearchElementByName (Data, Name) != NULL)
+    Name = BumpName (Name);
+  return (Name);
 }
 
 static void
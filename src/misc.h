@@ -39,6 +39,19 @@
 #include "global.h"
 #include "mymem.h"
 
+/*!
+ * \brief One stroke of an expanded text object.
+ *
+ * Either a line from (X1, Y1) to (X2, Y2), or, for characters the font
+ * has no glyph for, a filled box with those corners.
+ */
+typedef struct
+{
+  Coord X1, Y1, X2, Y2;
+  Coord Thickness;		/*!< Line width; 0 for boxes. */
+  bool Box;			/*!< Filled default-symbol box. */
+} TextStrokeType;
+
 enum unitflags { UNIT_PERCENT = 1 };
 
 typedef struct {
@@ -75,6 +88,7 @@ void QuitApplication (void);
 char *EvaluateFilename (char *, char *, char *, char *);
 char *ExpandFilename (char *, char *);
 void SetTextBoundingBox (FontType *, TextType *);
+const TextStrokeType *GetTextStrokes (FontType *, TextType *, Cardinal *);
 
 void SaveOutputWindow (void);
 int GetLayerNumber (DataType *, LayerType *);
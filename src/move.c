@@ -112,6 +112,7 @@ void
 MoveElementLowLevel (DataType *Data, ElementType *Element,
 		     Coord DX, Coord DY)
 {
+  BeginPolygonBatch ();
   if (Data)
     r_delete_entry (Data->element_tree, (BoxType *)Element);
   ELEMENTLINE_LOOP (Element);
@@ -168,6 +169,7 @@ MoveElementLowLevel (DataType *Data, ElementType *Element,
   MOVE (Element->MarkX, Element->MarkY, DX, DY);
   if (Data)
     r_insert_entry (Data->element_tree, (BoxType *)Element, 0);
+  EndPolygonBatch ();
 }
 
 /*!
@@ -436,10 +438,13 @@ MoveLineToLayerLowLevel (LayerType *Source, LineType *line,
 {
   r_delete_entry (Source->line_tree, (BoxType *)line);
 
-  Source->Line = g_list_remove (Source->Line, line);
+  RemoveObjectFromList (&Source->Line, &Source->LineTail,
+			(AnyObjectType *) line);
   Source->LineN --;
-  Destination->Line = g_list_append (Destination->Line, line);
+  AppendObjectToList (&Destination->Line, &Destination->LineTail,
+		      (AnyObjectType *) line);
   Destination->LineN ++;
+  UpdateSelectionIndex (LINE_TYPE, Destination, line, true);
 
   if (!Destination->line_tree)
     Destination->line_tree = r_create_tree (NULL, 0, 0);
@@ -456,10 +461,12 @@ MoveArcToLayerLowLevel (LayerType *Source, ArcType *arc,
 {
   r_delete_entry (Source->arc_tree, (BoxType *)arc);
 
-  Source->Arc = g_list_remove (Source->Arc, arc);
+  RemoveObjectFromList (&Source->Arc, &Source->ArcTail, (AnyObjectType *) arc);
   Source->ArcN --;
-  Destination->Arc = g_list_append (Destination->Arc, arc);
+  AppendObjectToList (&Destination->Arc, &Destination->ArcTail,
+		      (AnyObjectType *) arc);
   Destination->ArcN ++;
+  UpdateSelectionIndex (ARC_TYPE, Destination, arc, true);
 
   if (!Destination->arc_tree)
     Destination->arc_tree = r_create_tree (NULL, 0, 0);
@@ -650,10 +657,13 @@ MoveTextToLayerLowLevel (LayerType *Source, TextType *text,
   RestoreToPolygon (PCB->Data, TEXT_TYPE, Source, text);
   r_delete_entry (Source->text_tree, (BoxType *)text);
 
-  Source->Text = g_list_remove (Source->Text, text);
+  RemoveObjectFromList (&Source->Text, &Source->TextTail,
+			(AnyObjectType *) text);
   Source->TextN --;
-  Destination->Text = g_list_append (Destination->Text, text);
+  AppendObjectToList (&Destination->Text, &Destination->TextTail,
+		      (AnyObjectType *) text);
   Destination->TextN ++;
+  UpdateSelectionIndex (TEXT_TYPE, Destination, text, true);
 
   if (GetLayerGroupNumberBySide (BOTTOM_SIDE) ==
       GetLayerGroupNumberByPointer (Destination))
@@ -705,10 +715,13 @@ MovePolygonToLayerLowLevel (LayerType *Source, PolygonType *polygon,
 {
   r_delete_entry (Source->polygon_tree, (BoxType *)polygon);
 
-  Source->Polygon = g_list_remove (Source->Polygon, polygon);
+  RemoveObjectFromList (&Source->Polygon, &Source->PolygonTail,
+			(AnyObjectType *) polygon);
   Source->PolygonN --;
-  Destination->Polygon = g_list_append (Destination->Polygon, polygon);
+  AppendObjectToList (&Destination->Polygon, &Destination->PolygonTail,
+		      (AnyObjectType *) polygon);
   Destination->PolygonN ++;
+  UpdateSelectionIndex (POLYGON_TYPE, Destination, polygon, true);
 
   if (!Destination->polygon_tree)
     Destination->polygon_tree = r_create_tree (NULL, 0, 0);
@@ -978,6 +991,9 @@ MoveLayer (int old_index, int new_index)
       return 1;
     }
 
+  /* the layer array is about to be shuffled */
+  InvalidateSelectionIndex (PCB->Data);
+
   for (l = 0; l < MAX_ALL_LAYER; l++)
     group_of_layer[l] = -1;
 
@@ -107,6 +107,8 @@ struct vetting
 
 #define SPECIAL 823157
 
+mtspace_counters_t mtspace_counters;
+
 mtspacebox_t *
 mtspace_create_box (const BoxType * box, Coord keepaway)
 {
@@ -476,6 +478,7 @@ mtspace_query_rect (mtspace_t * mtspace, const BoxType * region,
 {
   struct query_closure qc;
 
+  mtspace_counters.queries++;
   /* pre-assertions */
   assert (free_space_vec);
   assert (lo_conflict_space_vec);
@@ -528,6 +531,8 @@ mtspace_query_rect (mtspace_t * mtspace, const BoxType * region,
   do
     {
       heap_or_vector temporary = {free_space_vec};
+
+      mtspace_counters.iterations++;
       /* search the fixed object tree discarding any intersections
        * and placing empty regions in the no_fix vector.
        */
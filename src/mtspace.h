@@ -78,4 +78,16 @@ vetting_t *mtspace_query_rect (mtspace_t * mtspace, const BoxType * region,
 void mtsFreeWork (vetting_t **);
 int mtsBoxCount (vetting_t *);
 
+/*!
+ * \brief Running totals of the work done by mtspace_query_rect(), read
+ * by the autorouter statistics.
+ */
+typedef struct
+{
+  long queries;			/*!< Calls to mtspace_query_rect(). */
+  long iterations;		/*!< Passes through its vetting loop. */
+} mtspace_counters_t;
+
+extern mtspace_counters_t mtspace_counters;
+
 #endif /* ! PCB_MTSPACE_H */
@@ -41,11 +41,18 @@
 #include <memory.h>
 
 #include "data.h"
+#include "drill.h"
 #include "error.h"
 #include "mymem.h"
 #include "misc.h"
 #include "rats.h"
 #include "rtree.h"
+#include "search.h"
+#include "select.h"
+
+#ifdef ENABLE_GL
+#include "hid/common/hidgl_tess.h"
+#endif
 
 #ifdef HAVE_LIBDMALLOC
 #include <dmalloc.h>
@@ -204,6 +211,58 @@ GetNetListMemory (NetListListType *Netlistlist)
   return (netlist + Netlistlist->NetListN++);
 }
 
+/*!
+ * \brief Appends an object to one of the object lists of a layer,
+ * element or data struct.
+ *
+ * \c Tail is the matching *Tail field of the owner, it saves walking
+ * the whole list to find its end.  The node holding the object is
+ * remembered in the object itself so RemoveObjectFromList() can unlink
+ * it without a search.
+ */
+void
+AppendObjectToList (GList **List, GList **Tail, AnyObjectType *Object)
+{
+  GList *link = g_list_alloc ();
+
+  link->data = Object;
+  link->next = NULL;
+  if (*List == NULL)
+    {
+      link->prev = NULL;
+      *List = link;
+    }
+  else
+    {
+      if (*Tail == NULL)
+	*Tail = g_list_last (*List);
+      link->prev = *Tail;
+      (*Tail)->next = link;
+    }
+  *Tail = link;
+  Object->Link = link;
+}
+
+/*!
+ * \brief Removes an object added with AppendObjectToList() from its
+ * list.
+ */
+void
+RemoveObjectFromList (GList **List, GList **Tail, AnyObjectType *Object)
+{
+  GList *link = Object->Link;
+
+  if (link == NULL || link->data != Object)
+    link = g_list_find (*List, Object);
+  if (link == NULL)
+    return;
+
+  if (*Tail == link)
+    *Tail = link->prev;
+  *List = g_list_delete_link (*List, link);
+  Object->Link = NULL;
+}
+
 /*!
  * \brief Get the next slot for a pin.
  *
@@ -215,7 +274,8 @@ GetPinMemory (ElementType *element)
   PinType *new_obj;
 
   new_obj = g_slice_new0 (PinType);
-  element->Pin = g_list_append (element->Pin, new_obj);
+  AppendObjectToList (&element->Pin, &element->PinTail,
+		      (AnyObjectType *) new_obj);
   element->PinN ++;
 
   return new_obj;
@@ -238,7 +298,8 @@ GetPadMemory (ElementType *element)
   PadType *new_obj;
 
   new_obj = g_slice_new0 (PadType);
-  element->Pad = g_list_append (element->Pad, new_obj);
+  AppendObjectToList (&element->Pad, &element->PadTail,
+		      (AnyObjectType *) new_obj);
   element->PadN ++;
 
   return new_obj;
@@ -261,7 +322,7 @@ GetViaMemory (DataType *data)
   PinType *new_obj;
 
   new_obj = g_slice_new0 (PinType);
-  data->Via = g_list_append (data->Via, new_obj);
+  AppendObjectToList (&data->Via, &data->ViaTail, (AnyObjectType *) new_obj);
   data->ViaN ++;
 
   return new_obj;
@@ -284,7 +345,7 @@ GetRatMemory (DataType *data)
   RatType *new_obj;
 
   new_obj = g_slice_new0 (RatType);
-  data->Rat = g_list_append (data->Rat, new_obj);
+  AppendObjectToList (&data->Rat, &data->RatTail, (AnyObjectType *) new_obj);
   data->RatN ++;
 
   return new_obj;
@@ -307,7 +368,8 @@ GetLineMemory (LayerType *layer)
   LineType *new_obj;
 
   new_obj = g_slice_new0 (LineType);
-  layer->Line = g_list_append (layer->Line, new_obj);
+  AppendObjectToList (&layer->Line, &layer->LineTail,
+		      (AnyObjectType *) new_obj);
   layer->LineN ++;
 
   return new_obj;
@@ -330,7 +392,7 @@ GetArcMemory (LayerType *layer)
   ArcType *new_obj;
 
   new_obj = g_slice_new0 (ArcType);
-  layer->Arc = g_list_append (layer->Arc, new_obj);
+  AppendObjectToList (&layer->Arc, &layer->ArcTail, (AnyObjectType *) new_obj);
   layer->ArcN ++;
 
   return new_obj;
@@ -353,7 +415,8 @@ GetTextMemory (LayerType *layer)
   TextType *new_obj;
 
   new_obj = g_slice_new0 (TextType);
-  layer->Text = g_list_append (layer->Text, new_obj);
+  AppendObjectToList (&layer->Text, &layer->TextTail,
+		      (AnyObjectType *) new_obj);
   layer->TextN ++;
 
   return new_obj;
@@ -376,7 +439,8 @@ GetPolygonMemory (LayerType *layer)
   PolygonType *new_obj;
 
   new_obj = g_slice_new0 (PolygonType);
-  layer->Polygon = g_list_append (layer->Polygon, new_obj);
+  AppendObjectToList (&layer->Polygon, &layer->PolygonTail,
+		      (AnyObjectType *) new_obj);
   layer->PolygonN ++;
 
   return new_obj;
@@ -446,7 +510,8 @@ GetElementMemory (DataType *data)
 
   if (data != NULL)
     {
-      data->Element = g_list_append (data->Element, new_obj);
+      AppendObjectToList (&data->Element, &data->ElementTail,
+			  (AnyObjectType *) new_obj);
       data->ElementN ++;
     }
 
@@ -478,6 +543,7 @@ GetLibraryMenuMemory (LibraryType *lib)
       memset (menu + lib->MenuN, 0,
 	      STEP_LIBRARYMENU * sizeof (LibraryMenuType));
     }
+  netlist_serial++;
   return (menu + lib->MenuN++);
 }
 
@@ -500,57 +566,10 @@ GetLibraryEntryMemory (LibraryMenuType *Menu)
       memset (entry + Menu->EntryN, 0,
 	      STEP_LIBRARYENTRY * sizeof (LibraryEntryType));
     }
+  netlist_serial++;
   return (entry + Menu->EntryN++);
 }
 
-/*!
- * \brief Get the next slot for a DrillElement.
- *
- * Allocates memory if necessary.
- */
-ElementType **
-GetDrillElementMemory (DrillType *Drill)
-{
-  ElementType **element;
-
-  element = Drill->Element;
-
-  /* realloc new memory if necessary and clear it */
-  if (Drill->ElementN >= Drill->ElementMax)
-    {
-      Drill->ElementMax += STEP_ELEMENT;
-      element = (ElementType **)realloc (element,
-                         Drill->ElementMax * sizeof (ElementType *));
-      Drill->Element = element;
-      memset (element + Drill->ElementN, 0,
-	      STEP_ELEMENT * sizeof (ElementType *));
-    }
-  return (element + Drill->ElementN++);
-}
-
-/*!
- * \brief Get the next slot for a DrillPoint.
- *
- * Allocates memory if necessary.
- */
-PinType **
-GetDrillPinMemory (DrillType *Drill)
-{
-  PinType **pin;
-
-  pin = Drill->Pin;
-
-  /* realloc new memory if necessary and clear it */
-  if (Drill->PinN >= Drill->PinMax)
-    {
-      Drill->PinMax += STEP_POINT;
-      pin = (PinType **)realloc (pin, Drill->PinMax * sizeof (PinType *));
-      Drill->Pin = pin;
-      memset (pin + Drill->PinN, 0, STEP_POINT * sizeof (PinType *));
-    }
-  return (pin + Drill->PinN++);
-}
-
 /*!
  * \brief Get the next slot for a Drill.
  *
@@ -588,6 +607,10 @@ FreePolygonMemory (PolygonType *polygon)
     poly_Free (&polygon->Clipped);
   poly_FreeContours (&polygon->NoHoles);
 
+#ifdef ENABLE_GL
+  hidgl_forget_polygon (polygon);
+#endif
+
   memset (polygon, 0, sizeof (PolygonType));
 }
 
@@ -679,6 +702,7 @@ FreeElementMemory (ElementType *element)
   if (element == NULL)
     return;
 
+  ForgetElementTerminals (element);
   ELEMENTNAME_LOOP (element);
   {
     free (textstring);
@@ -806,6 +830,9 @@ FreeDataMemory (DataType *data)
     r_destroy_tree (&data->pad_tree);
   if (data->rat_tree)
     r_destroy_tree (&data->rat_tree);
+  InvalidateDrillInfo (data);
+  InvalidateSelectionIndex (data);
+  InvalidateElementNameIndex (data);
   /* clear struct */
   memset (data, 0, sizeof (DataType));
 }
@@ -829,6 +856,7 @@ FreeLibraryMemory (LibraryType *lib)
   }
   END_LOOP;
   free (lib->Menu);
+  netlist_serial++;
 
   /* clear struct */
   memset (lib, 0, sizeof (LibraryType));
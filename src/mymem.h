@@ -45,13 +45,11 @@
 /* ---------------------------------------------------------------------------
  * number of additional objects that are allocated with one system call
  */
-#define	STEP_ELEMENT		50
 #define STEP_DRILL		30
 #define STEP_POINT		100
 #define	STEP_SYMBOLLINE		10
 #define	STEP_SELECTORENTRY	128
 #define	STEP_REMOVELIST		500
-#define	STEP_UNDOLIST		500
 #define	STEP_POLYGONPOINT	10
 #define	STEP_POLYGONHOLEINDEX	10
 #define	STEP_LIBRARYMENU	10
@@ -69,6 +67,8 @@ typedef struct
   char *Data;
 } DynamicStringType;
 
+void AppendObjectToList (GList **, GList **, AnyObjectType *);
+void RemoveObjectFromList (GList **, GList **, AnyObjectType *);
 RubberbandType * GetRubberbandMemory (void);
 PinType * GetPinMemory (ElementType *);
 PadType * GetPadMemory (ElementType *);
@@ -87,8 +87,6 @@ NetType * GetNetMemory (NetListType *);
 NetListType * GetNetListMemory (NetListListType *);
 LibraryMenuType * GetLibraryMenuMemory (LibraryType *);
 LibraryEntryType * GetLibraryEntryMemory (LibraryMenuType *);
-ElementType **GetDrillElementMemory (DrillType *);
-PinType ** GetDrillPinMemory (DrillType *);
 DrillType * GetDrillInfoDrillMemory (DrillInfoType *);
 void **GetPointerMemory (PointerListType *);
 void FreePolygonMemory (PolygonType *);
@@ -89,6 +89,102 @@ typedef void (*NFunc) (LibraryMenuType *, LibraryEntryType *);
 int netlist_frozen = 0;
 static int netlist_needs_update = 0;
 
+/*!
+ * \brief Bumped whenever nets or connections are added, removed or
+ * reordered.
+ */
+unsigned long netlist_serial = 0;
+
+/*!
+ * \brief Net and node name indexes of PCB->NetlistLib.
+ *
+ * Values are menu indexes plus one.  The indexes are rebuilt on the next
+ * lookup after netlist_serial moves; netlist_add() keeps them current for
+ * its own additions.
+ */
+static struct
+{
+  GHashTable *Nets; /*!< Net name -> menu. */
+  GHashTable *Nodes; /*!< Node -> first menu listing it. */
+  LibraryType *Lib;
+  unsigned long Serial;
+} NetIndex;
+
+static bool
+NetIndexCurrent (void)
+{
+  return NetIndex.Nets != NULL && NetIndex.Lib == &PCB->NetlistLib
+    && NetIndex.Serial == netlist_serial;
+}
+
+static void
+IndexNet (int ni)
+{
+  LibraryMenuType *menu = &PCB->NetlistLib.Menu[ni];
+  int pi;
+
+  if (menu->Name && !g_hash_table_lookup (NetIndex.Nets, menu->Name + 2))
+    g_hash_table_insert (NetIndex.Nets, g_strdup (menu->Name + 2),
+			 GINT_TO_POINTER (ni + 1));
+  for (pi = 0; pi < menu->EntryN; pi++)
+    {
+      char *node = menu->Entry[pi].ListEntry;
+      int first;
+
+      if (node == NULL)
+	continue;
+      first = GPOINTER_TO_INT (g_hash_table_lookup (NetIndex.Nodes, node));
+      if (first == 0 || first > ni + 1)
+	g_hash_table_insert (NetIndex.Nodes, g_strdup (node),
+			     GINT_TO_POINTER (ni + 1));
+    }
+}
+
+static void
+BuildNetIndex (void)
+{
+  int ni;
+
+  if (NetIndex.Nets == NULL)
+    {
+      NetIndex.Nets = g_hash_table_new_full (g_str_hash, g_str_equal,
+					     g_free, NULL);
+      NetIndex.Nodes = g_hash_table_new_full (g_str_hash, g_str_equal,
+					      g_free, NULL);
+    }
+  g_hash_table_remove_all (NetIndex.Nets);
+  g_hash_table_remove_all (NetIndex.Nodes);
+  for (ni = 0; ni < PCB->NetlistLib.MenuN; ni++)
+    IndexNet (ni);
+  NetIndex.Lib = &PCB->NetlistLib;
+  NetIndex.Serial = netlist_serial;
+}
+
+/*!
+ * \brief Looks a net or node name up in the index.
+ *
+ * \return The menu index, -1 if not found.
+ */
+static int
+NetIndexLookup (GHashTable **table, const char *name)
+{
+  LibraryType *lib = &PCB->NetlistLib;
+  int ni;
+
+  if (!NetIndexCurrent ())
+    BuildNetIndex ();
+  ni = GPOINTER_TO_INT (g_hash_table_lookup (*table, name)) - 1;
+  if (ni >= lib->MenuN
+      || (ni >= 0 && table == &NetIndex.Nets
+	  && strcmp (lib->Menu[ni].Name + 2, name) != 0))
+    {
+      /* The netlist changed without netlist_serial noticing. */
+      BuildNetIndex ();
+      ni = GPOINTER_TO_INT (g_hash_table_lookup (*table, name)) - 1;
+    }
+  return ni;
+}
+
 void
 NetlistChanged (int force_unfreeze)
 {
@@ -106,20 +202,9 @@ NetlistChanged (int force_unfreeze)
 LibraryMenuType *
 netnode_to_netname (char *nodename)
 {
-  int i, j;
-  /*printf("nodename [%s]\n", nodename);*/
-  for (i=0; i<PCB->NetlistLib.MenuN; i++)
-    {
-      for (j=0; j<PCB->NetlistLib.Menu[i].EntryN; j++)
-	{
-	  if (strcmp (PCB->NetlistLib.Menu[i].Entry[j].ListEntry, nodename) == 0)
-	    {
-	      /*printf(" in [%s]\n", PCB->NetlistLib.Menu[i].Name);*/
-	      return & (PCB->NetlistLib.Menu[i]);
-	    }
-	}
-    }
-  return 0;
+  int i = NetIndexLookup (&NetIndex.Nodes, nodename);
+
+  return i < 0 ? 0 : & (PCB->NetlistLib.Menu[i]);
 }
 
 LibraryMenuType *
@@ -132,14 +217,8 @@ netname_to_netname (char *netname)
       /* Looks like we were passed an internal netname, skip the prefix */
       netname += 2;
     }
-  for (i=0; i<PCB->NetlistLib.MenuN; i++)
-    {
-      if (strcmp (PCB->NetlistLib.Menu[i].Name + 2, netname) == 0)
-	{
-	  return & (PCB->NetlistLib.Menu[i]);
-	}
-    }
-  return 0;
+  i = NetIndexLookup (&NetIndex.Nets, netname);
+  return i < 0 ? 0 : & (PCB->NetlistLib.Menu[i]);
 }
 
 static int
@@ -222,6 +301,7 @@ netlist_clear (LibraryMenuType * net, LibraryEntryType * pin)
 	  if (netlist->MenuN - ni > 1)
 	    memmove (net, net+1, (netlist->MenuN - ni - 1) * sizeof (*net));
 	  netlist->MenuN --;
+	  netlist_serial++;
 	}
     }
   else
@@ -236,6 +316,7 @@ netlist_clear (LibraryMenuType * net, LibraryEntryType * pin)
 	  if (net->EntryN - pi > 1)
 	    memmove (pin, pin+1, (net->EntryN - pi - 1) * sizeof (*pin));
 	  net->EntryN --;
+	  netlist_serial++;
 	}
     }
   NetlistChanged (0);
@@ -260,15 +341,13 @@ netlist_add (const char *netname, const char *pinname)
   LibraryMenuType *net = NULL;
   LibraryEntryType *pin = NULL;
 
-  for (ni=0; ni<netlist->MenuN; ni++)
-    if (strcmp (netlist->Menu[ni].Name+2, netname) == 0)
-      {
-	net = & (netlist->Menu[ni]);
-	break;
-      }
-  if (net == NULL)
+  ni = NetIndexLookup (&NetIndex.Nets, netname);
+  if (ni >= 0)
+    net = & (netlist->Menu[ni]);
+  else
     {
       net = CreateNewNet (netlist, (char *)netname, NULL);
+      ni = net - netlist->Menu;
     }
 
   for (pi=0; pi<net->EntryN; pi++)
@@ -282,6 +361,10 @@ netlist_add (const char *netname, const char *pinname)
       pin = CreateNewConnection (net, (char *)pinname);
     }
 
+  /* the lookup above left the index current, so extend it in place */
+  IndexNet (ni);
+  NetIndex.Serial = netlist_serial;
+
   NetlistChanged (0);
   return 0;
 }
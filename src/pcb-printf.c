@@ -314,6 +314,77 @@ static int min_sig_figs(double d)
   return rv;
 }
 
+/*!
+ * \brief Destination of the pcb-printf formatter.
+ *
+ * Exactly one of \c string, \c file and \c buffer is used.  Writing
+ * to a file or to a caller's buffer needs no heap memory.
+ */
+typedef struct
+{
+  GString *string; /*!< Append to this string. */
+  FILE *file; /*!< Write through stdio to this file. */
+  char *buffer; /*!< Copy into this buffer, truncating. */
+  size_t size; /*!< Size of \c buffer. */
+  size_t length; /*!< Number of bytes produced so far. */
+  bool error; /*!< A write to \c file failed. */
+} PrintfOutput;
+
+static void
+output_append (PrintfOutput *out, const char *str, size_t len)
+{
+  if (out->string != NULL)
+    g_string_append_len (out->string, str, len);
+  else if (out->file != NULL)
+    {
+      if (fwrite (str, 1, len, out->file) != len)
+        out->error = true;
+    }
+  else if (out->buffer != NULL && out->length + 1 < out->size)
+    memcpy (out->buffer + out->length, str,
+            MIN (len, out->size - 1 - out->length));
+  out->length += len;
+}
+
+static void
+output_append_c (PrintfOutput *out, char c)
+{
+  output_append (out, &c, 1);
+}
+
+/*!
+ * \brief printf one conversion to the output.
+ *
+ * Short results, which is nearly all of them, are formatted on the
+ * stack; only longer ones fall back to an allocated string.
+ */
+static void
+output_printf (PrintfOutput *out, const char *spec, ...)
+{
+  char buffer[256];
+  va_list args;
+  int len;
+
+  va_start (args, spec);
+  len = vsnprintf (buffer, sizeof buffer, spec, args);
+  va_end (args);
+  if (len < 0)
+    return;
+  /* like the strings this used to build, stop at an embedded NUL */
+  if (len < (int) sizeof buffer)
+    output_append (out, buffer, strlen (buffer));
+  else
+    {
+      gchar *tmp;
+
+      va_start (args, spec);
+      tmp = g_strdup_vprintf (spec, args);
+      va_end (args);
+      output_append (out, tmp, strlen (tmp));
+      g_free (tmp);
+    }
+}
+
 /*!
  * \brief Internal coord-to-string converter for pcb-printf.
  *
@@ -322,31 +393,23 @@ static int min_sig_figs(double d)
  * given, the list is enclosed in parens to make the scope of
  * the unit suffix clear.
  *
+ * \param [in] out          Where to write the formatted coords.
  * \param [in] coord        Array of coords to convert.
- * \param [in] n_coords     Number of coords in array.
+ * \param [in] n_coords     Number of coords in array, at most 10.
  * \param [in] printf_spec  printf sub-specifier to use with %f.
  * \param [in] e_allow      Bitmap of units the function may use.
  * \param [in] suffix_type  Whether to add a suffix.
- *
- * \return A string containing the formatted coords. Must be freed with
- * g_free.
  */
-static gchar *CoordsToString(Coord coord[], int n_coords, const char *printf_spec, enum e_allow allow, enum e_suffix suffix_type)
+static void CoordsToString(PrintfOutput *out, Coord coord[], int n_coords, const char *printf_spec, enum e_allow allow, enum e_suffix suffix_type)
 {
-  GString *buff;
-  gchar *printf_buff;
+  char printf_buff[64];
   gchar filemode_buff[G_ASCII_DTOSTR_BUF_SIZE];
   enum e_family family;
-  double *value;
+  double value[10];
   const char *suffix;
   int i, n;
 
-  value = malloc (n_coords * sizeof *value);
-  buff  = g_string_new ("");
-
   /* Sanity checks */
-  if (buff == NULL || value == NULL)
-    return NULL;
   if (allow == 0)
     allow = ALLOW_ALL;
   if (printf_spec == NULL)
@@ -419,33 +482,36 @@ static gchar *CoordsToString(Coord coord[], int n_coords, const char *printf_spe
          printf_spec[i] == '#')
     ++i;
   if (printf_spec[i] == '.')
-    printf_buff = g_strdup_printf (", %sf", printf_spec);
+    snprintf (printf_buff, sizeof printf_buff, ", %sf", printf_spec);
   else
-    printf_buff = g_strdup_printf (", %s.%df", printf_spec, Units[n].default_prec);
+    snprintf (printf_buff, sizeof printf_buff, ", %s.%df", printf_spec,
+              Units[n].default_prec);
 
   /* Actually sprintf the values in place
    *  (+ 2 skips the ", " for first value) */
   if (n_coords > 1)
-    g_string_append_c (buff, '(');
+    output_append_c (out, '(');
   if (suffix_type == FILE_MODE || suffix_type == FILE_MODE_NO_SUFFIX)
     {
-      g_ascii_formatd (filemode_buff, sizeof filemode_buff, printf_buff + 2, value[0]);
-      g_string_append_printf (buff, "%s", filemode_buff);
+      g_ascii_formatd (filemode_buff, sizeof filemode_buff,
+                       printf_buff + 2, value[0]);
+      output_append (out, filemode_buff, strlen (filemode_buff));
     }
   else
-    g_string_append_printf (buff, printf_buff + 2, value[0]);
+    output_printf (out, printf_buff + 2, value[0]);
   for (i = 1; i < n_coords; ++i)
     {
       if (suffix_type == FILE_MODE || suffix_type == FILE_MODE_NO_SUFFIX)
         {
-          g_ascii_formatd (filemode_buff, sizeof filemode_buff, printf_buff, value[i]);
-          g_string_append_printf (buff, "%s", filemode_buff);
+          g_ascii_formatd (filemode_buff, sizeof filemode_buff,
+                           printf_buff, value[i]);
+          output_append (out, filemode_buff, strlen (filemode_buff));
         }
       else
-        g_string_append_printf (buff, printf_buff, value[i]);
+        output_printf (out, printf_buff, value[i]);
     }
   if (n_coords > 1)
-    g_string_append_c (buff, ')');
+    output_append_c (out, ')');
   /* Append suffix */
   if (value[0] != 0 || n_coords > 1)
     {
@@ -455,54 +521,65 @@ static gchar *CoordsToString(Coord coord[], int n_coords, const char *printf_spe
         case FILE_MODE_NO_SUFFIX:
           break;
         case SUFFIX:
-          g_string_append_printf (buff, " %s", suffix);
+          output_append_c (out, ' ');
+          output_append (out, suffix, strlen (suffix));
           break;
         case FILE_MODE:
-          g_string_append_printf (buff, "%s", suffix);
+          output_append (out, suffix, strlen (suffix));
           break;
         }
     }
+}
 
-  g_free (printf_buff);
-  free (value);
-  /* Return just the gchar* part of our string */
-  return g_string_free (buff, FALSE);
+/*!
+ * \brief Appends one character to a printf specifier under
+ * construction, silently dropping what does not fit.
+ */
+static void
+spec_append_c (char *spec, size_t size, char c)
+{
+  size_t len = strlen (spec);
+
+  if (len + 1 < size)
+    {
+      spec[len] = c;
+      spec[len + 1] = '\0';
+    }
+}
+
+static void
+spec_append (char *spec, size_t size, const char *str)
+{
+  while (*str)
+    spec_append_c (spec, size, *str++);
 }
 
 /*!
- * \brief Main pcb-printf function.
- *
- * This is a printf wrapper that accepts new format specifiers to
- * output pcb coords as various units. See the comment at the top
- * of pcb-printf.h for full details.
+ * \brief The pcb-printf formatter.
  *
- * \param [in] fmt    Format specifier.
- * \param [in] args   Arguments to specifier.
- *
- * \return A formatted string. Must be freed with g_free.
+ * Parses \p fmt and writes the result to \p out as it goes.  Format
+ * specifiers are assembled on the stack and coords are formatted by
+ * CoordsToString() into the output directly, so apart from the
+ * destination itself nothing is allocated.
  */
-gchar *pcb_vprintf(const char *fmt, va_list args)
+static void
+pcb_vprintf_output (PrintfOutput *out, const char *fmt, va_list args)
 {
-  GString *string = g_string_new ("");
-  GString *spec   = g_string_new ("");
+  char spec[64];
 
   enum e_allow mask = ALLOW_ALL;
 
-  if (string == NULL || spec == NULL)
-    return NULL;
-
   while(*fmt)
     {
       enum e_suffix suffix = NO_SUFFIX;
 
       if(*fmt == '%')
         {
-          gchar *unit_str = NULL;
           const char *ext_unit = "";
           Coord value[10];
           int count, i, done;
 
-          g_string_assign (spec, "%");
+          strcpy (spec, "%");
 
           done = 0;
           while ( ! done && fmt++ && *fmt)
@@ -521,7 +598,12 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
                   break;
                 /* Printf sub-specifiers */
                 case '*':
-                  g_string_append_printf (spec, "%d", va_arg (args, int));
+                  {
+                    char width[16];
+
+                    snprintf (width, sizeof width, "%d", va_arg (args, int));
+                    spec_append (spec, sizeof spec, width);
+                  }
                   break;
                 case '.':
                 case ' ':
@@ -541,7 +623,7 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
                 case '7':
                 case '8':
                 case '9':
-                  g_string_append_c (spec, *fmt);
+                  spec_append_c (spec, sizeof spec, *fmt);
                   break;
                 default:
                   done = 1;
@@ -550,22 +632,22 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
 
           /* Tack full specifier onto specifier */
           if (*fmt != 'm')
-            g_string_append_c (spec, *fmt);
+            spec_append_c (spec, sizeof spec, *fmt);
           switch(*fmt)
             {
             /* Printf specs */
             case 'o': case 'i': case 'd':
             case 'u': case 'x': case 'X':
-              if(strchr (spec->str, 'l'))
+              if(strchr (spec, 'l'))
                 {
-                  if(strchr (spec->str, 'l') != strrchr (spec->str, 'l'))
-                    unit_str = g_strdup_printf (spec->str, va_arg(args, long long));
+                  if(strchr (spec, 'l') != strrchr (spec, 'l'))
+                    output_printf (out, spec, va_arg(args, long long));
                   else
-                    unit_str = g_strdup_printf (spec->str, va_arg(args, long));
+                    output_printf (out, spec, va_arg(args, long));
                 }
               else
                 {
-                  unit_str = g_strdup_printf (spec->str, va_arg(args, int));
+                  output_printf (out, spec, va_arg(args, int));
                 }
               break;
             case 'e': case 'E':
@@ -574,34 +656,43 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
               if(suffix == FILE_MODE || suffix == FILE_MODE_NO_SUFFIX)
                 {
                   gchar buffer[128];
-                  g_ascii_formatd (buffer, 128, spec->str, va_arg(args, double));
-                  unit_str = g_strdup_printf ("%s", buffer);
+                  output_printf (out, "%s",
+                                 g_ascii_formatd (buffer, 128, spec,
+                                                  va_arg(args, double)));
                 }
               else
-                unit_str = g_strdup_printf (spec->str, va_arg(args, double));
+                output_printf (out, spec, va_arg(args, double));
               break;
             case 'c':
-              if(strchr (spec->str, 'l') && sizeof(int) <= sizeof(wchar_t))
-                unit_str = g_strdup_printf (spec->str, va_arg(args, wchar_t));
+              if(strchr (spec, 'l') && sizeof(int) <= sizeof(wchar_t))
+                output_printf (out, spec, va_arg(args, wchar_t));
               else
-                unit_str = g_strdup_printf (spec->str, va_arg(args, int));
+                output_printf (out, spec, va_arg(args, int));
               break;
             case 's':
-              if(strchr (spec->str, 'l'))
-                unit_str = g_strdup_printf (spec->str, va_arg(args, wchar_t *));
+              if(strchr (spec, 'l'))
+                output_printf (out, spec, va_arg(args, wchar_t *));
               else
-                unit_str = g_strdup_printf (spec->str, va_arg(args, char *));
+                {
+                  const char *str = va_arg(args, char *);
+
+                  /* a plain %s is copied straight through */
+                  if (str != NULL && spec[1] == 's')
+                    output_append (out, str, strlen (str));
+                  else
+                    output_printf (out, spec, str);
+                }
               break;
             case 'n':
               /* Depending on gcc settings, this will probably break with
                *  some silly "can't put %n in writeable data space" message */
-              unit_str = g_strdup_printf (spec->str, va_arg(args, int *));
+              output_printf (out, spec, va_arg(args, int *));
               break;
             case 'p':
-              unit_str = g_strdup_printf (spec->str, va_arg(args, void *));
+              output_printf (out, spec, va_arg(args, void *));
               break;
             case '%':
-              g_string_append_c (string, '%');
+              output_append_c (out, '%');
               break;
             /* Our specs */
             case 'm':
@@ -613,11 +704,11 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
               count = 1;
               switch(*fmt)
                 {
-                case 's': unit_str = CoordsToString(value, 1, spec->str, ALLOW_MM | ALLOW_MIL, suffix); break;
-                case 'S': unit_str = CoordsToString(value, 1, spec->str, mask & ALLOW_ALL, suffix); break;
-                case 'M': unit_str = CoordsToString(value, 1, spec->str, mask & ALLOW_METRIC, suffix); break;
-                case 'L': unit_str = CoordsToString(value, 1, spec->str, mask & ALLOW_IMPERIAL, suffix); break;
-                case 'r': unit_str = CoordsToString(value, 1, spec->str, set_allow_readable(0), FILE_MODE); break;
+                case 's': CoordsToString(out, value, 1, spec, ALLOW_MM | ALLOW_MIL, suffix); break;
+                case 'S': CoordsToString(out, value, 1, spec, mask & ALLOW_ALL, suffix); break;
+                case 'M': CoordsToString(out, value, 1, spec, mask & ALLOW_METRIC, suffix); break;
+                case 'L': CoordsToString(out, value, 1, spec, mask & ALLOW_IMPERIAL, suffix); break;
+                case 'r': CoordsToString(out, value, 1, spec, set_allow_readable(0), FILE_MODE); break;
                 /* All these fallthroughs are deliberate */
                 case '9': value[count++] = va_arg(args, Coord);
                 case '8': value[count++] = va_arg(args, Coord);
@@ -629,51 +720,70 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
                 case '2':
                 case 'D':
                   value[count++] = va_arg(args, Coord);
-                  unit_str = CoordsToString(value, count, spec->str, mask & ALLOW_ALL, suffix);
+                  CoordsToString(out, value, count, spec, mask & ALLOW_ALL, suffix);
                   break;
                 case 'd':
                   value[1] = va_arg(args, Coord);
-                  unit_str = CoordsToString(value, 2, spec->str, ALLOW_MM | ALLOW_MIL, suffix);
+                  CoordsToString(out, value, 2, spec, ALLOW_MM | ALLOW_MIL, suffix);
                   break;
                 case '*':
                   for (i = 0; i < N_UNITS; ++i)
                     if (strcmp (ext_unit, Units[i].suffix) == 0)
-                      unit_str = CoordsToString(value, 1, spec->str, Units[i].allow, suffix);
-                  if (unit_str == NULL)
-                    unit_str = CoordsToString(value, 1, spec->str, mask & ALLOW_ALL, suffix);
+                      break;
+                  CoordsToString(out, value, 1, spec,
+                                 i < N_UNITS ? Units[i].allow : mask & ALLOW_ALL,
+                                 suffix);
                   break;
                 case 'a':
-                  g_string_append (spec, "f");
+                  spec_append (spec, sizeof spec, "f");
                   if (suffix == SUFFIX)
-                    g_string_append (spec, " deg");
-                  unit_str = g_strdup_printf (spec->str, (double) va_arg(args, Angle));
+                    spec_append (spec, sizeof spec, " deg");
+                  output_printf (out, spec, (double) va_arg(args, Angle));
                   break;
                 case '+':
                   mask = va_arg(args, enum e_allow);
                   break;
                 default:
+                  /* units sharing a printf code also share allow bits,
+                   * so the first match is as good as any */
                   for (i = 0; i < N_UNITS; ++i)
                     if (*fmt == Units[i].printf_code)
-                      unit_str = CoordsToString(value, 1, spec->str, Units[i].allow, suffix);
-                  if (unit_str == NULL)
-                    unit_str = CoordsToString(value, 1, spec->str, ALLOW_ALL, suffix);
+                      break;
+                  CoordsToString(out, value, 1, spec,
+                                 i < N_UNITS ? Units[i].allow : ALLOW_ALL,
+                                 suffix);
                   break;
                 }
               break;
             }
-          if (unit_str != NULL)
-            {
-              g_string_append (string, unit_str);
-              g_free (unit_str);
-            }
         }
       else
-        g_string_append_c (string, *fmt);
+        output_append_c (out, *fmt);
       ++fmt;
     }
-  g_string_free (spec, TRUE);
+}
+
+/*!
+ * \brief Main pcb-printf function.
+ *
+ * This is a printf wrapper that accepts new format specifiers to
+ * output pcb coords as various units. See the comment at the top
+ * of pcb-printf.h for full details.
+ *
+ * \param [in] fmt    Format specifier.
+ * \param [in] args   Arguments to specifier.
+ *
+ * \return A formatted string. Must be freed with g_free.
+ */
+gchar *pcb_vprintf(const char *fmt, va_list args)
+{
+  PrintfOutput out;
+
+  memset (&out, 0, sizeof out);
+  out.string = g_string_new ("");
+  pcb_vprintf_output (&out, fmt, args);
   /* Return just the gchar* part of our string */
-  return g_string_free (string, FALSE);
+  return g_string_free (out.string, FALSE);
 }
 
 
@@ -695,26 +805,32 @@ gchar *pcb_vprintf(const char *fmt, va_list args)
  */
 int pcb_snprintf(char *string, size_t size, const char *fmt, ...)
 {
-  gchar *tmp;
-  gsize length;
+  PrintfOutput out;
 
   va_list args;
   va_start(args, fmt);
 
-  tmp = pcb_vprintf (fmt, args);
-  length = strlen (tmp);
-  strncpy (string, tmp, size);
+  memset (&out, 0, sizeof out);
+  out.buffer = string;
+  out.size = size;
+  pcb_vprintf_output (&out, fmt, args);
+
+  /* pad the rest with zeros, as strncpy() would */
+  if (out.length < size)
+    memset (string + out.length, 0, size - out.length);
   string[size - 1] = '\0';
 
-  g_free (tmp);
   va_end(args);
 
-  return length;
+  return out.length;
 }
 
 /*!
  * \brief Wrapper for pcb_vprintf that outputs to a file.
  *
+ * The output goes straight to the stdio buffer of \p fh without an
+ * intermediate string.
+ *
  * \param [in] fh   File to output to.
  * \param [in] fmt  Format specifier.
  *
@@ -723,7 +839,7 @@ int pcb_snprintf(char *string, size_t size, const char *fmt, ...)
 int pcb_fprintf(FILE *fh, const char *fmt, ...)
 {
   int rv;
-  gchar *tmp;
+  PrintfOutput out;
 
   va_list args;
   va_start(args, fmt);
@@ -732,9 +848,10 @@ int pcb_fprintf(FILE *fh, const char *fmt, ...)
     rv = -1;
   else
     {
-      tmp = pcb_vprintf (fmt, args);
-      rv = fprintf (fh, "%s", tmp);
-      g_free (tmp);
+      memset (&out, 0, sizeof out);
+      out.file = fh;
+      pcb_vprintf_output (&out, fmt, args);
+      rv = out.error ? -1 : (int) out.length;
     }
   
   va_end(args);
@@ -751,14 +868,15 @@ int pcb_fprintf(FILE *fh, const char *fmt, ...)
 int pcb_printf(const char *fmt, ...)
 {
   int rv;
-  gchar *tmp;
+  PrintfOutput out;
 
   va_list args;
   va_start(args, fmt);
 
-  tmp = pcb_vprintf (fmt, args);
-  rv = printf ("%s", tmp);
-  g_free (tmp);
+  memset (&out, 0, sizeof out);
+  out.file = stdout;
+  pcb_vprintf_output (&out, fmt, args);
+  rv = out.error ? -1 : (int) out.length;
   
   va_end(args);
   return rv;
@@ -789,6 +907,8 @@ pcb_printf_register_tests ()
 {
   g_test_add_func ("/pcb-printf/test-unit", pcb_printf_test_unit);
   g_test_add_func ("/pcb-printf/test-printf", pcb_printf_test_printf);
+  g_test_add_func ("/pcb-printf/test-fprintf", pcb_printf_test_fprintf);
+  g_test_add_func ("/pcb-printf/perf-fprintf", pcb_printf_perf_fprintf);
 }
 
 void
@@ -868,4 +988,128 @@ pcb_printf_test_printf ()
   g_assert_cmpstr (pcb_g_strdup_printf ("%#S", e), ==, "");
 }
 
+/*!
+ * \brief Formats \p fmt with pcb_fprintf into a temporary file and
+ * returns what was written.
+ */
+static char *
+fprintf_to_string (const char *fmt, ...)
+{
+  PrintfOutput out;
+  va_list args;
+  char *written;
+  FILE *fp;
+  long length;
+
+  fp = tmpfile ();
+  g_assert (fp != NULL);
+  memset (&out, 0, sizeof out);
+  out.file = fp;
+  va_start (args, fmt);
+  pcb_vprintf_output (&out, fmt, args);
+  va_end (args);
+  g_assert (!out.error);
+
+  length = ftell (fp);
+  g_assert_cmpint (length, ==, out.length);
+  written = g_malloc0 (length + 1);
+  rewind (fp);
+  g_assert_cmpint (fread (written, 1, length, fp), ==, length);
+  fclose (fp);
+  return written;
+}
+
+/*!
+ * \brief Check that writing to a stream produces exactly the same bytes
+ * as formatting to a string, including results longer than the
+ * on-stack formatting buffer.
+ */
+void
+pcb_printf_test_fprintf ()
+{
+  Coord c = unit_to_coord (get_unit_struct ("mil"), 12.5);
+  Coord d = unit_to_coord (get_unit_struct ("mm"), -3.2);
+  char long_name[1024];
+  char *expected;
+  char *written;
+  char *via_string;
+  FILE *fp;
+  long length;
+
+  memset (long_name, 'x', sizeof long_name - 1);
+  long_name[sizeof long_name - 1] = '\0';
+
+  expected = pcb_g_strdup_printf ("Via[%mr %mr %mr] (%$mD) \"%s\" %`.2f\n",
+                                  c, d, c, c, d, long_name, 0.125);
+
+  fp = tmpfile ();
+  g_assert (fp != NULL);
+  g_assert_cmpint (pcb_fprintf (fp, "Via[%mr %mr %mr] (%$mD) \"%s\" %`.2f\n",
+                                c, d, c, c, d, long_name, 0.125),
+                   ==, strlen (expected));
+  length = ftell (fp);
+  g_assert_cmpint (length, ==, strlen (expected));
+
+  written = g_malloc0 (length + 1);
+  rewind (fp);
+  g_assert_cmpint (fread (written, 1, length, fp), ==, length);
+  fclose (fp);
+
+  g_assert_cmpstr (written, ==, expected);
+
+  g_free (written);
+  g_free (expected);
+
+  /* Widths and precisions that overflow the 256 byte stack buffer of
+   * output_printf (), so that the heap fallback is taken, checked
+   * against plain g_strdup_printf (). */
+  expected = g_strdup_printf ("%300.3f|%-280s|%.290f|%300.2f",
+                              COORD_TO_MM (d), "pad", 0.5, COORD_TO_MIL (c));
+  written = fprintf_to_string ("%300.3mm|%-280s|%.290f|%300.2ml",
+                               d, "pad", 0.5, c);
+  g_assert_cmpuint (strlen (written), >, 1000);
+  g_assert_cmpstr (written, ==, expected);
+  g_free (written);
+
+  via_string = pcb_g_strdup_printf ("%300.3mm|%-280s|%.290f|%300.2ml",
+                                    d, "pad", 0.5, c);
+  g_assert_cmpstr (via_string, ==, expected);
+  g_free (via_string);
+  g_free (expected);
+}
+
+/*!
+ * \brief Time the kind of pcb_fprintf calls made when saving a layout.
+ *
+ * Only runs with "-m perf".
+ */
+void
+pcb_printf_perf_fprintf ()
+{
+  FILE *fp;
+  GTimer *timer;
+  Coord x;
+  int i;
+
+  if (!g_test_perf ())
+    return;
+
+  fp = fopen ("/dev/null", "w");
+  g_assert (fp != NULL);
+
+  timer = g_timer_new ();
+  for (i = 0; i < 1000000; i++)
+    {
+      x = (Coord) i * 2540;
+      pcb_fprintf (fp, "\tLine[%mr %mr %mr %mr %mr %mr %s]\n",
+                   x, x + 1000, x + 25400, x, 25400, 40000, "\"clearline\"");
+    }
+  fclose (fp);
+
+  g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                           "pcb_fprintf of 1000000 lines: %.3f s",
+                           g_timer_elapsed (timer, NULL));
+  g_timer_destroy (timer);
+}
+
 #endif
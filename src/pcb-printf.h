@@ -178,6 +178,8 @@ gchar *pcb_vprintf(const char *fmt, va_list args);
 void pcb_printf_register_tests ();
 void pcb_printf_test_unit ();
 void pcb_printf_test_printf ();
+void pcb_printf_test_fprintf ();
+void pcb_printf_perf_fprintf ();
 #endif
 
 #endif
@@ -135,6 +135,7 @@ void poly_ClrContour(PLINE *  c);  /* clears list of vertices */
 void poly_DelContour(PLINE ** c);
 
 BOOLp poly_CopyContour(PLINE ** dst, PLINE * src);
+BOOLp poly_TranslateContour(PLINE ** dst, PLINE * src, Coord dx, Coord dy);
 
 void poly_PreContour(PLINE * c, BOOLp optimize); /* prepare contour */
 void poly_InvContour(PLINE * c);  /* invert contour */
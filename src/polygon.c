@@ -386,8 +386,8 @@ RectPoly (Coord x1, Coord x2, Coord y1, Coord y2)
   return ContourToPoly (contour);
 }
 
-POLYAREA *
-OctagonPoly (Coord x, Coord y, Coord radius)
+static POLYAREA *
+octagon_poly (Coord x, Coord y, Coord radius)
 {
   PLINE *contour = NULL;
   Vector v;
@@ -451,17 +451,158 @@ frac_circle (PLINE * c, Coord X, Coord Y, Vector v, int fraction)
     }
 }
 
+/* ---------------------------------------------------------------------------
+ * Shape cache.
+ *
+ * Pins, vias, pads and thermals with the same geometry produce the same
+ * contour at every location, so the first one built is kept, moved to the
+ * origin, and later ones are translated copies of it.  Only shapes whose
+ * vertices are the position plus integer offsets may be cached; that way a
+ * copy is identical to what building the shape afresh would give.
+ */
+
+#define SHAPE_CACHE_MAX 4096
+
+typedef struct
+{
+  ShapeKeyType key;
+  POLYAREA *shape;		/*!< Prototype, positioned at the origin. */
+} ShapeCacheEntry;
+
+static GHashTable *shape_cache = NULL;
+
+static guint
+shape_key_hash (gconstpointer data)
+{
+  const ShapeKeyType *key = (const ShapeKeyType *) data;
+  guint hash = key->kind;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    hash = hash * 31 + (guint) key->size[i];
+  return hash * 31 + (guint) (key->scale * 1000000);
+}
+
+static gboolean
+shape_key_equal (gconstpointer a, gconstpointer b)
+{
+  const ShapeKeyType *ka = (const ShapeKeyType *) a;
+  const ShapeKeyType *kb = (const ShapeKeyType *) b;
+
+  return ka->kind == kb->kind &&
+    ka->size[0] == kb->size[0] && ka->size[1] == kb->size[1] &&
+    ka->size[2] == kb->size[2] && ka->size[3] == kb->size[3] &&
+    ka->scale == kb->scale;
+}
+
+static void
+free_shape_cache_entry (gpointer data)
+{
+  ShapeCacheEntry *entry = (ShapeCacheEntry *) data;
+
+  poly_Free (&entry->shape);
+  g_slice_free (ShapeCacheEntry, entry);
+}
+
 /*!
- * \brief Create a circle approximation from lines.
+ * \brief Copy a circular list of polygon areas, moving them by (dx, dy).
+ */
+static POLYAREA *
+translate_polyarea (const POLYAREA *src, Coord dx, Coord dy)
+{
+  const POLYAREA *area = src;
+  POLYAREA *list = NULL, *copy;
+  PLINE *cur, **last;
+
+  do
+    {
+      if ((copy = poly_Create ()) == NULL)
+        return list;
+      last = &copy->contours;
+      for (cur = area->contours; cur != NULL; cur = cur->next)
+        {
+          if (!poly_TranslateContour (last, cur, dx, dy))
+            break;
+          r_insert_entry (copy->contour_tree, (BoxType *) *last, 0);
+          last = &(*last)->next;
+        }
+      poly_M_Incl (&list, copy);
+    }
+  while ((area = area->f) != src);
+  return list;
+}
+
+/*!
+ * \brief Fill in a shape cache key.
+ *
+ * Unused sizes should be passed as 0.
+ */
+void
+InitShapeKey (ShapeKeyType *key, int kind, Coord s0, Coord s1, Coord s2,
+              Coord s3, double scale)
+{
+  key->kind = kind;
+  key->size[0] = s0;
+  key->size[1] = s1;
+  key->size[2] = s2;
+  key->size[3] = s3;
+  key->scale = scale;
+}
+
+/*!
+ * \brief Look up a cached shape.
+ *
+ * \return a new copy of the shape placed at (x, y), or NULL if the shape
+ * is not in the cache.
  */
 POLYAREA *
-CirclePoly (Coord x, Coord y, Coord radius)
+LookupShape (const ShapeKeyType *key, Coord x, Coord y)
+{
+  ShapeCacheEntry *entry;
+
+  if (shape_cache == NULL)
+    return NULL;
+  entry = (ShapeCacheEntry *) g_hash_table_lookup (shape_cache, key);
+  if (entry == NULL)
+    return NULL;
+  return translate_polyarea (entry->shape, x, y);
+}
+
+/*!
+ * \brief Store a shape that was built at (x, y) in the cache.
+ *
+ * The cache keeps its own copy; the shape is returned to the caller
+ * untouched.
+ */
+POLYAREA *
+RememberShape (const ShapeKeyType *key, Coord x, Coord y, POLYAREA *shape)
+{
+  ShapeCacheEntry *entry;
+
+  if (shape == NULL)
+    return NULL;
+  if (shape_cache == NULL)
+    shape_cache = g_hash_table_new_full (shape_key_hash, shape_key_equal,
+                                         NULL, free_shape_cache_entry);
+  else if (g_hash_table_size (shape_cache) >= SHAPE_CACHE_MAX)
+    g_hash_table_remove_all (shape_cache);
+
+  entry = g_slice_new (ShapeCacheEntry);
+  entry->key = *key;
+  entry->shape = translate_polyarea (shape, -x, -y);
+  g_hash_table_replace (shape_cache, &entry->key, entry);
+  return shape;
+}
+
+/*!
+ * \brief Create a circle approximation from lines.
+ */
+static POLYAREA *
+circle_poly (Coord x, Coord y, Coord radius)
 {
   PLINE *contour;
   Vector v;
 
-  if (radius <= 0)
-    return NULL;
   v[0] = x + radius;
   v[1] = y;
   if ((contour = poly_NewContour (v)) == NULL)
@@ -474,12 +615,38 @@ CirclePoly (Coord x, Coord y, Coord radius)
   return ContourToPoly (contour);
 }
 
+POLYAREA *
+CirclePoly (Coord x, Coord y, Coord radius)
+{
+  ShapeKeyType key;
+  POLYAREA *np;
+
+  if (radius <= 0)
+    return NULL;
+  InitShapeKey (&key, SHAPE_CIRCLE, radius, 0, 0, 0, 0.0);
+  if ((np = LookupShape (&key, x, y)) == NULL)
+    np = RememberShape (&key, x, y, circle_poly (x, y, radius));
+  return np;
+}
+
+POLYAREA *
+OctagonPoly (Coord x, Coord y, Coord radius)
+{
+  ShapeKeyType key;
+  POLYAREA *np;
+
+  InitShapeKey (&key, SHAPE_OCTAGON, radius, 0, 0, 0, 0.0);
+  if ((np = LookupShape (&key, x, y)) == NULL)
+    np = RememberShape (&key, x, y, octagon_poly (x, y, radius));
+  return np;
+}
+
 /*!
  * \brief Make a rounded-corner rectangle with radius t beyond
  * x1,x2,y1,y2 rectangle.
  */
-POLYAREA *
-RoundRect (Coord x1, Coord x2, Coord y1, Coord y2, Coord t)
+static POLYAREA *
+round_rect (Coord x1, Coord x2, Coord y1, Coord y2, Coord t)
 {
   PLINE *contour = NULL;
   Vector v;
@@ -506,6 +673,20 @@ RoundRect (Coord x1, Coord x2, Coord y1, Coord y2, Coord t)
   return ContourToPoly (contour);
 }
 
+POLYAREA *
+RoundRect (Coord x1, Coord x2, Coord y1, Coord y2, Coord t)
+{
+  ShapeKeyType key;
+  POLYAREA *np;
+
+  assert (x2 > x1);
+  assert (y2 > y1);
+  InitShapeKey (&key, SHAPE_ROUND_RECT, x2 - x1, y2 - y1, t, 0, 0.0);
+  if ((np = LookupShape (&key, x1, y1)) == NULL)
+    np = RememberShape (&key, x1, y1, round_rect (x1, x2, y1, y2, t));
+  return np;
+}
+
 #define ARC_ANGLE 5
 static POLYAREA *
 ArcPolyNoIntersect (ArcType * a, Coord thick)
@@ -670,33 +851,54 @@ LinePoly (LineType * L, Coord thick)
   return np;
 }
 
+/*!
+ * \brief Offsets of the pad outline (tx, ty) and of the clearance
+ * outline (cx, cy) from the pad's centre line.
+ */
+static void
+square_pad_offsets (PadType *pad, Coord clear, double *tx, double *ty,
+                    double *cx, double *cy)
+{
+  int halfthick = (pad->Thickness + 1) / 2;
+  int halfclear = (clear + 1) / 2;
+  double d;
+
+  d = hypot (pad->Point1.X - pad->Point2.X, pad->Point1.Y - pad->Point2.Y);
+  if (d != 0)
+    {
+      double a = halfthick / d;
+      *tx = (pad->Point1.Y - pad->Point2.Y) * a;
+      *ty = (pad->Point2.X - pad->Point1.X) * a;
+      a = halfclear / d;
+      *cx = (pad->Point1.Y - pad->Point2.Y) * a;
+      *cy = (pad->Point2.X - pad->Point1.X) * a;
+    }
+  else
+    {
+      *tx = halfthick;
+      *ty = 0;
+      *cx = halfclear;
+      *cy = 0;
+    }
+}
+
 /*!
  * \brief Make a rounded-corner rectangle.
  */
-POLYAREA *
-SquarePadPoly (PadType * pad, Coord clear)
+static POLYAREA *
+square_pad_poly (PadType * pad, Coord clear)
 {
   PLINE *contour = NULL;
   POLYAREA *np = NULL;
   Vector v;
-  double d;
   double tx, ty;
   double cx, cy;
   PadType _t=*pad,*t=&_t;
   PadType _c=*pad,*c=&_c;
-  int halfthick = (pad->Thickness + 1) / 2;
-  int halfclear = (clear + 1) / 2;
 
-  d = hypot (pad->Point1.X - pad->Point2.X, pad->Point1.Y - pad->Point2.Y);
-  if (d != 0)
+  square_pad_offsets (pad, clear, &tx, &ty, &cx, &cy);
+  if (pad->Point1.X != pad->Point2.X || pad->Point1.Y != pad->Point2.Y)
     {
-      double a = halfthick / d;
-      tx = (t->Point1.Y - t->Point2.Y) * a;
-      ty = (t->Point2.X - t->Point1.X) * a;
-      a = halfclear / d;
-      cx = (c->Point1.Y - c->Point2.Y) * a;
-      cy = (c->Point2.X - c->Point1.X) * a;
-
       t->Point1.X -= ty;
       t->Point1.Y += tx;
       t->Point2.X += ty;
@@ -708,11 +910,6 @@ SquarePadPoly (PadType * pad, Coord clear)
     }
   else
     {
-      tx = halfthick;
-      ty = 0;
-      cx = halfclear;
-      cy = 0;
-
       t->Point1.Y += tx;
       t->Point2.Y -= tx;
       c->Point1.Y += cx;
@@ -746,6 +943,48 @@ SquarePadPoly (PadType * pad, Coord clear)
   return np;
 }
 
+POLYAREA *
+SquarePadPoly (PadType * pad, Coord clear)
+{
+  ShapeKeyType key;
+  POLYAREA *np;
+  double tx, ty;
+  double cx, cy;
+
+  /* With fractional offsets the outline depends on where the pad is, as
+   * the coordinates get truncated, so such pads are always built afresh.
+   */
+  square_pad_offsets (pad, clear, &tx, &ty, &cx, &cy);
+  if (tx != floor (tx) || ty != floor (ty) ||
+      cx != floor (cx) || cy != floor (cy))
+    return square_pad_poly (pad, clear);
+
+  InitShapeKey (&key, SHAPE_SQUARE_PAD, pad->Point2.X - pad->Point1.X,
+                pad->Point2.Y - pad->Point1.Y, pad->Thickness, clear, 0.0);
+  if ((np = LookupShape (&key, pad->Point1.X, pad->Point1.Y)) == NULL)
+    np = RememberShape (&key, pad->Point1.X, pad->Point1.Y,
+                        square_pad_poly (pad, clear));
+  return np;
+}
+
+/*!
+ * \brief Note that a polygon's Clipped area has been replaced.
+ *
+ * Invalidates the NoHoles cache and stamps the polygon with a fresh,
+ * never reused ClipGeneration so that renderers holding data derived
+ * from the old Clipped area can tell it is stale.
+ */
+static void
+ClippedChanged (PolygonType *p)
+{
+  static unsigned int generation = 0;
+
+  p->NoHolesValid = 0;
+  if (++generation == 0)
+    generation = 1;
+  p->ClipGeneration = generation;
+}
+
 /*!
  * \brief Clear np1 from the polygon.
  */
@@ -783,11 +1022,13 @@ Subtract (POLYAREA * np1, PolygonType * p, bool fnp)
       fprintf (stderr, "Error while clipping PBO_SUB: %d\n", x);
       poly_Free (&merged);
       p->Clipped = NULL;
+      ClippedChanged (p);
       if (p->NoHoles) printf ("Just leaked in Subtract\n");
       p->NoHoles = NULL;
       return -1;
     }
   p->Clipped = biggest (merged);
+  ClippedChanged (p);
   assert (!p->Clipped || poly_Valid (p->Clipped));
   if (!p->Clipped)
     Message ("Polygon cleared out of existence near (%d, %d)\n",
@@ -1159,11 +1400,13 @@ Unsubtract (POLYAREA * np1, PolygonType * p)
       goto fail;
     }
   p->Clipped = biggest (merged);
+  ClippedChanged (p);
   assert (!p->Clipped || poly_Valid (p->Clipped));
   return 1;
 
 fail:
   p->Clipped = NULL;
+  ClippedChanged (p);
   if (p->NoHoles) printf ("Just leaked in Unsubtract\n");
   p->NoHoles = NULL;
   return 0;
@@ -1275,6 +1518,7 @@ InitClip (DataType *Data, LayerType *layer, PolygonType * p)
 
   /* Compute the perimeter of the polygon */
   p->Clipped = original_poly (p);
+  ClippedChanged (p);
 
   /* NoHoles is a version of the polygon broken into pieces so that it is
    * hole free. If we have one, we need to clear it. */
@@ -1717,6 +1961,217 @@ PlowsPolygon (DataType * Data, int type, void *ptr1, void *ptr2,
   return r;
 }
 
+/* ---------------------------------------------------------------------------
+ * Deferred polygon clearing.
+ *
+ * Bulk operations (moving or rotating a selection, pasting a buffer,
+ * undoing a serial) restore and re-clear the polygons around every
+ * object they touch, one object at a time.  Between BeginPolygonBatch ()
+ * and EndPolygonBatch () RestoreToPolygon () and ClearFromPolygon () only
+ * note which polygons an object plows and where; EndPolygonBatch () then
+ * re-clips every noted area of every polygon once, against the final
+ * state of the layout.
+ */
+
+/*!
+ * \brief Areas of one clearing polygon waiting to be re-cleared.
+ */
+typedef struct
+{
+  DataType *data;
+  LayerType *layer;
+  PolygonType *polygon;
+  BoxType box;		/*!< Polygon bounding box when last marked. */
+  GArray *regions;	/*!< BoxType, the areas to restore and re-clear. */
+} DirtyPolygonType;
+
+/*!
+ * \brief Above this many regions a polygon is simply re-clipped from
+ * scratch.
+ */
+#define BATCH_MAX_REGIONS 64
+
+static int batch_depth = 0;
+static GHashTable *dirty_polygons = NULL;
+
+static void
+free_dirty_polygon (gpointer data)
+{
+  DirtyPolygonType *dirty = (DirtyPolygonType *) data;
+
+  g_array_free (dirty->regions, TRUE);
+  g_free (dirty);
+}
+
+/*!
+ * \brief PlowsPolygon() callback recording the plowed area.
+ */
+static int
+mark_plow (DataType *Data, LayerType *Layer, PolygonType *Polygon,
+           int type, void *ptr1, void *ptr2, void *userdata)
+{
+  DirtyPolygonType *dirty;
+  PinType *via;
+
+  if (type == VIA_TYPE)
+    {
+      via = (PinType *) ptr2;
+      if (VIA_IS_BURIED (via)
+          && !VIA_ON_LAYER (via, GetLayerNumber (Data, Layer)))
+        return 0;
+    }
+
+  dirty = (DirtyPolygonType *) g_hash_table_lookup (dirty_polygons, Polygon);
+  if (dirty == NULL)
+    {
+      dirty = g_new0 (DirtyPolygonType, 1);
+      dirty->polygon = Polygon;
+      dirty->regions = g_array_new (FALSE, FALSE, sizeof (BoxType));
+      g_hash_table_insert (dirty_polygons, Polygon, dirty);
+    }
+  /* The polygon may have been moved to another layer since the last mark. */
+  dirty->data = Data;
+  dirty->layer = Layer;
+  dirty->box = Polygon->BoundingBox;
+  g_array_append_val (dirty->regions, ((AnyObjectType *) ptr2)->BoundingBox);
+  return 1;
+}
+
+static int
+same_polygon_callback (const BoxType * b, void *cl)
+{
+  return b == (const BoxType *) cl;
+}
+
+static bool
+boxes_touch (const BoxType *a, const BoxType *b)
+{
+  return a->X1 <= b->X2 + 2 * UNSUBTRACT_BLOAT
+    && b->X1 <= a->X2 + 2 * UNSUBTRACT_BLOAT
+    && a->Y1 <= b->Y2 + 2 * UNSUBTRACT_BLOAT
+    && b->Y1 <= a->Y2 + 2 * UNSUBTRACT_BLOAT;
+}
+
+/*!
+ * \brief Merge touching regions until all of them are disjoint.
+ */
+static void
+merge_regions (GArray *regions)
+{
+  bool merged;
+  guint i, j;
+
+  do
+    {
+      merged = false;
+      for (i = 0; i < regions->len; i++)
+        for (j = i + 1; j < regions->len; j++)
+          {
+            BoxType *a = &g_array_index (regions, BoxType, i);
+            BoxType *b = &g_array_index (regions, BoxType, j);
+
+            if (!boxes_touch (a, b))
+              continue;
+            MAKEMIN (a->X1, b->X1);
+            MAKEMIN (a->Y1, b->Y1);
+            MAKEMAX (a->X2, b->X2);
+            MAKEMAX (a->Y2, b->Y2);
+            g_array_remove_index_fast (regions, j);
+            j--;
+            merged = true;
+          }
+    }
+  while (merged);
+}
+
+/*!
+ * \brief Restore and re-clear the noted areas of one polygon.
+ */
+static void
+recut_polygon (gpointer key, gpointer value, gpointer userdata)
+{
+  DirtyPolygonType *dirty = (DirtyPolygonType *) value;
+  PolygonType *polygon = dirty->polygon;
+  GArray *regions = dirty->regions;
+  double area = 0;
+  guint i;
+
+  /* Skip polygons that were removed or moved away during the batch;
+   * a moved polygon has been re-clipped as a whole already. */
+  if (r_search (dirty->layer->polygon_tree, &dirty->box, NULL,
+                same_polygon_callback, polygon) == 0)
+    return;
+
+  if (!polygon->Clipped || regions->len > BATCH_MAX_REGIONS)
+    {
+      InitClip (dirty->data, dirty->layer, polygon);
+      return;
+    }
+
+  merge_regions (regions);
+  for (i = 0; i < regions->len; i++)
+    {
+      BoxType *box = &g_array_index (regions, BoxType, i);
+      area += (double) (box->X2 - box->X1) * (box->Y2 - box->Y1);
+    }
+  /* Restoring most of the polygon piecewise costs more than starting over. */
+  if (area * 2 > (double) (polygon->BoundingBox.X2 - polygon->BoundingBox.X1)
+                 * (polygon->BoundingBox.Y2 - polygon->BoundingBox.Y1))
+    {
+      InitClip (dirty->data, dirty->layer, polygon);
+      return;
+    }
+
+  for (i = 0; i < regions->len; i++)
+    {
+      BoxType box = g_array_index (regions, BoxType, i);
+      POLYAREA *np;
+
+      /* overlap a bit to prevent notches from rounding errors */
+      np = BoxPolyBloated (&box, UNSUBTRACT_BLOAT);
+      if (!np)
+        continue;
+      if (!Unsubtract (np, polygon))
+        {
+          InitClip (dirty->data, dirty->layer, polygon);
+          return;
+        }
+      /* The region box is not an object, so everything in it is
+       * subtracted again. */
+      clearPoly (dirty->data, dirty->layer, polygon, &box,
+                 2 * UNSUBTRACT_BLOAT);
+    }
+}
+
+/*!
+ * \brief Start deferring polygon clearing.
+ *
+ * Batches nest; clearing happens when the outermost batch ends.  Nothing
+ * between the two calls may rely on the clipped shape of a polygon near
+ * a changed object.
+ */
+void
+BeginPolygonBatch (void)
+{
+  if (batch_depth++ == 0 && dirty_polygons == NULL)
+    dirty_polygons = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, free_dirty_polygon);
+}
+
+/*!
+ * \brief Re-clear every polygon touched since the matching
+ * BeginPolygonBatch().
+ */
+void
+EndPolygonBatch (void)
+{
+  assert (batch_depth > 0);
+  if (--batch_depth > 0)
+    return;
+  g_hash_table_foreach (dirty_polygons, recut_polygon, NULL);
+  g_hash_table_remove_all (dirty_polygons);
+}
+
 void
 RestoreToPolygon (DataType * Data, int type, void *ptr1, void *ptr2)
 {
@@ -1725,6 +2180,8 @@ RestoreToPolygon (DataType * Data, int type, void *ptr1, void *ptr2)
 
   if (type == POLYGON_TYPE)
     InitClip (PCB->Data, (LayerType *) ptr1, (PolygonType *) ptr2);
+  else if (batch_depth > 0)
+    PlowsPolygon (Data, type, ptr1, ptr2, mark_plow, NULL);
   else
     PlowsPolygon (Data, type, ptr1, ptr2, add_plow, NULL);
 }
@@ -1737,6 +2194,8 @@ ClearFromPolygon (DataType * Data, int type, void *ptr1, void *ptr2)
 
   if (type == POLYGON_TYPE)
     InitClip (PCB->Data, (LayerType *) ptr1, (PolygonType *) ptr2);
+  else if (batch_depth > 0)
+    PlowsPolygon (Data, type, ptr1, ptr2, mark_plow, NULL);
   else
     PlowsPolygon (Data, type, ptr1, ptr2, subtract_plow, NULL);
 }
@@ -1922,6 +2381,7 @@ MorphPolygon (LayerType *layer, PolygonType *poly)
    * we do this dirty work.
    */
   poly->Clipped = NULL;
+  ClippedChanged (poly);
   if (poly->NoHoles) printf ("Just leaked in MorpyPolygon\n");
   poly->NoHoles = NULL;
   flags = poly->Flags;
@@ -1948,6 +2408,7 @@ MorphPolygon (LayerType *layer, PolygonType *poly)
           newone->BoundingBox.Y2 = p->contours->ymax + 1;
           AddObjectToCreateUndoList (POLYGON_TYPE, layer, newone, newone);
           newone->Clipped = p;
+          ClippedChanged (newone);
           p = p->f;             /* go to next pline */
           newone->Clipped->b = newone->Clipped->f = newone->Clipped;     /* unlink from others */
           r_insert_entry (layer->polygon_tree, (BoxType *) newone, 0);
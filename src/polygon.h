@@ -56,6 +56,29 @@
  */
 #define POLY_ARC_MAX_DEVIATION 0.02
 
+/*!
+ * \brief Kinds of shape kept in the shape cache.
+ */
+enum
+{
+  SHAPE_CIRCLE,
+  SHAPE_OCTAGON,
+  SHAPE_ROUND_RECT,
+  SHAPE_SQUARE_PAD,
+  SHAPE_SQUARE_THERMAL
+};
+
+/*!
+ * \brief Key of a cached shape: its kind and everything except its
+ * position that its outline depends on.
+ */
+typedef struct
+{
+  int kind;
+  Coord size[4];
+  double scale;
+} ShapeKeyType;
+
 /* Prototypes */
 
 void polygon_init (void);
@@ -87,9 +110,14 @@ POLYAREA * ArcPoly(ArcType *l, Coord thick);
 POLYAREA * PinPoly(PinType *l, Coord thick, Coord clear);
 POLYAREA * BoxPolyBloated (BoxType *box, Coord radius);
 void frac_circle (PLINE *, Coord, Coord, Vector, int);
+void InitShapeKey (ShapeKeyType *, int, Coord, Coord, Coord, Coord, double);
+POLYAREA * LookupShape (const ShapeKeyType *, Coord, Coord);
+POLYAREA * RememberShape (const ShapeKeyType *, Coord, Coord, POLYAREA *);
 int InitClip(DataType *d, LayerType *l, PolygonType *p);
 void RestoreToPolygon(DataType *, int, void *, void *);
 void ClearFromPolygon(DataType *, int, void *, void *);
+void BeginPolygonBatch (void);
+void EndPolygonBatch (void);
 
 bool IsPointInPolygon (Coord, Coord, Coord, PolygonType *);
 bool IsPointInPolygonIgnoreHoles (Coord, Coord, PolygonType *);
@@ -2947,6 +2947,139 @@ poly_CopyContour (PLINE ** dst, PLINE * src)
   return TRUE;
 }
 
+typedef struct
+{
+  const VNODE *src;
+  VNODE *dst;
+} node_pair;
+
+struct translate_info
+{
+  node_pair *pairs;
+  unsigned int n;
+  PLINE *contour;
+  Coord dx, dy;
+};
+
+static int
+node_pair_cmp (const void *a, const void *b)
+{
+  const VNODE *va = ((const node_pair *) a)->src;
+  const VNODE *vb = ((const node_pair *) b)->src;
+
+  return (va < vb) ? -1 : (va > vb);
+}
+
+static const BoxType *
+translate_seg (const BoxType * b, void *cl)
+{
+  struct translate_info *info = (struct translate_info *) cl;
+  const seg *src = (const seg *) b;
+  node_pair key, *pair;
+  seg *s;
+
+  key.src = src->v;
+  pair = (node_pair *) bsearch (&key, info->pairs, info->n,
+				sizeof (node_pair), node_pair_cmp);
+  assert (pair != NULL);
+
+  s = (seg *) malloc (sizeof (struct seg));
+  s->box.X1 = src->box.X1 + info->dx;
+  s->box.X2 = src->box.X2 + info->dx;
+  s->box.Y1 = src->box.Y1 + info->dy;
+  s->box.Y2 = src->box.Y2 + info->dy;
+  s->v = pair->dst;
+  s->p = info->contour;
+  s->intersected = src->intersected;
+  return (const BoxType *) s;
+}
+
+/*!
+ * \brief Copy a prepared contour, moving it by (dx, dy).
+ *
+ * The result is what poly_PreContour would give for the moved vertices,
+ * but the edge tree is copied from the source rather than rebuilt.
+ */
+BOOLp
+poly_TranslateContour (PLINE ** dst, PLINE * src, Coord dx, Coord dy)
+{
+  struct translate_info info;
+  VNODE *cur, *newnode, *p, *c;
+  Vector v;
+  double area = 0;
+  unsigned int i;
+
+  assert (src != NULL);
+  assert (src->tree != NULL);
+  v[0] = src->head.point[0] + dx;
+  v[1] = src->head.point[1] + dy;
+  *dst = poly_NewContour (v);
+  if (*dst == NULL)
+    return FALSE;
+
+  info.pairs = (node_pair *) malloc (src->Count * sizeof (node_pair));
+  if (info.pairs == NULL)
+    {
+      poly_DelContour (dst);
+      return FALSE;
+    }
+  info.pairs[0].src = &src->head;
+  info.pairs[0].dst = &(*dst)->head;
+  i = 1;
+  for (cur = src->head.next; cur != &src->head; cur = cur->next)
+    {
+      v[0] = cur->point[0] + dx;
+      v[1] = cur->point[1] + dy;
+      if ((newnode = poly_CreateNode (v)) == NULL)
+	{
+	  free (info.pairs);
+	  poly_DelContour (dst);
+	  return FALSE;
+	}
+      newnode->prev = (*dst)->head.prev;
+      newnode->next = &(*dst)->head;
+      (*dst)->head.prev->next = newnode;
+      (*dst)->head.prev = newnode;
+      assert (i < src->Count);
+      info.pairs[i].src = cur;
+      info.pairs[i].dst = newnode;
+      i++;
+    }
+  assert (i == src->Count);
+
+  (*dst)->Count = src->Count;
+  (*dst)->Flags.orient = src->Flags.orient;
+  (*dst)->xmin = src->xmin + dx, (*dst)->xmax = src->xmax + dx;
+  (*dst)->ymin = src->ymin + dy, (*dst)->ymax = src->ymax + dy;
+
+  /* same sum as in poly_PreContour */
+  p = (c = &(*dst)->head)->prev;
+  if (c != p)
+    do
+      area += (double) (p->point[0] - c->point[0]) *
+	(p->point[1] + c->point[1]);
+    while ((c = (p = c)->next) != &(*dst)->head);
+  (*dst)->area = ABS (area);
+
+  if (src->is_round)
+    {
+      (*dst)->is_round = TRUE;
+      (*dst)->cx = src->cx + dx;
+      (*dst)->cy = src->cy + dy;
+      (*dst)->radius = src->radius;
+    }
+
+  info.n = i;
+  info.contour = *dst;
+  info.dx = dx;
+  info.dy = dy;
+  qsort (info.pairs, info.n, sizeof (node_pair), node_pair_cmp);
+  (*dst)->tree = r_copy_tree ((rtree_t *) src->tree, dx, dy,
+			      translate_seg, &info);
+  free (info.pairs);
+  return TRUE;
+}
+
 /* polygon routines */
 
 BOOLp
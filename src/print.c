@@ -224,7 +224,7 @@ count_drill_lines (DrillInfoType *AllDrills)
 int
 PrintFab_overhang (void)
 {
-  DrillInfoType *AllDrills = GetDrillInfo (PCB->Data);
+  DrillInfoType *AllDrills = GetCachedDrillInfo (PCB->Data);
   int ds = count_drill_lines (AllDrills);
   if (ds < 4)
     ds = 4;
@@ -242,7 +242,7 @@ PrintFab (hidGC gc)
 #ifdef ENABLE_NLS
   char *oldlocale;
 #endif
-  AllDrills = GetDrillInfo (PCB->Data);
+  AllDrills = GetCachedDrillInfo (PCB->Data);
   yoff = -TEXT_LINE;
 
   /* count how many drill description lines will be needed */
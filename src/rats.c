@@ -71,14 +71,44 @@
 #define TRIEDFIRST 0x1
 #define BESTFOUND 0x2
 
+/*!
+ * \brief An object of a connected component, see SubnetLabelsType.
+ */
+typedef struct
+{
+  int seq; /*!< Position in board order. */
+  int type;
+  void *ptr1;
+  void *ptr2;
+} SubnetMemberType;
+
+/*!
+ * \brief The connected components of the copper which hold netlist pins
+ * and pads.
+ *
+ * All of them are found in one sweep before the subnets of any net are
+ * gathered.  Each component lists its lines, polygons, vias, pins and
+ * pads in the order a board scan meets them.  Rats added while drawing
+ * a net join their components, so that the nets after it see the same
+ * connections a fresh lookup would find.
+ */
+typedef struct
+{
+  GHashTable *labels; /*!< Object to component number + 1. */
+  GArray *parent; /*!< Union-find parent of each component. */
+  GPtrArray *members; /*!< GArray of SubnetMemberType per component. */
+  GPtrArray *joined; /*!< GArray of components joined to each, or NULL. */
+  int seq; /*!< Next board order position. */
+} SubnetLabelsType;
+
 /* ---------------------------------------------------------------------------
  * some forward declarations
  */
 static bool FindPad (char *, char *, ConnectionType *, bool);
 static bool ParseConnection (char *, char *, char *);
-static bool DrawShortestRats (NetListType *, void (*)(register ConnectionType *, register ConnectionType *, register RouteStyleType *));
-static bool GatherSubnets (NetListType *, bool, bool);
-static bool CheckShorts (LibraryMenuType *);
+static bool DrawShortestRats (NetListType *, SubnetLabelsType *, void (*)(register ConnectionType *, register ConnectionType *, register RouteStyleType *));
+static bool GatherSubnets (NetListType *, SubnetLabelsType *, bool);
+static bool CheckShorts (LibraryMenuType *, GArray *, GHashTable *);
 static void TransferNet (NetListType *, NetType *, NetType *);
 
 /* ---------------------------------------------------------------------------
@@ -129,17 +159,19 @@ static bool
 FindPad (char *ElementName, char *PinNum, ConnectionType * conn, bool Same)
 {
   ElementType *element;
+  TerminalListType *terminals;
   GList *i;
 
   if ((element = SearchElementByName (PCB->Data, ElementName)) == NULL)
     return false;
+  if ((terminals = SearchTerminalsByNumber (element, PinNum)) == NULL)
+    return false;
 
-  for (i = element->Pad; i != NULL; i = g_list_next (i))
+  for (i = terminals->Pad; i != NULL; i = g_list_next (i))
     {
       PadType *pad = i->data;
 
-      if (NSTRCMP (PinNum, pad->Number) == 0 &&
-          (!Same || !TEST_FLAG (DRCFLAG, pad)))
+      if (!Same || !TEST_FLAG (DRCFLAG, pad))
         {
           conn->type = PAD_TYPE;
           conn->ptr1 = element;
@@ -160,12 +192,11 @@ FindPad (char *ElementName, char *PinNum, ConnectionType * conn, bool Same)
         }
     }
 
-  for (i = element->Pin; i != NULL; i = g_list_next (i))
+  for (i = terminals->Pin; i != NULL; i = g_list_next (i))
     {
       PinType *pin = i->data;
 
       if (!TEST_FLAG (HOLEFLAG, pin) &&
-          pin->Number && NSTRCMP (PinNum, pin->Number) == 0 &&
           (!Same || !TEST_FLAG (DRCFLAG, pin)))
         {
           conn->type = PIN_TYPE;
@@ -363,8 +394,15 @@ TransferNet (NetListType *Netl, NetType *SourceNet, NetType *DestNet)
   memset (&Netl->Net[Netl->NetN], 0, sizeof (NetType));
 }
 
+/*!
+ * \brief Warn about the pins and pads of a subnet's component which
+ * belong to other nets, or to no net at all.
+ *
+ * \p starts holds the netlist pins and pads of the subnet itself, which
+ * are not checked.
+ */
 static bool
-CheckShorts (LibraryMenuType *theNet)
+CheckShorts (LibraryMenuType *theNet, GArray *members, GHashTable *starts)
 {
   bool newone, warn = false;
   PointerListType *generic = (PointerListType *)calloc (1, sizeof (PointerListType));
@@ -372,85 +410,263 @@ CheckShorts (LibraryMenuType *theNet)
    * the menu is always non-null
    */
   void **menu = GetPointerMemory (generic);
+  SubnetMemberType *member;
+  ElementType *element;
+  void *spare;
+  Cardinal i;
 
   *menu = theNet;
-  ALLPIN_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (DRCFLAG, pin))
-      {
-	warn = true;
-	if (!pin->Spare)
-	  {
+  for (i = 0; i < members->len; i++)
+    {
+      member = &g_array_index (members, SubnetMemberType, i);
+      if (member->type == PIN_TYPE)
+	spare = ((PinType *) member->ptr2)->Spare;
+      else if (member->type == PAD_TYPE)
+	spare = ((PadType *) member->ptr2)->Spare;
+      else
+	continue;
+      if (g_hash_table_lookup (starts, member->ptr2))
+	continue;
+      element = (ElementType *) member->ptr1;
+      warn = true;
+      if (!spare)
+	{
+	  if (member->type == PIN_TYPE)
 	    Message (_("Warning! Net \"%s\" is shorted to %s pin %s\n"),
 		     &theNet->Name[2],
 		     UNKNOWN (NAMEONPCB_NAME (element)),
-		     UNKNOWN (pin->Number));
-	    SET_FLAG (WARNFLAG, pin);
-	    continue;
-	  }
-	newone = true;
-	POINTER_LOOP (generic);
-	{
-	  if (*ptr == pin->Spare)
-	    {
-	      newone = false;
-	      break;
-	    }
-	}
-	END_LOOP;
-	if (newone)
-	  {
-	    menu = GetPointerMemory (generic);
-	    *menu = pin->Spare;
-	    Message (_("Warning! Net \"%s\" is shorted to net \"%s\"\n"),
-		     &theNet->Name[2],
-		     &((LibraryMenuType *) (pin->Spare))->Name[2]);
-	    SET_FLAG (WARNFLAG, pin);
-	  }
-      }
-  }
-  ENDALL_LOOP;
-  ALLPAD_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (DRCFLAG, pad))
-      {
-	warn = true;
-	if (!pad->Spare)
-	  {
+		     UNKNOWN (((PinType *) member->ptr2)->Number));
+	  else
 	    Message (_("Warning! Net \"%s\" is shorted  to %s pad %s\n"),
 		     &theNet->Name[2],
 		     UNKNOWN (NAMEONPCB_NAME (element)),
-		     UNKNOWN (pad->Number));
-	    SET_FLAG (WARNFLAG, pad);
-	    continue;
-	  }
-	newone = true;
-	POINTER_LOOP (generic);
-	{
-	  if (*ptr == pad->Spare)
-	    {
-	      newone = false;
-	      break;
-	    }
+		     UNKNOWN (((PadType *) member->ptr2)->Number));
+	  SET_FLAG (WARNFLAG, (PinType *) member->ptr2);
+	  continue;
 	}
-	END_LOOP;
-	if (newone)
+      newone = true;
+      POINTER_LOOP (generic);
+      {
+	if (*ptr == spare)
 	  {
-	    menu = GetPointerMemory (generic);
-	    *menu = pad->Spare;
-	    Message (_("Warning! Net \"%s\" is shorted to net \"%s\"\n"),
-		     &theNet->Name[2],
-		     &((LibraryMenuType *) (pad->Spare))->Name[2]);
-	    SET_FLAG (WARNFLAG, pad);
+	    newone = false;
+	    break;
 	  }
       }
-  }
-  ENDALL_LOOP;
+      END_LOOP;
+      if (newone)
+	{
+	  menu = GetPointerMemory (generic);
+	  *menu = spare;
+	  Message (_("Warning! Net \"%s\" is shorted to net \"%s\"\n"),
+		   &theNet->Name[2],
+		   &((LibraryMenuType *) spare)->Name[2]);
+	  SET_FLAG (WARNFLAG, (PinType *) member->ptr2);
+	}
+    }
   FreePointerListMemory (generic);
   free (generic);
   return (warn);
 }
 
+static void
+LabelSubnetObject (int type, void *ptr1, void *ptr2, void *userdata)
+{
+  SubnetLabelsType *sl = (SubnetLabelsType *) userdata;
+
+  g_hash_table_insert (sl->labels, ptr2, GINT_TO_POINTER (sl->parent->len + 1));
+}
+
+static void
+AddSubnetMember (SubnetLabelsType *sl, int type, void *ptr1, void *ptr2)
+{
+  int label = GPOINTER_TO_INT (g_hash_table_lookup (sl->labels, ptr2));
+  SubnetMemberType member;
+
+  if (label == 0)
+    return;
+  member.seq = sl->seq++;
+  member.type = type;
+  member.ptr1 = ptr1;
+  member.ptr2 = ptr2;
+  g_array_append_val ((GArray *) g_ptr_array_index (sl->members, label - 1),
+		      member);
+}
+
+/*!
+ * \brief Label the copper connected to every netlist pin and pad.
+ *
+ * Assumes InitConnectionLookup() has already been done.  If
+ * \p SelectedOnly is true, only the components of selected pins and
+ * pads are labelled.
+ */
+static SubnetLabelsType *
+LabelSubnets (NetListType *Wantlist, bool SelectedOnly, bool AndRats)
+{
+  SubnetLabelsType *sl = g_new0 (SubnetLabelsType, 1);
+  int component;
+
+  sl->labels = g_hash_table_new (NULL, NULL);
+  sl->parent = g_array_new (FALSE, FALSE, sizeof (int));
+  sl->members = g_ptr_array_new ();
+  sl->joined = g_ptr_array_new ();
+
+  NewSearchEpoch ();
+  NET_LOOP (Wantlist);
+  {
+    CONNECTION_LOOP (net);
+    {
+      if ((!SelectedOnly
+	   || TEST_FLAG (SELECTEDFLAG, (PinType *) connection->ptr2))
+	  && !g_hash_table_lookup (sl->labels, connection->ptr2))
+	{
+	  /* components are disjoint, so the marks left on the earlier
+	   * ones stop the lookup from entering them again
+	   */
+	  component = sl->parent->len;
+	  LookupConnectedComponent (connection->type, connection->ptr1,
+				    connection->ptr2, connection->ptr2,
+				    SEARCHMARK, AndRats, LabelSubnetObject, sl);
+	  g_array_append_val (sl->parent, component);
+	  g_ptr_array_add (sl->members,
+			   g_array_new (FALSE, FALSE, sizeof (SubnetMemberType)));
+	  g_ptr_array_add (sl->joined, NULL);
+	}
+    }
+    END_LOOP;
+  }
+  END_LOOP;
+
+  /* list the members of each component in board order; lines,
+   * polygons and vias are the attachment points of a subnet
+   */
+  ALLLINE_LOOP (PCB->Data);
+  {
+    AddSubnetMember (sl, LINE_TYPE, layer, line);
+  }
+  ENDALL_LOOP;
+  ALLPOLYGON_LOOP (PCB->Data);
+  {
+    AddSubnetMember (sl, POLYGON_TYPE, layer, polygon);
+  }
+  ENDALL_LOOP;
+  VIA_LOOP (PCB->Data);
+  {
+    AddSubnetMember (sl, VIA_TYPE, via, via);
+  }
+  END_LOOP;
+  ALLPIN_LOOP (PCB->Data);
+  {
+    AddSubnetMember (sl, PIN_TYPE, element, pin);
+  }
+  ENDALL_LOOP;
+  ALLPAD_LOOP (PCB->Data);
+  {
+    AddSubnetMember (sl, PAD_TYPE, element, pad);
+  }
+  ENDALL_LOOP;
+  return sl;
+}
+
+static void
+FreeSubnetLabels (SubnetLabelsType *sl)
+{
+  Cardinal i;
+
+  for (i = 0; i < sl->members->len; i++)
+    {
+      g_array_free (g_ptr_array_index (sl->members, i), TRUE);
+      if (g_ptr_array_index (sl->joined, i) != NULL)
+	g_array_free (g_ptr_array_index (sl->joined, i), TRUE);
+    }
+  g_ptr_array_free (sl->members, TRUE);
+  g_ptr_array_free (sl->joined, TRUE);
+  g_array_free (sl->parent, TRUE);
+  g_hash_table_destroy (sl->labels);
+  g_free (sl);
+}
+
+/*!
+ * \brief Return the component an object belongs to, or -1 if it is not
+ * connected to any netlist pin or pad.
+ */
+static int
+SubnetComponent (SubnetLabelsType *sl, void *ptr)
+{
+  int c = GPOINTER_TO_INT (g_hash_table_lookup (sl->labels, ptr)) - 1;
+  int *parent = (int *) sl->parent->data;
+
+  if (c < 0)
+    return -1;
+  while (parent[c] != c)
+    c = parent[c] = parent[parent[c]];
+  return c;
+}
+
+/*!
+ * \brief Join the components of two objects after a rat between them
+ * has been added.
+ */
+static void
+JoinSubnetComponents (SubnetLabelsType *sl, void *ptr1, void *ptr2)
+{
+  int a = SubnetComponent (sl, ptr1);
+  int b = SubnetComponent (sl, ptr2);
+  GArray *joined;
+
+  if (a < 0 || b < 0 || a == b)
+    return;
+  g_array_index (sl->parent, int, b) = a;
+  joined = g_ptr_array_index (sl->joined, a);
+  if (joined == NULL)
+    {
+      joined = g_array_new (FALSE, FALSE, sizeof (int));
+      sl->joined->pdata[a] = joined;
+    }
+  g_array_append_val (joined, b);
+}
+
+static gint
+compare_subnet_members (gconstpointer a, gconstpointer b)
+{
+  return ((const SubnetMemberType *) a)->seq
+    - ((const SubnetMemberType *) b)->seq;
+}
+
+/*!
+ * \brief Return the members of a component, including those of any
+ * components joined to it, in board order.
+ *
+ * The result must be freed if it is not the component's own list.
+ */
+static GArray *
+SubnetMembers (SubnetLabelsType *sl, int component)
+{
+  GArray *result, *pending, *joined;
+  int c;
+
+  if (g_ptr_array_index (sl->joined, component) == NULL)
+    return g_ptr_array_index (sl->members, component);
+
+  result = g_array_new (FALSE, FALSE, sizeof (SubnetMemberType));
+  pending = g_array_new (FALSE, FALSE, sizeof (int));
+  g_array_append_val (pending, component);
+  while (pending->len > 0)
+    {
+      GArray *members;
+
+      c = g_array_index (pending, int, pending->len - 1);
+      g_array_set_size (pending, pending->len - 1);
+      members = g_ptr_array_index (sl->members, c);
+      g_array_append_vals (result, members->data, members->len);
+      joined = g_ptr_array_index (sl->joined, c);
+      if (joined != NULL)
+	g_array_append_vals (pending, joined->data, joined->len);
+    }
+  g_array_free (pending, TRUE);
+  g_array_sort (result, compare_subnet_members);
+  return result;
+}
 
 /*!
  * \brief Determine existing interconnections of the net and gather into
@@ -461,96 +677,107 @@ CheckShorts (LibraryMenuType *theNet)
  * each.
  */
 static bool
-GatherSubnets (NetListType *Netl, bool NoWarn, bool AndRats)
+GatherSubnets (NetListType *Netl, SubnetLabelsType *sl, bool NoWarn)
 {
   NetType *a, *b;
   ConnectionType *conn;
-  Cardinal m, n;
+  SubnetMemberType *member;
+  GArray *members;
+  GHashTable *starts = NULL;
+  Cardinal m, n, i;
+  int component;
   bool Warned = false;
 
+  if (!NoWarn)
+    starts = g_hash_table_new (NULL, NULL);
   for (m = 0; Netl->NetN > 0 && m < Netl->NetN; m++)
     {
       a = &Netl->Net[m];
-      ClearFlagOnAllObjects (DRCFLAG, false);
-      RatFindHook (a->Connection[0].type, a->Connection[0].ptr1,
-                   a->Connection[0].ptr2, a->Connection[0].ptr2,
-                   false, DRCFLAG, AndRats);
-      /* now anybody connected to the first point has DRCFLAG set */
-      /* so move those to this subnet */
-      CLEAR_FLAG (DRCFLAG, (PinType *) a->Connection[0].ptr2);
+      component = SubnetComponent (sl, a->Connection[0].ptr2);
+      /* anybody in the component of the first point is connected */
+      /* to it, so move those to this subnet */
       for (n = m + 1; n < Netl->NetN; n++)
 	{
 	  b = &Netl->Net[n];
 	  /* There can be only one connection in net b */
-	  if (TEST_FLAG (DRCFLAG, (PinType *) b->Connection[0].ptr2))
+	  if (SubnetComponent (sl, b->Connection[0].ptr2) == component)
 	    {
-	      CLEAR_FLAG (DRCFLAG, (PinType *) b->Connection[0].ptr2);
 	      TransferNet (Netl, b, a);
 	      /* back up since new subnet is now at old index */
 	      n--;
 	    }
 	}
+      if (starts)
+	{
+	  g_hash_table_remove_all (starts);
+	  for (i = 0; i < a->ConnectionN; i++)
+	    g_hash_table_insert (starts, a->Connection[i].ptr2,
+				 a->Connection[i].ptr2);
+	}
       /* now add other possible attachment points to the subnet */
       /* e.g. line end-points and vias */
-      /* don't add non-manhattan lines, the auto-router can't route to them */
-      ALLLINE_LOOP (PCB->Data);
-      {
-	if (TEST_FLAG (DRCFLAG, line))
-	  {
-	    conn = GetConnectionMemory (a);
-	    conn->X = line->Point1.X;
-	    conn->Y = line->Point1.Y;
-	    conn->type = LINE_TYPE;
-	    conn->ptr1 = layer;
-	    conn->ptr2 = line;
-	    conn->group = GetLayerGroupNumberByPointer (layer);
-	    conn->menu = NULL;	/* agnostic view of where it belongs */
-	    conn = GetConnectionMemory (a);
-	    conn->X = line->Point2.X;
-	    conn->Y = line->Point2.Y;
-	    conn->type = LINE_TYPE;
-	    conn->ptr1 = layer;
-	    conn->ptr2 = line;
-	    conn->group = GetLayerGroupNumberByPointer (layer);
-	    conn->menu = NULL;
-	  }
-      }
-      ENDALL_LOOP;
-      /* add polygons so the auto-router can see them as targets */
-      ALLPOLYGON_LOOP (PCB->Data);
-      {
-	if (TEST_FLAG (DRCFLAG, polygon))
-	  {
-	    conn = GetConnectionMemory (a);
-	    /* make point on a vertex */
-	    conn->X = polygon->Clipped->contours->head.point[0];
-	    conn->Y = polygon->Clipped->contours->head.point[1];
-	    conn->type = POLYGON_TYPE;
-	    conn->ptr1 = layer;
-	    conn->ptr2 = polygon;
-	    conn->group = GetLayerGroupNumberByPointer (layer);
-	    conn->menu = NULL;	/* agnostic view of where it belongs */
-	  }
-      }
-      ENDALL_LOOP;
-      VIA_LOOP (PCB->Data);
-      {
-	if (TEST_FLAG (DRCFLAG, via))
-	  {
-	    conn = GetConnectionMemory (a);
-	    conn->X = via->X;
-	    conn->Y = via->Y;
-	    conn->type = VIA_TYPE;
-	    conn->ptr1 = via;
-	    conn->ptr2 = via;
-	    conn->group = bottom_group;
-	  }
-      }
-      END_LOOP;
+      members = SubnetMembers (sl, component);
+      for (i = 0; i < members->len; i++)
+	{
+	  member = &g_array_index (members, SubnetMemberType, i);
+	  if (member->type == LINE_TYPE)
+	    {
+	      LayerType *layer = (LayerType *) member->ptr1;
+	      LineType *line = (LineType *) member->ptr2;
+
+	      conn = GetConnectionMemory (a);
+	      conn->X = line->Point1.X;
+	      conn->Y = line->Point1.Y;
+	      conn->type = LINE_TYPE;
+	      conn->ptr1 = layer;
+	      conn->ptr2 = line;
+	      conn->group = GetLayerGroupNumberByPointer (layer);
+	      conn->menu = NULL;	/* agnostic view of where it belongs */
+	      conn = GetConnectionMemory (a);
+	      conn->X = line->Point2.X;
+	      conn->Y = line->Point2.Y;
+	      conn->type = LINE_TYPE;
+	      conn->ptr1 = layer;
+	      conn->ptr2 = line;
+	      conn->group = GetLayerGroupNumberByPointer (layer);
+	      conn->menu = NULL;
+	    }
+	  /* add polygons so the auto-router can see them as targets */
+	  else if (member->type == POLYGON_TYPE)
+	    {
+	      LayerType *layer = (LayerType *) member->ptr1;
+	      PolygonType *polygon = (PolygonType *) member->ptr2;
+
+	      conn = GetConnectionMemory (a);
+	      /* make point on a vertex */
+	      conn->X = polygon->Clipped->contours->head.point[0];
+	      conn->Y = polygon->Clipped->contours->head.point[1];
+	      conn->type = POLYGON_TYPE;
+	      conn->ptr1 = layer;
+	      conn->ptr2 = polygon;
+	      conn->group = GetLayerGroupNumberByPointer (layer);
+	      conn->menu = NULL;	/* agnostic view of where it belongs */
+	    }
+	  else if (member->type == VIA_TYPE)
+	    {
+	      PinType *via = (PinType *) member->ptr2;
+
+	      conn = GetConnectionMemory (a);
+	      conn->X = via->X;
+	      conn->Y = via->Y;
+	      conn->type = VIA_TYPE;
+	      conn->ptr1 = via;
+	      conn->ptr2 = via;
+	      conn->group = bottom_group;
+	    }
+	}
       if (!NoWarn)
-	Warned |= CheckShorts (a->Connection[0].menu);
+	Warned |= CheckShorts (a->Connection[0].menu, members, starts);
+      if (members != g_ptr_array_index (sl->members, component))
+	g_array_free (members, TRUE);
     }
-  ClearFlagOnAllObjects (DRCFLAG, false);
+  if (starts)
+    g_hash_table_destroy (starts);
   return (Warned);
 }
 
@@ -589,7 +816,7 @@ GatherSubnets (NetListType *Netl, bool NoWarn, bool AndRats)
  * (for that net) in it.
  */
 static bool
-DrawShortestRats (NetListType *Netl, void (*funcp) (register ConnectionType *, register ConnectionType *, register RouteStyleType *))
+DrawShortestRats (NetListType *Netl, SubnetLabelsType *sl, void (*funcp) (register ConnectionType *, register ConnectionType *, register RouteStyleType *))
 {
   RatType *line;
   register float distance, temp;
@@ -706,6 +933,7 @@ DrawShortestRats (NetListType *Netl, void (*funcp) (register ConnectionType *, r
 		{
 		  if (distance == 0)
 		    SET_FLAG (VIAFLAG, line);
+		  JoinSubnetComponents (sl, firstpoint->ptr2, secondpoint->ptr2);
 		  AddObjectToCreateUndoList (RATLINE_TYPE, line, line, line);
 		  DrawRat (line);
 		  changed = true;
@@ -744,6 +972,7 @@ AddAllRats (bool SelectedOnly, void (*funcp) (register ConnectionType *, registe
   NetListType *Nets, *Wantlist;
   NetType *lonesome;
   ConnectionType *onepin;
+  SubnetLabelsType *labels;
   bool changed, Warned = false;
 
   /* the netlist library has the text form
@@ -760,6 +989,7 @@ AddAllRats (bool SelectedOnly, void (*funcp) (register ConnectionType *, registe
   changed = false;
   /* initialize finding engine */
   InitConnectionLookup ();
+  labels = LabelSubnets (Wantlist, SelectedOnly, true);
   Nets = (NetListType *)calloc (1, sizeof (NetListType));
   /* now we build another netlist (Nets) for each
    * net in Wantlist that shows how it actually looks now,
@@ -787,11 +1017,12 @@ AddAllRats (bool SelectedOnly, void (*funcp) (register ConnectionType *, registe
 	}
     }
     END_LOOP;
-    Warned |= GatherSubnets (Nets, SelectedOnly, true);
+    Warned |= GatherSubnets (Nets, labels, SelectedOnly);
     if (Nets->NetN > 0)
-      changed |= DrawShortestRats (Nets, funcp);
+      changed |= DrawShortestRats (Nets, labels, funcp);
   }
   END_LOOP;
+  FreeSubnetLabels (labels);
   FreeNetListMemory (Nets);
   free (Nets);
   FreeConnectionLookupMemory ();
@@ -839,6 +1070,7 @@ CollectSubnets (bool SelectedOnly)
   NetListType *Nets, *Wantlist;
   NetType *lonesome;
   ConnectionType *onepin;
+  SubnetLabelsType *labels;
 
   /* the netlist library has the text form
    * ProcNetlist fills in the Netlist
@@ -853,6 +1085,8 @@ CollectSubnets (bool SelectedOnly)
     }
   /* initialize finding engine */
   InitConnectionLookup ();
+  /* Note that AndRats is *FALSE* here! */
+  labels = LabelSubnets (Wantlist, SelectedOnly, false);
   /* now we build another netlist (Nets) for each
    * net in Wantlist that shows how it actually looks now,
    * then fill in any missing connections with rat lines.
@@ -880,10 +1114,10 @@ CollectSubnets (bool SelectedOnly)
 	}
     }
     END_LOOP;
-    /* Note that AndRats is *FALSE* here! */
-    GatherSubnets (Nets, SelectedOnly, false);
+    GatherSubnets (Nets, labels, SelectedOnly);
   }
   END_LOOP;
+  FreeSubnetLabels (labels);
   FreeConnectionLookupMemory ();
   return result;
 }
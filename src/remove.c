@@ -44,6 +44,7 @@
 
 #include "data.h"
 #include "draw.h"
+#include "drill.h"
 #include "error.h"
 #include "misc.h"
 #include "move.h"
@@ -130,9 +131,12 @@ static void *
 DestroyVia (PinType *Via)
 {
   r_delete_entry (DestroyTarget->via_tree, (BoxType *) Via);
+  InvalidateDrillInfo (DestroyTarget);
   free (Via->Name);
 
-  DestroyTarget->Via = g_list_remove (DestroyTarget->Via, Via);
+  UpdateSelectionIndex (VIA_TYPE, Via, Via, false);
+  RemoveObjectFromList (&DestroyTarget->Via, &DestroyTarget->ViaTail,
+			(AnyObjectType *) Via);
   DestroyTarget->ViaN --;
 
   g_slice_free (PinType, Via);
@@ -149,7 +153,9 @@ DestroyLine (LayerType *Layer, LineType *Line)
   r_delete_entry (Layer->line_tree, (BoxType *) Line);
   free (Line->Number);
 
-  Layer->Line = g_list_remove (Layer->Line, Line);
+  UpdateSelectionIndex (LINE_TYPE, Layer, Line, false);
+  RemoveObjectFromList (&Layer->Line, &Layer->LineTail,
+			(AnyObjectType *) Line);
   Layer->LineN --;
 
   g_slice_free (LineType, Line);
@@ -165,7 +171,8 @@ DestroyArc (LayerType *Layer, ArcType *Arc)
 {
   r_delete_entry (Layer->arc_tree, (BoxType *) Arc);
 
-  Layer->Arc = g_list_remove (Layer->Arc, Arc);
+  UpdateSelectionIndex (ARC_TYPE, Layer, Arc, false);
+  RemoveObjectFromList (&Layer->Arc, &Layer->ArcTail, (AnyObjectType *) Arc);
   Layer->ArcN --;
 
   g_slice_free (ArcType, Arc);
@@ -182,7 +189,9 @@ DestroyPolygon (LayerType *Layer, PolygonType *Polygon)
   r_delete_entry (Layer->polygon_tree, (BoxType *) Polygon);
   FreePolygonMemory (Polygon);
 
-  Layer->Polygon = g_list_remove (Layer->Polygon, Polygon);
+  UpdateSelectionIndex (POLYGON_TYPE, Layer, Polygon, false);
+  RemoveObjectFromList (&Layer->Polygon, &Layer->PolygonTail,
+			(AnyObjectType *) Polygon);
   Layer->PolygonN --;
 
   g_slice_free (PolygonType, Polygon);
@@ -239,7 +248,9 @@ DestroyText (LayerType *Layer, TextType *Text)
   free (Text->TextString);
   r_delete_entry (Layer->text_tree, (BoxType *) Text);
 
-  Layer->Text = g_list_remove (Layer->Text, Text);
+  UpdateSelectionIndex (TEXT_TYPE, Layer, Text, false);
+  RemoveObjectFromList (&Layer->Text, &Layer->TextTail,
+			(AnyObjectType *) Text);
   Layer->TextN --;
 
   g_slice_free (TextType, Text);
@@ -263,6 +274,7 @@ DestroyElement (ElementType *Element)
       }
       END_LOOP;
     }
+  InvalidateDrillInfo (DestroyTarget);
   if (DestroyTarget->pad_tree)
     {
       PAD_LOOP (Element);
@@ -277,10 +289,12 @@ DestroyElement (ElementType *Element)
       r_delete_entry (DestroyTarget->name_tree[n], (BoxType *) text);
   }
   END_LOOP;
-  FreeElementMemory (Element);
-
-  DestroyTarget->Element = g_list_remove (DestroyTarget->Element, Element);
+  UpdateSelectionIndex (ELEMENT_TYPE, Element, Element, false);
+  UpdateElementNameIndex (DestroyTarget, Element, false);
+  RemoveObjectFromList (&DestroyTarget->Element, &DestroyTarget->ElementTail,
+			(AnyObjectType *) Element);
   DestroyTarget->ElementN --;
+  FreeElementMemory (Element);
 
   g_slice_free (ElementType, Element);
 
@@ -296,7 +310,9 @@ DestroyRat (RatType *Rat)
   if (DestroyTarget->rat_tree)
     r_delete_entry (DestroyTarget->rat_tree, &Rat->BoundingBox);
 
-  DestroyTarget->Rat = g_list_remove (DestroyTarget->Rat, Rat);
+  UpdateSelectionIndex (RATLINE_TYPE, Rat, Rat, false);
+  RemoveObjectFromList (&DestroyTarget->Rat, &DestroyTarget->RatTail,
+			(AnyObjectType *) Rat);
   DestroyTarget->RatN --;
 
   g_slice_free (RatType, Rat);
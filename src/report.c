@@ -85,7 +85,7 @@ ReportDrills (int argc, char **argv, Coord x, Coord y)
   int total_drills = 0;
   size_t size_left;
 
-  AllDrills = GetDrillInfo (PCB->Data);
+  AllDrills = GetCachedDrillInfo (PCB->Data);
 
   for (n = 0; n < AllDrills->DrillN; n++)
     {
@@ -126,7 +126,6 @@ ReportDrills (int argc, char **argv, Coord x, Coord y)
 	  size_left--;
 	}
     }
-  FreeDrillInfo (AllDrills);
   /* create dialog box */
   gui->report_dialog (_("Drill Report"), stringlist);
 
@@ -580,10 +579,11 @@ ReportFoundPins (int argc, char **argv, Coord x, Coord y)
 }
 
 /*!
- * \brief Assumes that we start with a blank connection state,
- * e.g. ClearFlagOnAllObjects() has been run.
+ * \brief Measures the net at the given location.
  *
- * Does not add its own changes to the undo system
+ * The net is only marked in a new search epoch, so the board and the
+ * undo system are left untouched; TEST_MARK() tells which objects
+ * belong to it until the next search.
  */
 static double
 XYtoNetLength (Coord x, Coord y, int *found)
@@ -593,14 +593,12 @@ XYtoNetLength (Coord x, Coord y, int *found)
   length = 0;
   *found = 0;
 
-  /* NB: The third argument here, 'false' ensures LookupConnection
-   *     does not add its changes to the undo system.
-   */
-  LookupConnection (x, y, false, PCB->Grid, FOUNDFLAG, true);
+  NewSearchEpoch ();
+  LookupConnection (x, y, false, PCB->Grid, SEARCHMARK, true);
 
   ALLLINE_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (FOUNDFLAG, line))
+    if (TEST_MARK (line))
       {
 	int dx, dy;
 	dx = line->Point1.X - line->Point2.X;
@@ -613,7 +611,7 @@ XYtoNetLength (Coord x, Coord y, int *found)
 
   ALLARC_LOOP (PCB->Data);
   {
-    if (TEST_FLAG (FOUNDFLAG, arc))
+    if (TEST_MARK (arc))
       {
 	double l;
 	/* FIXME: we assume width==height here */
@@ -627,91 +625,197 @@ XYtoNetLength (Coord x, Coord y, int *found)
   return length;
 }
 
+/*!
+ * \brief Length and via count of one connected component.
+ */
+typedef struct
+{
+  double length;
+  int vias;
+} NetLengthType;
+
+/*!
+ * \brief State of the all-nets length sweep.
+ */
+typedef struct
+{
+  GHashTable *labels; /*!< Copper object -> component index + 1. */
+  GArray *components; /*!< NetLengthType per component. */
+} NetLengthSweep;
+
+static void
+NetLengthLabelObject (int type, void *ptr1, void *ptr2, void *userdata)
+{
+  NetLengthSweep *sweep = (NetLengthSweep *) userdata;
+
+  if (type & (PIN_TYPE | PAD_TYPE | VIA_TYPE | LINE_TYPE | ARC_TYPE))
+    g_hash_table_insert (sweep->labels, ptr2,
+			 GINT_TO_POINTER (sweep->components->len));
+}
+
+/*!
+ * \brief Returns the component a pin or pad belongs to, labelling it
+ * first if this is the first net to reach it.
+ */
+static int
+NetLengthComponent (NetLengthSweep *sweep, int type, void *ptr1, void *ptr2)
+{
+  int label = GPOINTER_TO_INT (g_hash_table_lookup (sweep->labels, ptr2));
+  NetLengthType component = { 0.0, 0 };
+
+  if (label)
+    return label - 1;
+
+  g_array_append_val (sweep->components, component);
+  LookupConnectedComponent (type, ptr1, ptr2, ptr2, SEARCHMARK, true,
+			    NetLengthLabelObject, sweep);
+  return sweep->components->len - 1;
+}
+
+/*!
+ * \brief Adds up line and arc lengths and vias per component.
+ *
+ * Walks the board in the same order as XYtoNetLength() does, so every
+ * component sums its lengths in the same order and gets the very same
+ * total.
+ */
+static void
+NetLengthSumComponents (NetLengthSweep *sweep)
+{
+  NetLengthType *components = (NetLengthType *) sweep->components->data;
+  int label;
+
+  ALLLINE_LOOP (PCB->Data);
+  {
+    label = GPOINTER_TO_INT (g_hash_table_lookup (sweep->labels, line));
+    if (label)
+      {
+	int dx, dy;
+	dx = line->Point1.X - line->Point2.X;
+	dy = line->Point1.Y - line->Point2.Y;
+	components[label - 1].length += hypot (dx, dy);
+      }
+  }
+  ENDALL_LOOP;
+
+  ALLARC_LOOP (PCB->Data);
+  {
+    label = GPOINTER_TO_INT (g_hash_table_lookup (sweep->labels, arc));
+    if (label)
+      {
+	double l;
+	/* FIXME: we assume width==height here */
+	l = M_PI * 2*arc->Width * abs(arc->Delta)/360.0;
+	components[label - 1].length += l;
+      }
+  }
+  ENDALL_LOOP;
+
+  VIA_LOOP (PCB->Data);
+  {
+    label = GPOINTER_TO_INT (g_hash_table_lookup (sweep->labels, via));
+    if (label)
+      components[label - 1].vias++;
+  }
+  END_LOOP;
+}
+
+/*!
+ * \brief Reports the length of every net in the netlist.
+ *
+ * Each net is measured from its first pin or pad.  Instead of one full
+ * connection lookup and flag reset per net, the copper is labelled one
+ * connected component at a time and the lengths of all components are
+ * then summed up in a single pass over the board.  Nets that share
+ * copper share a component, and report the same length just like
+ * separate lookups would.
+ *
+ * With a file name as second argument, the net names, lengths (in the
+ * given units) and via counts are also written to that file, one
+ * tab separated line per net.
+ */
 static int
 ReportAllNetLengths (int argc, char **argv, Coord x, Coord y)
 {
-  int ni;
-  int found;
-
-  /* Reset all connection flags and save an undo-state to get back
-   * to the state the board was in when we started this function.
-   *
-   * After this, we don't add any changes to the undo system, but
-   * ensure we get back to a point where we can Undo() our changes
-   * by resetting the connections with ClearFlagOnAllObjects() before
-   * calling Undo() at the end of the procedure.
-   */
-  ClearFlagOnAllObjects (FOUNDFLAG, true);
-  IncrementUndoSerialNumber ();
+  const char *units_name = Settings.grid_unit->suffix;
+  NetLengthSweep sweep;
+  GArray *net_components;
+  FILE *fp = NULL;
+  int ni, i;
+
+  if (argc >= 1)
+    units_name = argv[0];
+  if (argc >= 2)
+    {
+      fp = fopen (argv[1], "w");
+      if (fp == NULL)
+	{
+	  Message (_("Could not open %s for writing\n"), argv[1]);
+	  return 1;
+	}
+    }
+
+  sweep.labels = g_hash_table_new (g_direct_hash, g_direct_equal);
+  sweep.components = g_array_new (FALSE, FALSE, sizeof (NetLengthType));
+  net_components = g_array_sized_new (FALSE, FALSE, sizeof (int),
+				      PCB->NetlistLib.MenuN);
+  NewSearchEpoch ();
+  InitConnectionLookup ();
 
   for (ni = 0; ni < PCB->NetlistLib.MenuN; ni++)
     {
-      char *netname = PCB->NetlistLib.Menu[ni].Name + 2;
       char *ename = PCB->NetlistLib.Menu[ni].Entry[0].ListEntry;
       char *pname;
-      bool got_one = 0;
+      ElementType *element;
+      TerminalListType *terminals;
+      int component = -1;
 
       ename = strdup (ename);
       pname = strchr (ename, '-');
-      if (! pname)
+      if (pname)
 	{
-	  free (ename);
-	  continue;
+	  *pname++ = 0;
+	  element = SearchElementByName (PCB->Data, ename);
+	  terminals = element ? SearchTerminalsByNumber (element, pname) : NULL;
+	  if (terminals && terminals->Pad)
+	    component = NetLengthComponent (&sweep, PAD_TYPE, element,
+					    terminals->Pad->data);
+	  else if (terminals && terminals->Pin)
+	    component = NetLengthComponent (&sweep, PIN_TYPE, element,
+					    terminals->Pin->data);
 	}
-      *pname++ = 0;
-
-      ELEMENT_LOOP (PCB->Data);
-      {
-	char *es = element->Name[NAMEONPCB_INDEX].TextString;
-	if (es && strcmp (es, ename) == 0)
-	  {
-	    PIN_LOOP (element);
-	    {
-	      if (strcmp (pin->Number, pname) == 0)
-		{
-		  x = pin->X;
-		  y = pin->Y;
-		  got_one = 1;
-                  break;
-		}
-	    }
-	    END_LOOP;
-	    PAD_LOOP (element);
-	    {
-	      if (strcmp (pad->Number, pname) == 0)
-		{
-		  x = (pad->Point1.X + pad->Point2.X) / 2;
-		  y = (pad->Point1.Y + pad->Point2.Y) / 2;
-		  got_one = 1;
-                  break;
-		}
-	    }
-	    END_LOOP;
-	  }
-      }
-      END_LOOP;
-
-      if (got_one)
-        {
-          char buf[50];
-          const char *units_name = argv[0];
-          Coord length;
-
-          if (argc < 1)
-            units_name = Settings.grid_unit->suffix;
-
-          length = XYtoNetLength (x, y, &found);
+      free (ename);
+      g_array_append_val (net_components, component);
+    }
 
-          /* Reset connectors for the next lookup */
-          ClearFlagOnAllObjects (FOUNDFLAG, false);
+  FreeConnectionLookupMemory ();
+  NetLengthSumComponents (&sweep);
 
-          pcb_snprintf(buf, sizeof (buf), _("%$m*"), units_name, length);
-          gui->log(_("Net \"%s\" length: %s\n"), netname, buf);
-        }
+  for (ni = 0; ni < PCB->NetlistLib.MenuN; ni++)
+    {
+      char *netname = PCB->NetlistLib.Menu[ni].Name + 2;
+      NetLengthType *net;
+      char buf[50];
+      Coord length;
+
+      i = g_array_index (net_components, int, ni);
+      if (i < 0)
+	continue;
+      net = &g_array_index (sweep.components, NetLengthType, i);
+      length = net->length;
+
+      pcb_snprintf(buf, sizeof (buf), _("%$m*"), units_name, length);
+      gui->log(_("Net \"%s\" length: %s\n"), netname, buf);
+      if (fp)
+	pcb_fprintf (fp, "%s\t%m*\t%d\n", netname, units_name, length,
+		     net->vias);
     }
 
-  ClearFlagOnAllObjects (FOUNDFLAG, false);
-  Undo (true);
+  if (fp)
+    fclose (fp);
+  g_array_free (net_components, TRUE);
+  g_array_free (sweep.components, TRUE);
+  g_hash_table_destroy (sweep.labels);
   return 0;
 }
 
@@ -724,23 +828,10 @@ ReportNetLength (int argc, char **argv, Coord x, Coord y)
 
   gui->get_coords (_("Click on a connection"), &x, &y);
 
-  /* Reset all connection flags and save an undo-state to get back
-   * to the state the board was in when we started this function.
-   *
-   * After this, we don't add any changes to the undo system, but
-   * ensure we get back to a point where we can Undo() our changes
-   * by resetting the connections with ClearFlagOnAllObjects() before
-   * calling Undo() at the end of the procedure.
-   */
-  ClearFlagOnAllObjects (FOUNDFLAG, true);
-  IncrementUndoSerialNumber ();
-
   length = XYtoNetLength (x, y, &found);
 
   if (!found)
     {
-      ClearFlagOnAllObjects (FOUNDFLAG, false);
-      Undo (true);
       gui->log (_("No net under cursor.\n"));
       return 1;
     }
@@ -749,7 +840,7 @@ ReportNetLength (int argc, char **argv, Coord x, Coord y)
   {
     PIN_LOOP (element);
     {
-      if (TEST_FLAG (FOUNDFLAG, pin))
+      if (TEST_MARK (pin))
 	{
 	  int ni, nei;
 	  char *ename = element->Name[NAMEONPCB_INDEX].TextString;
@@ -774,7 +865,7 @@ ReportNetLength (int argc, char **argv, Coord x, Coord y)
     END_LOOP;
     PAD_LOOP (element);
     {
-      if (TEST_FLAG (FOUNDFLAG, pad))
+      if (TEST_MARK (pad))
 	{
 	  int ni, nei;
 	  char *ename = element->Name[NAMEONPCB_INDEX].TextString;
@@ -801,8 +892,6 @@ ReportNetLength (int argc, char **argv, Coord x, Coord y)
   END_LOOP;
 
 got_net_name:
-  ClearFlagOnAllObjects (FOUNDFLAG, false);
-  Undo (true);
 
   {
     char buf[50];
@@ -930,23 +1019,9 @@ ReportNetLengthByName (char *tofind, int x, int y)
     regfree (&elt_pattern);
 #endif
 
-  /* Reset all connection flags and save an undo-state to get back
-   * to the state the board was in when we started.
-   *
-   * After this, we don't add any changes to the undo system, but
-   * ensure we get back to a point where we can Undo() our changes
-   * by resetting the connections with ClearFlagOnAllObjects() before
-   * calling Undo() when we are finished.
-   */
-  ClearFlagOnAllObjects (FOUNDFLAG, true);
-  IncrementUndoSerialNumber ();
-
   length = XYtoNetLength (x, y, &found);
   netname = net->Name + 2;
 
-  ClearFlagOnAllObjects (FOUNDFLAG, false);
-  Undo (true);
-
   if (!found)
     {
       if (net_found)
@@ -970,7 +1045,8 @@ ReportNetLengthByName (char *tofind, int x, int y)
 }
 
 static const char report_syntax[] =
-  N_("Report(Object|DrillReport|FoundPins|NetLength|AllNetLengths|[,name])");
+  N_("Report(Object|DrillReport|FoundPins|NetLength|AllNetLengths|Undo|[,name])\n"
+     "Report(AllNetLengths, units[, filename])");
 
 static const char report_help[] = N_("Produce various report.");
 
@@ -997,18 +1073,51 @@ the message log.
 @item AllNetLengths
 The name and length of the net under the crosshair will be reported to
 the message log.  An optional parameter specifies mm, mil, pcb, or in
-units
+units.  If a file name follows the units, the net name, length and
+number of vias of every net are also written to that file, separated
+by tabs, one net per line.
+
+@item Undo
+The size of the undo history and the number, total and slowest time of
+the undo and redo operations of this session will be reported.
 
 @end table
 
 %end-doc */
+static int
+ReportUndo (int argc, char **argv, Coord x, Coord y)
+{
+  UndoStatisticsType stats;
+  char *report;
+
+  GetUndoStatistics (&stats);
+  report = g_strdup_printf (_("Undo history: %lu operations, %lu to redo\n"
+			      "Undo list: %lu bytes, %lu bytes on disk\n"
+			      "Removed objects: about %lu bytes\n"
+			      "Undo: %d calls, %.3f ms total, %.3f ms slowest\n"
+			      "Redo: %d calls, %.3f ms total, %.3f ms slowest\n"),
+			    (unsigned long) stats.Entries,
+			    (unsigned long) stats.RedoEntries,
+			    (unsigned long) stats.ListBytes,
+			    (unsigned long) stats.SpilledBytes,
+			    (unsigned long) stats.RemovedBytes,
+			    stats.Undos, stats.UndoSeconds * 1000,
+			    stats.UndoMaxSeconds * 1000,
+			    stats.Redos, stats.RedoSeconds * 1000,
+			    stats.RedoMaxSeconds * 1000);
+  gui->report_dialog (_("Undo Report"), report);
+  g_free (report);
+  return 0;
+}
+
 /*!
  * \brief Reports on an object.
  */
 static int
 Report (int argc, char **argv, Coord x, Coord y)
 {
-  if ((argc < 1) || (argc > 2))
+  if ((argc < 1) || (argc > 3)
+      || (argc == 3 && strcasecmp (argv[0], "AllNetLengths") != 0))
     AUSAGE (report);
   else if (strcasecmp (argv[0], "Object") == 0)
     {
@@ -1019,6 +1128,8 @@ Report (int argc, char **argv, Coord x, Coord y)
     return ReportDrills (argc - 1, argv + 1, x, y);
   else if (strcasecmp (argv[0], "FoundPins") == 0)
     return ReportFoundPins (argc - 1, argv + 1, x, y);
+  else if (strcasecmp (argv[0], "Undo") == 0)
+    return ReportUndo (argc - 1, argv + 1, x, y);
   else if ((strcasecmp (argv[0], "NetLength") == 0) && (argc == 1))
     return ReportNetLength (argc - 1, argv + 1, x, y);
   else if (strcasecmp (argv[0], "AllNetLengths") == 0)
@@ -216,6 +216,7 @@ RotateElementLowLevel (DataType *Data, ElementType *Element,
 {
   /* solder side objects need a different orientation */
 
+  BeginPolygonBatch ();
   /* the text subroutine decides by itself if the direction
    * is to be corrected
    */
@@ -258,6 +259,7 @@ RotateElementLowLevel (DataType *Data, ElementType *Element,
   /* SetElementBoundingBox reenters the rtree data */
   SetElementBoundingBox (Data, Element, &PCB->Font);
   ClearFromPolygon (Data, ELEMENT_TYPE, Element, Element);
+  EndPolygonBatch ();
 }
 
 /*!
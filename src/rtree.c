@@ -447,6 +447,69 @@ r_create_tree (const BoxType * boxlist[], int N, int manage)
   return rtree;
 }
 
+static struct rtree_node *
+__r_copy_node (struct rtree_node *node, struct rtree_node *parent,
+               Coord dx, Coord dy,
+               const BoxType * (*copy_box) (const BoxType * box, void *cl),
+               void *closure)
+{
+  struct rtree_node *copy;
+  int i;
+
+  copy = (struct rtree_node *)malloc (sizeof (*copy));
+  *copy = *node;
+  copy->parent = parent;
+  copy->box.X1 += dx;
+  copy->box.X2 += dx;
+  copy->box.Y1 += dy;
+  copy->box.Y2 += dy;
+  if (node->flags.is_leaf)
+    for (i = 0; i < M_SIZE; i++)
+      {
+        if (!node->u.rects[i].bptr)
+          break;
+        copy->u.rects[i].bptr = copy_box (node->u.rects[i].bptr, closure);
+        copy->u.rects[i].bounds.X1 += dx;
+        copy->u.rects[i].bounds.X2 += dx;
+        copy->u.rects[i].bounds.Y1 += dy;
+        copy->u.rects[i].bounds.Y2 += dy;
+      }
+  else
+    for (i = 0; i < M_SIZE; i++)
+      {
+        if (!node->u.kids[i])
+          break;
+        copy->u.kids[i] = __r_copy_node (node->u.kids[i], copy, dx, dy,
+                                         copy_box, closure);
+      }
+  return copy;
+}
+
+/*!
+ * \brief Copy an rtree, moving everything in it by (dx, dy).
+ *
+ * The copy has the same structure as the original, which is much
+ * cheaper than inserting the boxes one by one.  copy_box is called for
+ * every entry and must return the box the copy should point to, already
+ * moved by (dx, dy).  Entries the original manages are managed by the
+ * copy too.
+ */
+rtree_t *
+r_copy_tree (rtree_t * rtree, Coord dx, Coord dy,
+             const BoxType * (*copy_box) (const BoxType * box, void *cl),
+             void *closure)
+{
+  rtree_t *copy;
+
+  copy = (rtree_t *)malloc (sizeof (*copy));
+  copy->size = rtree->size;
+  copy->root = __r_copy_node (rtree->root, NULL, dx, dy, copy_box, closure);
+#ifdef SLOW_ASSERTS
+  assert (__r_tree_is_good (copy->root));
+#endif
+  return copy;
+}
+
 /*!
  * \brief Destroy an rtree.
  */
@@ -656,6 +719,22 @@ __r_region_is_empty_rect_in_reg (const BoxType * box, void *cl)
   longjmp (*envp, 1);           /* found one! */
 }
 
+/*!
+ * \brief Get the bounds of everything in the tree.
+ *
+ * The root box is kept tight as entries come and go, so this is O(1).
+ *
+ * \return false if the tree is empty.
+ */
+bool
+r_bounds (rtree_t * rtree, BoxType * bounds)
+{
+  if (rtree == NULL || rtree->size == 0)
+    return false;
+  *bounds = rtree->root->box;
+  return true;
+}
+
 /*!
  * \brief Special-purpose searches build upon r_search.
  *
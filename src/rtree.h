@@ -46,6 +46,10 @@
 
 rtree_t *r_create_tree (const BoxType * boxlist[], int N, int manage);
 void r_destroy_tree (rtree_t ** rtree);
+rtree_t *r_copy_tree (rtree_t * rtree, Coord dx, Coord dy,
+                      const BoxType * (*copy_box) (const BoxType * box,
+                                                   void *cl),
+                      void *closure);
 
 bool r_delete_entry (rtree_t * rtree, const BoxType * which);
 void r_insert_entry (rtree_t * rtree, const BoxType * which, int manage);
@@ -69,6 +73,7 @@ static inline int r_search_pt (rtree_t * rtree, const PointType * pt,
   return r_search(rtree, &box, region_in_search, rectangle_in_region, closure);
 }
 int r_region_is_empty (rtree_t * rtree, const BoxType * region);
+bool r_bounds (rtree_t * rtree, BoxType * bounds);
 void __r_dump_tree (struct rtree_node *, int);
 
 #endif
@@ -89,6 +89,40 @@ struct rubber_info
   LayerType *layer;
 };
 
+/*!
+ * \brief Lines already attached by the lookup in progress.
+ *
+ * Lets rubber_callback skip lines that are in the rubberband list
+ * without scanning the whole list for every line it is handed.
+ */
+static GHashTable *rubber_lines = NULL;
+
+static void
+BeginRubberbandLookup (void)
+{
+  Cardinal n;
+
+  rubber_lines = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (n = 0; n < Crosshair.AttachedObject.RubberbandN; n++)
+    g_hash_table_insert (rubber_lines,
+			 Crosshair.AttachedObject.Rubberband[n].Line,
+			 Crosshair.AttachedObject.Rubberband[n].Line);
+}
+
+static void
+EndRubberbandLookup (void)
+{
+  g_hash_table_destroy (rubber_lines);
+  rubber_lines = NULL;
+}
+
+static void
+AddRubberbandEntry (LayerType *Layer, LineType *Line, PointType *MovedPoint)
+{
+  CreateNewRubberbandEntry (Layer, Line, MovedPoint);
+  g_hash_table_insert (rubber_lines, Line, Line);
+}
+
 static int
 rubber_callback (const BoxType * b, void *cl)
 {
@@ -96,15 +130,14 @@ rubber_callback (const BoxType * b, void *cl)
   struct rubber_info *i = (struct rubber_info *) cl;
   double x, y, rad, dist1, dist2;
   Coord t;
-  int touches = 0, n = 0 ;
+  int touches = 0;
 
   t = line->Thickness / 2;
 
   /* Check to see if the line is already in the rubberband list */
-  for (n = 0; n < Crosshair.AttachedObject.RubberbandN; n++)
-    if (Crosshair.AttachedObject.Rubberband[n].Line == line)
-      return 0;
-    
+  if (g_hash_table_lookup (rubber_lines, line))
+    return 0;
+
   if (TEST_FLAG (LOCKFLAG, line))
     return 0;
   if (line == i->line)
@@ -156,7 +189,7 @@ rubber_callback (const BoxType * b, void *cl)
 	    }
 	  if (touches)
 	    {
-	      CreateNewRubberbandEntry (i->layer, line, &line->Point1);
+	      AddRubberbandEntry (i->layer, line, &line->Point1);
 	      found++;
 	    }
 	}
@@ -186,7 +219,7 @@ rubber_callback (const BoxType * b, void *cl)
 	    }
 	  if (touches)
 	    {
-	      CreateNewRubberbandEntry (i->layer, line, &line->Point2);
+	      AddRubberbandEntry (i->layer, line, &line->Point2);
 	      found++;
 	    }
 	}
@@ -215,14 +248,14 @@ rubber_callback (const BoxType * b, void *cl)
 
 #ifdef CLOSEST_ONLY	/* keep this to remind me */
   if (dist1 < dist2)
-    CreateNewRubberbandEntry (i->layer, line, &line->Point1);
+    AddRubberbandEntry (i->layer, line, &line->Point1);
   else
-    CreateNewRubberbandEntry (i->layer, line, &line->Point2);
+    AddRubberbandEntry (i->layer, line, &line->Point2);
 #else
   if (dist1 <= 0)
-    CreateNewRubberbandEntry (i->layer, line, &line->Point1);
+    AddRubberbandEntry (i->layer, line, &line->Point1);
   if (dist2 <= 0)
-    CreateNewRubberbandEntry (i->layer, line, &line->Point2);
+    AddRubberbandEntry (i->layer, line, &line->Point2);
 #endif
   return 1;
 }
@@ -484,6 +517,31 @@ CheckArcPointForRubberbandConnection (LayerType *Layer,
   END_LOOP;
 }
 
+struct polygon_rubber_info
+{
+  LayerType *layer;
+  PolygonType *polygon;
+};
+
+static int
+polygon_rubber_callback (const BoxType * b, void *cl)
+{
+  LineType *line = (LineType *) b;
+  struct polygon_rubber_info *i = (struct polygon_rubber_info *) cl;
+  Coord thick;
+
+  if (TEST_FLAG (LOCKFLAG, line))
+    return 0;
+  if (TEST_FLAG (CLEARLINEFLAG, line))
+    return 0;
+  thick = (line->Thickness + 1) / 2;
+  if (IsPointInPolygon (line->Point1.X, line->Point1.Y, thick, i->polygon))
+    CreateNewRubberbandEntry (i->layer, line, &line->Point1);
+  if (IsPointInPolygon (line->Point2.X, line->Point2.Y, thick, i->polygon))
+    CreateNewRubberbandEntry (i->layer, line, &line->Point2);
+  return 1;
+}
+
 /* ---------------------------------------------------------------------------
  * checks all visible lines which belong to the same group as the passed polygon.
  * If one of the endpoints of the line lays inside the passed polygon,
@@ -494,6 +552,19 @@ CheckPolygonForRubberbandConnection (LayerType *Layer,
 				     PolygonType *Polygon)
 {
   Cardinal group;
+  struct polygon_rubber_info info;
+  BoxType box;
+
+  /* a line endpoint within half the line width of the polygon always
+   * leaves the line's bounding box overlapping the polygon's, so only
+   * lines found in the layer's tree need to be compared
+   */
+  box = Polygon->BoundingBox;
+  box.X1 -= 1;
+  box.Y1 -= 1;
+  box.X2 += 1;
+  box.Y2 += 1;
+  info.polygon = Polygon;
 
   /* lookup layergroup and check all visible lines in this group */
   group = GetLayerGroupNumberByPointer (Layer);
@@ -501,26 +572,9 @@ CheckPolygonForRubberbandConnection (LayerType *Layer,
   {
     if (layer->On)
       {
-	Coord thick;
-
-	/* the following code just stupidly compares the endpoints
-	 * of the lines
-	 */
-	LINE_LOOP (layer);
-	{
-	  if (TEST_FLAG (LOCKFLAG, line))
-	    continue;
-	  if (TEST_FLAG (CLEARLINEFLAG, line))
-	    continue;
-	  thick = (line->Thickness + 1) / 2;
-	  if (IsPointInPolygon (line->Point1.X, line->Point1.Y,
-				thick, Polygon))
-	    CreateNewRubberbandEntry (layer, line, &line->Point1);
-	  if (IsPointInPolygon (line->Point2.X, line->Point2.Y,
-				thick, Polygon))
-	    CreateNewRubberbandEntry (layer, line, &line->Point2);
-	}
-	END_LOOP;
+	info.layer = layer;
+	r_search (layer->line_tree, &box, NULL, polygon_rubber_callback,
+		  &info);
       }
   }
   END_LOOP;
@@ -535,6 +589,7 @@ CheckPolygonForRubberbandConnection (LayerType *Layer,
 void
 LookupRubberbandLines (int Type, void *Ptr1, void *Ptr2, void *Ptr3)
 {
+  BeginRubberbandLookup ();
 
   /* the function is only supported for some types
    * check all visible lines;
@@ -609,6 +664,8 @@ LookupRubberbandLines (int Type, void *Ptr1, void *Ptr2, void *Ptr3)
 					     (PolygonType *) Ptr2);
       break;
     }
+
+  EndRubberbandLookup ();
 }
 
 void
@@ -1663,6 +1663,152 @@ SearchObjectByID (DataType *Base,
   return (NO_TYPE);
 }
 
+/* ---------------------------------------------------------------------------
+ * Name indexes.
+ *
+ * Every DataType keeps a hash of its elements by name on PCB, built on the
+ * first lookup and kept up to date by UpdateElementNameIndex () as
+ * elements are created, renamed, moved between data sets and destroyed.
+ * Pins and pads are indexed by number per element, also on first lookup;
+ * ForgetElementTerminals () drops an element's table when its pins change.
+ */
+
+/*!
+ * \brief Elements sharing one name on PCB.
+ */
+typedef struct
+{
+  ElementType *First; /*!< The first of them in the element list. */
+  int Count; /*!< How many elements have this name. */
+} ElementNameEntryType;
+
+struct ElementIndexType
+{
+  GHashTable *Names; /*!< Name -> ElementNameEntryType. */
+};
+
+static GHashTable *terminal_index = NULL; /*!< Element -> number table. */
+
+/*!
+ * \brief Linear search for the first element named Name, ignoring Skip.
+ */
+static ElementType *
+FirstElementNamed (DataType *Base, const char *Name, ElementType *Skip)
+{
+  ELEMENT_LOOP (Base);
+  {
+    if (element != Skip && element->Name[1].TextString &&
+	NSTRCMP (element->Name[1].TextString, Name) == 0)
+      return (element);
+  }
+  END_LOOP;
+  return (NULL);
+}
+
+/*!
+ * \brief Only non-empty names are indexed; unnamed parts are common and
+ * would all share one entry.
+ */
+static bool
+IndexedName (const char *Name)
+{
+  return (Name != NULL && *Name != '\0');
+}
+
+static void
+IndexElementName (struct ElementIndexType *index, ElementType *Element)
+{
+  char *name = Element->Name[1].TextString;
+  ElementNameEntryType *entry;
+
+  entry = (ElementNameEntryType *) g_hash_table_lookup (index->Names, name);
+  if (entry == NULL)
+    {
+      entry = g_new (ElementNameEntryType, 1);
+      entry->First = Element;
+      entry->Count = 1;
+      g_hash_table_insert (index->Names, g_strdup (name), entry);
+    }
+  else
+    entry->Count++;
+}
+
+static struct ElementIndexType *
+GetElementIndex (DataType *Base)
+{
+  struct ElementIndexType *index = Base->element_index;
+
+  if (index != NULL)
+    return (index);
+
+  index = g_new (struct ElementIndexType, 1);
+  index->Names = g_hash_table_new_full (g_str_hash, g_str_equal,
+					g_free, g_free);
+  ELEMENT_LOOP (Base);
+  {
+    if (IndexedName (element->Name[1].TextString))
+      IndexElementName (index, element);
+  }
+  END_LOOP;
+  Base->element_index = index;
+  return (index);
+}
+
+/*!
+ * \brief Adds an element to or removes it from the name index of Data.
+ *
+ * Call with Present false before an element's name on PCB changes or the
+ * element leaves Data, and with Present true once it has its new name or
+ * has joined Data.
+ */
+void
+UpdateElementNameIndex (DataType *Data, ElementType *Element, bool Present)
+{
+  struct ElementIndexType *index;
+  ElementNameEntryType *entry;
+  char *name = Element->Name[1].TextString;
+
+  if (Data == NULL || Data->element_index == NULL || !IndexedName (name))
+    return;
+  index = Data->element_index;
+  entry = (ElementNameEntryType *) g_hash_table_lookup (index->Names, name);
+
+  if (Present)
+    {
+      if (entry == NULL)
+	IndexElementName (index, Element);
+      else
+	{
+	  entry->Count++;
+	  /* an element appended to the list can never come before the
+	   * current first one, but a renamed or reinserted one may */
+	  if (Element->Link == NULL || Element->Link->next != NULL)
+	    entry->First = FirstElementNamed (Data, name, NULL);
+	}
+      return;
+    }
+
+  if (entry == NULL)
+    return;
+  if (--entry->Count == 0)
+    g_hash_table_remove (index->Names, name);
+  else if (entry->First == Element)
+    entry->First = FirstElementNamed (Data, name, Element);
+}
+
+/*!
+ * \brief Drops the name index of Data, to be rebuilt on the next lookup.
+ */
+void
+InvalidateElementNameIndex (DataType *Data)
+{
+  if (Data == NULL || Data->element_index == NULL)
+    return;
+  g_hash_table_destroy (Data->element_index->Names);
+  g_free (Data->element_index);
+  Data->element_index = NULL;
+}
+
 /*!
  * \brief Searches for an element by its board name.
  *
@@ -1672,19 +1818,99 @@ SearchObjectByID (DataType *Base,
 ElementType *
 SearchElementByName (DataType *Base, char *Name)
 {
-  ElementType *result = NULL;
+  ElementNameEntryType *entry;
+
+  if (Name == NULL)
+    return (NULL);
+  if (!IndexedName (Name))
+    return (FirstElementNamed (Base, Name, NULL));
+  entry = (ElementNameEntryType *)
+    g_hash_table_lookup (GetElementIndex (Base)->Names, Name);
+  return (entry ? entry->First : NULL);
+}
 
-  ELEMENT_LOOP (Base);
-  {
-    if (element->Name[1].TextString &&
-	NSTRCMP (element->Name[1].TextString, Name) == 0)
-      {
-	result = element;
-	return (result);
-      }
-  }
-  END_LOOP;
-  return result;
+static void
+FreeTerminalList (gpointer data)
+{
+  TerminalListType *terminals = (TerminalListType *) data;
+
+  g_list_free (terminals->Pad);
+  g_list_free (terminals->Pin);
+  g_free (terminals);
+}
+
+static TerminalListType *
+TerminalsNumbered (GHashTable *numbers, char *Number)
+{
+  TerminalListType *terminals;
+
+  terminals = (TerminalListType *) g_hash_table_lookup (numbers, Number);
+  if (terminals == NULL)
+    {
+      terminals = g_new0 (TerminalListType, 1);
+      g_hash_table_insert (numbers, g_strdup (Number), terminals);
+    }
+  return (terminals);
+}
+
+/*!
+ * \brief Searches for the pads and pins of an element by number.
+ *
+ * \return The pads and pins numbered Number in element order, NULL if
+ * there are none.  The lists belong to the index.
+ */
+TerminalListType *
+SearchTerminalsByNumber (ElementType *Element, const char *Number)
+{
+  GHashTable *numbers;
+  GList *i;
+
+  if (Number == NULL)
+    return (NULL);
+  if (terminal_index == NULL)
+    terminal_index = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+					    NULL,
+					    (GDestroyNotify) g_hash_table_destroy);
+
+  numbers = (GHashTable *) g_hash_table_lookup (terminal_index, Element);
+  if (numbers == NULL)
+    {
+      numbers = g_hash_table_new_full (g_str_hash, g_str_equal,
+				       g_free, FreeTerminalList);
+      /* build the lists back to front, prepending is cheap */
+      for (i = g_list_last (Element->Pad); i; i = g_list_previous (i))
+	{
+	  PadType *pad = (PadType *) i->data;
+	  TerminalListType *terminals;
+
+	  if (pad->Number == NULL)
+	    continue;
+	  terminals = TerminalsNumbered (numbers, pad->Number);
+	  terminals->Pad = g_list_prepend (terminals->Pad, pad);
+	}
+      for (i = g_list_last (Element->Pin); i; i = g_list_previous (i))
+	{
+	  PinType *pin = (PinType *) i->data;
+	  TerminalListType *terminals;
+
+	  if (pin->Number == NULL)
+	    continue;
+	  terminals = TerminalsNumbered (numbers, pin->Number);
+	  terminals->Pin = g_list_prepend (terminals->Pin, pin);
+	}
+      g_hash_table_insert (terminal_index, Element, numbers);
+    }
+  return ((TerminalListType *) g_hash_table_lookup (numbers, Number));
+}
+
+/*!
+ * \brief Drops the pin and pad number table of an element.
+ */
+void
+ForgetElementTerminals (ElementType *Element)
+{
+  if (terminal_index != NULL)
+    g_hash_table_remove (terminal_index, Element);
 }
 
 /*!
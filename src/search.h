@@ -72,6 +72,15 @@
 #define ARC_IN_BOX(a,b)		\
 	(BOX_IN_BOX(&((a)->BoundingBox), (b)))
 
+/*!
+ * \brief The pads and pins of an element sharing one number.
+ */
+typedef struct
+{
+  GList *Pad;
+  GList *Pin;
+} TerminalListType;
+
 /* ---------------------------------------------------------------------------
  * prototypes
  */
@@ -88,5 +97,9 @@ int SearchObjectByLocation (unsigned, void **, void **, void **, Coord, Coord, C
 int SearchScreen (Coord, Coord, int, void **, void **, void **);
 int SearchObjectByID (DataType *, void **, void **, void **, int, int);
 ElementType * SearchElementByName (DataType *, char *);
+void UpdateElementNameIndex (DataType *, ElementType *, bool);
+void InvalidateElementNameIndex (DataType *);
+TerminalListType * SearchTerminalsByNumber (ElementType *, const char *);
+void ForgetElementTerminals (ElementType *);
 int SearchLayerByName (DataType *Base, char *Name);
 #endif
@@ -49,6 +49,7 @@
 #include "rats.h"
 #include "misc.h"
 #include "find.h"
+#include "polygon.h"
 
 #include <sys/types.h>
 #ifdef HAVE_REGEX_H
@@ -63,6 +64,302 @@
 #include <dmalloc.h>
 #endif
 
+/* ---------------------------------------------------------------------------
+ * The selection index.
+ *
+ * Every selected object of PCB->Data is kept in a hash table keyed by
+ * the object pointer, so that operations on the selection cost
+ * O(selection) rather than O(board).  Selection changes made in this
+ * file keep the index in step, as do object creation, relocation and
+ * destruction reported through UpdateSelectionIndex ().  Anybody else
+ * writing SELECTEDFLAG bumps selection_serial (see flags.h) and the
+ * next user of the index rebuilds it with one scan of the board.
+ */
+
+/*!
+ * \brief One selected object.
+ *
+ * Ptr1 and Ptr2 follow the conventions of the search routines, the
+ * keys give the order in which SelectedOperation visits the objects.
+ */
+typedef struct
+{
+  int Type;
+  void *Ptr1, *Ptr2;
+  long Key1, Key2;
+} SelectedEntryType;
+
+static struct
+{
+  GHashTable *Objects;		/*!< object pointer -> SelectedEntryType. */
+  DataType *Data;		/*!< the data the index was built for. */
+  unsigned long Serial;		/*!< selection_serial when last in step. */
+} Selection;
+
+/*!
+ * \brief Tells if the index still describes the selection of the board.
+ */
+static bool
+SelectionIndexCurrent (void)
+{
+  return (Selection.Objects != NULL && PCB != NULL
+	  && Selection.Data == PCB->Data
+	  && Selection.Serial == selection_serial);
+}
+
+/*!
+ * \brief Adds an object to the index or drops it, depending on its
+ * SELECTEDFLAG.
+ */
+static void
+IndexObject (int Type, void *Ptr1, void *Ptr2)
+{
+  SelectedEntryType *entry;
+
+  if (!TEST_FLAG (SELECTEDFLAG, (AnyObjectType *) Ptr2))
+    {
+      g_hash_table_remove (Selection.Objects, Ptr2);
+      return;
+    }
+  entry = (SelectedEntryType *) g_hash_table_lookup (Selection.Objects, Ptr2);
+  if (entry == NULL)
+    {
+      entry = g_new (SelectedEntryType, 1);
+      g_hash_table_insert (Selection.Objects, Ptr2, entry);
+    }
+  entry->Type = Type;
+  entry->Ptr1 = Ptr1;
+  entry->Ptr2 = Ptr2;
+}
+
+/*!
+ * \brief Re-files an element together with its pins, pads and names.
+ */
+static void
+IndexElement (ElementType *element, bool OnBoard)
+{
+  PIN_LOOP (element);
+  {
+    if (OnBoard)
+      IndexObject (PIN_TYPE, element, pin);
+    else
+      g_hash_table_remove (Selection.Objects, pin);
+  }
+  END_LOOP;
+  PAD_LOOP (element);
+  {
+    if (OnBoard)
+      IndexObject (PAD_TYPE, element, pad);
+    else
+      g_hash_table_remove (Selection.Objects, pad);
+  }
+  END_LOOP;
+  ELEMENTTEXT_LOOP (element);
+  {
+    if (OnBoard)
+      IndexObject (ELEMENTNAME_TYPE, element, text);
+    else
+      g_hash_table_remove (Selection.Objects, text);
+  }
+  END_LOOP;
+  if (OnBoard)
+    IndexObject (ELEMENT_TYPE, element, element);
+  else
+    g_hash_table_remove (Selection.Objects, element);
+}
+
+/*!
+ * \brief Builds the index from scratch with one scan of the board.
+ */
+static void
+RebuildSelectionIndex (void)
+{
+  if (Selection.Objects == NULL)
+    Selection.Objects = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  else
+    g_hash_table_remove_all (Selection.Objects);
+
+  ALLLINE_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, line))
+      IndexObject (LINE_TYPE, layer, line);
+  }
+  ENDALL_LOOP;
+  ALLARC_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, arc))
+      IndexObject (ARC_TYPE, layer, arc);
+  }
+  ENDALL_LOOP;
+  ALLTEXT_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, text))
+      IndexObject (TEXT_TYPE, layer, text);
+  }
+  ENDALL_LOOP;
+  ALLPOLYGON_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, polygon))
+      IndexObject (POLYGON_TYPE, layer, polygon);
+  }
+  ENDALL_LOOP;
+  ELEMENT_LOOP (PCB->Data);
+  {
+    IndexElement (element, true);
+  }
+  END_LOOP;
+  VIA_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, via))
+      IndexObject (VIA_TYPE, via, via);
+  }
+  END_LOOP;
+  RAT_LOOP (PCB->Data);
+  {
+    if (TEST_FLAG (SELECTEDFLAG, line))
+      IndexObject (RATLINE_TYPE, line, line);
+  }
+  END_LOOP;
+
+  Selection.Data = PCB->Data;
+  Selection.Serial = selection_serial;
+}
+
+/*!
+ * \brief Notifies the selection index that an object has been created,
+ * moved between data/layers or is about to be destroyed.
+ *
+ * OnBoard tells whether the object now belongs to the board (as opposed
+ * to a paste or undo buffer, or nowhere at all).  Ptr1 and Ptr2 follow
+ * the conventions of the search routines; for elements the pins, pads
+ * and names are taken care of as well.
+ */
+void
+UpdateSelectionIndex (int Type, void *Ptr1, void *Ptr2, bool OnBoard)
+{
+  if (!SelectionIndexCurrent ())
+    return;
+  if (Type == ELEMENT_TYPE)
+    IndexElement ((ElementType *) Ptr1, OnBoard);
+  else if (OnBoard)
+    IndexObject (Type, Ptr1, Ptr2);
+  else
+    g_hash_table_remove (Selection.Objects, Ptr2);
+}
+
+/*!
+ * \brief Forgets the selection index if it was built for Data.
+ *
+ * For changes the index cannot follow, like freeing all of Data or
+ * shuffling the layer array.
+ */
+void
+InvalidateSelectionIndex (DataType *Data)
+{
+  if (Selection.Data == Data)
+    Selection.Data = NULL;
+}
+
+/*!
+ * \brief Sets or clears SELECTEDFLAG of an object and keeps the index
+ * in step.
+ */
+static void
+SelectionAssign (int Type, void *Ptr1, void *Ptr2, bool select)
+{
+  bool current = SelectionIndexCurrent ();
+
+  ASSIGN_FLAG (SELECTEDFLAG, select, (AnyObjectType *) Ptr2);
+  if (current)
+    {
+      Selection.Serial = selection_serial;
+      IndexObject (Type, Ptr1, Ptr2);
+    }
+}
+
+static int
+selected_entry_compare (const void *va, const void *vb)
+{
+  const SelectedEntryType *a = (const SelectedEntryType *) va;
+  const SelectedEntryType *b = (const SelectedEntryType *) vb;
+
+  if (a->Key1 != b->Key1)
+    return a->Key1 < b->Key1 ? -1 : 1;
+  if (a->Key2 != b->Key2)
+    return a->Key2 < b->Key2 ? -1 : 1;
+  return 0;
+}
+
+/*!
+ * \brief Collects the selected objects of the given type(s).
+ *
+ * The result is a snapshot, so the caller may change or remove the
+ * objects while walking it.  Objects on a layer are ordered by layer,
+ * pins, pads and names by their element, everything else by ID.
+ *
+ * \return a newly allocated array the caller has to g_free (), NULL if
+ * nothing of that type is selected.
+ */
+static SelectedEntryType *
+GatherSelected (int Type, Cardinal *Count)
+{
+  SelectedEntryType *entries;
+  GHashTableIter iter;
+  gpointer value;
+  Cardinal n = 0;
+
+  if (!SelectionIndexCurrent ())
+    RebuildSelectionIndex ();
+
+  *Count = 0;
+  if (g_hash_table_size (Selection.Objects) == 0)
+    return NULL;
+
+  entries = g_new (SelectedEntryType, g_hash_table_size (Selection.Objects));
+  g_hash_table_iter_init (&iter, Selection.Objects);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      SelectedEntryType *entry = (SelectedEntryType *) value;
+
+      if (!(entry->Type & Type))
+	continue;
+      entries[n] = *entry;
+      entries[n].Key2 = ((AnyObjectType *) entry->Ptr2)->ID;
+      switch (entry->Type)
+	{
+	case LINE_TYPE:
+	case ARC_TYPE:
+	case TEXT_TYPE:
+	case POLYGON_TYPE:
+	  entries[n].Key1 = GetLayerNumber (PCB->Data,
+					    (LayerType *) entry->Ptr1);
+	  /* the layer loops stop at the silk layers */
+	  if (entries[n].Key1 >= max_copper_layer + SILK_LAYER)
+	    continue;
+	  break;
+
+	case PIN_TYPE:
+	case PAD_TYPE:
+	case ELEMENTNAME_TYPE:
+	  entries[n].Key1 = ((ElementType *) entry->Ptr1)->ID;
+	  break;
+
+	default:
+	  entries[n].Key1 = 0;
+	  break;
+	}
+      n++;
+    }
+  if (n == 0)
+    {
+      g_free (entries);
+      return NULL;
+    }
+  qsort (entries, n, sizeof (SelectedEntryType), selected_entry_compare);
+  *Count = n;
+  return entries;
+}
+
 /*!
  * \brief Toggles the selection of any kind of object.
  *
@@ -85,7 +382,8 @@ SelectObject (void)
     {
     case VIA_TYPE:
       AddObjectToFlagUndoList (VIA_TYPE, ptr1, ptr1, ptr1);
-      TOGGLE_FLAG (SELECTEDFLAG, (PinType *) ptr1);
+      SelectionAssign (VIA_TYPE, ptr1, ptr1,
+		       !TEST_FLAG (SELECTEDFLAG, (PinType *) ptr1));
       DrawVia ((PinType *) ptr1);
       break;
 
@@ -95,7 +393,8 @@ SelectObject (void)
 
 	layer = (LayerType *) ptr1;
 	AddObjectToFlagUndoList (LINE_TYPE, ptr1, ptr2, ptr2);
-	TOGGLE_FLAG (SELECTEDFLAG, line);
+	SelectionAssign (LINE_TYPE, ptr1, ptr2,
+			 !TEST_FLAG (SELECTEDFLAG, line));
 	DrawLine (layer, line);
 	break;
       }
@@ -105,7 +404,8 @@ SelectObject (void)
 	RatType *rat = (RatType *) ptr2;
 
 	AddObjectToFlagUndoList (RATLINE_TYPE, ptr1, ptr1, ptr1);
-	TOGGLE_FLAG (SELECTEDFLAG, rat);
+	SelectionAssign (RATLINE_TYPE, ptr1, ptr1,
+			 !TEST_FLAG (SELECTEDFLAG, rat));
 	DrawRat (rat);
 	break;
       }
@@ -116,7 +416,8 @@ SelectObject (void)
 
 	layer = (LayerType *) ptr1;
 	AddObjectToFlagUndoList (ARC_TYPE, ptr1, ptr2, ptr2);
-	TOGGLE_FLAG (SELECTEDFLAG, arc);
+	SelectionAssign (ARC_TYPE, ptr1, ptr2,
+			 !TEST_FLAG (SELECTEDFLAG, arc));
 	DrawArc (layer, arc);
 	break;
       }
@@ -127,7 +428,8 @@ SelectObject (void)
 
 	layer = (LayerType *) ptr1;
 	AddObjectToFlagUndoList (TEXT_TYPE, ptr1, ptr2, ptr2);
-	TOGGLE_FLAG (SELECTEDFLAG, text);
+	SelectionAssign (TEXT_TYPE, ptr1, ptr2,
+			 !TEST_FLAG (SELECTEDFLAG, text));
 	DrawText (layer, text);
 	break;
       }
@@ -138,7 +440,8 @@ SelectObject (void)
 
 	layer = (LayerType *) ptr1;
 	AddObjectToFlagUndoList (POLYGON_TYPE, ptr1, ptr2, ptr2);
-	TOGGLE_FLAG (SELECTEDFLAG, poly);
+	SelectionAssign (POLYGON_TYPE, ptr1, ptr2,
+			 !TEST_FLAG (SELECTEDFLAG, poly));
 	DrawPolygon (layer, poly);
 	/* changing memory order no longer effects draw order */
 	break;
@@ -146,13 +449,15 @@ SelectObject (void)
 
     case PIN_TYPE:
       AddObjectToFlagUndoList (PIN_TYPE, ptr1, ptr2, ptr2);
-      TOGGLE_FLAG (SELECTEDFLAG, (PinType *) ptr2);
+      SelectionAssign (PIN_TYPE, ptr1, ptr2,
+		       !TEST_FLAG (SELECTEDFLAG, (PinType *) ptr2));
       DrawPin ((PinType *) ptr2);
       break;
 
     case PAD_TYPE:
       AddObjectToFlagUndoList (PAD_TYPE, ptr1, ptr2, ptr2);
-      TOGGLE_FLAG (SELECTEDFLAG, (PadType *) ptr2);
+      SelectionAssign (PAD_TYPE, ptr1, ptr2,
+		       !TEST_FLAG (SELECTEDFLAG, (PadType *) ptr2));
       DrawPad ((PadType *) ptr2);
       break;
 
@@ -164,7 +469,8 @@ SelectObject (void)
 	ELEMENTTEXT_LOOP (element);
 	{
 	  AddObjectToFlagUndoList (ELEMENTNAME_TYPE, element, text, text);
-	  TOGGLE_FLAG (SELECTEDFLAG, text);
+	  SelectionAssign (ELEMENTNAME_TYPE, element, text,
+			   !TEST_FLAG (SELECTEDFLAG, text));
 	}
 	END_LOOP;
 	DrawElementName (element);
@@ -179,23 +485,27 @@ SelectObject (void)
 	PIN_LOOP (element);
 	{
 	  AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-	  TOGGLE_FLAG (SELECTEDFLAG, pin);
+	  SelectionAssign (PIN_TYPE, element, pin,
+			   !TEST_FLAG (SELECTEDFLAG, pin));
 	}
 	END_LOOP;
 	PAD_LOOP (element);
 	{
 	  AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-	  TOGGLE_FLAG (SELECTEDFLAG, pad);
+	  SelectionAssign (PAD_TYPE, element, pad,
+			   !TEST_FLAG (SELECTEDFLAG, pad));
 	}
 	END_LOOP;
 	ELEMENTTEXT_LOOP (element);
 	{
 	  AddObjectToFlagUndoList (ELEMENTNAME_TYPE, element, text, text);
-	  TOGGLE_FLAG (SELECTEDFLAG, text);
+	  SelectionAssign (ELEMENTNAME_TYPE, element, text,
+			   !TEST_FLAG (SELECTEDFLAG, text));
 	}
 	END_LOOP;
 	AddObjectToFlagUndoList (ELEMENT_TYPE, element, element, element);
-	TOGGLE_FLAG (SELECTEDFLAG, element);
+	SelectionAssign (ELEMENT_TYPE, element, element,
+			 !TEST_FLAG (SELECTEDFLAG, element));
 	if (PCB->ElementOn &&
 	    ((TEST_FLAG (ONSOLDERFLAG, element) != 0) == SWAP_IDENT ||
 	     PCB->InvisibleObjectsOn))
@@ -214,6 +524,189 @@ SelectObject (void)
   return (changed);
 }
 
+/*!
+ * \brief Selects/unselects an element, or its pins and pads, within
+ * the passed box.
+ *
+ * \return true if the state of any object has changed.
+ */
+static bool
+SelectElementInBlock (ElementType *element, BoxType *Box, bool select)
+{
+  bool changed = false;
+  bool gotElement = false;
+
+  if ((PCB->ElementOn || !select)
+      && !TEST_FLAG (LOCKFLAG, element)
+      && ((TEST_FLAG (ONSOLDERFLAG, element) != 0) == SWAP_IDENT
+	  || PCB->InvisibleObjectsOn))
+    {
+      if (BOX_IN_BOX
+	  (&ELEMENT_TEXT (PCB, element).BoundingBox, Box)
+	  && !TEST_FLAG (LOCKFLAG, &ELEMENT_TEXT (PCB, element))
+	  && TEST_FLAG (SELECTEDFLAG,
+			&ELEMENT_TEXT (PCB, element)) != select)
+	{
+	  /* select all names of element */
+	  ELEMENTTEXT_LOOP (element);
+	  {
+	    AddObjectToFlagUndoList (ELEMENTNAME_TYPE,
+				     element, text, text);
+	    SelectionAssign (ELEMENTNAME_TYPE, element, text, select);
+	  }
+	  END_LOOP;
+	  if (PCB->ElementOn)
+	    DrawElementName (element);
+	  changed = true;
+	}
+      if ((PCB->PinOn || !select) && ELEMENT_IN_BOX (element, Box))
+	if (TEST_FLAG (SELECTEDFLAG, element) != select)
+	  {
+	    AddObjectToFlagUndoList (ELEMENT_TYPE,
+				     element, element, element);
+	    SelectionAssign (ELEMENT_TYPE, element, element, select);
+	    PIN_LOOP (element);
+	    {
+	      if (TEST_FLAG (SELECTEDFLAG, pin) != select)
+		{
+		  AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
+		  SelectionAssign (PIN_TYPE, element, pin, select);
+		  if (PCB->PinOn)
+		    DrawPin (pin);
+		  changed = true;
+		}
+	    }
+	    END_LOOP;
+	    PAD_LOOP (element);
+	    {
+	      if (TEST_FLAG (SELECTEDFLAG, pad) != select)
+		{
+		  AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
+		  SelectionAssign (PAD_TYPE, element, pad, select);
+		  if (PCB->PinOn)
+		    DrawPad (pad);
+		  changed = true;
+		}
+	    }
+	    END_LOOP;
+	    if (PCB->PinOn)
+	      DrawElement (element);
+	    changed = true;
+	    gotElement = true;
+	  }
+    }
+  if ((PCB->PinOn || !select) && !TEST_FLAG (LOCKFLAG, element) && !gotElement)
+    {
+      PIN_LOOP (element);
+      {
+	if ((VIA_OR_PIN_IN_BOX (pin, Box)
+	     && TEST_FLAG (SELECTEDFLAG, pin) != select))
+	  {
+	    AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
+	    SelectionAssign (PIN_TYPE, element, pin, select);
+	    if (PCB->PinOn)
+	      DrawPin (pin);
+	    changed = true;
+	  }
+      }
+      END_LOOP;
+      PAD_LOOP (element);
+      {
+	if (PAD_IN_BOX (pad, Box)
+	    && TEST_FLAG (SELECTEDFLAG, pad) != select
+	    && (TEST_FLAG (ONSOLDERFLAG, pad) == SWAP_IDENT
+		|| PCB->InvisibleObjectsOn
+		|| !select))
+	  {
+	    AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
+	    SelectionAssign (PAD_TYPE, element, pad, select);
+	    if (PCB->PinOn)
+	      DrawPad (pad);
+	    changed = true;
+	  }
+      }
+      END_LOOP;
+    }
+  return (changed);
+}
+
+/*!
+ * \brief Unselects all objects within the passed box.
+ *
+ * Only the selected objects are visited, so clearing the selection
+ * costs O(selection) however big the board is.
+ *
+ * \return true if the state of any object has changed.
+ */
+static bool
+UnselectBlock (BoxType *Box)
+{
+  SelectedEntryType *entries;
+  GHashTable *elements;
+  Cardinal i, n;
+  bool changed = false;
+
+  entries = GatherSelected (ALL_TYPES, &n);
+  elements = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < n; i++)
+    {
+      int type = entries[i].Type;
+      void *ptr1 = entries[i].Ptr1;
+      void *ptr2 = entries[i].Ptr2;
+      bool inside;
+
+      switch (type)
+	{
+	case RATLINE_TYPE:
+	case LINE_TYPE:
+	  inside = LINE_IN_BOX ((LineType *) ptr2, Box);
+	  break;
+
+	case ARC_TYPE:
+	  inside = ARC_IN_BOX ((ArcType *) ptr2, Box);
+	  break;
+
+	case TEXT_TYPE:
+	  inside = TEXT_IN_BOX ((TextType *) ptr2, Box);
+	  break;
+
+	case POLYGON_TYPE:
+	  inside = POLYGON_IN_BOX ((PolygonType *) ptr2, Box);
+	  break;
+
+	case VIA_TYPE:
+	  inside = VIA_OR_PIN_IN_BOX ((PinType *) ptr2, Box);
+	  break;
+
+	default:
+	  /* elements, their pins, pads and names go together */
+	  if (g_hash_table_lookup (elements, ptr1) == NULL)
+	    {
+	      g_hash_table_insert (elements, ptr1, ptr1);
+	      changed = SelectElementInBlock ((ElementType *) ptr1, Box,
+					      false) || changed;
+	    }
+	  continue;
+	}
+      if (!inside || TEST_FLAG (LOCKFLAG, (AnyObjectType *) ptr2)
+	  || !TEST_FLAG (SELECTEDFLAG, (AnyObjectType *) ptr2))
+	continue;
+      AddObjectToFlagUndoList (type, ptr1, ptr2, ptr2);
+      SelectionAssign (type, ptr1, ptr2, false);
+      DrawObject (type, ptr1, ptr2);
+      changed = true;
+    }
+  g_hash_table_destroy (elements);
+  g_free (entries);
+
+  if (changed)
+    {
+      Draw ();
+      IncrementUndoSerialNumber ();
+    }
+  return (changed);
+}
+
 /*!
  * \brief Selects/unselects all visible objects within the passed box.
  *
@@ -226,6 +719,9 @@ SelectBlock (BoxType *Box, bool select)
 {
   bool changed = false;
 
+  if (!select)
+    return (UnselectBlock (Box));
+
   if (PCB->RatOn || !select)
     RAT_LOOP (PCB->Data);
   {
@@ -233,7 +729,7 @@ SelectBlock (BoxType *Box, bool select)
 	!TEST_FLAG (LOCKFLAG, line) && TEST_FLAG (SELECTEDFLAG, line) != select)
       {
 	AddObjectToFlagUndoList (RATLINE_TYPE, line, line, line);
-	ASSIGN_FLAG (SELECTEDFLAG, select, line);
+	SelectionAssign (RATLINE_TYPE, line, line, select);
 	if (PCB->RatOn)
 	  DrawRat (line);
 	changed = true;
@@ -265,7 +761,7 @@ SelectBlock (BoxType *Box, bool select)
 	  && TEST_FLAG (SELECTEDFLAG, line) != select)
 	{
 	  AddObjectToFlagUndoList (LINE_TYPE, layer, line, line);
-	  ASSIGN_FLAG (SELECTEDFLAG, select, line);
+	  SelectionAssign (LINE_TYPE, layer, line, select);
 	  if (layer->On)
 	    DrawLine (layer, line);
 	  changed = true;
@@ -279,7 +775,7 @@ SelectBlock (BoxType *Box, bool select)
 	  && TEST_FLAG (SELECTEDFLAG, arc) != select)
 	{
 	  AddObjectToFlagUndoList (ARC_TYPE, layer, arc, arc);
-	  ASSIGN_FLAG (SELECTEDFLAG, select, arc);
+	  SelectionAssign (ARC_TYPE, layer, arc, select);
 	  if (layer->On)
 	    DrawArc (layer, arc);
 	  changed = true;
@@ -295,7 +791,7 @@ SelectBlock (BoxType *Box, bool select)
 	      && TEST_FLAG (SELECTEDFLAG, text) != select)
 	    {
 	      AddObjectToFlagUndoList (TEXT_TYPE, layer, text, text);
-	      ASSIGN_FLAG (SELECTEDFLAG, select, text);
+	      SelectionAssign (TEXT_TYPE, layer, text, select);
 	      if (TEXT_IS_VISIBLE(PCB, layer, text))
 		DrawText (layer, text);
 	      changed = true;
@@ -310,7 +806,7 @@ SelectBlock (BoxType *Box, bool select)
 	  && TEST_FLAG (SELECTEDFLAG, polygon) != select)
 	{
 	  AddObjectToFlagUndoList (POLYGON_TYPE, layer, polygon, polygon);
-	  ASSIGN_FLAG (SELECTEDFLAG, select, polygon);
+	  SelectionAssign (POLYGON_TYPE, layer, polygon, select);
 	  if (layer->On)
 	    DrawPolygon (layer, polygon);
 	  changed = true;
@@ -323,100 +819,7 @@ SelectBlock (BoxType *Box, bool select)
   /* elements */
   ELEMENT_LOOP (PCB->Data);
   {
-    {
-      bool gotElement = false;
-      if ((PCB->ElementOn || !select)
-	  && !TEST_FLAG (LOCKFLAG, element)
-	  && ((TEST_FLAG (ONSOLDERFLAG, element) != 0) == SWAP_IDENT
-	      || PCB->InvisibleObjectsOn))
-	{
-	  if (BOX_IN_BOX
-	      (&ELEMENT_TEXT (PCB, element).BoundingBox, Box)
-	      && !TEST_FLAG (LOCKFLAG, &ELEMENT_TEXT (PCB, element))
-	      && TEST_FLAG (SELECTEDFLAG,
-			    &ELEMENT_TEXT (PCB, element)) != select)
-	    {
-	      /* select all names of element */
-	      ELEMENTTEXT_LOOP (element);
-	      {
-		AddObjectToFlagUndoList (ELEMENTNAME_TYPE,
-					 element, text, text);
-		ASSIGN_FLAG (SELECTEDFLAG, select, text);
-	      }
-	      END_LOOP;
-	      if (PCB->ElementOn)
-		DrawElementName (element);
-	      changed = true;
-	    }
-	  if ((PCB->PinOn || !select) && ELEMENT_IN_BOX (element, Box))
-	    if (TEST_FLAG (SELECTEDFLAG, element) != select)
-	      {
-		AddObjectToFlagUndoList (ELEMENT_TYPE,
-					 element, element, element);
-		ASSIGN_FLAG (SELECTEDFLAG, select, element);
-		PIN_LOOP (element);
-		{
-		  if (TEST_FLAG (SELECTEDFLAG, pin) != select)
-		    {
-		      AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-		      ASSIGN_FLAG (SELECTEDFLAG, select, pin);
-		      if (PCB->PinOn)
-			DrawPin (pin);
-		      changed = true;
-		    }
-		}
-		END_LOOP;
-		PAD_LOOP (element);
-		{
-		  if (TEST_FLAG (SELECTEDFLAG, pad) != select)
-		    {
-		      AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-		      ASSIGN_FLAG (SELECTEDFLAG, select, pad);
-		      if (PCB->PinOn)
-			DrawPad (pad);
-		      changed = true;
-		    }
-		}
-		END_LOOP;
-		if (PCB->PinOn)
-		  DrawElement (element);
-		changed = true;
-		gotElement = true;
-	      }
-	}
-      if ((PCB->PinOn || !select) && !TEST_FLAG (LOCKFLAG, element) && !gotElement)
-	{
-	  PIN_LOOP (element);
-	  {
-	    if ((VIA_OR_PIN_IN_BOX (pin, Box)
-		 && TEST_FLAG (SELECTEDFLAG, pin) != select))
-	      {
-		AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-		ASSIGN_FLAG (SELECTEDFLAG, select, pin);
-		if (PCB->PinOn)
-		  DrawPin (pin);
-		changed = true;
-	      }
-	  }
-	  END_LOOP;
-	  PAD_LOOP (element);
-	  {
-	    if (PAD_IN_BOX (pad, Box)
-		&& TEST_FLAG (SELECTEDFLAG, pad) != select
-		&& (TEST_FLAG (ONSOLDERFLAG, pad) == SWAP_IDENT
-		    || PCB->InvisibleObjectsOn
-		    || !select))
-	      {
-		AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-		ASSIGN_FLAG (SELECTEDFLAG, select, pad);
-		if (PCB->PinOn)
-		  DrawPad (pad);
-		changed = true;
-	      }
-	  }
-	  END_LOOP;
-	}
-    }
+    changed = SelectElementInBlock (element, Box, select) || changed;
   }
   END_LOOP;
   /* end with vias */
@@ -428,7 +831,7 @@ SelectBlock (BoxType *Box, bool select)
 	&& TEST_FLAG (SELECTEDFLAG, via) != select)
       {
 	AddObjectToFlagUndoList (VIA_TYPE, via, via, via);
-	ASSIGN_FLAG (SELECTEDFLAG, select, via);
+	SelectionAssign (VIA_TYPE, via, via, select);
 	if (PCB->ViaOn)
 	  DrawVia (via);
 	changed = true;
@@ -491,7 +894,15 @@ ObjectOperation (ObjectFunctionType *F,
 
     case ELEMENT_TYPE:
       if (F->Element)
-	return (F->Element ((ElementType *) Ptr1));
+	{
+	  void *result;
+
+	  /* element operations plow with every pin and pad */
+	  BeginPolygonBatch ();
+	  result = F->Element ((ElementType *) Ptr1);
+	  EndPolygonBatch ();
+	  return (result);
+	}
       break;
 
     case PIN_TYPE:
@@ -517,6 +928,58 @@ ObjectOperation (ObjectFunctionType *F,
   return (NULL);
 }
 
+/*!
+ * \brief Applies F to the selected and visible objects of one type.
+ *
+ * Each type takes a fresh snapshot of the selection index, since the
+ * operations on a previous type may have removed objects (e.g. the
+ * pins of a deleted element).
+ */
+static bool
+SelectedTypeOperation (ObjectFunctionType *F, bool Reset, int Type)
+{
+  SelectedEntryType *entries;
+  Cardinal i, n;
+  bool changed = false;
+
+  entries = GatherSelected (Type, &n);
+  for (i = 0; i < n; i++)
+    {
+      void *ptr1 = entries[i].Ptr1;
+      void *ptr2 = entries[i].Ptr2;
+
+      switch (Type)
+	{
+	case LINE_TYPE:
+	case ARC_TYPE:
+	case POLYGON_TYPE:
+	  if (!((LayerType *) ptr1)->On)
+	    continue;
+	  break;
+
+	case TEXT_TYPE:
+	  if (!TEXT_IS_VISIBLE (PCB, (LayerType *) ptr1, (TextType *) ptr2))
+	    continue;
+	  break;
+
+	case ELEMENTNAME_TYPE:
+	  /* only the name currently displayed counts */
+	  if (ptr2 != &ELEMENT_TEXT (PCB, (ElementType *) ptr1))
+	    continue;
+	  break;
+	}
+      if (Reset)
+	{
+	  AddObjectToFlagUndoList (Type, ptr1, ptr2, ptr2);
+	  SelectionAssign (Type, ptr1, ptr2, false);
+	}
+      ObjectOperation (F, Type, ptr1, ptr2, ptr2);
+      changed = true;
+    }
+  g_free (entries);
+  return (changed);
+}
+
 /*!
  * \brief Performs several operations on selected objects which are also
  * visible.
@@ -533,181 +996,44 @@ SelectedOperation (ObjectFunctionType *F, bool Reset, int type)
 {
   bool changed = false;
 
+  /* re-clear each affected polygon once, not once per object */
+  BeginPolygonBatch ();
+
   /* check lines */
   if (type & LINE_TYPE && F->Line)
-    VISIBLELINE_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, line))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (LINE_TYPE, layer, line, line);
-	    CLEAR_FLAG (SELECTEDFLAG, line);
-	  }
-	F->Line (layer, line);
-	changed = true;
-      }
-  }
-  ENDALL_LOOP;
+    changed = SelectedTypeOperation (F, Reset, LINE_TYPE) || changed;
 
   /* check arcs */
   if (type & ARC_TYPE && F->Arc)
-    VISIBLEARC_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, arc))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (ARC_TYPE, layer, arc, arc);
-	    CLEAR_FLAG (SELECTEDFLAG, arc);
-	  }
-	F->Arc (layer, arc);
-	changed = true;
-      }
-  }
-  ENDALL_LOOP;
+    changed = SelectedTypeOperation (F, Reset, ARC_TYPE) || changed;
 
   /* check text */
   if (type & TEXT_TYPE && F->Text)
-    ALLTEXT_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, text) && TEXT_IS_VISIBLE (PCB, layer, text))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (TEXT_TYPE, layer, text, text);
-	    CLEAR_FLAG (SELECTEDFLAG, text);
-	  }
-	F->Text (layer, text);
-	changed = true;
-      }
-  }
-  ENDALL_LOOP;
+    changed = SelectedTypeOperation (F, Reset, TEXT_TYPE) || changed;
 
   /* check polygons */
   if (type & POLYGON_TYPE && F->Polygon)
-    VISIBLEPOLYGON_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, polygon))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (POLYGON_TYPE, layer, polygon, polygon);
-	    CLEAR_FLAG (SELECTEDFLAG, polygon);
-	  }
-	F->Polygon (layer, polygon);
-	changed = true;
-      }
-  }
-  ENDALL_LOOP;
+    changed = SelectedTypeOperation (F, Reset, POLYGON_TYPE) || changed;
 
   /* elements silkscreen */
   if (type & ELEMENT_TYPE && PCB->ElementOn && F->Element)
-    ELEMENT_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, element))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (ELEMENT_TYPE, element, element, element);
-	    CLEAR_FLAG (SELECTEDFLAG, element);
-	  }
-	F->Element (element);
-	changed = true;
-      }
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, ELEMENT_TYPE) || changed;
   if (type & ELEMENTNAME_TYPE && PCB->ElementOn && F->ElementName)
-    ELEMENT_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, &ELEMENT_TEXT (PCB, element)))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (ELEMENTNAME_TYPE,
-				     element,
-				     &ELEMENT_TEXT (PCB, element),
-				     &ELEMENT_TEXT (PCB, element));
-	    CLEAR_FLAG (SELECTEDFLAG, &ELEMENT_TEXT (PCB, element));
-	  }
-	F->ElementName (element);
-	changed = true;
-      }
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, ELEMENTNAME_TYPE) || changed;
 
   if (type & PIN_TYPE && PCB->PinOn && F->Pin)
-    ELEMENT_LOOP (PCB->Data);
-  {
-    PIN_LOOP (element);
-    {
-      if (TEST_FLAG (SELECTEDFLAG, pin))
-	{
-	  if (Reset)
-	    {
-	      AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-	      CLEAR_FLAG (SELECTEDFLAG, pin);
-	    }
-	  F->Pin (element, pin);
-	  changed = true;
-	}
-    }
-    END_LOOP;
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, PIN_TYPE) || changed;
 
   if (type & PAD_TYPE && PCB->PinOn && F->Pad)
-    ELEMENT_LOOP (PCB->Data);
-  {
-    PAD_LOOP (element);
-    {
-      if (TEST_FLAG (SELECTEDFLAG, pad))
-	{
-	  if (Reset)
-	    {
-	      AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-	      CLEAR_FLAG (SELECTEDFLAG, pad);
-	    }
-	  F->Pad (element, pad);
-	  changed = true;
-	}
-    }
-    END_LOOP;
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, PAD_TYPE) || changed;
 
   /* process vias */
   if (type & VIA_TYPE && PCB->ViaOn && F->Via)
-    VIA_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, via))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (VIA_TYPE, via, via, via);
-	    CLEAR_FLAG (SELECTEDFLAG, via);
-	  }
-	F->Via (via);
-	changed = true;
-      }
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, VIA_TYPE) || changed;
   /* and rat-lines */
   if (type & RATLINE_TYPE && PCB->RatOn && F->Rat)
-    RAT_LOOP (PCB->Data);
-  {
-    if (TEST_FLAG (SELECTEDFLAG, line))
-      {
-	if (Reset)
-	  {
-	    AddObjectToFlagUndoList (RATLINE_TYPE, line, line, line);
-	    CLEAR_FLAG (SELECTEDFLAG, line);
-	  }
-	F->Rat (line);
-	changed = true;
-      }
-  }
-  END_LOOP;
+    changed = SelectedTypeOperation (F, Reset, RATLINE_TYPE) || changed;
+  EndPolygonBatch ();
   if (Reset && changed)
     IncrementUndoSerialNumber ();
   return (changed);
@@ -736,7 +1062,7 @@ SelectByFlag (int flag, bool select)
     if (TEST_FLAG (flag, line))
       {
 	AddObjectToFlagUndoList (RATLINE_TYPE, line, line, line);
-	ASSIGN_FLAG (SELECTEDFLAG, select, line);
+	SelectionAssign (RATLINE_TYPE, line, line, select);
 	DrawRat (line);
 	changed = true;
       }
@@ -748,7 +1074,7 @@ SelectByFlag (int flag, bool select)
     if (TEST_FLAG (flag, line) && !TEST_FLAG (LOCKFLAG, line))
       {
 	AddObjectToFlagUndoList (LINE_TYPE, layer, line, line);
-	ASSIGN_FLAG (SELECTEDFLAG, select, line);
+	SelectionAssign (LINE_TYPE, layer, line, select);
 	DrawLine (layer, line);
 	changed = true;
       }
@@ -759,7 +1085,7 @@ SelectByFlag (int flag, bool select)
     if (TEST_FLAG (flag, arc) && !TEST_FLAG (LOCKFLAG, arc))
       {
 	AddObjectToFlagUndoList (ARC_TYPE, layer, arc, arc);
-	ASSIGN_FLAG (SELECTEDFLAG, select, arc);
+	SelectionAssign (ARC_TYPE, layer, arc, select);
 	DrawArc (layer, arc);
 	changed = true;
       }
@@ -770,7 +1096,7 @@ SelectByFlag (int flag, bool select)
     if (TEST_FLAG (flag, polygon) && !TEST_FLAG (LOCKFLAG, polygon))
       {
 	AddObjectToFlagUndoList (POLYGON_TYPE, layer, polygon, polygon);
-	ASSIGN_FLAG (SELECTEDFLAG, select, polygon);
+	SelectionAssign (POLYGON_TYPE, layer, polygon, select);
 	DrawPolygon (layer, polygon);
 	changed = true;
       }
@@ -784,7 +1110,7 @@ SelectByFlag (int flag, bool select)
 	if (!TEST_FLAG (LOCKFLAG, element) && TEST_FLAG (flag, pin))
 	  {
 	    AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-	    ASSIGN_FLAG (SELECTEDFLAG, select, pin);
+	    SelectionAssign (PIN_TYPE, element, pin, select);
 	    DrawPin (pin);
 	    changed = true;
 	  }
@@ -795,7 +1121,7 @@ SelectByFlag (int flag, bool select)
 	if (!TEST_FLAG (LOCKFLAG, element) && TEST_FLAG (flag, pad))
 	  {
 	    AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-	    ASSIGN_FLAG (SELECTEDFLAG, select, pad);
+	    SelectionAssign (PAD_TYPE, element, pad, select);
 	    DrawPad (pad);
 	    changed = true;
 	  }
@@ -809,7 +1135,7 @@ SelectByFlag (int flag, bool select)
     if (TEST_FLAG (flag, via) && !TEST_FLAG (LOCKFLAG, via))
       {
 	AddObjectToFlagUndoList (VIA_TYPE, via, via, via);
-	ASSIGN_FLAG (SELECTEDFLAG, select, via);
+	SelectionAssign (VIA_TYPE, via, via, select);
 	DrawVia (via);
 	changed = true;
       }
@@ -887,7 +1213,7 @@ SelectObjectByName (int Type, char *Pattern, bool select)
 	&& TEST_FLAG (SELECTEDFLAG, text) != select)
       {
 	AddObjectToFlagUndoList (TEXT_TYPE, layer, text, text);
-	ASSIGN_FLAG (SELECTEDFLAG, select, text);
+	SelectionAssign (TEXT_TYPE, layer, text, select);
 	DrawText (layer, text);
 	changed = true;
       }
@@ -906,23 +1232,23 @@ SelectObjectByName (int Type, char *Pattern, bool select)
 	if (name && REGEXEC (name))
 	  {
 	    AddObjectToFlagUndoList (ELEMENT_TYPE, element, element, element);
-	    ASSIGN_FLAG (SELECTEDFLAG, select, element);
+	    SelectionAssign (ELEMENT_TYPE, element, element, select);
 	    PIN_LOOP (element);
 	    {
 	      AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-	      ASSIGN_FLAG (SELECTEDFLAG, select, pin);
+	      SelectionAssign (PIN_TYPE, element, pin, select);
 	    }
 	    END_LOOP;
 	    PAD_LOOP (element);
 	    {
 	      AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-	      ASSIGN_FLAG (SELECTEDFLAG, select, pad);
+	      SelectionAssign (PAD_TYPE, element, pad, select);
 	    }
 	    END_LOOP;
 	    ELEMENTTEXT_LOOP (element);
 	    {
 	      AddObjectToFlagUndoList (ELEMENTNAME_TYPE, element, text, text);
-	      ASSIGN_FLAG (SELECTEDFLAG, select, text);
+	      SelectionAssign (ELEMENTNAME_TYPE, element, text, select);
 	    }
 	    END_LOOP;
 	    DrawElementName (element);
@@ -940,7 +1266,7 @@ SelectObjectByName (int Type, char *Pattern, bool select)
 	&& TEST_FLAG (SELECTEDFLAG, pin) != select)
       {
 	AddObjectToFlagUndoList (PIN_TYPE, element, pin, pin);
-	ASSIGN_FLAG (SELECTEDFLAG, select, pin);
+	SelectionAssign (PIN_TYPE, element, pin, select);
 	DrawPin (pin);
 	changed = true;
       }
@@ -956,7 +1282,7 @@ SelectObjectByName (int Type, char *Pattern, bool select)
       if (pad->Name && REGEXEC (pad->Name))
 	{
 	  AddObjectToFlagUndoList (PAD_TYPE, element, pad, pad);
-	  ASSIGN_FLAG (SELECTEDFLAG, select, pad);
+	  SelectionAssign (PAD_TYPE, element, pad, select);
 	  DrawPad (pad);
 	  changed = true;
 	}
@@ -970,7 +1296,7 @@ SelectObjectByName (int Type, char *Pattern, bool select)
 	&& REGEXEC (via->Name) && TEST_FLAG (SELECTEDFLAG, via) != select)
       {
 	AddObjectToFlagUndoList (VIA_TYPE, via, via, via);
-	ASSIGN_FLAG (SELECTEDFLAG, select, via);
+	SelectionAssign (VIA_TYPE, via, via, select);
 	DrawVia (via);
 	changed = true;
       }
@@ -1035,7 +1361,7 @@ SelectBuriedVias (bool select)
    if (VIA_IS_BURIED (via))
       {
 	AddObjectToFlagUndoList (VIA_TYPE, via, via, via);
-	ASSIGN_FLAG (SELECTEDFLAG, select, via);
+	SelectionAssign (VIA_TYPE, via, via, select);
 	changed = true;
       }
   END_LOOP;
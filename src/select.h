@@ -47,6 +47,8 @@ bool SelectedOperation (ObjectFunctionType *, bool, int);
 void *ObjectOperation (ObjectFunctionType *, int, void *, void *, void *);
 bool SelectByFlag (int flag, bool select);
 bool SelectBuriedVias (bool select);
+void UpdateSelectionIndex (int Type, void *Ptr1, void *Ptr2, bool OnBoard);
+void InvalidateSelectionIndex (DataType *Data);
 
 #if defined(HAVE_REGCOMP) || defined(HAVE_RE_COMP)
 bool SelectObjectByName (int, char *, bool);
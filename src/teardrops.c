@@ -35,6 +35,7 @@
 #include "hid.h"
 #include "misc.h"
 #include "create.h"
+#include "polygon.h"
 #include "rtree.h"
 #include "undo.h"
 
@@ -48,6 +49,41 @@ static LayerType * silk;
 
 static int new_arcs = 0;
 
+/*!
+ * \brief A teardrop arc waiting to be added to the board.
+ */
+typedef struct
+{
+  int layer;
+  Coord X, Y, radius;
+  Angle start, delta;
+  Coord thickness, clearance;
+  FlagType flags;
+} TeardropArcType;
+
+/*!
+ * \brief Arcs found by the search, added in one go by add_teardrop_arcs ().
+ */
+static GArray *pending_arcs = NULL;
+
+static void
+queue_teardrop_arc (LineType *line, Coord X, Coord Y, Coord radius,
+                    Angle start, Angle delta)
+{
+  TeardropArcType arc;
+
+  arc.layer = layer;
+  arc.X = X;
+  arc.Y = Y;
+  arc.radius = radius;
+  arc.start = start;
+  arc.delta = delta;
+  arc.thickness = line->Thickness;
+  arc.clearance = line->Clearance;
+  arc.flags = line->Flags;
+  g_array_append_val (pending_arcs, arc);
+}
+
 int
 distance_between_points(int x1,int y1, int x2, int y2)
 {
@@ -63,7 +99,6 @@ distance_between_points(int x1,int y1, int x2, int y2)
 static int
 check_line_callback (const BoxType * box, void *cl)
 {
-  LayerType * lay = & PCB->Data->Layer[layer];
   LineType * l = (LineType *) box;
   int x1, x2, y1, y2;
   double a, b, c, x, r, t;
@@ -72,7 +107,6 @@ check_line_callback (const BoxType * box, void *cl)
   double ldist, adist, radius;
   double vx, vy, vr, vl;
   int delta, aoffset, count;
-  ArcType * arc;
 
   /* if our line is to short ignore it */
   if (distance_between_points(l->Point1.X,l->Point1.Y,l->Point2.X,l->Point2.Y) < MIN_LINE_LENGTH )
@@ -164,20 +198,14 @@ check_line_callback (const BoxType * box, void *cl)
     ax = lx - dy * adist;
     ay = ly + dx * adist;
 
-    arc = CreateNewArcOnLayer (lay, (int)ax, (int)ay, (int)radius, (int)radius,
-			       (int)theta+90+aoffset, delta-aoffset,
-			       l->Thickness, l->Clearance, l->Flags);
-    if (arc)
-      AddObjectToCreateUndoList (ARC_TYPE, lay, arc, arc);
+    queue_teardrop_arc (l, (int)ax, (int)ay, (int)radius,
+			(int)theta+90+aoffset, delta-aoffset);
 
     ax = lx + dy * (x+t);
     ay = ly - dx * (x+t);
 
-    arc = CreateNewArcOnLayer (lay, (int)ax, (int)ay, (int)radius, (int)radius,
-			       (int)theta-90-aoffset, -delta+aoffset,
-			       l->Thickness, l->Clearance, l->Flags);
-    if (arc)
-      AddObjectToCreateUndoList (ARC_TYPE, lay, arc, arc);
+    queue_teardrop_arc (l, (int)ax, (int)ay, (int)radius,
+			(int)theta-90-aoffset, -delta+aoffset);
 
     radius += t*1.9;
     aoffset = acos ((double)adist / radius) * 180.0 / M_PI;
@@ -210,6 +238,37 @@ check_pin (PinType * _pin)
     }
 }
 
+/*!
+ * \brief Add the queued arcs to the board.
+ *
+ * The board is not changed while the lines are searched, so all the arcs
+ * are added here, and the polygons they cut through are re-clipped once
+ * each when the batch ends rather than once per arc.
+ */
+static void
+add_teardrop_arcs (void)
+{
+  guint i;
+
+  BeginPolygonBatch ();
+  for (i = 0; i < pending_arcs->len; i++)
+    {
+      TeardropArcType *t = &g_array_index (pending_arcs, TeardropArcType, i);
+      LayerType *lay = &PCB->Data->Layer[t->layer];
+      ArcType *arc;
+
+      arc = CreateNewArcOnLayer (lay, t->X, t->Y, t->radius, t->radius,
+				 t->start, t->delta, t->thickness,
+				 t->clearance, t->flags);
+      if (arc)
+	{
+	  AddObjectToCreateUndoList (ARC_TYPE, lay, arc, arc);
+	  ClearFromPolygon (PCB->Data, ARC_TYPE, lay, arc);
+	}
+    }
+  EndPolygonBatch ();
+}
+
 /* %start-doc actions Teardrops
 
 The @code{Teardrops()} action adds teardrops to the intersections
@@ -258,6 +317,7 @@ teardrops (int argc, char **argv, Coord x, Coord y)
   silk = & PCB->Data->SILKLAYER;
 
   new_arcs = 0;
+  pending_arcs = g_array_new (FALSE, FALSE, sizeof (TeardropArcType));
 
   VIA_LOOP (PCB->Data);
   {
@@ -271,6 +331,10 @@ teardrops (int argc, char **argv, Coord x, Coord y)
   }
   ENDALL_LOOP;
 
+  add_teardrop_arcs ();
+  g_array_free (pending_arcs, TRUE);
+  pending_arcs = NULL;
+
   gui->invalidate_all ();
 
   if (new_arcs)
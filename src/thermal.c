@@ -406,6 +406,26 @@ square_therm (PinType *pin, Cardinal style)
     }
 }
 
+/*!
+ * \brief Square thermals, apart from style 4, are built from the pin
+ * position plus integer offsets, so identical pins can share one shape.
+ */
+static POLYAREA *
+cached_square_therm (PinType *pin, Cardinal style)
+{
+  ShapeKeyType key;
+  POLYAREA *p;
+
+  if (style == 4)
+    return square_therm (pin, style);
+
+  InitShapeKey (&key, SHAPE_SQUARE_THERMAL, pin->Thickness, pin->Clearance,
+                style, 0, pcb->ThermScale);
+  if ((p = LookupShape (&key, pin->X, pin->Y)) == NULL)
+    p = RememberShape (&key, pin->X, pin->Y, square_therm (pin, style));
+  return p;
+}
+
 static POLYAREA *
 oct_therm (PinType *pin, Cardinal style)
 {
@@ -465,7 +485,7 @@ ThermPoly (PCBType *p, PinType *pin, Cardinal laynum)
     return NULL;                /* solid connection no clearance */
   pcb = p;
   if (TEST_FLAG (SQUAREFLAG, pin))
-    return square_therm (pin, style);
+    return cached_square_therm (pin, style);
   if (TEST_FLAG (OCTAGONFLAG, pin))
     return oct_therm (pin, style);
   /* must be circular */
@@ -12,6 +12,10 @@
  * Both lists are organized as first-in-last-out which means that the undo
  * list can always use the last entry of the remove list.
  *
+ * The undo list is a chain of fixed size chunks holding packed records
+ * of varying length.  When the undo-memory setting is exceeded, chunks
+ * away from the undo position are written to a temporary file.
+ *
  * A serial number is incremented whenever an operation is completed.
  *
  * An operation itself may consist of several basic instructions.
@@ -57,6 +61,7 @@
 
 #include <assert.h>
 #include <memory.h>
+#include <stddef.h>
 #include "global.h"
 
 #include "buffer.h"
@@ -64,6 +69,7 @@
 #include "create.h"
 #include "data.h"
 #include "draw.h"
+#include "drill.h"
 #include "error.h"
 #include "flags.h"
 #include "insert.h"
@@ -76,6 +82,7 @@
 #include "rotate.h"
 #include "rtree.h"
 #include "search.h"
+#include "select.h"
 #include "set.h"
 #include "undo.h"
 #include "strflags.h"
@@ -174,15 +181,35 @@ typedef struct
   LibraryType *lib;
 } NetlistChangeType;
 
+/*!
+ * \brief Where a removed object lives inside the remove list.
+ *
+ * Objects keep their address when they are moved between buffers, so
+ * these pointers stay valid for as long as the entry is of type
+ * UNDO_REMOVE.
+ */
+typedef struct
+{
+  void *Ptr1, *Ptr2, *Ptr3;
+} RemovedObjectType;
+
 /*!
  * \brief Holds information about an operation.
+ *
+ * Records are packed back to back in the chunks of the undo list, and
+ * each one is only as long as its Type needs, see RecordSize().  Only
+ * the member of Data which belongs to the Type may be used.
  */
 typedef struct
 {
-  int Serial, /*!< Serial number of operation. */
-    Type, /*!< Type of operation. */
-    Kind, /*!< Type of object with given ID. */
-    ID; /*!< Object ID. */
+  int Serial; /*!< Serial number of operation. */
+  unsigned int Type : 24; /*!< Type of operation. */
+  unsigned int Size : 8; /*!< Length of this record, in UNDO_RECORD_ALIGN
+                              units. */
+  unsigned int Kind : 24; /*!< Type of object with given ID. */
+  unsigned int PrevSize : 8; /*!< Length of the record before this one in
+                                  its chunk, 0 for the first one. */
+  int ID; /*!< Object ID. */
   union /* Some additional information. */
   {
     ChangeNameType ChangeName;
@@ -196,26 +223,80 @@ typedef struct
     LayerChangeType LayerChange;
     ClearPolyType ClearPoly;
     NetlistChangeType NetlistChange;
+    RemovedObjectType Removed;
     SetViaLayersChangeType SetViaLayersChange;
     long int CopyID;
   }
   Data;
 } UndoListType;
 
+/*!
+ * \brief Records are padded to a multiple of this many bytes.
+ */
+#define UNDO_RECORD_ALIGN 8
+
+/*!
+ * \brief Bytes of records held by one chunk of the undo list.
+ */
+#define UNDO_CHUNK_SIZE (64 * 1024)
+
+/*!
+ * \brief A chunk of packed undo records.
+ *
+ * Chunks other than the one at the undo position may be written to the
+ * spill file when the undo list grows past the undo-memory setting.
+ * Their Records are then NULL until an undo or redo reaches them.
+ */
+typedef struct UndoChunkType
+{
+  struct UndoChunkType *Prev, *Next;
+  char *Records; /*!< The records, NULL while spilled. */
+  size_t Used; /*!< Bytes of records in this chunk. */
+  size_t Last; /*!< Offset of the last record. */
+  long Spilled; /*!< Offset in the spill file, -1 if never written. */
+} UndoChunkType;
+
+/*!
+ * \brief A position in the undo list.
+ */
+typedef struct
+{
+  UndoChunkType *Chunk;
+  size_t Offset; /*!< Byte offset of a record in Chunk. */
+} UndoCursorType;
+
+#define CURSOR_RECORD(c) ((UndoListType *) ((c)->Chunk->Records + (c)->Offset))
+
 /* ---------------------------------------------------------------------------
  * some local variables
  */
 static DataType *RemoveList = NULL; /*!< List of removed objects. */
-static UndoListType *UndoList = NULL; /*!< List of operations. */
+static UndoChunkType *FirstChunk = NULL; /*!< List of operations. */
+static UndoChunkType *LastChunk = NULL;
+static UndoCursorType Top; /*!< Where the operations to redo start. */
 static int Serial = 1; /*!< Serial number. */
 static int SavedSerial;
 static size_t UndoN; /*!< Number of entries. */
 static size_t RedoN; /*!< Number of entries. */
-static size_t UndoMax; /*!< Number of entries. */
-static bool Locked = false; /*!< Do not add entries if. */
+static size_t ChunkBytes; /*!< Bytes of chunks held in memory. */
+static size_t SpilledBytes; /*!< Bytes of records in the spill file. */
+static size_t NameBytes; /*!< Bytes of names held by the records. */
+static FILE *SpillFile = NULL; /*!< Holds old records, see SpillChunks(). */
+static long SpillEnd; /*!< Where the next chunk goes in SpillFile. */
+static bool SpillFailed = false; /*!< Keep everything in memory. */
+static bool Locked = false; /*!< Do not add entries if flag is set;
+                              prevents from infinite loops. */
 static bool andDraw = true;
-										/* flag is set; prevents from */
-										/* infinite loops */
+
+/*!
+ * \brief How long the Undo() and Redo() calls of this session took.
+ */
+static struct
+{
+  GTimer *Timer;
+  int Undos, Redos;
+  double UndoTotal, UndoMax, RedoTotal, RedoMax;
+} Latency;
 
 /* ---------------------------------------------------------------------------
  * some local prototypes
@@ -243,6 +324,287 @@ static bool UndoClearPoly (UndoListType *);
 static bool UndoSetViaLayers (UndoListType *);
 static int PerformUndo (UndoListType *);
 
+/*!
+ * \brief Returns the length of a record of the given type in bytes.
+ *
+ * Types which turn into each other when they are undone share a size.
+ */
+static size_t
+RecordSize (int Type)
+{
+  UndoListType *undo;
+  size_t size;
+
+  switch (Type)
+    {
+    case UNDO_CHANGENAME:
+      size = sizeof (undo->Data.ChangeName);
+      break;
+    case UNDO_MOVE:
+    case UNDO_MIRROR:
+    case UNDO_CHANGEANGLES:
+      size = sizeof (undo->Data.Move);
+      break;
+    case UNDO_CREATE:
+    case UNDO_REMOVE:
+      size = sizeof (undo->Data.Removed);
+      break;
+    case UNDO_REMOVE_POINT:
+    case UNDO_INSERT_POINT:
+      size = sizeof (undo->Data.RemovedPoint);
+      break;
+    case UNDO_REMOVE_CONTOUR:
+    case UNDO_INSERT_CONTOUR:
+      size = sizeof (undo->Data.CopyID);
+      break;
+    case UNDO_ROTATE:
+      size = sizeof (undo->Data.Rotate);
+      break;
+    case UNDO_CLEAR:
+      size = sizeof (undo->Data.ClearPoly);
+      break;
+    case UNDO_MOVETOLAYER:
+      size = sizeof (undo->Data.MoveToLayer);
+      break;
+    case UNDO_FLAG:
+      size = sizeof (undo->Data.Flags);
+      break;
+    case UNDO_CHANGESIZE:
+      size = MAX (sizeof (undo->Data.Size), sizeof (undo->Data.Scale));
+      break;
+    case UNDO_CHANGE2NDSIZE:
+    case UNDO_CHANGECLEARSIZE:
+    case UNDO_CHANGEMASKSIZE:
+      size = sizeof (undo->Data.Size);
+      break;
+    case UNDO_LAYERCHANGE:
+      size = sizeof (undo->Data.LayerChange);
+      break;
+    case UNDO_NETLISTCHANGE:
+      size = sizeof (undo->Data.NetlistChange);
+      break;
+    case UNDO_CHANGESETVIALAYERS:
+      size = sizeof (undo->Data.SetViaLayersChange);
+      break;
+    default:
+      size = sizeof (undo->Data);
+      break;
+    }
+  size += offsetof (UndoListType, Data);
+  return (size + UNDO_RECORD_ALIGN - 1) / UNDO_RECORD_ALIGN * UNDO_RECORD_ALIGN;
+}
+
+/*!
+ * \brief Returns the memory held by a name of a change-name record.
+ */
+static size_t
+NameSize (char *Name)
+{
+  return Name ? strlen (Name) + 1 : 0;
+}
+
+/*!
+ * \brief Reads a spilled chunk back into memory.
+ */
+static void
+LoadChunk (UndoChunkType *Chunk)
+{
+  if (Chunk->Records != NULL)
+    return;
+
+  Chunk->Records = (char *) malloc (UNDO_CHUNK_SIZE);
+  if (Chunk->Records == NULL
+      || fseek (SpillFile, Chunk->Spilled, SEEK_SET) != 0
+      || fread (Chunk->Records, 1, Chunk->Used, SpillFile) != Chunk->Used)
+    {
+      fprintf (stderr, "Can't read the undo history back from its "
+	       "temporary file\n");
+      exit (1);
+    }
+  ChunkBytes += UNDO_CHUNK_SIZE;
+  SpilledBytes -= Chunk->Used;
+}
+
+/*!
+ * \brief Writes chunks to the spill file until the undo list holds no
+ * more memory than the undo-memory setting allows.
+ *
+ * The oldest chunks go first.  The chunk at the undo position is always
+ * kept, the others are read back when an undo or redo reaches them.
+ * The objects and names the records point to stay in memory.
+ */
+static void
+SpillChunks (void)
+{
+  UndoChunkType *chunk;
+  size_t limit = (size_t) Settings.UndoMemory * 1024;
+
+  if (limit == 0 || ChunkBytes <= limit || SpillFailed)
+    return;
+
+  if (SpillFile == NULL && (SpillFile = tmpfile ()) == NULL)
+    {
+      Message (_("Can't create a temporary file for the undo history, "
+		 "keeping all of it in memory\n"));
+      SpillFailed = true;
+      return;
+    }
+
+  for (chunk = FirstChunk; chunk && ChunkBytes > limit; chunk = chunk->Next)
+    {
+      if (chunk->Records == NULL || chunk == Top.Chunk)
+	continue;
+
+      /* every chunk keeps its place in the file once it has one */
+      if (chunk->Spilled < 0)
+	{
+	  chunk->Spilled = SpillEnd;
+	  SpillEnd += UNDO_CHUNK_SIZE;
+	}
+      if (fseek (SpillFile, chunk->Spilled, SEEK_SET) != 0
+	  || fwrite (chunk->Records, 1, chunk->Used, SpillFile) != chunk->Used)
+	{
+	  Message (_("Can't write the undo history to a temporary file, "
+		     "keeping all of it in memory\n"));
+	  SpillFailed = true;
+	  return;
+	}
+      free (chunk->Records);
+      chunk->Records = NULL;
+      ChunkBytes -= UNDO_CHUNK_SIZE;
+      SpilledBytes += chunk->Used;
+    }
+}
+
+/*!
+ * \brief Frees Chunk and all chunks after it.
+ */
+static void
+FreeChunks (UndoChunkType *Chunk)
+{
+  UndoChunkType *next;
+
+  for (; Chunk; Chunk = next)
+    {
+      next = Chunk->Next;
+      if (Chunk->Records)
+	{
+	  free (Chunk->Records);
+	  ChunkBytes -= UNDO_CHUNK_SIZE;
+	}
+      else
+	SpilledBytes -= Chunk->Used;
+      free (Chunk);
+    }
+}
+
+/*!
+ * \brief Returns the record at a position, loading its chunk if needed.
+ *
+ * The position must not be at the end of the list.
+ */
+static UndoListType *
+CursorRecord (UndoCursorType *c)
+{
+  while (c->Offset == c->Chunk->Used && c->Chunk->Next != NULL)
+    {
+      c->Chunk = c->Chunk->Next;
+      c->Offset = 0;
+    }
+  LoadChunk (c->Chunk);
+  return CURSOR_RECORD (c);
+}
+
+/*!
+ * \brief Moves a position past the record returned by CursorRecord().
+ */
+static void
+NextRecord (UndoCursorType *c)
+{
+  c->Offset += CURSOR_RECORD (c)->Size * UNDO_RECORD_ALIGN;
+}
+
+/*!
+ * \brief Moves a position back to the record before it and returns that
+ * record, loading its chunk if needed.
+ *
+ * There must be a record before the position.
+ */
+static UndoListType *
+PrevRecord (UndoCursorType *c)
+{
+  while (c->Offset == 0)
+    {
+      c->Chunk = c->Chunk->Prev;
+      c->Offset = c->Chunk->Used;
+    }
+  LoadChunk (c->Chunk);
+  if (c->Offset == c->Chunk->Used)
+    c->Offset = c->Chunk->Last;
+  else
+    c->Offset -= CURSOR_RECORD (c)->PrevSize * UNDO_RECORD_ALIGN;
+  return CURSOR_RECORD (c);
+}
+
+/*!
+ * \brief Returns the record which the next Undo() starts with.
+ */
+static UndoListType *
+LastUndoRecord (void)
+{
+  UndoCursorType c = Top;
+
+  return PrevRecord (&c);
+}
+
+/*!
+ * \brief Frees what a record of the pruned redo list holds.
+ */
+static void
+FreeRecord (UndoListType *Entry)
+{
+  switch (Entry->Type)
+    {
+    case UNDO_CHANGENAME:
+      NameBytes -= NameSize (Entry->Data.ChangeName.Name);
+      free (Entry->Data.ChangeName.Name);
+      break;
+    case UNDO_REMOVE:
+      if (Entry->Data.Removed.Ptr2)
+	DestroyObject (RemoveList, Entry->Kind, Entry->Data.Removed.Ptr1,
+		       Entry->Data.Removed.Ptr2, Entry->Data.Removed.Ptr3);
+      break;
+    default:
+      break;
+    }
+}
+
+/*!
+ * \brief Drops the redo list.
+ */
+static void
+PruneRedoList (void)
+{
+  UndoCursorType c = Top;
+  UndoChunkType *chunk;
+
+  for (; RedoN; RedoN--, NextRecord (&c))
+    FreeRecord (CursorRecord (&c));
+
+  /* cut the list at the undo position */
+  chunk = Top.Chunk;
+  FreeChunks (chunk->Next);
+  chunk->Next = NULL;
+  LastChunk = chunk;
+  if (Top.Offset < chunk->Used)
+    {
+      if (Top.Offset > 0)
+	chunk->Last =
+	  Top.Offset - CURSOR_RECORD (&Top)->PrevSize * UNDO_RECORD_ALIGN;
+      chunk->Used = Top.Offset;
+    }
+}
+
 /*!
  * \brief Adds a command plus some data to the undo list.
  */
@@ -250,61 +612,69 @@ static UndoListType *
 GetUndoSlot (int CommandType, int ID, int Kind)
 {
   UndoListType *ptr;
-  void *ptr1, *ptr2, *ptr3;
-  int type;
+  UndoChunkType *chunk;
+  size_t size = RecordSize (CommandType);
   static size_t limit = UNDO_WARNING_SIZE;
 
 #ifdef DEBUG_ID
+  void *ptr1, *ptr2, *ptr3;
+
   if (SearchObjectByID (PCB->Data, &ptr1, &ptr2, &ptr3, ID, Kind) == NO_TYPE)
     Message ("hace: ID (%d) and Type (%x) mismatch in AddObject...\n", ID,
 	     Kind);
 #endif
 
+  /* free structures from the pruned redo list */
+  if (RedoN)
+    PruneRedoList ();
+
   /* allocate memory */
-  if (UndoN >= UndoMax)
+  chunk = LastChunk;
+  if (chunk == NULL || chunk->Used + size > UNDO_CHUNK_SIZE)
     {
-      size_t size;
+      chunk = (UndoChunkType *) calloc (1, sizeof (UndoChunkType));
+      chunk->Records = (char *) malloc (UNDO_CHUNK_SIZE);
+      if (chunk->Records == NULL)
+	{
+	  fprintf (stderr, "malloc() failed in %s\n", __FUNCTION__);
+	  exit (1);
+	}
+      chunk->Spilled = -1;
+      chunk->Prev = LastChunk;
+      if (LastChunk)
+	LastChunk->Next = chunk;
+      else
+	FirstChunk = chunk;
+      LastChunk = chunk;
+      ChunkBytes += UNDO_CHUNK_SIZE;
 
-      UndoMax += STEP_UNDOLIST;
-      size = UndoMax * sizeof (UndoListType);
-      UndoList = (UndoListType *) realloc (UndoList, size);
-      memset (&UndoList[UndoN], 0, STEP_REMOVELIST * sizeof (UndoListType));
+      Top.Chunk = chunk;
+      Top.Offset = 0;
+      SpillChunks ();
 
       /* ask user to flush the table because of it's size */
-      if (size > limit)
+      if (ChunkBytes > limit)
 	{
-	  limit = (size / UNDO_WARNING_SIZE + 1) * UNDO_WARNING_SIZE;
+	  limit = (ChunkBytes / UNDO_WARNING_SIZE + 1) * UNDO_WARNING_SIZE;
 	  Message (_("Size of 'undo-list' exceeds %li kb\n"),
-		   (long) (size >> 10));
+		   (long) (ChunkBytes >> 10));
 	}
     }
 
-  /* free structures from the pruned redo list */
-
-  for (ptr = &UndoList[UndoN]; RedoN; ptr++, RedoN--)
-    switch (ptr->Type)
-      {
-      case UNDO_CHANGENAME:
-	free (ptr->Data.ChangeName.Name);
-	break;
-      case UNDO_REMOVE:
-	type =
-	  SearchObjectByID (RemoveList, &ptr1, &ptr2, &ptr3, ptr->ID,
-			    ptr->Kind);
-	if (type != NO_TYPE)
-	  {
-	    DestroyObject (RemoveList, type, ptr1, ptr2, ptr3);
-	  }
-	break;
-      default:
-	break;
-      }
-
   if (between_increment_and_restore)
     added_undo_between_increment_and_restore = true;
 
   /* copy typefield and serial number to the list */
-  ptr = &UndoList[UndoN++];
+  ptr = (UndoListType *) (chunk->Records + chunk->Used);
+  memset (ptr, 0, size);
+  ptr->Size = size / UNDO_RECORD_ALIGN;
+  ptr->PrevSize = chunk->Used ? (chunk->Used - chunk->Last) / UNDO_RECORD_ALIGN : 0;
+  chunk->Last = chunk->Used;
+  chunk->Used += size;
+  Top.Chunk = chunk;
+  Top.Offset = chunk->Used;
+  UndoN++;
+
   ptr->Type = CommandType;
   ptr->Kind = Kind;
   ptr->ID = ID;
@@ -395,9 +765,11 @@ UndoChangeName (UndoListType *Entry)
     SearchObjectByID (PCB->Data, &ptr1, &ptr2, &ptr3, Entry->ID, Entry->Kind);
   if (type != NO_TYPE)
     {
+      NameBytes -= NameSize (Entry->Data.ChangeName.Name);
       Entry->Data.ChangeName.Name =
 	(char *)(ChangeObjectName (type, ptr1, ptr2, ptr3,
 			   Entry->Data.ChangeName.Name));
+      NameBytes += NameSize (Entry->Data.ChangeName.Name);
       return (true);
     }
   return (false);
@@ -423,6 +795,7 @@ UndoChange2ndSize (UndoListType *Entry)
 	EraseObject (type, ptr1, ptr2);
       ((PinType *) ptr2)->DrillingHole = Entry->Data.Size;
       Entry->Data.Size = swap;
+      InvalidateDrillInfo (PCB->Data);
       DrawObject (type, ptr1, ptr2);
       return (true);
     }
@@ -640,6 +1013,13 @@ UndoFlag (UndoListType *Entry)
 
       Entry->Data.Flags = swap;
 
+      /* the flags were restored wholesale, behind SET_FLAG's back */
+      UpdateSelectionIndex (type, ptr1, ptr2, true);
+
+      /* The hole flag decides whether a pin or via is plated.  */
+      if (type & (PIN_TYPE | VIA_TYPE))
+	InvalidateDrillInfo (PCB->Data);
+
       if (andDraw && must_redraw)
 	DrawObject (type, ptr1, ptr2);
       return (true);
@@ -679,6 +1059,28 @@ UndoMirror (UndoListType *Entry)
   return (false);
 }
 
+/*!
+ * \brief Remembers where an object that is about to be moved from the
+ * layout to the remove list will end up.
+ */
+static void
+SetRemovedObject (UndoListType *Entry, int Type,
+		  void *Ptr1, void *Ptr2, void *Ptr3)
+{
+  switch (Type)
+    {
+    case LINE_TYPE:
+    case ARC_TYPE:
+    case TEXT_TYPE:
+    case POLYGON_TYPE:
+      Ptr1 = &RemoveList->Layer[GetLayerNumber (PCB->Data, (LayerType *) Ptr1)];
+      break;
+    }
+  Entry->Data.Removed.Ptr1 = Ptr1;
+  Entry->Data.Removed.Ptr2 = Ptr2;
+  Entry->Data.Removed.Ptr3 = Ptr3;
+}
+
 /*!
  * \brief Recovers an object from a 'copy' or 'create' operation.
  *
@@ -700,6 +1102,7 @@ UndoCopyOrCreate (UndoListType *Entry)
       if (andDraw)
 	EraseObject (type, ptr1, ptr2);
       /* in order to make this re-doable we move it to the RemoveList */
+      SetRemovedObject (Entry, type, ptr1, ptr2, ptr3);
       MoveObjectToBuffer (RemoveList, PCB->Data, type, ptr1, ptr2, ptr3);
       Entry->Type = UNDO_REMOVE;
       return (true);
@@ -741,17 +1144,16 @@ static bool
 UndoRemove (UndoListType *Entry)
 {
   void *ptr1, *ptr2, *ptr3;
-  int type;
 
-  /* lookup entry by it's ID */
-  type =
-    SearchObjectByID (RemoveList, &ptr1, &ptr2, &ptr3, Entry->ID,
-		      Entry->Kind);
-  if (type != NO_TYPE)
+  /* the entry knows where the object is kept, no need to search for it */
+  ptr1 = Entry->Data.Removed.Ptr1;
+  ptr2 = Entry->Data.Removed.Ptr2;
+  ptr3 = Entry->Data.Removed.Ptr3;
+  if (ptr2)
     {
       if (andDraw)
-	DrawRecoveredObject (type, ptr1, ptr2, ptr3);
-      MoveObjectToBuffer (PCB->Data, RemoveList, type, ptr1, ptr2, ptr3);
+	DrawRecoveredObject (Entry->Kind, ptr1, ptr2, ptr3);
+      MoveObjectToBuffer (PCB->Data, RemoveList, Entry->Kind, ptr1, ptr2, ptr3);
       Entry->Type = UNDO_CREATE;
       return (true);
     }
@@ -1029,6 +1431,7 @@ UndoNetlistChange (UndoListType *Entry)
 
   *lib = *saved;
 
+  netlist_serial++;
   NetlistChanged (0);
   return true;
 }
@@ -1065,6 +1468,25 @@ UndoSetViaLayers (UndoListType *Entry)
   return (false);
 }
 
+static void
+StartLatency (void)
+{
+  if (Latency.Timer == NULL)
+    Latency.Timer = g_timer_new ();
+  else
+    g_timer_start (Latency.Timer);
+}
+
+static void
+StopLatency (int *Count, double *Total, double *Max)
+{
+  double elapsed = g_timer_elapsed (Latency.Timer, NULL);
+
+  (*Count)++;
+  *Total += elapsed;
+  MAKEMAX (*Max, elapsed);
+}
+
 /*!
  * \brief Undo of any 'hard to recover' operation.
  *
@@ -1074,6 +1496,7 @@ int
 Undo (bool draw)
 {
   UndoListType *ptr;
+  UndoCursorType c;
   int Types = 0;
   int unique;
   bool error_undoing = false;
@@ -1098,7 +1521,7 @@ Undo (bool draw)
 
   Serial --;
 
-  ptr = &UndoList[UndoN - 1];
+  ptr = LastUndoRecord ();
 
   if (ptr->Serial > Serial)
     {
@@ -1117,18 +1540,30 @@ Undo (bool draw)
       return 0;
     }
 
+  StartLatency ();
   LockUndo (); /* lock undo module to prevent from loops */
+  BeginPolygonBatch ();
 
   /* Loop over all entries with the correct serial number */
-  for (; UndoN && ptr->Serial == Serial; ptr--, UndoN--, RedoN++)
+  for (; UndoN; UndoN--, RedoN++)
     {
-      int undid = PerformUndo (ptr);
+      int undid;
+
+      c = Top;
+      ptr = PrevRecord (&c);
+      if (ptr->Serial != Serial)
+	break;
+      Top = c;
+      undid = PerformUndo (ptr);
       if (undid == 0)
         error_undoing = true;
       Types |= undid;
     }
 
+  EndPolygonBatch ();
   UnlockUndo ();
+  SpillChunks ();
+  StopLatency (&Latency.Undos, &Latency.UndoTotal, &Latency.UndoMax);
 
   if (error_undoing)
     Message (_("ERROR: Failed to undo some operations\n"));
@@ -1276,7 +1711,7 @@ Redo (bool draw)
       return 0;
     }
 
-  ptr = &UndoList[UndoN];
+  ptr = CursorRecord (&Top);
 
   if (ptr->Serial < Serial)
     {
@@ -1295,12 +1730,20 @@ Redo (bool draw)
       return 0;
     }
 
+  StartLatency ();
   LockUndo (); /* lock undo module to prevent from loops */
+  BeginPolygonBatch ();
 
   /* and loop over all entries with the correct serial number */
-  for (; RedoN && ptr->Serial == Serial; ptr++, UndoN++, RedoN--)
+  for (; RedoN; UndoN++, RedoN--)
     {
-      int undid = PerformUndo (ptr);
+      int undid;
+
+      ptr = CursorRecord (&Top);
+      if (ptr->Serial != Serial)
+	break;
+      undid = PerformUndo (ptr);
+      NextRecord (&Top);
       if (undid == 0)
         error_undoing = true;
       Types |= undid;
@@ -1309,7 +1752,10 @@ Redo (bool draw)
   /* Make next serial number current */
   Serial++;
 
+  EndPolygonBatch ();
   UnlockUndo ();
+  SpillChunks ();
+  StopLatency (&Latency.Redos, &Latency.RedoTotal, &Latency.RedoMax);
 
   if (error_undoing)
     Message (_("ERROR: Failed to redo some operations\n"));
@@ -1365,7 +1811,7 @@ IncrementUndoSerialNumber (void)
   if (!Locked)
     {
       /* Set the changed flag if anything was added prior to this bump */
-      if (UndoN > 0 && UndoList[UndoN - 1].Serial == Serial)
+      if (UndoN > 0 && LastUndoRecord ()->Serial == Serial)
         SetChangedFlag (true);
       Serial++;
       Bumped = true;
@@ -1393,14 +1839,20 @@ IncrementUndoSerialNumber (void)
 int
 MergeUndoSerialRange(int min, int max)
 {
+  UndoCursorType c = Top;
+  UndoListType *undo;
   size_t n;
   int dsn = max - min; /* delta serial number */
-  for(n = 0; n < UndoN; n++)
+  /* serial numbers never decrease along the list, so only the tail
+   * starting at the first entry >= min needs to be looked at
+   */
+  for(n = UndoN; n > 0; n--)
   {
-    if (UndoList[n].Serial < min) continue;
-    else if (UndoList[n].Serial <= max) UndoList[n].Serial = min;
+    undo = PrevRecord (&c);
+    if (undo->Serial < min) break;
+    if (undo->Serial <= max) undo->Serial = min;
     /* greater than max */
-    else UndoList[n].Serial -= dsn;
+    else undo->Serial -= dsn;
   }
   Serial -= dsn;
   return Serial;
@@ -1412,19 +1864,38 @@ MergeUndoSerialRange(int min, int max)
 void
 ClearUndoList (bool Force)
 {
+  UndoChunkType *chunk, *next;
   UndoListType *undo;
+  size_t offset;
 
   if (UndoN
       && (Force || gui->confirm_dialog ("OK to clear 'undo' buffer?", 0)))
     {
       /* release memory allocated by objects in undo list */
-      for (undo = UndoList; UndoN; undo++, UndoN--)
+      for (chunk = FirstChunk; chunk; chunk = next)
+	{
+	  next = chunk->Next;
+	  LoadChunk (chunk);
+	  for (offset = 0; offset < chunk->Used;
+	       offset += undo->Size * UNDO_RECORD_ALIGN)
+	    {
+	      undo = (UndoListType *) (chunk->Records + offset);
+	      if (undo->Type == UNDO_CHANGENAME)
+		free (undo->Data.ChangeName.Name);
+	    }
+	  chunk->Next = NULL;
+	  FreeChunks (chunk);
+	}
+      FirstChunk = LastChunk = NULL;
+      Top.Chunk = NULL;
+      Top.Offset = 0;
+      if (SpillFile)
 	{
-	  if (undo->Type == UNDO_CHANGENAME)
-	    free (undo->Data.ChangeName.Name);
+	  fclose (SpillFile);
+	  SpillFile = NULL;
 	}
-      free (UndoList);
-      UndoList = NULL;
+      SpillEnd = 0;
+      NameBytes = 0;
       if (RemoveList)
 	{
           FreeDataMemory (RemoveList);
@@ -1433,13 +1904,77 @@ ClearUndoList (bool Force)
         }
 
       /* reset some counters */
-      UndoN = UndoMax = RedoN = 0;
+      UndoN = RedoN = 0;
     }
 
   /* reset counter in any case */
   Serial = 1;
 }
 
+/*!
+ * \brief Estimates the memory held by the objects in Data.
+ */
+static size_t
+DataBytes (DataType *Data)
+{
+  size_t bytes = sizeof (DataType);
+
+  bytes += Data->ViaN * sizeof (PinType) + Data->RatN * sizeof (RatType);
+  ELEMENT_LOOP (Data);
+  {
+    bytes += sizeof (ElementType) + element->PinN * sizeof (PinType)
+      + element->PadN * sizeof (PadType)
+      + element->LineN * sizeof (LineType)
+      + element->ArcN * sizeof (ArcType);
+  }
+  END_LOOP;
+  ALLLINE_LOOP (Data);
+  {
+    bytes += sizeof (LineType);
+  }
+  ENDALL_LOOP;
+  ALLARC_LOOP (Data);
+  {
+    bytes += sizeof (ArcType);
+  }
+  ENDALL_LOOP;
+  ALLTEXT_LOOP (Data);
+  {
+    bytes += sizeof (TextType) + (text->TextString
+				  ? strlen (text->TextString) + 1 : 0);
+  }
+  ENDALL_LOOP;
+  ALLPOLYGON_LOOP (Data);
+  {
+    bytes += sizeof (PolygonType) + polygon->PointN * sizeof (PointType)
+      + polygon->HoleIndexN * sizeof (Cardinal);
+  }
+  ENDALL_LOOP;
+  return bytes;
+}
+
+/*!
+ * \brief Reports the size of the undo history and how long undoing
+ * and redoing took in this session.
+ */
+void
+GetUndoStatistics (UndoStatisticsType *Stats)
+{
+  memset (Stats, 0, sizeof (*Stats));
+  Stats->Entries = UndoN;
+  Stats->RedoEntries = RedoN;
+  Stats->ListBytes = ChunkBytes + NameBytes;
+  Stats->SpilledBytes = SpilledBytes;
+  if (RemoveList)
+    Stats->RemovedBytes = DataBytes (RemoveList);
+  Stats->Undos = Latency.Undos;
+  Stats->UndoSeconds = Latency.UndoTotal;
+  Stats->UndoMaxSeconds = Latency.UndoMax;
+  Stats->Redos = Latency.Redos;
+  Stats->RedoSeconds = Latency.RedoTotal;
+  Stats->RedoMaxSeconds = Latency.RedoMax;
+}
+
 /*!
  * \brief Adds an object to the list of clearpoly objects.
  */
@@ -1499,13 +2034,16 @@ AddObjectToRotateUndoList (int Type, void *Ptr1, void *Ptr2, void *Ptr3,
 void
 MoveObjectToRemoveUndoList (int Type, void *Ptr1, void *Ptr2, void *Ptr3)
 {
+  UndoListType *undo;
+
   if (Locked)
     return;
 
   if (!RemoveList)
     RemoveList = CreateNewBuffer ();
 
-  GetUndoSlot (UNDO_REMOVE, OBJECT_ID (Ptr3), Type);
+  undo = GetUndoSlot (UNDO_REMOVE, OBJECT_ID (Ptr3), Type);
+  SetRemovedObject (undo, Type, Ptr1, Ptr2, Ptr3);
   MoveObjectToBuffer (RemoveList, PCB->Data, Type, Ptr1, Ptr2, Ptr3);
 }
 
@@ -1635,6 +2173,7 @@ AddObjectToChangeNameUndoList (int Type, void *Ptr1, void *Ptr2, void *Ptr3,
     {
       undo = GetUndoSlot (UNDO_CHANGENAME, OBJECT_ID (Ptr3), Type);
       undo->Data.ChangeName.Name = OldName;
+      NameBytes += NameSize (OldName);
     }
 }
 
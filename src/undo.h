@@ -43,6 +43,21 @@
 
 											/* different layers */
 
+/*!
+ * \brief Size of the undo history and undo/redo timings of a session.
+ */
+typedef struct
+{
+  size_t Entries; /*!< Operations that can be undone. */
+  size_t RedoEntries; /*!< Operations that can be redone. */
+  size_t ListBytes; /*!< Memory held by the undo list. */
+  size_t SpilledBytes; /*!< Undo list records written to a temporary file. */
+  size_t RemovedBytes; /*!< Estimated memory held by removed objects. */
+  int Undos, Redos; /*!< Calls to Undo() and Redo(). */
+  double UndoSeconds, UndoMaxSeconds; /*!< Total and slowest Undo(). */
+  double RedoSeconds, RedoMaxSeconds; /*!< Total and slowest Redo(). */
+} UndoStatisticsType;
+
 int Undo (bool);
 int Redo (bool);
 int IncrementUndoSerialNumber (void);
@@ -76,5 +91,6 @@ void AddNetlistLibToUndoList (LibraryType *);
 void LockUndo (void);
 void UnlockUndo (void);
 bool Undoing (void);
+void GetUndoStatistics (UndoStatisticsType *);
 
 #endif
@@ -0,0 +1,164 @@
+#!/bin/sh
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of version 2 of the GNU General Public License as
+#  published by the Free Software Foundation
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+#  MA 02110-1301 USA.
+#
+# Checks the --batch-socket mode of the batch HID.  A server is started
+# on a board, two clients connect to it at the same time, and every reply
+# must be "message <text>" lines followed by "status <result> <microseconds>".
+#
+# Exit status 77 tells automake that the test was skipped.
+
+srcdir=${srcdir:-.}
+INDIR=${INDIR:-${srcdir}/inputs}
+PCB=${PCB:-../src/pcbtest.sh}
+PERL=${PERL:-perl}
+
+if grep '^HID="batch"' ${PCB} >/dev/null 2>&1 ; then
+    :
+else
+    echo "pcb was not built with the batch HID, skipping"
+    exit 77
+fi
+
+if ${PERL} -MIO::Socket::UNIX -e 1 >/dev/null 2>&1 ; then
+    :
+else
+    echo "perl with IO::Socket::UNIX was not found, skipping"
+    exit 77
+fi
+
+# socket paths are limited to about 100 characters, so stay out of the
+# build tree
+sock=${TMPDIR:-/tmp}/pcb-batch-socket.$$
+log=batch_socket.log
+
+rm -f ${sock}
+${PCB} --batch-socket ${sock} ${INDIR}/gerber_oneline.pcb \
+    < /dev/null > ${log} 2>&1 &
+pid=$!
+
+tries=0
+while test ! -S ${sock} ; do
+    tries=`expr ${tries} + 1`
+    if test ${tries} -gt 30 ; then
+	echo "The server did not create ${sock}:"
+	cat ${log}
+	kill ${pid} 2>/dev/null
+	exit 1
+    fi
+    sleep 1
+done
+
+${PERL} - ${sock} << 'EOF'
+use strict;
+use IO::Socket::UNIX;
+
+my $path = shift;
+
+sub client
+{
+  return IO::Socket::UNIX->new (Type => SOCK_STREAM, Peer => $path)
+    || die "Cannot connect to $path: $!\n";
+}
+
+# Reads one reply and checks its format.  Returns the result and the
+# message texts.
+sub reply
+{
+  my ($c, $what) = @_;
+  my @messages;
+
+  while (defined (my $line = <$c>))
+    {
+      if ($line =~ /^message (.*)\n$/)
+	{
+	  push @messages, $1;
+	}
+      elsif ($line =~ /^status (-?\d+) (\d+)\n$/)
+	{
+	  return ($1, @messages);
+	}
+      else
+	{
+	  die "$what: malformed reply line \"$line\"\n";
+	}
+    }
+  die "$what: connection closed before the status line\n";
+}
+
+sub expect
+{
+  my ($c, $what, $result, @expected) = @_;
+  my ($got, @messages) = reply ($c, $what);
+
+  die "$what: result $got, expected $result\n" if $got != $result;
+  die "$what: messages \"@messages\", expected \"@expected\"\n"
+    if "@messages" ne "@expected";
+}
+
+my $a = client ();
+my $b = client ();
+
+# Both clients are connected.  The second one is answered although the
+# first has not read its reply yet.
+print $a "Message(first,second)\n";
+print $b "Message(other)\n";
+expect ($b, "second client", 0, "other");
+expect ($a, "first client", 0, "first", "second");
+
+# Lines sent together are answered in order.
+print $a "Message(one)\nMessage(two)\r\n";
+expect ($a, "first line", 0, "one");
+expect ($a, "second line", 0, "two");
+
+# A failing action still gets a well formed reply.
+print $b "NoSuchAction()\n";
+my ($result) = reply ($b, "unknown action");
+die "unknown action: result 0, expected a failure\n" if $result == 0;
+
+close ($a);
+print $b "Message(again)\n";
+expect ($b, "after the first client left", 0, "again");
+
+print $b "Quit()\n";
+close ($b);
+exit 0;
+EOF
+rc=$?
+
+if test ${rc} -ne 0 ; then
+    kill ${pid} 2>/dev/null
+    wait ${pid}
+    echo "Server log:"
+    cat ${log}
+    exit 1
+fi
+
+wait ${pid}
+rc=$?
+if test ${rc} -ne 0 ; then
+    echo "The server exited with status ${rc}:"
+    cat ${log}
+    exit 1
+fi
+
+if test -S ${sock} ; then
+    echo "The server did not remove ${sock}"
+    rm -f ${sock}
+    exit 1
+fi
+
+rm -f ${log}
+exit 0
@@ -763,6 +763,28 @@ compare_pcb() {
     run_diff "$cf1" "$cf2" || test_failed=yes
 }
 
+# used to compare only the rat lines of two layouts
+normalize_rats() {
+    local f1="$1"
+    local f2="$2"
+    grep '^Rat[[(]' $f1 > $f2
+}
+
+compare_rats() {
+    local f1="$1"
+    local f2="$2"
+
+    compare_check "compare_rats" "$f1" "$f2" || return 1
+
+    local cf1=${tmpd}/`basename $f1`-ref
+    local cf2=${tmpd}/`basename $f2`-out
+
+    normalize_rats $f1 $cf1
+    normalize_rats $f2 $cf2
+
+    run_diff "$cf1" "$cf2" || test_failed=yes
+}
+
 ##########################################################################
 #
 # The main program loop
@@ -996,6 +1018,10 @@ for t in $all_tests ; do
 		    compare_pcb ${refdir}/${fn} ${rundir}/${fn}
 		    ;;
 
+		rats)
+		    compare_rats ${refdir}/${fn} ${rundir}/${fn}
+		    ;;
+
 		# unknown
 		*)
 		    echo "internal error:  $type is not a known file type"